@@ -37,6 +37,7 @@ set_if_false (ENABLE_DEBUG NDEBUG)
 set_if_false (ENABLE_COREFILES NOCOREFILE)
 set_if_true (ENABLE_INTEL_SOFT_CPM INTEL_SOFT_CPM)
 set_if_true (BUILD_UNIT_TESTS UNIT_TEST)
+set_if_true (BUILD_BENCHMARKS BENCHMARK)
 set_if_true (ENABLE_PROFILE PROFILE)
 set_if_true (ENABLE_SHELL BUILD_SHELL)
 
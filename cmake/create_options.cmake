@@ -31,6 +31,7 @@ option (ENABLE_INTEL_SOFT_CPM "Enable Intel Soft CPM support" OFF)
 option (ENABLE_LARGE_PCAP "Enable support for pcaps larger than 2 GB" OFF)
 option (BUILD_SIDE_CHANNEL "Build the side channel library" OFF)
 option (BUILD_UNIT_TESTS "Build Snort++ unit tests" OFF)
+option (BUILD_BENCHMARKS "Build Snort++ benchmarks" OFF)
 option (BUILD_EXTRA_PLUGINS "Build and test the plugins in the extra directory" OFF)
 option (MAKE_HTML_DOC "Create the HTML documentation" ON)
 option (MAKE_PDF_DOC "Create the PDF documentation" ON)
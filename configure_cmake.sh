@@ -41,6 +41,7 @@ Optional Features:
     --disable-corefiles      Prevent Snort from generating core files
     --enable-intel-soft-cpm  Enable Intel Soft CPM support
     --enable-unit-tests      Build unit tests
+    --enable-benchmarks      Build benchmarks
     --enable-large-pcap      Enable support for pcaps larger than 2 GB
     --disable-static-daq     Link static DAQ modules.
     --enable-shell           enable command line shell support
@@ -289,6 +290,12 @@ while [ $# -ne 0 ]; do
         --enable-unit-tests)
             append_cache_entry BUILD_UNIT_TESTS    BOOL   true
             ;;
+        --disable-benchmarks)
+            append_cache_entry BUILD_BENCHMARKS    BOOL   false
+            ;;
+        --enable-benchmarks)
+            append_cache_entry BUILD_BENCHMARKS    BOOL   true
+            ;;
         --disable-html-docs)
             append_cache_entry MAKE_HTML_DOC    BOOL   false
             ;;
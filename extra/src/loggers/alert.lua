@@ -57,6 +57,20 @@ function alert ()
         evt.gid, evt.sid, evt.rev, str))
 end
 
+-- alert_batch() is optional
+-- if present and batch > 1, it is called instead of alert() with
+-- up to batch of the events queued for a packet at once
+function alert_batch ()
+    local evts = ffi.C.get_events()
+
+    for i = 0, evts.num - 1 do
+        local evt = evts.event[i]
+
+        print(string.format('%d:%d:%d %s',
+            evt.gid, evt.sid, evt.rev, ffi.string(evt.msg)))
+    end
+end
+
 -- plugin table is required
 plugin =
 {
@@ -69,6 +69,7 @@ perf_monitor = { }
 arp_spoof = { }
 back_orifice = { }
 rpc_decode = { }
+ssl = { }
 port_scan = { }
 telnet = { }
 
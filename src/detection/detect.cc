@@ -54,6 +54,7 @@
 #include "packet_io/active.h"
 #include "signature.h"
 #include "ppm.h"
+#include "time/latency.h"
 #include "snort_types.h"
 #include "detection_util.h"
 #include "managers/inspector_manager.h"
@@ -312,6 +313,7 @@ bool Detect(Packet * p)
 {
     int detected = 0;
     PROFILE_VARS;
+    LATENCY_VARS;
 
     if ((p == NULL) || !p->ptrs.ip_api.is_valid())
     {
@@ -358,7 +360,9 @@ bool Detect(Packet * p)
             **  that we can do IP checks.
             */
             MODULE_PROFILE_START(detectPerfStats);
+            LATENCY_START();
             detected = fpEvalPacket(p);
+            LATENCY_END(detect);
             MODULE_PROFILE_END(detectPerfStats);
 
             return detected;
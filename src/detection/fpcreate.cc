@@ -712,6 +712,10 @@ int fpDetectGetDebugPrintFastPatterns(FastPatternConfig *fp)
 {
     return fp->debug_print_fast_pattern;
 }
+int fpDetectGetParallelPortTables(FastPatternConfig *fp)
+{
+    return fp->portlists_flags & PL_PARALLEL_PORT_TABLES;
+}
 int fpDetectSplitAnyAny(FastPatternConfig *fp)
 {
     return fp->split_any_any;
@@ -748,6 +752,10 @@ void fpDetectSetDebugPrintFastPatterns(FastPatternConfig *fp, int flag)
 {
     fp->debug_print_fast_pattern = flag;
 }
+void fpDetectSetParallelPortTables(FastPatternConfig *fp)
+{
+    fp->portlists_flags |= PL_PARALLEL_PORT_TABLES;
+}
 void fpSetDetectSearchOpt(FastPatternConfig *fp, int flag)
 {
     fp->search_opt = flag;
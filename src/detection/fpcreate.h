@@ -50,6 +50,7 @@ struct SnortConfig;
 #define PL_DEBUG_PRINT_RULEGROUPS_UNCOMPILED 0x08
 #define PL_DEBUG_PRINT_RULEGROUPS_COMPILED   0x10
 #define PL_SINGLE_RULE_GROUP                 0x20
+#define PL_PARALLEL_PORT_TABLES              0x40
 
 typedef struct _pmx_
 {
@@ -168,6 +169,7 @@ void fpDetectSetDebugPrintRuleGroupBuildDetails(FastPatternConfig *);
 void fpDetectSetDebugPrintRuleGroupsCompiled(FastPatternConfig *);
 void fpDetectSetDebugPrintRuleGroupsUnCompiled(FastPatternConfig *);
 void fpDetectSetDebugPrintFastPatterns(FastPatternConfig *, int);
+void fpDetectSetParallelPortTables(FastPatternConfig *);
 
 int  fpDetectGetSingleRuleGroup(FastPatternConfig *);
 int  fpDetectGetBleedOverPortLimit(FastPatternConfig *);
@@ -178,6 +180,7 @@ int  fpDetectGetDebugPrintRuleGroupsCompiled(FastPatternConfig *);
 int  fpDetectGetDebugPrintRuleGroupsUnCompiled(FastPatternConfig *);
 int  fpDetectSplitAnyAny(FastPatternConfig *);
 int  fpDetectGetDebugPrintFastPatterns(FastPatternConfig *);
+int  fpDetectGetParallelPortTables(FastPatternConfig *);
 
 void fpDeleteFastPacketDetection(SnortConfig*);
 
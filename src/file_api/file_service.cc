@@ -49,6 +49,7 @@
 #include "framework/inspector.h"
 #include "detection_util.h"
 #include "service_inspectors/http_inspect/hi_main.h" // FIXIT-M bad dependency; use inspector::get_buf()
+#include "time/shed.h"
 
 static bool file_type_id_enabled = false;  // STATIC
 static bool file_signature_enabled = false;
@@ -188,6 +189,12 @@ static void start_file_processing(void)
         file_processing_initiated = true;
     }
 }
+
+void compile_file_config(void *conf)
+{
+    compile_file_identifiers(conf);
+}
+
 void free_file_config(void *conf)
 {
 
@@ -611,6 +618,8 @@ static int file_process( void* p, uint8_t* file_data, int data_size,
         return 0;
     if (position == SNORT_FILE_POSITION_UNKNOWN)
         return 0;
+    if (SHED_SKIP(pkt->flow, SHED_FILES, files_skipped))
+        return 0;
 #if defined(DEBUG_MSGS) && !defined (REG_TEST)
     if (DEBUG_FILE & GetDebugLevel())
 #endif
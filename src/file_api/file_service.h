@@ -34,6 +34,7 @@
 
 void FileAPIInit(void);
 void FileAPIPostInit(void);
+void compile_file_config(void*);
 void free_file_config(void*);
 void close_fileAPI(void);
 #endif
@@ -33,16 +33,9 @@
 
 #define FILE_ID_MAX          1024
 
-typedef struct _IdentifierMemoryBlock
-{
-    void *mem_block;  /*the node that is shared*/
-    struct _IdentifierMemoryBlock *next;  /*next node*/
-}IdentifierMemoryBlock;
-
 typedef struct _fileConfig
 {
-    IdentifierNode *identifier_root; /*Root of magic tries*/
-    IdentifierMemoryBlock *id_memory_root; /*root of memory used*/
+    IdentifierDfa *identifier_dfa; /*Compiled magic rules*/
     RuleInfo *FileRules[FILE_ID_MAX + 1];
     int64_t file_type_depth;
     int64_t file_signature_depth;
@@ -32,121 +32,273 @@
 #include <sys/types.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
 
 #include "snort_types.h"
 #include "snort_debug.h"
 #include "parser.h"
 #include "util.h"
 #include "mstring.h"
-#include "sfghash.h"
 #include "file_config.h"
 
 static THREAD_LOCAL_TBD uint32_t memory_used = 0; /*Track memory usage*/
 
-static THREAD_LOCAL_TBD SFGHASH *identifier_merge_hash = NULL;
+/* Guards against rule sets that blow up during subset construction */
+#define ID_DFA_MAX_STATES (1 << 20)
 
-typedef struct _IdentifierSharedNode
+struct MagicByte
 {
-    IdentifierNode *shared_node;  /*the node that is shared*/
-    IdentifierNode *append_node;  /*the node that is added*/
-} IdentifierSharedNode;
-
-static THREAD_LOCAL_TBD IdentifierMemoryBlock *id_memory_root = NULL;
-static THREAD_LOCAL_TBD IdentifierMemoryBlock *id_memory_current = NULL;
+    uint32_t offset;
+    uint8_t byte;
+};
 
+struct MagicRule
+{
+    uint32_t type_id;
+    std::vector<MagicByte> bytes;  /* sorted by offset */
+};
 
-static void identifierMergeHashFree(void)
+/* A DFA state is the set of rules still matching when the byte at offset
+ * is examined plus the last type matched so far.  All rules are anchored
+ * at the file start so the offset fixes each rule's position. */
+struct DfaKey
 {
-    if (identifier_merge_hash != NULL)
+    uint32_t offset;
+    uint32_t type_id;
+    std::vector<uint32_t> rules;
+
+    bool operator<(const DfaKey& rhs) const
     {
-        sfghash_delete(identifier_merge_hash);
-        identifier_merge_hash = NULL;
+        if ( offset != rhs.offset )
+            return offset < rhs.offset;
+
+        if ( type_id != rhs.type_id )
+            return type_id < rhs.type_id;
+
+        return rules < rhs.rules;
     }
+};
+
+struct DfaBuild
+{
+    std::vector<MagicRule> rules;
+    std::map<DfaKey, uint32_t> map;
+    std::vector<const DfaKey*> keys;
+    std::vector<IdentifierState> states;
+    std::vector<uint8_t> bytes;
+    std::vector<uint32_t> next;
+};
+
+static inline bool magic_before(const MagicByte& mb, uint32_t offset)
+{
+    return mb.offset < offset;
 }
 
-static void identifierMergeHashInit(void)
+/* Index of the first byte the rule checks at or after offset */
+static inline unsigned magic_at(const MagicRule& mr, uint32_t offset)
 {
-    if (identifier_merge_hash != NULL)
-        identifierMergeHashFree();
+    return std::lower_bound(
+        mr.bytes.begin(), mr.bytes.end(), offset, magic_before) - mr.bytes.begin();
+}
+
+static void add_magic_rule(DfaBuild& b, RuleInfo *rule)
+{
+    MagicRule mr;
+    mr.type_id = rule->id;
 
-    identifier_merge_hash = sfghash_new(1000, sizeof(IdentifierSharedNode), 0, NULL);
-    if (identifier_merge_hash == NULL)
+    for ( MagicData *md = rule->magics; md; md = md->next )
     {
-        FatalError("%s(%d) Could not create identifier merge hash.\n",
-                __FILE__, __LINE__);
+        for ( int i = 0; i < md->content_len; i++ )
+        {
+            MagicByte mb = { md->offset + i, md->content[i] };
+            mr.bytes.push_back(mb);
+        }
     }
+    if ( mr.bytes.empty() )
+        return;
 
+    std::stable_sort(mr.bytes.begin(), mr.bytes.end(),
+        [](const MagicByte& x, const MagicByte& y) { return x.offset < y.offset; });
+
+    b.rules.push_back(mr);
 }
 
-static inline void *calloc_mem(size_t size)
+/* Get the state reached after the byte at offset was matched (or skipped)
+ * by the candidate rules.  Rules whose last byte is at offset complete
+ * here; the later rule wins if several do.  Returns 0 if nothing is left
+ * to match and nothing new was found. */
+static uint32_t get_state(
+    DfaBuild& b, uint32_t offset, uint32_t type_id, const std::vector<uint32_t>& cand)
 {
-    void *ret;
-    IdentifierMemoryBlock *imb;
-    ret = SnortAlloc(size);
-    memory_used += size;
-    /*For memory management*/
-    size = sizeof(*imb);
-    imb = (IdentifierMemoryBlock *)SnortAlloc(size);
-    imb->mem_block = ret;
-    if (!id_memory_root)
-    {
-        id_memory_root = imb;
-    }
-    else
+    DfaKey key;
+    uint32_t found = 0;
+
+    key.offset = UINT32_MAX;
+
+    for ( auto r : cand )
     {
-        id_memory_current->next = imb;
+        const MagicRule& mr = b.rules[r];
+
+        if ( mr.bytes.back().offset == offset )
+        {
+            found = mr.type_id;
+            continue;
+        }
+        key.rules.push_back(r);
+
+        const MagicByte& mb = mr.bytes[magic_at(mr, offset + 1)];
+
+        if ( mb.offset < key.offset )
+            key.offset = mb.offset;
     }
-    id_memory_current = imb;
-    memory_used += size;
-    DEBUG_WRAP(DebugMessage(DEBUG_FILE,"calloc:  %p (%d).\n", ret, size););
-    return ret;
-}
 
-static void  set_node_state_shared(IdentifierNode *start)
-{
-    int i;
+    if ( key.rules.empty() && !found )
+        return 0;
 
-    if (!start)
-        return;
+    key.type_id = found ? found : type_id;
 
-    if (start->state == ID_NODE_SHARED)
-        return;
+    auto it = b.map.find(key);
+
+    if ( it != b.map.end() )
+        return it->second;
 
-    if (start->state == ID_NODE_USED)
-       start->state = ID_NODE_SHARED;
-    else
+    uint32_t id = b.states.size();
+    IdentifierState state = { key.offset, key.type_id, 0, 0, 0 };
+
+    b.states.push_back(state);
+    it = b.map.insert(std::make_pair(key, id)).first;
+    b.keys.push_back(&it->first);
+
+    return id;
+}
+
+/* Add the transitions out of state id */
+static void expand_state(DfaBuild& b, uint32_t id)
+{
+    const DfaKey& key = *b.keys[id];
+    std::vector<uint32_t> wild;
+    std::vector<std::pair<uint8_t, uint32_t> > fixed;
+
+    for ( auto r : key.rules )
     {
-       start->state = ID_NODE_USED;
+        const MagicRule& mr = b.rules[r];
+        const MagicByte& mb = mr.bytes[magic_at(mr, key.offset)];
+
+        if ( mb.offset == key.offset )
+            fixed.push_back(std::make_pair(mb.byte, r));
+        else
+            wild.push_back(r);
     }
+    std::sort(fixed.begin(), fixed.end());
 
-    for(i = 0; i < MAX_BRANCH; i++)
+    uint32_t edge = b.bytes.size();
+    unsigned i = 0;
+
+    while ( i < fixed.size() )
     {
-        set_node_state_shared(start->next[i]);
+        uint8_t byte = fixed[i].first;
+        std::vector<uint32_t> cand;
+
+        while ( i < fixed.size() && fixed[i].first == byte )
+            cand.push_back(fixed[i++].second);
+
+        cand.insert(cand.end(), wild.begin(), wild.end());
+        std::sort(cand.begin(), cand.end());
+
+        uint32_t next = get_state(b, key.offset, key.type_id, cand);
+
+        if ( next )
+        {
+            b.bytes.push_back(byte);
+            b.next.push_back(next);
+        }
     }
+
+    uint32_t other = wild.empty() ? 0 : get_state(b, key.offset, key.type_id, wild);
+
+    /* b.states may have grown */
+    IdentifierState& state = b.states[id];
+    state.edge = edge;
+    state.num_edges = b.bytes.size() - edge;
+    state.other = other;
 }
 
-/*Clone a trie*/
-static IdentifierNode *clone_node(IdentifierNode *start)
+static IdentifierDfa *compile_identifiers(DfaBuild& b)
 {
-    int index;
-    IdentifierNode *node;
-    if (!start)
+    if ( b.rules.empty() )
         return NULL;
 
-    node = (IdentifierNode*)calloc_mem(sizeof(*node));
+    DfaKey start;
+    start.offset = UINT32_MAX;
+    start.type_id = 0;
+
+    for ( uint32_t r = 0; r < b.rules.size(); r++ )
+    {
+        start.rules.push_back(r);
+
+        if ( b.rules[r].bytes[0].offset < start.offset )
+            start.offset = b.rules[r].bytes[0].offset;
+    }
 
-    node->offset = start->offset;
-    node->type_id = start->type_id;
+    /* state 0 is the no match state */
+    IdentifierState none = { 0, 0, 0, 0, 0 };
+    IdentifierState first = { start.offset, 0, 0, 0, 0 };
+    b.states.push_back(none);
+    b.keys.push_back(NULL);
+    b.states.push_back(first);
+    b.keys.push_back(&b.map.insert(std::make_pair(start, 1)).first->first);
 
-    for(index = 0; index < MAX_BRANCH; index++)
+    for ( uint32_t id = 1; id < b.states.size(); id++ )
     {
-        if (start->next[index])
+        if ( b.states.size() > ID_DFA_MAX_STATES )
         {
-            node->next[index] = start->next[index];
+            ParseError("file magic rules are too complex to compile.");
+            return NULL;
         }
+        if ( b.keys[id]->offset != UINT32_MAX )
+            expand_state(b, id);
+    }
+
+    IdentifierDfa *dfa = (IdentifierDfa*)SnortAlloc(sizeof(*dfa));
+    dfa->num_states = b.states.size();
+    dfa->num_edges = b.bytes.size();
+
+    size_t size = dfa->num_states * sizeof(*dfa->states);
+    dfa->states = (IdentifierState*)SnortAlloc(size);
+    memcpy(dfa->states, &b.states[0], size);
+    memory_used = sizeof(*dfa) + size;
+
+    if ( dfa->num_edges )
+    {
+        dfa->edge_bytes = (uint8_t*)SnortAlloc(dfa->num_edges);
+        memcpy(dfa->edge_bytes, &b.bytes[0], dfa->num_edges);
 
+        size = dfa->num_edges * sizeof(*dfa->edge_next);
+        dfa->edge_next = (uint32_t*)SnortAlloc(size);
+        memcpy(dfa->edge_next, &b.next[0], size);
+        memory_used += dfa->num_edges + size;
     }
-    return node;
+
+    DEBUG_WRAP(DebugMessage(DEBUG_FILE,
+        "File magic DFA: %u rules, %u states, %u edges, %u bytes.\n",
+        (unsigned)b.rules.size(), dfa->num_states, dfa->num_edges, memory_used););
+
+    return dfa;
+}
+
+static void free_dfa(IdentifierDfa *dfa)
+{
+    if (!dfa)
+        return;
+
+    free(dfa->states);
+    free(dfa->edge_bytes);
+    free(dfa->edge_next);
+    free(dfa);
 }
 
 static void verify_magic_offset(MagicData *parent, MagicData *current)
@@ -220,191 +372,43 @@ static void sort_magics(MagicData **head)
     }
 }
 
-/*Create a trie for the magic*/
-static inline IdentifierNode *create_trie_from_magic(MagicData **head, uint32_t type_id)
-{
-    int i;
-    IdentifierNode *current;
-    IdentifierNode *root = NULL;
-    MagicData *magic;
-
-    if (!head || !(*head)||(0 == (*head)->content_len) || !type_id)
-        return NULL;
-
-    sort_magics(head);
-    magic = *head;
-
-    current =  (IdentifierNode*)calloc_mem(sizeof(*current));
-    current->state = ID_NODE_NEW;
-    root = current;
-
-    while (magic)
-    {
-        current->offset = magic->offset;
-        for(i = 0; i < magic->content_len; i++)
-        {
-            IdentifierNode *node = (IdentifierNode*)calloc_mem(sizeof(*node));
-            node->offset = magic->offset + i + 1;
-            node->state = ID_NODE_NEW;
-            current->next[magic->content[i]] = node;
-            current = node;
-        }
-        magic = magic->next;
-    }
-
-    /*Last node has type name*/
-    current->type_id = type_id;
-    DEBUG_WRAP( print_identifiers(root););
-    return root;
-
-}
-
-/*This function examines whether to update the trie based on shared state*/
-
-static inline bool updateNext(IdentifierNode *start,IdentifierNode **next_ptr, IdentifierNode *append)
+void insert_file_rule(RuleInfo *rule, void *conf)
 {
+    FileConfig *file_config = (FileConfig *) conf;
 
-    IdentifierNode *next = (*next_ptr);
-    IdentifierSharedNode sharedIdentifier;
-    IdentifierNode *result;
-
-    if (!append || (next == append))
-        return false;
-
-    sharedIdentifier.append_node = append;
-    sharedIdentifier.shared_node = next;
-    if (!next)
-    {
-        /*reuse the append*/
-        *next_ptr = append;
-        set_node_state_shared(append);
-        return false;
-    }
-    else if ((result = (IdentifierNode*)sfghash_find(identifier_merge_hash, &sharedIdentifier))) /*the same pointer has been processed, reuse it*/
-    {
-        *next_ptr = result;
-        set_node_state_shared(result);
-        return false;
-    }
-    else
-    {
-
-        if ((start->offset < append->offset) && (next->offset > append->offset))
-        {
-            /*offset could have gap when non 0 offset is allowed */
-            int index;
-            IdentifierNode *node = (IdentifierNode*)calloc_mem(sizeof(*node));
-            sharedIdentifier.shared_node = next;
-            sharedIdentifier.append_node = append;
-            node->offset = append->offset;
-
-            for(index = 0; index < MAX_BRANCH; index++)
-            {
-                node->next[index] = next;
-            }
-
-            set_node_state_shared(next);
-            DEBUG_WRAP(DebugMessage(DEBUG_FILE,"MEM:Add new node after next %p.\n", next););
-            next = node;
-            sfghash_add(identifier_merge_hash, &sharedIdentifier, next);
-        }
-        else if (next->state == ID_NODE_SHARED)
-        {
-            /*shared, need to clone one*/
-            IdentifierNode *current_next = next;
-            sharedIdentifier.shared_node = current_next;
-            sharedIdentifier.append_node = append;
-            DEBUG_WRAP(DebugMessage(DEBUG_FILE,"MEM:Clone node on %p.\n", current_next););
-            DEBUG_WRAP(DebugMessage(DEBUG_FILE,"MEM:Before clone: %d.\n",  memory_usage_identifiers()););
-            next = clone_node(current_next);
-            set_node_state_shared(next);
-            DEBUG_WRAP(DebugMessage(DEBUG_FILE,"MEM:Cloned node on %p.\n", next););
-            DEBUG_WRAP(DebugMessage(DEBUG_FILE,"MEM:After clone: %d.\n", memory_usage_identifiers()););
-            sfghash_add(identifier_merge_hash, &sharedIdentifier, next);
-        }
+    if (!rule->magics || !rule->magics->content_len || !rule->id)
+        return;
 
-        *next_ptr = next;
-    }
+    sort_magics(&(rule->magics));
 
-    return true;
+    /*Rules are compiled together once the configuration is loaded*/
+    free_file_identifiers(file_config);
 }
 
-/*
- * Append magic to existing trie
- *
+/* Build the DFA from all rules.  Doing this once after all rules are
+ * parsed gives the minimal set of states without any node sharing
+ * bookkeeping.  The later rule id wins if rules share a type definition.
  */
-static void update_trie(IdentifierNode *start, IdentifierNode *append)
+void compile_file_identifiers(void *conf)
 {
-    int i;
-
-    if ((!start )||(!append)||(start == append))
-        return ;
-
-
-    DEBUG_WRAP(DebugMessage(DEBUG_FILE,"Working on %p -> %p at offset %d.\n",
-            start, append, append->offset););
-
-    if (start->offset == append->offset )
-    {
-        /* when we come here, make sure this tree is not shared
-         * Update start trie using append information*/
+    FileConfig *file_config = (FileConfig *) conf;
+    DfaBuild b;
 
-        if (start->state == ID_NODE_SHARED)
-        {
-            DEBUG_WRAP(DebugMessage(DEBUG_FILE, "Something is wrong ..."););
-        }
-
-        if (append->type_id)
-        {
-            if(start->type_id)
-                LogMessage("Duplicated type definition '%d -> %d at offset %d.\n",
-                        start->type_id, append->type_id, append->offset);
-            start->type_id = append->type_id;
-        }
+    if (!file_config || file_config->identifier_dfa)
+        return;
 
-        for(i = 0; i < MAX_BRANCH; i++)
-        {
-            if (updateNext(start,&start->next[i], append->next[i]))
-            {
-                update_trie(start->next[i], append->next[i]);
-            }
-        }
-    }
-    else  if (start->offset < append->offset )
+    for (int id = 0; id < FILE_ID_MAX + 1; id++)
     {
+        RuleInfo *rule = file_config->FileRules[id];
 
-        for(i = 0; i < MAX_BRANCH; i++)
-        {
-            if (updateNext(start,&start->next[i], append))
-                update_trie(start->next[i], append);
-        }
+        if (rule && rule->magics && rule->magics->content_len)
+            add_magic_rule(b, rule);
     }
-    else /*This is impossible*/
-    {
-        DEBUG_WRAP(DebugMessage(DEBUG_FILE,"Something is wrong ....."););
-    }
-    return;
-}
 
+    init_file_identifers();
+    file_config->identifier_dfa = compile_identifiers(b);
 
-void insert_file_rule(RuleInfo *rule, void *conf)
-{
-    IdentifierNode *node;
-    FileConfig *file_config = NULL;
-
-    file_config = (FileConfig *) conf;
-
-    if (!file_config->identifier_root)
-    {
-        init_file_identifers();
-        file_config->identifier_root = (IdentifierNode*)calloc_mem(sizeof(*file_config->identifier_root));
-        file_config->id_memory_root = id_memory_root;
-        identifierMergeHashInit();
-    }
-
-    node = create_trie_from_magic(&(rule->magics), rule->id);
-
-    update_trie(file_config->identifier_root, node);
+    DEBUG_WRAP( print_identifiers(file_config->identifier_dfa););
     DEBUG_WRAP(test_find_file_type(file_config););
 }
 
@@ -412,8 +416,6 @@ void insert_file_rule(RuleInfo *rule, void *conf)
 void init_file_identifers(void)
 {
     memory_used = 0;
-    id_memory_root = NULL;
-    id_memory_current = NULL;
 }
 
 
@@ -422,110 +424,137 @@ uint32_t memory_usage_identifiers(void)
     return memory_used;
 }
 
+static inline uint32_t next_state(const IdentifierDfa *dfa, const IdentifierState *state, uint8_t byte)
+{
+    const uint8_t *lo = dfa->edge_bytes + state->edge;
+    const uint8_t *hi = lo + state->num_edges;
+    const uint8_t *pos = std::lower_bound(lo, hi, byte);
+
+    if ((pos != hi) && (*pos == byte))
+        return dfa->edge_next[pos - dfa->edge_bytes];
+
+    return state->other;
+}
+
 /*
  * This is the main function to find file type
- * Find file type is to traverse the tries.
- * Context is saved to continue file type identification as data becomes available
+ * Find file type is to walk the DFA one examined offset at a time.
+ * Context is saved to continue file type identification as data becomes available.
+ * As with the trie, a type found before the data runs out is not final while a
+ * longer magic could still match in the next chunk; see final_file_type_id.
  */
 uint32_t find_file_type_id(uint8_t *buf, int len, FileContext *context)
 {
     FileConfig *file_config;
-    IdentifierNode* current;
+    const IdentifierDfa *dfa;
+    const IdentifierState *current;
     uint64_t end;
 
     if ((!context)||(!buf)||(len <= 0))
         return 0;
 
     file_config = (FileConfig *)context->file_config;
+    dfa = file_config ? file_config->identifier_dfa : NULL;
+
+    if (!dfa)
+        return SNORT_FILE_TYPE_UNKNOWN;
 
     if (!(context->file_type_context))
-        context->file_type_context = (void *)(file_config->identifier_root);
+        context->file_type_context = (void *)(dfa->states + 1);
 
-    current = (IdentifierNode*) context->file_type_context;
+    current = (const IdentifierState*) context->file_type_context;
 
     end = context->processed_bytes + len;
 
-    while(current && (current->offset < end) && len && (current->offset >= context->processed_bytes))
+    while (current->num_edges || current->other)
     {
-        /*Found file id, save and continue*/
-        if (current->type_id)
+        uint32_t next;
+
+        if (current->offset >= end)
         {
-            context->file_type_id = current->type_id;
+            /*No final file type yet, save current state and continue*/
+            context->file_type_context = (void *)current;
+            return SNORT_FILE_TYPE_CONTINUE;
         }
 
-        /*Move to the next level*/
-        current = current->next[buf[current->offset - context->processed_bytes ]];
-        len--;
+        if (current->offset < context->processed_bytes)
+            break;
+
+        next = next_state(dfa, current, buf[current->offset - context->processed_bytes]);
+
+        if (!next)
+            break;
+
+        current = dfa->states + next;
     }
 
     /*No more checks are needed*/
-    if (!current)
-    {
-        /*Found file type in current buffer, return*/
-        if (context->file_type_id)
-            return context->file_type_id;
-        else
-            return SNORT_FILE_TYPE_UNKNOWN;
-    }
-    else if ((context->file_type_id) && (current->state == ID_NODE_SHARED))
-        return context->file_type_id;
-    else if (current->offset >= end)
-    {
-        /*No file type found, save current state and continue*/
-        context->file_type_context = current;
-        return SNORT_FILE_TYPE_CONTINUE;
-    }
-    else
-        return SNORT_FILE_TYPE_UNKNOWN;
+    if (current->type_id)
+        return current->type_id;
+
+    return SNORT_FILE_TYPE_UNKNOWN;
 }
 
 
+/*
+ * The file ended, or the type depth was reached, while a longer magic could
+ * still match.  Return the last type matched on the way to the saved state.
+ */
+uint32_t final_file_type_id(FileContext *context)
+{
+    const IdentifierState *current;
+
+    if (!context || !context->file_type_context)
+        return SNORT_FILE_TYPE_UNKNOWN;
+
+    current = (const IdentifierState*) context->file_type_context;
+
+    if (current->type_id)
+        return current->type_id;
+
+    return SNORT_FILE_TYPE_UNKNOWN;
+}
+
 void free_file_identifiers(void *conf)
 {
-    IdentifierMemoryBlock *id_memory_next;
     FileConfig *file_config = (FileConfig *)conf;
 
     if (!file_config)
         return;
-    /*Release memory used for identifiers*/
-    id_memory_current = file_config->id_memory_root;
-    while (id_memory_current)
-    {
-        id_memory_next = id_memory_current->next;
-        free(id_memory_current->mem_block);
-        free(id_memory_current);
-        id_memory_current = id_memory_next;
-    }
 
-    file_config->id_memory_root = NULL;
-    identifierMergeHashFree();
+    /*Release memory used for identifiers*/
+    free_dfa(file_config->identifier_dfa);
+    file_config->identifier_dfa = NULL;
+    memory_used = 0;
 }
 
-void print_identifiers(IdentifierNode* current)
+void print_identifiers(IdentifierDfa* dfa)
 {
 #ifdef DEBUG_MSGS
-    int i;
+    uint32_t i, j;
 
-    if ( !(DEBUG_FILE & GetDebugLevel()) )
+    if ( !dfa || !(DEBUG_FILE & GetDebugLevel()) )
         return;
 
-    printf("Working on pointer %p, offset:%d\n", (void *) current, current->offset);
-
-    for (i = 0; i < MAX_BRANCH; i++)
+    for (i = 1; i < dfa->num_states; i++)
     {
-        if (current->next[i])
-        {
-            printf("Magic number: %x ", i);
-            print_identifiers(current->next[i]);
-        }
+        IdentifierState *state = dfa->states + i;
 
-    }
-    if (current->type_id)
-    {
-        printf("Type: %d\n", current->type_id);
+        printf("State %u, offset:%u", i, state->offset);
+
+        if (state->type_id)
+            printf(", type: %u", state->type_id);
+
+        printf("\n");
+
+        for (j = state->edge; j < state->edge + state->num_edges; j++)
+            printf("  Magic number: %x -> %u\n", dfa->edge_bytes[j], dfa->edge_next[j]);
+
+        if (state->other)
+            printf("  Other -> %u\n", state->other);
     }
 #else
-    UNUSED(current);
+    UNUSED(dfa);
 #endif
 }
 
@@ -31,40 +31,42 @@
 #include "config.h"
 #endif
 
-#define MAX_BRANCH (UINT8_MAX + 1)
-
-typedef enum _IdNodeState
-{
-    ID_NODE_NEW,
-    ID_NODE_USED,
-    ID_NODE_SHARED
-} IdNodeState;
-
-typedef struct _IdentifierNode
+/* File magic rules are compiled into a DFA anchored at the start of the
+ * file.  Each state examines the byte at a single file offset; offsets that
+ * no live rule constrains are skipped.  A state remembers the last type
+ * matched on the way to it so identification can stop at the first
+ * mismatch without backtracking.
+ */
+typedef struct _IdentifierState
 {
-    uint32_t type_id;       /* magic content to match*/
-    IdNodeState state;
-    uint32_t offset;            /* offset from file start */
-    struct _IdentifierNode *next[MAX_BRANCH]; /* pointer to an array of 256 identifiers pointers*/
+    uint32_t offset;        /* offset from file start examined here */
+    uint32_t type_id;       /* last type matched on the path to this state */
+    uint32_t edge;          /* index of first explicit transition */
+    uint32_t num_edges;     /* explicit transitions, sorted by byte */
+    uint32_t other;         /* state for all other bytes, 0 = no match */
 
-} IdentifierNode;
+} IdentifierState;
 
-typedef struct _IdentifierNodeHead
+typedef struct _IdentifierDfa
 {
-    int offset;            /* offset from file start */
-    IdentifierNode *start;  /* start node for the trie at this offset*/
-    struct _IdentifierNodeHead *nextHead; /* pointer to next offset head*/
+    IdentifierState *states;   /* states[0] is unused, states[1] is the start */
+    uint8_t *edge_bytes;       /* transition byte, sorted within each state */
+    uint32_t *edge_next;       /* transition target state */
+    uint32_t num_states;
+    uint32_t num_edges;
 
-} IdentifierNodeHead;
+} IdentifierDfa;
 
 void init_file_identifers(void);
 void insert_file_rule(RuleInfo *rule, void *conf);
+void compile_file_identifiers(void *conf);
 uint32_t memory_usage_identifiers(void);
 
 uint32_t find_file_type_id(uint8_t *buf, int len, FileContext *context);
+uint32_t final_file_type_id(FileContext *context);
 
 #ifdef DEBUG_MSGS
-void print_identifiers(IdentifierNode*);
+void print_identifiers(IdentifierDfa*);
 char *test_find_file_type(void *conf);
 #endif
 
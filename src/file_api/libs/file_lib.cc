@@ -87,7 +87,7 @@ void file_type_id( FileContext* context, uint8_t* file_data, int data_size, File
 
     if (data_size < 0)
     {
-        context->file_type_id = SNORT_FILE_TYPE_UNKNOWN;
+        context->file_type_id = final_file_type_id(context);
         return;
     }
 
@@ -104,13 +104,13 @@ void file_type_id( FileContext* context, uint8_t* file_data, int data_size, File
     case SNORT_FILE_END:
         context->file_type_id = find_file_type_id(file_data, data_size, context);
         if (SNORT_FILE_TYPE_CONTINUE ==  context->file_type_id)
-            context->file_type_id = SNORT_FILE_TYPE_UNKNOWN;
+            context->file_type_id = final_file_type_id(context);
         break;
     case SNORT_FILE_FULL:
         context->file_type_context = NULL;
         context->file_type_id = find_file_type_id(file_data, data_size, context);
         if (SNORT_FILE_TYPE_CONTINUE ==  context->file_type_id)
-            context->file_type_id = SNORT_FILE_TYPE_UNKNOWN;
+            context->file_type_id = final_file_type_id(context);
         break;
     default:
         break;
@@ -80,6 +80,11 @@ void RateFilter_Cleanup(void)
     SFRF_Delete();
 }
 
+void RateFilter_Term(void)
+{
+    SFRF_Term();
+}
+
 /*
  * Create and Add a Thresholding Event Object
  */
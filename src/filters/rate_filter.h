@@ -39,6 +39,7 @@ struct OptTreeNode;
 RateFilterConfig * RateFilter_ConfigNew(void);
 void RateFilter_ConfigFree(RateFilterConfig *);
 void RateFilter_Cleanup(void);
+void RateFilter_Term(void);
 
 struct SnortConfig;
 int RateFilter_Create(SnortConfig* sc, RateFilterConfig *, tSFRFConfigNode *);
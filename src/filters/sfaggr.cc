@@ -0,0 +1,166 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// sfaggr.cc
+
+#include "sfaggr.h"
+
+#include <atomic>
+
+#define SFAGGR_MIN_ROWS 64
+
+// each slot packs tag:16 | window:16 | count:32 into one word so a single
+// compare and swap updates all three.  the tag distinguishes keys that
+// share a slot; a slot is reclaimed once its window has passed.
+struct SfAggr
+{
+    unsigned mask;
+    std::atomic<uint64_t>* slots;
+};
+
+static inline uint64_t pack(uint16_t tag, uint16_t win, int32_t count)
+{
+    return ((uint64_t)tag << 48) | ((uint64_t)win << 32) | (uint32_t)count;
+}
+
+SfAggr* sfaggr_new(unsigned rows)
+{
+    unsigned n = SFAGGR_MIN_ROWS;
+
+    while ( n < rows && n < (1u << 30) )
+        n <<= 1;
+
+    SfAggr* agg = new SfAggr;
+    agg->mask = n - 1;
+    agg->slots = new std::atomic<uint64_t>[n];
+    sfaggr_flush(agg);
+
+    return agg;
+}
+
+void sfaggr_free(SfAggr* agg)
+{
+    if ( !agg )
+        return;
+
+    delete[] agg->slots;
+    delete agg;
+}
+
+void sfaggr_flush(SfAggr* agg)
+{
+    for ( unsigned i = 0; i <= agg->mask; ++i )
+        agg->slots[i].store(0, std::memory_order_relaxed);
+}
+
+void sfaggr_init(SfAggrNode* node, const void* key, size_t len)
+{
+    const uint8_t* b = (const uint8_t*)key;
+    uint64_t h = 0xcbf29ce484222325ull;
+
+    for ( size_t i = 0; i < len; ++i )
+        h = (h ^ b[i]) * 0x100000001b3ull;
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+
+    node->hash = h;
+    node->window = node->tpub = 0;
+    node->pending = node->published = node->peers = 0;
+}
+
+// returns the total count for the key in window or -1 if the slot is
+// held by another live key or a newer window
+static int publish(SfAggr* agg, uint64_t hash, uint32_t window, int delta)
+{
+    std::atomic<uint64_t>& slot = agg->slots[hash & agg->mask];
+    uint16_t tag = (uint16_t)(hash >> 48) | 1;
+    uint16_t win = (uint16_t)window;
+    uint64_t old = slot.load(std::memory_order_relaxed);
+
+    while ( true )
+    {
+        uint16_t t = (uint16_t)(old >> 48);
+        uint16_t w = (uint16_t)(old >> 32);
+        int32_t c = (int32_t)(uint32_t)old;
+
+        if ( t != tag || w != win )
+        {
+            if ( t && w == win && c > 0 )
+                return -1;
+
+            if ( t == tag && (int16_t)(w - win) > 0 )
+                return -1;
+
+            c = 0;
+        }
+        c += delta;
+
+        if ( c < 0 )
+            c = 0;
+
+        if ( slot.compare_exchange_weak(
+            old, pack(tag, win, c), std::memory_order_relaxed) )
+            return c;
+    }
+}
+
+void sfaggr_count(
+    SfAggr* agg, SfAggrNode* node, uint32_t window, int delta,
+    uint32_t now, bool sync)
+{
+    if ( node->window != window )
+    {
+        node->window = window;
+        node->pending = node->published = node->peers = 0;
+    }
+    node->pending += delta;
+
+    if ( !sync && node->tpub == now &&
+        node->pending < SFAGGR_BATCH && node->pending > -SFAGGR_BATCH )
+        return;
+
+    int total = publish(agg, node->hash, window, node->pending);
+    node->tpub = now;
+
+    if ( total < 0 )
+    {
+        node->pending = node->peers = 0;
+        return;
+    }
+    node->published += node->pending;
+    node->pending = 0;
+
+    // another thread reset the count
+    if ( total < node->published )
+        node->published = total;
+
+    node->peers = total - node->published;
+}
+
+void sfaggr_reset(SfAggr* agg, SfAggrNode* node, uint32_t now)
+{
+    int total = node->published + node->pending + node->peers;
+
+    if ( total > 0 )
+        publish(agg, node->hash, node->window, -total);
+
+    node->tpub = now;
+    node->pending = node->published = node->peers = 0;
+}
+
@@ -0,0 +1,91 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// sfaggr.h
+
+#ifndef SFAGGR_H
+#define SFAGGR_H
+
+// rate_filter and event_filter track counts per packet thread so the hot
+// path never contends.  by_src / by_dst limits apply across all threads
+// though, so each thread periodically publishes its count deltas to a
+// shared, lock-free table and folds the other threads' contribution into
+// its threshold tests.  the result is approximate: a thread may be up to
+// one batch or one second behind its peers, and keys that collide in the
+// shared table are counted per thread only.
+//
+// shared counts are kept in windows aligned to multiples of the interval
+// so all threads agree on them.  while counts are aggregated each thread
+// aligns its own intervals the same way (see sfaggr_start()); otherwise
+// peer counts from before a local reset would carry into the new interval.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+// max unpublished delta per tracking node
+#define SFAGGR_BATCH 8
+
+struct SfAggr;
+
+// per thread view of one shared count; lives in the tracking node
+struct SfAggrNode
+{
+    uint64_t hash;       // of the tracking key
+    uint32_t window;     // aggregation window of published and peers
+    uint32_t tpub;       // time of last publication
+    int pending;         // local delta not yet published
+    int published;       // local delta published in window
+    int peers;           // other threads' count in window
+};
+
+SfAggr* sfaggr_new(unsigned rows);
+void sfaggr_free(SfAggr*);
+void sfaggr_flush(SfAggr*);
+
+void sfaggr_init(SfAggrNode*, const void* key, size_t len);
+
+// add delta to the local view and publish when the batch is full, the
+// second has changed, or sync is set.  window identifies the counting
+// interval (0 for counts that never expire).
+void sfaggr_count(
+    SfAggr*, SfAggrNode*, uint32_t window, int delta, uint32_t now, bool sync);
+
+// remove the key's count in the current window from all threads' view,
+// as when a threshold fires and starts counting over
+void sfaggr_reset(SfAggr*, SfAggrNode*, uint32_t now);
+
+// true when the estimated count is closing in on the limit so the
+// next test should see fresh peer counts
+static inline bool sfaggr_near(unsigned est, unsigned limit)
+{
+    return est <= limit && est + SFAGGR_BATCH > limit;
+}
+
+static inline uint32_t sfaggr_window(uint32_t now, unsigned seconds)
+{
+    return seconds ? now / seconds : 0;
+}
+
+// start of the aggregation window containing now
+static inline time_t sfaggr_start(time_t now, unsigned seconds)
+{
+    return seconds ? now - now % seconds : now;
+}
+
+#endif
+
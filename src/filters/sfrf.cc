@@ -46,6 +46,8 @@
 #include "hash/sfghash.h"
 #include "hash/sfxhash.h"
 #include "sfip/sf_ipvar.h"
+#include "main/thread.h"
+#include "sfaggr.h"
 
 // Number of hash rows for gid 1 (rules)
 #define SFRF_GEN_ID_1_ROWS 4096
@@ -102,9 +104,19 @@ typedef struct
     */
     time_t revertTime;
 
+    /* this thread's view of the count across all packet threads.
+    */
+    SfAggrNode aggr;
+
 } tSFRFTrackingNode;
 
-SFXHASH *rf_hash = NULL;
+/* Tracking nodes are kept per packet thread.  Counts are shared across
+ * threads through rf_aggr, which is only consulted (rf_sync) when there
+ * is more than one packet thread.
+ */
+static THREAD_LOCAL SFXHASH* rf_hash = NULL;
+static THREAD_LOCAL SfAggr* rf_sync = NULL;
+static SfAggr* rf_aggr = NULL;
 
 // private methods ...
 static int _checkThreshold(
@@ -166,21 +178,35 @@ static void SFRF_New( unsigned nbytes )
         0,         /* ANR callback - none */
         0,         /* user freemem callback - none */
         1) ;      /* Recycle nodes ?*/
+
+    rf_sync = (get_instance_max() > 1) ? rf_aggr : NULL;
 }
 
-void SFRF_Delete (void)
+void SFRF_Term (void)
 {
     if ( !rf_hash )
         return;
 
     sfxhash_delete(rf_hash);
     rf_hash = NULL;
+    rf_sync = NULL;
+}
+
+void SFRF_Delete (void)
+{
+    SFRF_Term();
+
+    sfaggr_free(rf_aggr);
+    rf_aggr = NULL;
 }
 
 void SFRF_Flush (void)
 {
     if ( rf_hash )
         sfxhash_make_empty(rf_hash);
+
+    if ( rf_aggr )
+        sfaggr_flush(rf_aggr);
 }
 
 static void SFRF_ConfigNodeFree(void *item)
@@ -236,18 +262,17 @@ int SFRF_ConfigAdd(
 
     PolicyId policy_id = get_network_policy()->policy_id;
 
-    // Auto init - memcap must be set 1st, which is not really a problem
-    if ( rf_hash == NULL )
-    {
-        SFRF_New(rf_config->memcap);
-
-        if ( rf_hash == NULL )
-            return -1;
-    }
-
     if ((rf_config == NULL) || (cfgNode == NULL))
         return -1;
 
+    // tracking nodes are allocated per thread on first use; the shared
+    // counts are sized to match one thread's memcap
+    if ( rf_aggr == NULL )
+    {
+        unsigned nbytes = rf_config->memcap;
+        rf_aggr = sfaggr_new(nbytes / SFRF_BYTES);
+    }
+
     if ( (cfgNode->sid == 0 ) || (cfgNode->gid == 0) )
         return -1;
 
@@ -389,6 +414,7 @@ static int SFRF_TestObject(
 ) {
     tSFRFTrackingNode* dynNode;
     int retValue = -1;
+    unsigned count;
 
     dynNode = _getSFRFTrackingNode(ip, cfgNode->tid, curTime);
 
@@ -403,6 +429,8 @@ static int SFRF_TestObject(
 #endif
     }
 
+    count = dynNode->count;
+
     switch (op)
     {
         case SFRF_COUNT_INCREMENT:
@@ -428,6 +456,14 @@ static int SFRF_TestObject(
             break;
     }
 
+    if ( rf_sync )
+    {
+        bool sync = sfaggr_near(dynNode->count + dynNode->aggr.peers, cfgNode->count);
+
+        sfaggr_count(rf_sync, &dynNode->aggr, sfaggr_window(curTime, cfgNode->seconds),
+            (int)(dynNode->count - count), curTime, sync);
+    }
+
     retValue = _checkThreshold(cfgNode, dynNode, curTime);
 
     // we drop after the session count has been incremented
@@ -436,8 +472,13 @@ static int SFRF_TestObject(
     // threshold would never be exceeded.
     if ( !cfgNode->seconds && dynNode->count > cfgNode->count )
         if ( cfgNode->newAction == RULE_TYPE__DROP )
+        {
             dynNode->count--;
 
+            if ( rf_sync )
+                sfaggr_count(rf_sync, &dynNode->aggr, 0, -1, curTime, false);
+        }
+
 #ifdef SFRF_DEBUG
     printf("--SFRF_DEBUG: %d-%d-%d: %d Packet IP %s, op: %d, count %d, action %d\n",
             cfgNode->tid, cfgNode->gid,
@@ -539,6 +580,15 @@ int SFRF_TestThreshold(
         return status;
     }
 
+    // Auto init - one tracking table per packet thread
+    if ( rf_hash == NULL )
+    {
+        SFRF_New(config->memcap);
+
+        if ( rf_hash == NULL )
+            return status;
+    }
+
     /* For each permanent thresholding object, test/add/update the config object */
     /* We maintain a list of thd objects for each gid+sid */
     /* each object has it's own unique thd_id */
@@ -662,7 +712,13 @@ static int _checkSamplingPeriod(
 
     if ( cfgNode->seconds )
     {
-        dt = (unsigned)(curTime - dynNode->tstart);
+        time_t tstart = dynNode->tstart;
+
+        // periods follow the shared windows while counts are aggregated
+        if ( rf_sync )
+            tstart = sfaggr_start(tstart, cfgNode->seconds);
+
+        dt = (unsigned)(curTime - tstart);
         if ( dt >= cfgNode->seconds )
         {   // observation period is over, start a new one
             dynNode->tstart = curTime;
@@ -710,6 +766,9 @@ static int _checkThreshold(
     tSFRFTrackingNode* dynNode,
     time_t curTime
 ) {
+    // peers is 0 unless counts are shared across packet threads
+    unsigned count = dynNode->count + dynNode->aggr.peers;
+
     /* Once newAction is activated, it stays active for the revert timeout, unless ANR
      * causes the node itself to disappear.
      * Also note that we want to maintain the counters and rates update so that we reblock
@@ -721,7 +780,7 @@ static int _checkThreshold(
             && ((unsigned)(curTime - dynNode->revertTime) >= cfgNode->timeout))
         {
 #ifdef SFRF_OVER_RATE
-            if ( dynNode->count > cfgNode->count || dynNode->overRate )
+            if ( count > cfgNode->count || dynNode->overRate )
             {
 #ifdef SFRF_DEBUG
                 printf("...dos action continued, count %u\n", dynnode->count);
@@ -748,9 +807,9 @@ static int _checkThreshold(
     }
 
 #ifdef SFRF_OVER_RATE
-    if ( dynNode->count <= cfgNode->count && !dynNode->overRate )
+    if ( count <= cfgNode->count && !dynNode->overRate )
 #else
-    if ( dynNode->count <= cfgNode->count )
+    if ( count <= cfgNode->count )
 #endif
     {
         // rate limit not reached.
@@ -830,6 +889,7 @@ static tSFRFTrackingNode* _getSFRFTrackingNode(
             dynNode->tlast = curTime;
 #endif
             dynNode->filterState = FS_OFF;
+            sfaggr_init(&dynNode->aggr, &key, sizeof(key));
         }
     }
     return dynNode;
@@ -162,6 +162,7 @@ struct RateFilterConfig
 /*
  * Prototypes
  */
+void SFRF_Term(void);    // release this thread's tracking nodes
 void SFRF_Delete(void);
 void SFRF_Flush(void);
 int SFRF_ConfigAdd(SnortConfig*, RateFilterConfig *, tSFRFConfigNode* );
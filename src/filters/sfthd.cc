@@ -717,23 +717,45 @@ static inline int sfthd_test_suppress (
     return 1; /* Keep looking for other suppressors */
 }
 
+/*
+ *  Seconds since the tracking interval started.  Intervals follow the
+ *  shared windows while counts are aggregated.
+ */
+static inline unsigned sfthd_elapsed(
+    THD_NODE* sfthd_node,
+    THD_IP_NODE* sfthd_ip_node,
+    time_t curtime,
+    SfAggr* aggr)
+{
+    time_t tstart = sfthd_ip_node->tstart;
+
+    if ( aggr )
+        tstart = sfaggr_start(tstart, sfthd_node->seconds);
+
+    return (unsigned)(curtime - tstart);
+}
+
 /*
  *  Do the appropriate test for the Threshold Object Type
  */
 static inline int sfthd_test_non_suppress(
     THD_NODE* sfthd_node,
     THD_IP_NODE* sfthd_ip_node,
-    time_t curtime)
+    time_t curtime,
+    SfAggr* aggr)
 {
     unsigned dt;
 
+    /* events counted by other packet threads, 0 unless aggregated */
+    unsigned peers = sfthd_ip_node->aggr.peers;
+
     if( sfthd_node->type == THD_TYPE_DETECT )
     {
 #ifdef THD_DEBUG
         printf("\n...Detect Test\n");
         fflush(stdout);
 #endif
-        dt = (unsigned)(curtime - sfthd_ip_node->tstart);
+        dt = sfthd_elapsed(sfthd_node, sfthd_ip_node, curtime, aggr);
 
         if( dt >= sfthd_node->seconds )
         {   /* reset */
@@ -752,7 +774,7 @@ static inline int sfthd_test_non_suppress(
             sfthd_ip_node->count,sfthd_node->count );
         fflush(stdout);
 #endif
-        if( (int)sfthd_ip_node->count > sfthd_node->count ||
+        if( (int)(sfthd_ip_node->count + peers) > sfthd_node->count ||
             (int)sfthd_ip_node->prev > sfthd_node->count )
         {
             return 0; /* Log it, stop looking: log all > 'count' events */
@@ -769,7 +791,7 @@ static inline int sfthd_test_non_suppress(
         printf("\n...Limit Test\n");
         fflush(stdout);
 #endif
-        dt = (unsigned)(curtime - sfthd_ip_node->tstart);
+        dt = sfthd_elapsed(sfthd_node, sfthd_ip_node, curtime, aggr);
 
         if( dt >= sfthd_node->seconds )
         {   /* reset */
@@ -783,7 +805,7 @@ static inline int sfthd_test_non_suppress(
             sfthd_ip_node->count,sfthd_node->count );
         fflush(stdout);
 #endif
-        if( (int)sfthd_ip_node->count <= sfthd_node->count )
+        if( (int)(sfthd_ip_node->count + peers) <= sfthd_node->count )
         {
             return 0; /* Log it, stop looking: only log the 1st 'count' events */
         }
@@ -800,17 +822,21 @@ static inline int sfthd_test_non_suppress(
         printf("\n...Threshold Test\n");
         fflush(stdout);
 #endif
-        dt = (unsigned)(curtime - sfthd_ip_node->tstart);
+        dt = sfthd_elapsed(sfthd_node, sfthd_ip_node, curtime, aggr);
         if( dt >= sfthd_node->seconds )
         {
             sfthd_ip_node->tstart = curtime;
             sfthd_ip_node->count  = 1;
         }
-        if( (int)sfthd_ip_node->count >= sfthd_node->count )
+        if( (int)(sfthd_ip_node->count + peers) >= sfthd_node->count )
         {
             /* reset */
             sfthd_ip_node->count = 0;
             sfthd_ip_node->tstart= curtime;
+
+            if ( aggr )
+                sfaggr_reset(aggr, &sfthd_ip_node->aggr, curtime);
+
             return 0; /* Log it, stop looking */
         }
         sfthd_node->filtered++;
@@ -823,7 +849,7 @@ static inline int sfthd_test_non_suppress(
         printf("\n...Threshold+Limit Test\n");
         fflush(stdout);
 #endif
-        dt = (unsigned)(curtime - sfthd_ip_node->tstart);
+        dt = sfthd_elapsed(sfthd_node, sfthd_ip_node, curtime, aggr);
         if( dt >= sfthd_node->seconds )
         {
             sfthd_ip_node->tstart = curtime;
@@ -836,9 +862,9 @@ static inline int sfthd_test_non_suppress(
         }
         else
         {
-            if( (int)sfthd_ip_node->count >= sfthd_node->count )
+            if( (int)(sfthd_ip_node->count + peers) >= sfthd_node->count )
             {
-                if( (int)sfthd_ip_node->count >  sfthd_node->count )
+                if( (int)(sfthd_ip_node->count + peers) >  sfthd_node->count )
                 {
                     /* don't log it, stop looking:
                      * log once per time interval - than block it */
@@ -889,7 +915,8 @@ int sfthd_test_local(
     THD_NODE *sfthd_node,
     const sfip_t *sip,
     const sfip_t *dip,
-    time_t curtime )
+    time_t curtime,
+    SfAggr *aggr )
 {
     THD_IP_NODE_KEY key;
     THD_IP_NODE data,*sfthd_ip_node;
@@ -952,12 +979,10 @@ int sfthd_test_local(
     /*
      * Check for any Permanent sig_id objects for this gen_id  or add this one ...
      */
-    status = sfxhash_add(local_hash, (void*)&key, &data);
+    status = sfxhash_add_return_data_ptr(local_hash, (void*)&key, (void**)&sfthd_ip_node);
     if (status == SFXHASH_INTABLE)
     {
         /* Already in the table */
-        sfthd_ip_node = (THD_IP_NODE*)local_hash->cnode->data;
-
         /* Increment the event count */
         sfthd_ip_node->count++;
     }
@@ -968,11 +993,21 @@ int sfthd_test_local(
     }
     else
     {
-        /* Was not in the table - it was added - work with our copy of the data */
-        sfthd_ip_node = &data;
+        /* Was not in the table - it was added - fill in the new node */
+        *sfthd_ip_node = data;
+        sfaggr_init(&sfthd_ip_node->aggr, &key, sizeof(key));
+    }
+
+    if ( aggr )
+    {
+        bool sync = sfaggr_near(
+            sfthd_ip_node->count + sfthd_ip_node->aggr.peers, sfthd_node->count);
+
+        sfaggr_count(aggr, &sfthd_ip_node->aggr,
+            sfaggr_window(curtime, sfthd_node->seconds), 1, curtime, sync);
     }
 
-    return sfthd_test_non_suppress(sfthd_node, sfthd_ip_node, curtime);
+    return sfthd_test_non_suppress(sfthd_node, sfthd_ip_node, curtime, aggr);
 }
 
 /*
@@ -984,7 +1019,8 @@ static inline int sfthd_test_global(
     unsigned sig_id,     /* from current event */
     const sfip_t *sip,        /* " */
     const sfip_t *dip,        /* " */
-    time_t curtime )
+    time_t curtime,
+    SfAggr *aggr )
 {
     THD_IP_GNODE_KEY key;
     THD_IP_NODE data;
@@ -1043,12 +1079,10 @@ static inline int sfthd_test_global(
     data.tstart = data.tlast = curtime; /* Event time */
 
     /* Check for any Permanent sig_id objects for this gen_id  or add this one ...  */
-    status = sfxhash_add(global_hash, (void*)&key, &data);
+    status = sfxhash_add_return_data_ptr(global_hash, (void*)&key, (void**)&sfthd_ip_node);
     if (status == SFXHASH_INTABLE)
     {
         /* Already in the table */
-        sfthd_ip_node = (THD_IP_NODE*)global_hash->cnode->data;
-
         /* Increment the event count */
         sfthd_ip_node->count++;
     }
@@ -1059,11 +1093,21 @@ static inline int sfthd_test_global(
     }
     else
     {
-        /* Was not in the table - it was added - work with our copy of the data */
-        sfthd_ip_node = &data;
+        /* Was not in the table - it was added - fill in the new node */
+        *sfthd_ip_node = data;
+        sfaggr_init(&sfthd_ip_node->aggr, &key, sizeof(key));
+    }
+
+    if ( aggr )
+    {
+        bool sync = sfaggr_near(
+            sfthd_ip_node->count + sfthd_ip_node->aggr.peers, sfthd_node->count);
+
+        sfaggr_count(aggr, &sfthd_ip_node->aggr,
+            sfaggr_window(curtime, sfthd_node->seconds), 1, curtime, sync);
     }
 
-    return sfthd_test_non_suppress(sfthd_node, sfthd_ip_node, curtime);
+    return sfthd_test_non_suppress(sfthd_node, sfthd_ip_node, curtime, aggr);
 }
 
 
@@ -1184,7 +1228,8 @@ int sfthd_test_threshold(
         /*
          *   Test SUPPRESSION and THRESHOLDING
          */
-        status = sfthd_test_local(thd->ip_nodes, sfthd_node, sip, dip, curtime );
+        status = sfthd_test_local(
+            thd->ip_nodes, sfthd_node, sip, dip, curtime, thd->aggr );
 
         if( status < 0 ) /* -1 == Don't log and stop looking */
         {
@@ -1227,7 +1272,7 @@ global_test:
      if( g_thd_node )
      {
          status = sfthd_test_global(
-             thd->ip_gnodes, g_thd_node, sig_id, sip, dip, curtime );
+             thd->ip_gnodes, g_thd_node, sig_id, sip, dip, curtime, thd->aggr );
 
          if( status < 0 ) /* -1 == Don't log and stop looking */
          {
@@ -32,6 +32,7 @@
 #include "sfxhash.h"
 #include "main/policy.h"
 #include "sfip/sfip_t.h"
+#include "filters/sfaggr.h"
 
 /*!
     Max GEN_ID value - Set this to the Max Used by Snort, this is used for the
@@ -88,6 +89,7 @@ typedef struct {
     unsigned prev;
     time_t tstart;
     time_t tlast;
+    SfAggrNode aggr;  /* count across packet threads, if shared */
 
 } THD_IP_NODE;
 
@@ -190,11 +192,15 @@ typedef struct {
 
     Local and global threshold thd_id's are all unqiue, so we use just one
     ip_nodes lookup table
+
+    One THD_STRUCT is allocated per packet thread.  If aggr is set, counts
+    are also published there so limits hold across threads.
  */
 struct THD_STRUCT
 {
     SFXHASH *ip_nodes;   /* Global hash of active IP's key=THD_IP_NODE_KEY, data=THD_IP_NODE */
     SFXHASH *ip_gnodes;  /* Global hash of active IP's key=THD_IP_GNODE_KEY, data=THD_IP_GNODE */
+    SfAggr *aggr;        /* Shared counts, not owned; NULL for thread local counts */
 
 };
 
@@ -273,7 +279,8 @@ int sfthd_test_local(
     THD_NODE *sfthd_node,
     const sfip_t *sip,
     const sfip_t *dip,
-    time_t curtime );
+    time_t curtime,
+    SfAggr *aggr = NULL );
 
 #ifdef THD_DEBUG
 int sfthd_show_objects( THD_STRUCT * thd );
@@ -43,17 +43,21 @@
 #include <string.h>
 
 #include "main/analyzer.h"
+#include "main/thread.h"
 #include "mstring.h"
 #include "util.h"
 #include "parser.h"
 
 #include "sfthd.h"
+#include "sfaggr.h"
 #include "snort.h"
 
 #include <errno.h>
 
 /* Data */
-THD_STRUCT *thd_runtime = NULL;
+// event counts are tracked per packet thread and shared through thd_aggr
+static THREAD_LOCAL THD_STRUCT *thd_runtime = NULL;
+static SfAggr *thd_aggr = NULL;
 
 static THREAD_LOCAL int thd_checked = 0; // per packet
 static THREAD_LOCAL int thd_answer = 0;  // per packet
@@ -253,7 +257,7 @@ static int print_thd_local(ThresholdObjects *thd_objs, PrintFormat type, unsigne
 void print_thresholding(ThresholdConfig*, unsigned)
 { }
 
-void sfthreshold_free(void)
+void sfthreshold_term(void)
 {
     if (thd_runtime != NULL)
         sfthd_free(thd_runtime);
@@ -261,6 +265,14 @@ void sfthreshold_free(void)
     thd_runtime = NULL;
 }
 
+void sfthreshold_free(void)
+{
+    sfthreshold_term();
+
+    sfaggr_free(thd_aggr);
+    thd_aggr = NULL;
+}
+
 /*
 
     Create and Add a Thresholding Event Object
@@ -276,11 +288,10 @@ int sfthreshold_create(
         return 0;
 
     /* Auto init - memcap must be set 1st, which is not really a problem */
-    if (thd_runtime == NULL)
+    if (thd_aggr == NULL)
     {
-        thd_runtime = sfthd_new(thd_config->memcap, thd_config->memcap);
-        if (thd_runtime == NULL)
-            return -1;
+        unsigned nbytes = thd_config->memcap;
+        thd_aggr = sfaggr_new(nbytes / (sizeof(THD_IP_NODE_KEY) + sizeof(THD_IP_NODE)));
     }
 
     /* print_thdx( thdx ); */
@@ -322,6 +333,17 @@ int sfthreshold_test(
     if (!thd_checked)
     {
        thd_checked = 1;
+
+       /* Auto init - thd_aggr is set once any threshold is created */
+       if (thd_runtime == NULL && thd_aggr != NULL)
+       {
+           int memcap = snort_conf->threshold_config->memcap;
+           thd_runtime = sfthd_new(memcap, memcap);
+
+           if (thd_runtime != NULL && get_instance_max() > 1)
+               thd_runtime->aggr = thd_aggr;
+       }
+
        thd_answer = sfthd_test_threshold(snort_conf->threshold_config->thd_objs,
                                          thd_runtime, gen_id, sig_id, sip, dip, curtime);
     }
@@ -350,5 +372,8 @@ void sfthreshold_reset_active(void)
 
     if (thd_runtime->ip_gnodes != NULL)
         sfxhash_make_empty(thd_runtime->ip_gnodes);
+
+    if (thd_aggr != NULL)
+        sfaggr_flush(thd_aggr);
 }
 
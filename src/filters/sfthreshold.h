@@ -38,6 +38,7 @@ int sfthreshold_create(struct SnortConfig*, ThresholdConfig*, THDX_STRUCT*);
 int sfthreshold_test(unsigned int, unsigned int, const sfip_t*, const sfip_t*, long curtime);
 void print_thresholding(ThresholdConfig*, unsigned shutdown);
 void sfthreshold_reset_active(void);
+void sfthreshold_term(void);  // release this thread's tracking nodes
 void sfthreshold_free(void);
 
 #endif
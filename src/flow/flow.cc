@@ -24,14 +24,47 @@
 #endif
 
 #include "flow/session.h"
-#include "ips_options/ips_flowbits.h"
-#include "utils/bitop_funcs.h"
 #include "utils/util.h"
 #include "protocols/packet.h"
 #include "sfip/sf_ip.h"
 
 unsigned FlowData:: flow_id = 0;
 
+//-------------------------------------------------------------------------
+// flowbits
+//-------------------------------------------------------------------------
+
+void StreamFlowData::reset()
+{
+    memset(bits, 0, sizeof(bits));
+
+    if ( more )
+        memset(more, 0, more_words * sizeof(*more));
+}
+
+void StreamFlowData::grow(unsigned words)
+{
+    unsigned n = words - FLOWBITS_INLINE_WORDS;
+    uint64_t* p = (uint64_t*)SnortAlloc(n * sizeof(*p));
+
+    if ( more )
+    {
+        memcpy(p, more, more_words * sizeof(*p));
+        free(more);
+    }
+    more = p;
+    more_words = n;
+}
+
+void StreamFlowData::term()
+{
+    if ( more )
+        free(more);
+
+    more = nullptr;
+    more_words = 0;
+}
+
 FlowData::FlowData(unsigned u, Inspector* ph)
 {
     assert(u > 0);
@@ -57,16 +90,6 @@ Flow::~Flow()
 void Flow::init(PktType proto)
 {
     protocol = proto;
-
-    // FIXIT-M this should just use C++11 bitset.
-    // FIXIT-M getFlowbitSizeInBytes() should be attribute of ??? (or eliminate)
-    /* use giFlowbitSize - 1, since there is already 1 byte in the
-    * StreamFlowData structure */
-    size_t sz = sizeof(StreamFlowData) + getFlowbitSizeInBytes() - 1;
-    flowdata = (StreamFlowData*)calloc(sz, 1);
-
-    if ( flowdata )
-        boInitStaticBITOP(&(flowdata->boFlowbits), getFlowbitSizeInBytes(), flowdata->flowb);
 }
 
 void Flow::term()
@@ -88,8 +111,7 @@ void Flow::term()
     if ( gadget )
         gadget->rem_ref();
 
-    if ( flowdata )
-        free(flowdata);
+    flowdata.term();
 }
 
 void Flow::reset()
@@ -120,7 +142,7 @@ void Flow::reset()
     // FIXIT-L need a struct to zero here to make future proof
     memset((uint8_t*)this+offset, 0, sizeof(Flow)-offset);
 
-    boResetBITOP(&(flowdata->boFlowbits));
+    flowdata.reset();
 }
 
 void Flow::restart(bool freeAppData)
@@ -128,7 +150,7 @@ void Flow::restart(bool freeAppData)
     if ( freeAppData )
         free_application_data();
 
-    boResetBITOP(&(flowdata->boFlowbits));
+    flowdata.reset();
 
     ssn_state.ignore_direction = 0;
     ssn_state.session_flags = SSNFLAG_NONE;
@@ -26,7 +26,6 @@
 #include "config.h"
 #endif
 
-#include "utils/bitop.h"
 #include "sfip/sfip_t.h"
 #include "flow/flow_key.h"
 #include "framework/inspector.h"
@@ -81,13 +80,59 @@
 #define STREAM_STATE_NO_PICKUP         0x2000
 
 struct Packet;
+struct HostAttributeEntry;
 
 typedef void (*StreamAppDataFree)(void*);
 
-struct StreamFlowData
+// flowbit ids are dense so the first FLOWBITS_INLINE_WORDS * 64 bits are
+// kept in the flow; any beyond that are allocated when first changed
+#define FLOWBITS_INLINE_WORDS 2
+
+struct SO_PUBLIC StreamFlowData
 {
-    BITOP boFlowbits;
-    unsigned char flowb[1];
+    uint64_t bits[FLOWBITS_INLINE_WORDS];
+    uint64_t* more;
+    unsigned more_words;
+
+    unsigned size() const
+    { return FLOWBITS_INLINE_WORDS + more_words; };
+
+    uint64_t get(unsigned w) const
+    {
+        if ( w < FLOWBITS_INLINE_WORDS )
+            return bits[w];
+
+        w -= FLOWBITS_INLINE_WORDS;
+        return w < more_words ? more[w] : 0;
+    };
+
+    // grows as needed
+    uint64_t& at(unsigned w)
+    {
+        if ( w < FLOWBITS_INLINE_WORDS )
+            return bits[w];
+
+        if ( w >= size() )
+            grow(w + 1);
+
+        return more[w - FLOWBITS_INLINE_WORDS];
+    };
+
+    bool is_set(unsigned id) const
+    { return (get(id >> 6) >> (id & 63)) & 1; };
+
+    void set(unsigned id)
+    { at(id >> 6) |= (uint64_t)1 << (id & 63); };
+
+    void clear(unsigned id)
+    {
+        if ( (id >> 6) < size() )
+            at(id >> 6) &= ~((uint64_t)1 << (id & 63));
+    };
+
+    void reset();
+    void grow(unsigned words);
+    void term();
 };
 
 class SO_PUBLIC FlowData
@@ -219,11 +264,15 @@ public:
         data = nullptr;
     };
 
+    // call when client_ip and server_ip change
+    void clear_hosts()
+    { host_gen = 0; };
+
 public:  // FIXIT-M privatize if possible
     // these fields are const after initialization
     const FlowKey* key;
     class Session* session;
-    StreamFlowData* flowdata;
+    StreamFlowData flowdata;
     uint8_t ip_proto; // FIXIT-M  -- do we need both of these?
     PktType protocol; // ^^
 
@@ -240,7 +289,13 @@ public:  // FIXIT-M privatize if possible
     PlugData* data;
     const char* service;
 
+    // attribute table entries of client_ip and server_ip, cached by
+    // SFAT_LookupHostEntryByFlow() and valid while host_gen is current
+    HostAttributeEntry* client_host;
+    HostAttributeEntry* server_host;
+
     unsigned policy_id;
+    unsigned host_gen;
 
     FlowState flow_state;
     LwState ssn_state;
@@ -262,6 +317,7 @@ public:  // FIXIT-M privatize if possible
 
     uint8_t  handler[SE_MAX];
     uint8_t  response_count;
+    uint8_t  shed;  // inspection stages disabled by load shedding
 
     uint8_t  inner_client_ttl, inner_server_ttl;
     uint8_t  outer_client_ttl, outer_server_ttl;
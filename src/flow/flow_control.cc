@@ -345,6 +345,9 @@ unsigned FlowControl::process(Flow* flow, Packet* p)
 
     else
     {
+        if ( shed_config )
+            flow->shed = shed_new_flow();
+
         init_roles(p, flow);
         Inspector* b = InspectorManager::get_binder();
 
@@ -36,6 +36,7 @@ Inspector::Inspector()
     unsigned max = get_instance_max();
     assert(slot < max);
     ref_count = new unsigned[max];
+    latency_id = 0;
 
     for ( unsigned i = 0; i < max; ++i )
         ref_count[i] = 0;
@@ -109,6 +109,13 @@ public:
     const InspectApi* get_api()
     { return api; };
 
+    // latency histogram of this inspector's type
+    void set_latency_id(unsigned id)
+    { latency_id = id; };
+
+    unsigned get_latency_id()
+    { return latency_id; };
+
 public:
     static unsigned max_slots;
     static THREAD_LOCAL unsigned slot;
@@ -121,6 +128,7 @@ private:
     const InspectApi* api;
     unsigned* ref_count;
     ServiceId srv_id;
+    unsigned latency_id;
 };
 
 enum InspectorType
@@ -58,6 +58,9 @@ public:
     virtual void close() { };
     virtual void reset() { };
 
+    // called at the end of each packet
+    virtual void flush() { };
+
     virtual void alert(Packet*, const char*, Event*) { };
     virtual void log(Packet*, const char*, Event*) { };
 
@@ -22,6 +22,9 @@
 
 #include <string>
 
+// each script is profiled separately; any beyond the max share the last
+#define MAX_LUA_SCRIPTS 32
+
 void init_chunk(struct lua_State*&, std::string& chunk, const char* name, std::string& args);
 void term_chunk(struct lua_State*&);
 
@@ -25,6 +25,7 @@
 #include "config.h"
 #endif
 #include <stdlib.h>
+#include <string.h>
 #include <ctype.h>
 #include <errno.h>
 
@@ -188,6 +189,207 @@ int string_extract(int bytes_to_grab, int base, const uint8_t *ptr,
     return(parse_helper - byte_array);  /* Return the number of bytes actually extracted */
 }
 
+//-------------------------------------------------------------------------
+// specialized kernels
+//-------------------------------------------------------------------------
+
+template <int N, bool little>
+static int extract_binary(
+    int, const uint8_t* ptr, const uint8_t* start, const uint8_t* end,
+    uint32_t* value)
+{
+    if ( ptr < start || ptr + N > end )
+        return -3;
+
+    uint32_t v = 0;
+
+    for ( int i = 0; i < N; ++i )
+    {
+        if ( little )
+            v |= (uint32_t)ptr[i] << (8 * i);
+        else
+            v = (v << 8) | ptr[i];
+    }
+    *value = v;
+    return N;
+}
+
+static int extract_unsupported(
+    int, const uint8_t*, const uint8_t*, const uint8_t*, uint32_t*)
+{
+    return -2;
+}
+
+static int extract_bad_size(
+    int, const uint8_t*, const uint8_t*, const uint8_t*, uint32_t*)
+{
+    return -1;
+}
+
+ByteExtractor get_byte_extractor(int endianess, int bytes_to_grab)
+{
+    static const ByteExtractor kernels[4][2] =
+    {
+        { extract_binary<1, false>, extract_binary<1, true> },
+        { extract_binary<2, false>, extract_binary<2, true> },
+        { extract_binary<3, false>, extract_binary<3, true> },
+        { extract_binary<4, false>, extract_binary<4, true> },
+    };
+
+    if ( endianess != ENDIAN_LITTLE && endianess != ENDIAN_BIG )
+        return extract_unsupported;
+
+    if ( bytes_to_grab < 1 || bytes_to_grab > 4 )
+        return extract_bad_size;
+
+    return kernels[bytes_to_grab - 1][endianess == ENDIAN_LITTLE];
+}
+
+static inline bool is_space(uint8_t c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static inline unsigned digit_value(uint8_t c)
+{
+    if ( c >= '0' && c <= '9' )
+        return c - '0';
+
+    c |= 0x20;
+
+    if ( c >= 'a' && c <= 'z' )
+        return c - 'a' + 10;
+
+    return 36;
+}
+
+// convert the run of up to n decimal digits at p.  when 8 bytes can be
+// loaded the leading digits are found and converted within one 64 bit
+// word; the rest, if any, are done a digit at a time.
+static inline int parse_decimal(
+    const uint8_t* p, int n, const uint8_t* end, uint64_t& value)
+{
+    int i = 0;
+    uint64_t v = 0;
+
+    if ( p + 8 <= end )
+    {
+        uint64_t x;
+        memcpy(&x, p, sizeof(x));
+
+        // a byte is a digit iff its high nibble is 3 and adding 6 leaves
+        // it at 3; carries only leak upward from a non-digit
+        uint64_t a = (x & 0xF0F0F0F0F0F0F0F0ull) ^ 0x3030303030303030ull;
+        uint64_t b = ((x + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) ^
+            0x3030303030303030ull;
+        uint64_t bad = (((a | b) >> 1) + 0x7878787878787878ull) & 0x8080808080808080ull;
+
+        int run = bad ? __builtin_ctzll(bad) >> 3 : 8;
+
+        if ( run > n )
+            run = n;
+
+        if ( !run )
+            return 0;
+
+        // left align the digits so the first is most significant
+        x = (x & 0x0F0F0F0F0F0F0F0Full) << (8 * (8 - run));
+        x = (x * 2561) >> 8;
+        x = ((x & 0x00FF00FF00FF00FFull) * 6553601) >> 16;
+        x = ((x & 0x0000FFFF0000FFFFull) * 42949672960001ull) >> 32;
+
+        v = x;
+        i = run;
+
+        if ( run < 8 )
+        {
+            value = v;
+            return i;
+        }
+    }
+
+    for ( ; i < n; ++i )
+    {
+        unsigned d = p[i] - '0';
+
+        if ( d > 9 )
+            break;
+
+        v = v * 10 + d;
+    }
+    value = v;
+    return i;
+}
+
+// same as SnortStrToU32() on the bytes_to_grab bytes at ptr without the
+// copy: leading space, an optional '+' and, for base 16, 0x are skipped;
+// '-' is rejected and values too large are clamped
+template <int base>
+static int extract_string(
+    int bytes_to_grab, const uint8_t* ptr, const uint8_t* start,
+    const uint8_t* end, uint32_t* value)
+{
+    if ( bytes_to_grab > PARSELEN || bytes_to_grab <= 0 )
+        return -1;
+
+    if ( ptr < start || ptr + bytes_to_grab > end )
+        return -3;
+
+    int i = 0;
+
+    while ( i < bytes_to_grab && is_space(ptr[i]) )
+        ++i;
+
+    if ( i == bytes_to_grab || ptr[i] == '-' )
+        return -1;
+
+    if ( ptr[i] == '+' )
+        ++i;
+
+    if ( base == 16 && i + 2 < bytes_to_grab && ptr[i] == '0' &&
+        (ptr[i+1] | 0x20) == 'x' && digit_value(ptr[i+2]) < 16 )
+        i += 2;
+
+    uint64_t v = 0;
+    int n;
+
+    if ( base == 10 )
+        n = parse_decimal(ptr + i, bytes_to_grab - i, end, v);
+
+    else
+    {
+        for ( n = 0; i + n < bytes_to_grab; ++n )
+        {
+            unsigned d = digit_value(ptr[i + n]);
+
+            if ( d >= (unsigned)base )
+                break;
+
+            v = v * base + d;
+        }
+    }
+
+    if ( !n )
+        return -1;
+
+    *value = (v > UINT32_MAX) ? UINT32_MAX : (uint32_t)v;
+    return i + n;
+}
+
+ByteExtractor get_string_extractor(int base)
+{
+    switch ( base )
+    {
+    case 8:
+        return extract_string<8>;
+    case 10:
+        return extract_string<10>;
+    case 16:
+        return extract_string<16>;
+    }
+    return extract_bad_size;
+}
+
 
 #ifdef TEST_BYTE_EXTRACT
 #include <stdio.h>
@@ -36,5 +36,16 @@ SO_PUBLIC int byte_extract(
     int endianess, int bytes_to_grab, const uint8_t *ptr,
     const uint8_t *start, const uint8_t *end, uint32_t *value);
 
+// extraction kernels specialized at rule load for an option's endianess,
+// width and base.  they return the number of bytes consumed or < 0 on
+// failure and otherwise produce the same values as byte_extract() and
+// string_extract().
+typedef int (*ByteExtractor)(
+    int bytes_to_grab, const uint8_t* ptr,
+    const uint8_t* start, const uint8_t* end, uint32_t* value);
+
+SO_PUBLIC ByteExtractor get_byte_extractor(int endianess, int bytes_to_grab);
+SO_PUBLIC ByteExtractor get_string_extractor(int base);
+
 #endif
 
@@ -69,7 +69,12 @@ class ByteExtractOption : public IpsOption
 {
 public:
     ByteExtractOption(const ByteExtractData& c) : IpsOption(s_name)
-    { config = c; };
+    {
+        config = c;
+        extract = c.data_string_convert_flag ?
+            get_string_extractor(c.base) :
+            get_byte_extractor(c.endianess, c.bytes_to_grab);
+    };
 
     ~ByteExtractOption()
     { free(config.name); };
@@ -87,6 +92,7 @@ public:
 
 private:
     ByteExtractData config;
+    ByteExtractor extract;
 };
 
 //-------------------------------------------------------------------------
@@ -176,26 +182,14 @@ int ByteExtractOption::eval(Cursor& c, Packet *p)
     }
 
     /* do the extraction */
-    if (data->data_string_convert_flag == 0)
-    {
-        ret = byte_extract(data->endianess, data->bytes_to_grab, ptr, start, end, value);
-        if (ret < 0)
-        {
-            MODULE_PROFILE_END(byteExtractPerfStats);
-            return DETECTION_OPTION_NO_MATCH;
-        }
-        bytes_read = data->bytes_to_grab;
-    }
-    else
+    ret = extract(data->bytes_to_grab, ptr, start, end, value);
+
+    if (ret < 0)
     {
-        ret = string_extract(data->bytes_to_grab, data->base, ptr, start, end, value);
-        if (ret < 0)
-        {
-            MODULE_PROFILE_END(byteExtractPerfStats);
-            return DETECTION_OPTION_NO_MATCH;
-        }
-        bytes_read = ret;
+        MODULE_PROFILE_END(byteExtractPerfStats);
+        return DETECTION_OPTION_NO_MATCH;
     }
+    bytes_read = ret;
 
     /* mulitply */
     *value *= data->multiplier;
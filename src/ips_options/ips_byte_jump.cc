@@ -119,7 +119,12 @@ class ByteJumpOption : public IpsOption
 {
 public:
     ByteJumpOption(const ByteJumpData& c) : IpsOption(s_name)
-    { config = c; };
+    {
+        config = c;
+        extract = c.data_string_convert_flag ?
+            get_string_extractor(c.base) :
+            get_byte_extractor(c.endianess, c.bytes_to_grab);
+    };
 
     ~ByteJumpOption() { };
 
@@ -136,6 +141,7 @@ public:
 
 private:
     ByteJumpData config;
+    ByteExtractor extract;
 };
 
 //-------------------------------------------------------------------------
@@ -229,33 +235,17 @@ int ByteJumpOption::eval(Cursor& c, Packet*)
     const uint8_t* const base_ptr = offset +
        ((bjd->relative_flag) ? c.start() : start_ptr);
 
-    /* Both of the extraction functions contain checks to ensure the data
-     * is inbounds and will return no match if it isn't */
-    if ( !bjd->data_string_convert_flag )
-    {
-        if ( byte_extract(
-                bjd->endianess, bjd->bytes_to_grab,
-                base_ptr, start_ptr, end_ptr, &jump) )
-        {
-            MODULE_PROFILE_END(byteJumpPerfStats);
-            return rval;
-        }
+    /* The extractor checks that the data is inbounds and will return no
+     * match if it isn't */
+    int32_t tmp = extract(
+        bjd->bytes_to_grab, base_ptr, start_ptr, end_ptr, &jump);
 
-        payload_bytes_grabbed = bjd->bytes_to_grab;
-    }
-    else
+    if (tmp < 0)
     {
-        int32_t tmp = string_extract(
-            bjd->bytes_to_grab, bjd->base,
-            base_ptr, start_ptr, end_ptr, &jump);
-
-        if (tmp < 0)
-        {
-            MODULE_PROFILE_END(byteJumpPerfStats);
-            return rval;
-        }
-        payload_bytes_grabbed = tmp;
+        MODULE_PROFILE_END(byteJumpPerfStats);
+        return rval;
     }
+    payload_bytes_grabbed = tmp;
     // Negative offsets that put us outside the buffer should have been caught
     // in the extraction routines
     assert(base_ptr >= c.buffer());
@@ -157,7 +157,12 @@ class ByteTestOption : public IpsOption
 {
 public:
     ByteTestOption(const ByteTestData& c) : IpsOption(s_name)
-    { config = c; };
+    {
+        config = c;
+        extract = c.data_string_convert_flag ?
+            get_string_extractor(c.base) :
+            get_byte_extractor(c.endianess, c.bytes_to_compare);
+    };
 
     ~ByteTestOption() { };
 
@@ -171,6 +176,7 @@ public:
 
 private:
     ByteTestData config;
+    ByteExtractor extract;
 };
 
 //-------------------------------------------------------------------------
@@ -274,35 +280,18 @@ int ByteTestOption::eval(Cursor& c, Packet*)
 
     start_ptr += offset;
 
-    /* both of these functions below perform their own bounds checking within
-     * byte_extract.c
-     */
+    /* the extractor performs its own bounds checking */
 
-    if(!btd->data_string_convert_flag)
-    {
-        if ( byte_extract(
-            btd->endianess, btd->bytes_to_compare,
-            start_ptr, c.buffer(), c.endo(), &value))
-        {
-            MODULE_PROFILE_END(byteTestPerfStats);
-            return rval;
-        }
-        payload_bytes_grabbed = (int)btd->bytes_to_compare;
-    }
-    else
-    {
-        payload_bytes_grabbed = string_extract(
-            btd->bytes_to_compare, btd->base,
-            start_ptr, c.buffer(), c.endo(), &value);
+    payload_bytes_grabbed = extract(
+        btd->bytes_to_compare, start_ptr, c.buffer(), c.endo(), &value);
 
-        if ( payload_bytes_grabbed < 0 )
-        {
-            DEBUG_WRAP(DebugMessage(DEBUG_PATTERN_MATCH,
-                                    "String Extraction Failed\n"););
+    if ( payload_bytes_grabbed < 0 )
+    {
+        DEBUG_WRAP(DebugMessage(DEBUG_PATTERN_MATCH,
+                                "Extraction Failed\n"););
 
-            MODULE_PROFILE_END(byteTestPerfStats);
-            return rval;
-        }
+        MODULE_PROFILE_END(byteTestPerfStats);
+        return rval;
     }
 
     DEBUG_WRAP(DebugMessage(DEBUG_PATTERN_MATCH,
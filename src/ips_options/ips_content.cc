@@ -35,6 +35,7 @@
 #include "snort_debug.h"
 #include "parser/mstring.h"
 #include "utils/boyer_moore.h"
+#include "utils/memsearch.h"
 #include "util.h"
 #include "parser/parser.h"
 #include "parser/parse_utils.h"
@@ -233,8 +234,12 @@ static void finalize_content(PatternMatchData* pmd, OptTreeNode*)
             get_instance_max() * sizeof(*pmd->last_check));
 }
 
+// only long patterns are searched with boyer-moore
 static void make_precomp(PatternMatchData * idx)
 {
+    if ( idx->pattern_size < MEMSEARCH_BM_MIN )
+        return;
+
     idx->skip_stride = make_skip(idx->pattern_buf, idx->pattern_size);
     idx->shift_stride = make_shift(idx->pattern_buf, idx->pattern_size);
 }
@@ -377,9 +382,17 @@ static int uniSearchReal(PatternMatchData* pmd, Cursor& c)
     }
 
     const uint8_t* base = c.buffer() + pos;
+    const uint8_t* pat = (const uint8_t*)pmd->pattern_buf;
     int found;
 
-    if ( pmd->no_case )
+    if ( !pmd->skip_stride )
+    {
+        if ( pmd->no_case )
+            found = memsearch_nocase(base, depth, pat, pmd->pattern_size);
+        else
+            found = memsearch(base, depth, pat, pmd->pattern_size);
+    }
+    else if ( pmd->no_case )
     {
         found = mSearchCI(
             (const char*)base, depth, pmd->pattern_buf, pmd->pattern_size,
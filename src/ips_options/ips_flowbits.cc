@@ -61,7 +61,6 @@ using namespace std;
 #include "util.h"
 #include "utils/stats.h"
 #include "snort.h"
-#include "bitop_funcs.h"
 #include "sfghash.h"
 #include "snort_types.h"
 #include "mstring.h"
@@ -122,6 +121,25 @@ typedef enum
     FLOWBITS_ALL
 }Flowbits_eval;
 
+typedef struct _FLOWBITS_GRP
+{
+    uint16_t count;
+    uint16_t max_id;
+    char *name;
+    uint32_t group_id;
+    uint64_t *mask;       /* one bit per member id */
+} FLOWBITS_GRP;
+
+/**
+**  The ids of an op are compiled into one mask per 64 bit word of
+**  flowbits so each op is a few word-wide bit ops at runtime.
+*/
+struct FLOWBITS_WORD
+{
+    unsigned index;
+    uint64_t mask;
+};
+
 /**
 **  This structure is the context ptr for each detection option
 **  on a rule.  The id is associated with a FLOWBITS_OBJECT id.
@@ -137,26 +155,18 @@ struct FLOWBITS_OP
     char *name;
     char *group;
     uint32_t group_id;
+    FLOWBITS_GRP *grp;    /* resolved from group when parsed */
+    FLOWBITS_WORD *words;
+    unsigned num_words;
 };
 
-typedef struct _FLOWBITS_GRP
-{
-    uint16_t count;
-    uint16_t max_id;
-    char *name;
-    uint32_t group_id;
-    BITOP GrpBitOp;
-} FLOWBITS_GRP;
-
 static SFGHASH *flowbits_grp_hash = NULL;
 
 // one per process
 static unsigned int giFlowbitSizeInBytes = CONVERT_BITS_TO_BYTES(DEFAULT_FLOWBIT_SIZE);
 static unsigned int giFlowbitSize = DEFAULT_FLOWBIT_SIZE;
 
-static int checkFlowBits(
-    uint8_t type, uint8_t evalType, uint16_t *ids, uint16_t num_ids,
-    char *group, Packet *p);
+static int checkFlowBits(const FLOWBITS_OP*, Packet*);
 
 class FlowBitsOption : public IpsOption
 {
@@ -191,6 +201,8 @@ FlowBitsOption::~FlowBitsOption()
         free(config->name);
     if (config->group)
         free(config->group);
+    if (config->words)
+        free(config->words);
 
     free(config);
 }
@@ -277,8 +289,7 @@ int FlowBitsOption::eval(Cursor&, Packet *p)
 
     MODULE_PROFILE_START(flowBitsPerfStats);
 
-    rval = checkFlowBits( flowbits->type, (uint8_t)flowbits->eval,
-            flowbits->ids, flowbits->num_ids, flowbits->group, p);
+    rval = checkFlowBits(flowbits, p);
 
     MODULE_PROFILE_END(flowBitsPerfStats);
     return rval;
@@ -288,135 +299,103 @@ int FlowBitsOption::eval(Cursor&, Packet *p)
 // helper methods
 //-------------------------------------------------------------------------
 
-static inline int boUnSetGrpBit(BITOP *BitOp, char *group)
+/* note, max_id is an index, not a count. */
+static inline unsigned groupWords(const FLOWBITS_GRP *flowbits_grp)
 {
-    FLOWBITS_GRP *flowbits_grp;
-    BITOP *GrpBitOp;
-    unsigned int i, max_bytes;
+    return (flowbits_grp->max_id >> 6) + 1;
+}
 
-    if( group == NULL )
+static inline int unsetGroupBits(StreamFlowData *flowdata, const FLOWBITS_GRP *flowbits_grp)
+{
+    if( flowbits_grp == NULL || flowbits_grp->count == 0 )
         return 0;
 
-    // FIXIT-M why is the hash lookup done at runtime for flowbits groups?
-    // a pointer to flowbis_grp should be in flowbits config data
-    // this *should* be safe but iff splay mode is disabled
-    flowbits_grp = (FLOWBITS_GRP *)sfghash_find(flowbits_grp_hash, group);
-    if( flowbits_grp == NULL )
-        return 0;
-    if((BitOp == NULL) || (BitOp->uiMaxBits <= flowbits_grp->max_id) || flowbits_grp->count == 0)
-        return 0;
-    GrpBitOp = &(flowbits_grp->GrpBitOp);
+    unsigned n = groupWords(flowbits_grp);
+
+    if ( n > flowdata->size() )
+        n = flowdata->size();
+
+    for ( unsigned i = 0; i < n; i++ )
+        flowdata->at(i) &= ~flowbits_grp->mask[i];
 
-    /* note, max_id is an index, not a count.
-     * Calculate max_bytes by adding 8 to max_id, then dividing by 8.  */
-    max_bytes = (flowbits_grp->max_id + 8) >> 3;
-    for ( i = 0; i < max_bytes; i++ )
-    {
-        BitOp->pucBitBuffer[i] &= ~GrpBitOp->pucBitBuffer[i];
-    }
     return 1;
 }
 
-static inline int boToggleGrpBit(BITOP *BitOp, char *group)
+static inline int toggleGroupBits(StreamFlowData *flowdata, const FLOWBITS_GRP *flowbits_grp)
 {
-    FLOWBITS_GRP *flowbits_grp;
-    BITOP *GrpBitOp;
-    unsigned int i, max_bytes;
-
-    if( group == NULL )
-        return 0;
-    flowbits_grp = (FLOWBITS_GRP *)sfghash_find(flowbits_grp_hash, group);
-    if( flowbits_grp == NULL )
+    if( flowbits_grp == NULL || flowbits_grp->count == 0 )
         return 0;
-    if((BitOp == NULL) || (BitOp->uiMaxBits <= flowbits_grp->max_id) || flowbits_grp->count == 0)
-        return 0;
-    GrpBitOp = &(flowbits_grp->GrpBitOp);
 
-    /* note, max_id is an index, not a count.
-     * Calculate max_bytes by adding 8 to max_id, then dividing by 8.  */
-    max_bytes = (flowbits_grp->max_id + 8) >> 3;
-    for ( i = 0; i < max_bytes; i++ )
+    unsigned n = groupWords(flowbits_grp);
+
+    for ( unsigned i = 0; i < n; i++ )
     {
-        BitOp->pucBitBuffer[i] ^= GrpBitOp->pucBitBuffer[i];
+        if ( flowbits_grp->mask[i] )
+            flowdata->at(i) ^= flowbits_grp->mask[i];
     }
     return 1;
 }
 
-static inline int boSetxBitsToGrp(
-    BITOP *BitOp, uint16_t *ids, uint16_t num_ids, char *group)
-{
-    unsigned int i;
-    if (!boUnSetGrpBit(BitOp, group))
-        return 0;
-    for(i = 0; i < num_ids; i++)
-        boSetBit(BitOp,ids[i]);
-    return 1;
-}
-
-
-static inline int issetFlowbits(
-    StreamFlowData *flowdata, uint8_t eval, uint16_t *ids,
-    uint16_t num_ids, char *group )
+static inline int issetFlowbits(StreamFlowData *flowdata, const FLOWBITS_OP *flowbits)
 {
-    unsigned int i;
-    FLOWBITS_GRP *flowbits_grp;
-    Flowbits_eval  evalType = (Flowbits_eval)eval;
+    const FLOWBITS_GRP *flowbits_grp = flowbits->grp;
+    unsigned i;
 
-    switch (evalType)
+    switch (flowbits->eval)
     {
     case FLOWBITS_AND:
-        for(i = 0; i < num_ids; i++)
+        for ( i = 0; i < flowbits->num_words; i++ )
         {
-            if(!boIsBitSet(&(flowdata->boFlowbits), ids[i]))
+            const FLOWBITS_WORD& w = flowbits->words[i];
+
+            if ( (flowdata->get(w.index) & w.mask) != w.mask )
                 return 0;
         }
         return 1;
-        break;
+
     case FLOWBITS_OR:
-        for(i = 0; i < num_ids; i++)
+        for ( i = 0; i < flowbits->num_words; i++ )
         {
-            if(boIsBitSet(&(flowdata->boFlowbits), ids[i]))
+            const FLOWBITS_WORD& w = flowbits->words[i];
+
+            if ( flowdata->get(w.index) & w.mask )
                 return 1;
         }
         return 0;
-        break;
+
     case FLOWBITS_ALL:
-        flowbits_grp = (FLOWBITS_GRP *)sfghash_find(flowbits_grp_hash, group);
         if( flowbits_grp == NULL )
             return 0;
-        for ( i = 0; i <= (unsigned int)(flowbits_grp->max_id >>3) ; i++ )
+
+        for ( i = 0; i < groupWords(flowbits_grp); i++ )
         {
-            uint8_t val = flowdata->boFlowbits.pucBitBuffer[i] & flowbits_grp->GrpBitOp.pucBitBuffer[i];
-            if (val != flowbits_grp->GrpBitOp.pucBitBuffer[i])
+            if ( (flowdata->get(i) & flowbits_grp->mask[i]) != flowbits_grp->mask[i] )
                 return 0;
         }
         return 1;
-        break;
+
     case FLOWBITS_ANY:
-        flowbits_grp = (FLOWBITS_GRP *)sfghash_find(flowbits_grp_hash, group);
         if( flowbits_grp == NULL )
             return 0;
-        for ( i = 0; i <= (unsigned int)(flowbits_grp->max_id >>3) ; i++ )
+
+        for ( i = 0; i < groupWords(flowbits_grp); i++ )
         {
-            uint8_t val = flowdata->boFlowbits.pucBitBuffer[i] & flowbits_grp->GrpBitOp.pucBitBuffer[i];
-            if (val)
+            if ( flowdata->get(i) & flowbits_grp->mask[i] )
                 return 1;
         }
         return 0;
-        break;
+
     default:
         return 0;
     }
 }
 
-static int checkFlowBits(
-    uint8_t type, uint8_t evalType, uint16_t *ids, uint16_t num_ids, char *group, Packet *p)
+static int checkFlowBits(const FLOWBITS_OP *flowbits, Packet *p)
 {
     int rval = DETECTION_OPTION_NO_MATCH;
     StreamFlowData *flowdata;
-    Flowbits_eval eval = (Flowbits_eval) evalType;
     int result = 0;
-    int i;
+    unsigned i;
 
     flowdata = stream.get_flow_data(p);
     if(!flowdata)
@@ -425,40 +404,51 @@ static int checkFlowBits(
         return rval;
     }
 
-    switch(type)
+    switch(flowbits->type)
     {
     case FLOWBITS_SET:
-        for(i = 0; i < num_ids; i++)
-            boSetBit(&(flowdata->boFlowbits),ids[i]);
+        for ( i = 0; i < flowbits->num_words; i++ )
+            flowdata->at(flowbits->words[i].index) |= flowbits->words[i].mask;
         result = 1;
         break;
 
     case FLOWBITS_SETX:
-        result = boSetxBitsToGrp(&(flowdata->boFlowbits), ids, num_ids, group);
+        result = unsetGroupBits(flowdata, flowbits->grp);
+
+        if ( result )
+        {
+            for ( i = 0; i < flowbits->num_words; i++ )
+                flowdata->at(flowbits->words[i].index) |= flowbits->words[i].mask;
+        }
         break;
 
     case FLOWBITS_UNSET:
-        if (eval == FLOWBITS_ALL )
-            boUnSetGrpBit(&(flowdata->boFlowbits), group);
+        if (flowbits->eval == FLOWBITS_ALL )
+            unsetGroupBits(flowdata, flowbits->grp);
         else
         {
-            for(i = 0; i < num_ids; i++)
-                boClearBit(&(flowdata->boFlowbits),ids[i]);
+            for ( i = 0; i < flowbits->num_words; i++ )
+            {
+                const FLOWBITS_WORD& w = flowbits->words[i];
+
+                if ( w.index < flowdata->size() )
+                    flowdata->at(w.index) &= ~w.mask;
+            }
         }
         result = 1;
         break;
 
     case FLOWBITS_RESET:
-        if (!group)
-            boResetBITOP(&(flowdata->boFlowbits));
+        if (!flowbits->group)
+            flowdata->reset();
         else
-            boUnSetGrpBit(&(flowdata->boFlowbits), group);
+            unsetGroupBits(flowdata, flowbits->grp);
         result = 1;
         break;
 
     case FLOWBITS_ISSET:
 
-        if(issetFlowbits(flowdata,(uint8_t)eval, ids, num_ids, group))
+        if(issetFlowbits(flowdata, flowbits))
         {
             result = 1;
         }
@@ -470,7 +460,7 @@ static int checkFlowBits(
         break;
 
     case FLOWBITS_ISNOTSET:
-        if(!issetFlowbits(flowdata, (uint8_t)eval, ids, num_ids, group))
+        if(!issetFlowbits(flowdata, flowbits))
         {
             result = 1;
         }
@@ -481,21 +471,12 @@ static int checkFlowBits(
         break;
 
     case FLOWBITS_TOGGLE:
-        if (group)
-            boToggleGrpBit(&(flowdata->boFlowbits),group);
+        if (flowbits->group)
+            toggleGroupBits(flowdata, flowbits->grp);
         else
         {
-            for(i = 0; i < num_ids; i++)
-            {
-                if (boIsBitSet(&(flowdata->boFlowbits),ids[i]))
-                {
-                    boClearBit(&(flowdata->boFlowbits),ids[i]);
-                }
-                else
-                {
-                    boSetBit(&(flowdata->boFlowbits),ids[i]);
-                }
-            }
+            for ( i = 0; i < flowbits->num_words; i++ )
+                flowdata->at(flowbits->words[i].index) ^= flowbits->words[i].mask;
         }
         result = 1;
 
@@ -602,7 +583,7 @@ static void udpateFlowBitGroupInfo(
     flowbits_grp->count++;
     if ( flowbits_grp->max_id < flowbits_item->id )
         flowbits_grp->max_id = flowbits_item->id;
-    boSetBit(&(flowbits_grp->GrpBitOp),flowbits_item->id);
+    flowbits_grp->mask[flowbits_item->id >> 6] |= (uint64_t)1 << (flowbits_item->id & 63);
 }
 
 static bool validateName(char *name)
@@ -687,6 +668,36 @@ static  FLOWBITS_OBJECT* getFlowBitItem(
     return flowbits_item;
 }
 
+// fold the ids into one mask per word in order of first use.  toggling
+// an id twice leaves it unchanged so toggle masks are combined with xor.
+static void compileFlowbitWords(FLOWBITS_OP *flowbits)
+{
+    flowbits->words = (FLOWBITS_WORD*)SnortAlloc(flowbits->num_ids * sizeof(FLOWBITS_WORD));
+    flowbits->num_words = 0;
+
+    for ( unsigned i = 0; i < flowbits->num_ids; i++ )
+    {
+        unsigned index = flowbits->ids[i] >> 6;
+        uint64_t bit = (uint64_t)1 << (flowbits->ids[i] & 63);
+        unsigned j = 0;
+
+        while ( j < flowbits->num_words && flowbits->words[j].index != index )
+            j++;
+
+        if ( j == flowbits->num_words )
+        {
+            flowbits->words[j].index = index;
+            flowbits->words[j].mask = 0;
+            flowbits->num_words++;
+        }
+
+        if ( flowbits->type == FLOWBITS_TOGGLE )
+            flowbits->words[j].mask ^= bit;
+        else
+            flowbits->words[j].mask |= bit;
+    }
+}
+
 static void processFlowbits(
     char *flowbits_names, FLOWBITS_GRP *flowbits_grp, FLOWBITS_OP *flowbits)
 {
@@ -755,6 +766,8 @@ static void processFlowbits(
 
     free(flowbits_name);
 
+    if ( flowbits->num_ids )
+        compileFlowbitWords(flowbits);
 }
 
 void validateFlowbitsSyntax(FLOWBITS_OP *flowbits)
@@ -849,8 +862,7 @@ static FLOWBITS_GRP *getFlowBitGroup(char *groupName)
     if (flowbits_grp == NULL)
     {
         flowbits_grp = (FLOWBITS_GRP *)SnortAlloc(sizeof(FLOWBITS_GRP));
-        boInitBITOP(&(flowbits_grp->GrpBitOp), giFlowbitSizeInBytes);
-        boResetBITOP(&(flowbits_grp->GrpBitOp));
+        flowbits_grp->mask = (uint64_t*)SnortAlloc(((giFlowbitSize + 63) >> 6) * sizeof(uint64_t));
         hstatus = sfghash_add(flowbits_grp_hash, groupName, flowbits_grp);
         if(hstatus != SFGHASH_OK)
         {
@@ -894,6 +906,7 @@ static void processFlowBitsWithGroup(char *flowbitsName, char *groupName, FLOWBI
     {
         flowbits->group = SnortStrdup(groupName);
         flowbits->group_id = flowbits_grp->group_id;
+        flowbits->grp = flowbits_grp;
     }
     validateFlowbitsSyntax(flowbits);
     DEBUG_WRAP( printOutFlowbits(flowbits));
@@ -977,6 +990,7 @@ static FLOWBITS_OP* flowbits_parse(const char *data)
             flowbits_grp = getFlowBitGroup(groupName);
             flowbits->group = groupName;
             flowbits->group_id = flowbits_grp->group_id;
+            flowbits->grp = flowbits_grp;
         }
         flowbits->type = FLOWBITS_RESET;
         flowbits->ids   = NULL;
@@ -1081,7 +1095,7 @@ static void FlowItemFree(void *d)
 static void FlowBitsGrpFree(void *d)
 {
     FLOWBITS_GRP *data = (FLOWBITS_GRP *)d;
-    boFreeBITOP(&(data->GrpBitOp));
+    free(data->mask);
     if (data->name)
         free(data->name);
     free(data);
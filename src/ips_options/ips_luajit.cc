@@ -31,13 +31,19 @@
 #include "framework/parameter.h"
 #include "time/profiler.h"
 #include "detection/detection_defines.h"
+#include "detection/detection_util.h"
+#include "protocols/packet.h"
 
-static THREAD_LOCAL ProfileStats luaIpsPerfStats;
+static THREAD_LOCAL ProfileStats luaIpsPerfStats[MAX_LUA_SCRIPTS];
+static unsigned num_scripts = 0;
 
 #define opt_eval "eval"
 
 //-------------------------------------------------------------------------
 // ffi stuff
+//
+// IMPORTANT - if you change these structs, you must also update
+// snort_plugins.lua.
 //-------------------------------------------------------------------------
 
 struct SnortBuffer
@@ -47,13 +53,24 @@ struct SnortBuffer
     unsigned len;
 };
 
+#define MAX_LUA_BUFFERS 16
+
+struct SnortBuffers
+{
+    unsigned num;
+    SnortBuffer buf[MAX_LUA_BUFFERS];
+};
+
 extern "C" {
 // ensure Lua can link with this
 const SnortBuffer* get_buffer();
+const SnortBuffers* get_buffers();
 }
 
 static THREAD_LOCAL Cursor* cursor;
+static THREAD_LOCAL Packet* packet;
 static THREAD_LOCAL SnortBuffer buf;
+static THREAD_LOCAL SnortBuffers bufs;
 
 SO_PUBLIC const SnortBuffer* get_buffer()
 {
@@ -64,6 +81,41 @@ SO_PUBLIC const SnortBuffer* get_buffer()
     return &buf;
 }
 
+static inline void add_buffer(const char* type, const uint8_t* data, unsigned len)
+{
+    assert(bufs.num < MAX_LUA_BUFFERS);
+    SnortBuffer& b = bufs.buf[bufs.num++];
+    b.type = type;
+    b.data = data;
+    b.len = len;
+}
+
+// views of every buffer available to the rule so a script can check
+// them all in one call; the first is the same as get_buffer()
+SO_PUBLIC const SnortBuffers* get_buffers()
+{
+    assert(cursor && packet);
+    bufs.num = 0;
+
+    add_buffer(cursor->get_name(), cursor->start(), cursor->length());
+
+    Cursor pkt(packet);
+    add_buffer(pkt.get_name(), pkt.buffer(), pkt.size());
+    add_buffer("raw_data", packet->data, packet->dsize);
+
+    if ( g_file_data.len )
+        add_buffer("file_data", g_file_data.data, g_file_data.len);
+
+    for ( unsigned i = HTTP_BUFFER_NONE + 1; i < HTTP_BUFFER_MAX; ++i )
+    {
+        const HttpBuffer* hb = GetHttpBuffer((HTTP_BUFFER)i);
+
+        if ( hb )
+            add_buffer(http_buffer_name[i], hb->buf, hb->length);
+    }
+    return &bufs;
+}
+
 //-------------------------------------------------------------------------
 // module stuff
 //-------------------------------------------------------------------------
@@ -83,16 +135,19 @@ class LuaJitModule : public Module
 {
 public:
     LuaJitModule(const char* name) : Module(name, s_help, s_params)
-    { };
+    {
+        slot = num_scripts < MAX_LUA_SCRIPTS ? num_scripts++ : MAX_LUA_SCRIPTS - 1;
+    };
 
     bool begin(const char*, int, SnortConfig*) override;
     bool set(const char*, Value&, SnortConfig*) override;
 
     ProfileStats* get_profile() const override
-    { return &luaIpsPerfStats; };
+    { return luaIpsPerfStats + slot; };
 
 public:
     std::string args;
+    unsigned slot;
 };
 
 bool LuaJitModule::begin(const char*, int, SnortConfig*)
@@ -136,6 +191,8 @@ private:
 
     std::string config;
     struct lua_State** lua;
+    int* eval_ref;
+    unsigned slot;
 };
 
 LuaJitOption::LuaJitOption(
@@ -150,9 +207,16 @@ LuaJitOption::LuaJitOption(
     unsigned max = get_instance_max();
 
     lua = new lua_State*[max];
+    eval_ref = new int[max];
+    slot = mod->slot;
 
+    // keep a reference to eval so it isn't looked up by name per packet
     for ( unsigned i = 0; i < max; ++i )
+    {
         init_chunk(lua[i], chunk, name, config);
+        lua_getglobal(lua[i], opt_eval);
+        eval_ref[i] = luaL_ref(lua[i], LUA_REGISTRYINDEX);
+    }
 }
 
 LuaJitOption::~LuaJitOption()
@@ -163,6 +227,7 @@ LuaJitOption::~LuaJitOption()
         term_chunk(lua[i]);
 
     delete[] lua;
+    delete[] eval_ref;
 }
 
 uint32_t LuaJitOption::hash() const
@@ -187,28 +252,31 @@ bool LuaJitOption::operator==(const IpsOption& ips) const
     return true;
 }
 
-int LuaJitOption::eval(Cursor& c, Packet*)
+int LuaJitOption::eval(Cursor& c, Packet* p)
 {
     PROFILE_VARS;
-    MODULE_PROFILE_START(luaIpsPerfStats);
+    MODULE_PROFILE_START(luaIpsPerfStats[slot]);
 
     cursor = &c;
+    packet = p;
 
-    lua_State* L = lua[get_instance_id()];
-    lua_getglobal(L, opt_eval);
+    unsigned id = get_instance_id();
+    lua_State* L = lua[id];
+    lua_rawgeti(L, LUA_REGISTRYINDEX, eval_ref[id]);
 
     if ( lua_pcall(L, 0, 1, 0) )
     {
         const char* err = lua_tostring(L, -1);
         ErrorMessage("%s\n", err);
-        MODULE_PROFILE_END(luaIpsPerfStats);
+        lua_pop(L, 1);
+        MODULE_PROFILE_END(luaIpsPerfStats[slot]);
         return DETECTION_OPTION_NO_MATCH;
     }
     bool result = lua_toboolean(L, -1);
     lua_pop(L, 1);
 
     int ret = result ? DETECTION_OPTION_MATCH : DETECTION_OPTION_NO_MATCH;
-    MODULE_PROFILE_END(luaIpsPerfStats);
+    MODULE_PROFILE_END(luaIpsPerfStats[slot]);
 
     return ret;
 }
@@ -39,6 +39,8 @@
 #include "sfhashfcn.h"
 #include "snort.h"
 #include "profiler.h"
+#include "flow/flow.h"
+#include "time/shed.h"
 #include "fpdetect.h"
 #include "sfhashfcn.h"
 #include "detection/detection_defines.h"
@@ -547,7 +549,7 @@ bool PcreOption::operator==(const IpsOption& ips) const
     return false;
 }
 
-int PcreOption::eval(Cursor& c, Packet*)
+int PcreOption::eval(Cursor& c, Packet* p)
 {
     PcreData *pcre_data = config;
     int found_offset = -1;  /* where is the ending location of the pattern */
@@ -557,7 +559,8 @@ int PcreOption::eval(Cursor& c, Packet*)
     MODULE_PROFILE_START(pcrePerfStats);
 
     //short circuit this for testing pcre performance impact
-    if (ScNoPcre())
+    //or when shed for this flow under load
+    if (ScNoPcre() || SHED_SKIP(p->flow, SHED_PCRE, pcre_skipped))
     {
         MODULE_PROFILE_END(pcrePerfStats);
         return DETECTION_OPTION_NO_MATCH;
@@ -31,7 +31,6 @@
 #include <signal.h>
 
 #include <string>
-#include <mutex>
 using namespace std;
 
 #include "log_text.h"
@@ -130,11 +129,13 @@ int RollAlertFile(const char *filearg)
 
 //--------------------------------------------------------------------
 // default logger stuff
+//
+// each thread (main and packet) has its own buffer so no locking is
+// needed; a flush is a single write so records from different threads
+// are not interleaved.
 //--------------------------------------------------------------------
 
-static mutex log_mutex;
-
-static TextLog* text_log = NULL;
+static THREAD_LOCAL TextLog* text_log = NULL;
 
 void OpenLogger()
 {
@@ -144,14 +145,13 @@ void OpenLogger()
 void CloseLogger()
 {
     TextLog_Term(text_log);
+    text_log = NULL;
 }
 
 void LogIPPkt(Packet* p)
 {
-    log_mutex.lock();
     LogIPPkt(text_log, p);
     TextLog_Flush(text_log);
-    log_mutex.unlock();
 }
 
 void snort_print(Packet* p)
@@ -164,11 +164,8 @@ void snort_print(Packet* p)
     // FIXIT-L ARP logging not impelemted
     else if (p->proto_bits & PROTO_BIT__ARP)
     {
-
-        log_mutex.lock();
         LogArpHeader(text_log, p);
         TextLog_Flush(text_log);
-        log_mutex.unlock();
     }
 #endif
 #if 0
@@ -185,9 +182,7 @@ void snort_print(Packet* p)
 
 void LogNetData(const uint8_t* data, const int len, Packet* p)
 {
-    log_mutex.lock();
     LogNetData(text_log, data, len, p);
     TextLog_Flush(text_log);
-    log_mutex.unlock();
 }
 
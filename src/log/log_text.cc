@@ -72,11 +72,45 @@
  * utility functions
  *--------------------------------------------------------------------
  */
+// alerts come in bursts so the date and time of day are formatted once
+// per second and only the microseconds are converted for each event.
+struct TimeStampCache
+{
+    const SnortConfig* conf;
+    time_t sec;
+    unsigned len;
+    char buf[TIMEBUF_SIZE];
+};
+
+static THREAD_LOCAL TimeStampCache ts_cache;
+
 void LogTimeStamp(TextLog* log, Packet* p)
 {
-    char timestamp[TIMEBUF_SIZE];
-    ts_print((struct timeval*)&p->pkth->ts, timestamp);
-    TextLog_Puts(log, timestamp);
+    const struct timeval* tv = (struct timeval*)&p->pkth->ts;
+
+    if ( !ts_cache.len || tv->tv_sec != ts_cache.sec || snort_conf != ts_cache.conf )
+    {
+        struct timeval sec = { tv->tv_sec, 0 };
+        ts_print(&sec, ts_cache.buf);
+
+        // drop the trailing "000000 " and keep the '.'
+        ts_cache.len = strlen(ts_cache.buf) - 7;
+        ts_cache.sec = tv->tv_sec;
+        ts_cache.conf = snort_conf;
+    }
+    TextLog_Write(log, ts_cache.buf, ts_cache.len);
+
+    char usec[7];
+    unsigned u = tv->tv_usec;
+
+    usec[6] = ' ';
+
+    for ( int i = 5; i >= 0; --i )
+    {
+        usec[i] = '0' + (u % 10);
+        u /= 10;
+    }
+    TextLog_Write(log, usec, sizeof(usec));
 }
 
 /*--------------------------------------------------------------------
@@ -562,40 +596,71 @@ void LogIpAddrs(TextLog *log, Packet *p)
     if (!p->has_ip())
         return;
 
-    if ( p->is_fragment() || ( !p->is_tcp() && !p->is_udp()))
+    bool ports = !p->is_fragment() && (p->is_tcp() || p->is_udp());
+
+    LogIpAddress(log, p->ptrs.ip_api.get_src());
+
+    if ( ports )
     {
-        const char *ip_fmt = "%s -> %s";
+        TextLog_Putc(log, ':');
+        TextLog_PutUInt(log, p->ptrs.sp);
+    }
+    TextLog_Write(log, " -> ", 4);
+    LogIpAddress(log, p->ptrs.ip_api.get_dst());
 
-        if (ScObfuscate())
-        {
-            TextLog_Print(log, ip_fmt,
-                    ObfuscateIpToText(p->ptrs.ip_api.get_src()),
-                    ObfuscateIpToText(p->ptrs.ip_api.get_dst()));
-        }
-        else
-        {
-            TextLog_Print(log, ip_fmt,
-                    inet_ntoax(p->ptrs.ip_api.get_src()),
-                    inet_ntoax((p->ptrs.ip_api.get_dst())));
-        }
+    if ( ports )
+    {
+        TextLog_Putc(log, ':');
+        TextLog_PutUInt(log, p->ptrs.dp);
     }
-    else
+}
+
+/*--------------------------------------------------------------------
+ * Function: LogIpAddress(TextLog*, const sfip_t*, bool)
+ *
+ * Purpose: Print a single address, obfuscated if configured and
+ *          obfuscate is set.  IPv4 is converted directly into the
+ *          buffer; IPv6 uses sfip_ntop.
+ *--------------------------------------------------------------------
+ */
+void LogIpAddress(TextLog* log, const sfip_t* ip, bool obfuscate)
+{
+    if ( obfuscate && ScObfuscate() )
     {
-        const char *ip_fmt = "%s:%d -> %s:%d";
+        TextLog_Puts(log, ObfuscateIpToText(ip));
+        return;
+    }
 
-        if (ScObfuscate())
-        {
-            TextLog_Print(log, ip_fmt,
-                    ObfuscateIpToText(p->ptrs.ip_api.get_src()), p->ptrs.sp,
-                    ObfuscateIpToText(p->ptrs.ip_api.get_dst()), p->ptrs.dp);
-        }
-        else
+    if ( !ip->is_ip4() )
+    {
+        char buf[INET6_ADDRSTRLEN];
+        sfip_ntop(ip, buf, sizeof(buf));
+        TextLog_Puts(log, buf);
+        return;
+    }
+
+    char buf[16];
+    char* s = buf;
+
+    for ( int i = 0; i < 4; ++i )
+    {
+        unsigned b = ip->ip8[i];
+
+        if ( i )
+            *s++ = '.';
+
+        if ( b >= 100 )
         {
-            TextLog_Print(log, ip_fmt,
-                    inet_ntoax(p->ptrs.ip_api.get_src()), p->ptrs.sp,
-                    inet_ntoax(p->ptrs.ip_api.get_dst()), p->ptrs.dp);
+            *s++ = '0' + b / 100;
+            b %= 100;
+            *s++ = '0' + b / 10;
         }
+        else if ( b >= 10 )
+            *s++ = '0' + b / 10;
+
+        *s++ = '0' + b % 10;
     }
+    TextLog_Write(log, buf, s - buf);
 }
 
 /*--------------------------------------------------------------------
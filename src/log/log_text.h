@@ -40,6 +40,7 @@
 
 struct Packet;
 struct Event;
+struct sfip_t;
 
 namespace ip
 {
@@ -61,6 +62,7 @@ void LogTimeStamp(TextLog*, Packet*);
 void LogTrHeader(TextLog*, Packet*);
 void Log2ndHeader(TextLog*, Packet*);
 void LogIpAddrs(TextLog*, Packet*);
+void LogIpAddress(TextLog*, const sfip_t*, bool obfuscate = true);
 SO_PUBLIC void LogIpOptions(TextLog*, const IP4Hdr*, uint16_t valid_ip4_len);
 SO_PUBLIC void LogTcpOptions(TextLog*, const tcp::TCPHdr*, uint16_t valid_tcp_len);
 void LogIPHeader(TextLog*, Packet*);
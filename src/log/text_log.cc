@@ -185,19 +185,20 @@ bool TextLog_Write (TextLog* const txt, const char* str, int len)
         TextLog_Flush(txt);
         avail = TextLog_Avail(txt);
     }
-    len = snprintf(txt->buf+txt->pos, avail, "%s", str);
-
-    if ( len >= avail )
+    if ( len < 0 )
     {
-        txt->pos = txt->maxBuf - 1;
-        txt->buf[txt->pos] = '\0';
         return false;
     }
-    else if ( len < 0 )
+    else if ( len >= avail )
     {
+        memcpy(txt->buf+txt->pos, str, avail);
+        txt->pos = txt->maxBuf - 1;
+        txt->buf[txt->pos] = '\0';
         return false;
     }
+    memcpy(txt->buf+txt->pos, str, len);
     txt->pos += len;
+    txt->buf[txt->pos] = '\0';
     return true;
 }
 
@@ -238,6 +239,26 @@ bool TextLog_Print (TextLog* const txt, const char* fmt, ...)
     return true;
 }
 
+/*-------------------------------------------------------------------
+ * TextLog_PutUInt: append decimal integer to buffer without the
+ * format parsing overhead of TextLog_Print
+ *-------------------------------------------------------------------
+ */
+bool TextLog_PutUInt (TextLog* const txt, uint64_t u)
+{
+    char tmp[24];
+    char* s = tmp + sizeof(tmp);
+
+    do
+    {
+        *--s = '0' + (u % 10);
+        u /= 10;
+    }
+    while ( u );
+
+    return TextLog_Write(txt, s, tmp + sizeof(tmp) - s);
+}
+
 /*-------------------------------------------------------------------
  * TextLog_Quote: write string escaping quotes
  * TBD could be smarter by counting required escapes instead of
@@ -38,6 +38,7 @@
 #ifndef TEXT_LOG_H
 #define TEXT_LOG_H
 
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
@@ -79,6 +80,7 @@ bool TextLog_Putc(TextLog* const, char);
 bool TextLog_Quote(TextLog* const, const char*);
 bool TextLog_Write(TextLog* const, const char*, int len);
 bool TextLog_Print(TextLog* const, const char* format, ...);
+bool TextLog_PutUInt(TextLog* const, uint64_t);
 bool TextLog_Flush(TextLog* const);
 
 /*-------------------------------------------------------------------
@@ -0,0 +1,333 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// alert_columnar writes events into blocks of compressed columns (see
+// columnar_common.h) for bulk loading into analytics tools.  each packet
+// thread fills its own block in memory and the block is compressed and
+// written only when it is full or the logger is closed.
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include <string>
+
+#include "framework/logger.h"
+#include "framework/module.h"
+#include "snort.h"
+#include "util.h"
+#include "utils/stats.h"
+#include "columnar_block.h"
+
+#define S_NAME "alert_columnar"
+#define F_NAME S_NAME ".bin"
+
+using namespace std;
+
+static const PegInfo col_pegs[] =
+{
+    { "rows", "events logged" },
+    { "blocks", "blocks written" },
+    { "raw bytes", "column bytes before compression" },
+    { "bytes", "column bytes after compression" },
+    { "dropped", "events lost to write errors" },
+    { nullptr, nullptr }
+};
+
+static THREAD_LOCAL ColumnarStats col_stats;
+
+//-------------------------------------------------------------------------
+// module stuff
+//-------------------------------------------------------------------------
+
+static const Parameter s_params[] =
+{
+    { "block_rows", Parameter::PT_INT, "1:1048576", "4096",
+      "number of events per block" },
+
+    { "level", Parameter::PT_INT, "0:9", "1",
+      "zlib compression level (0 is none)" },
+
+    { "limit", Parameter::PT_INT, "0:", "0",
+      "set limit (0 is unlimited)" },
+
+    { "units", Parameter::PT_ENUM, "B | K | M | G", "B",
+      "bytes | KB | MB | GB" },
+
+    { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
+};
+
+#define s_help \
+    "output event in compressed columnar blocks"
+
+class ColumnarModule : public Module
+{
+public:
+    ColumnarModule() : Module(S_NAME, s_help, s_params) { };
+
+    bool set(const char*, Value&, SnortConfig*) override;
+    bool begin(const char*, int, SnortConfig*) override;
+    bool end(const char*, int, SnortConfig*) override;
+
+    const PegInfo* get_pegs() const override
+    { return col_pegs; }
+
+    PegCount* get_counts() const override
+    { return (PegCount*)&col_stats; }
+
+public:
+    unsigned block_rows;
+    int level;
+    unsigned long limit;
+    unsigned units;
+};
+
+bool ColumnarModule::set(const char*, Value& v, SnortConfig*)
+{
+    if ( v.is("block_rows") )
+        block_rows = v.get_long();
+
+    else if ( v.is("level") )
+        level = v.get_long();
+
+    else if ( v.is("limit") )
+        limit = v.get_long();
+
+    else if ( v.is("units") )
+        units = v.get_long();
+
+    else
+        return false;
+
+    return true;
+}
+
+bool ColumnarModule::begin(const char*, int, SnortConfig*)
+{
+    block_rows = 4096;
+    level = 1;
+    limit = 0;
+    units = 0;
+    return true;
+}
+
+bool ColumnarModule::end(const char*, int, SnortConfig*)
+{
+    while ( units-- )
+        limit *= 1024;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+// logger stuff
+//-------------------------------------------------------------------------
+
+struct ColumnarContext
+{
+    FILE* file;
+    size_t size;
+    ColumnarBlock* block;
+};
+
+static THREAD_LOCAL ColumnarContext context;
+
+class ColumnarLogger : public Logger {
+public:
+    ColumnarLogger(ColumnarModule*);
+
+    void open() override;
+    void close() override;
+
+    void alert(Packet*, const char* msg, Event*) override;
+
+private:
+    void open_file();
+    void close_file();
+    void write_block();
+
+private:
+    unsigned block_rows;
+    int level;
+    unsigned long limit;
+};
+
+ColumnarLogger::ColumnarLogger(ColumnarModule* m)
+{
+    block_rows = m->block_rows;
+    level = m->level;
+    limit = m->limit;
+}
+
+void ColumnarLogger::open_file()
+{
+    // each file is stamped and created exclusively so that rotation never
+    // overwrites; a sequence number separates rotations in the same second
+    string base;
+    get_instance_file(base, F_NAME);
+
+    unsigned now = (unsigned)time(nullptr);
+    string name;
+    int fd = -1;
+
+    for ( unsigned seq = 0; fd < 0; ++seq )
+    {
+        char suffix[32];
+
+        if ( seq )
+            snprintf(suffix, sizeof(suffix), ".%u.%u", now, seq);
+        else
+            snprintf(suffix, sizeof(suffix), ".%u", now);
+
+        name = base + suffix;
+        fd = ::open(name.c_str(), O_WRONLY|O_CREAT|O_EXCL, 0666);
+
+        if ( fd < 0 && errno != EEXIST )
+            FatalError("%s: can't open %s: %s\n", S_NAME, name.c_str(), get_error(errno));
+    }
+
+    if ( !(context.file = fdopen(fd, "wb")) )
+        FatalError("%s: can't open %s: %s\n", S_NAME, name.c_str(), get_error(errno));
+
+    // blocks are written in a few large pieces and a failed block is cut
+    // off with ftruncate(), which a stdio buffer would undo
+    setvbuf(context.file, nullptr, _IONBF, 0);
+
+    ColumnarFileHeader hdr;
+    hdr.magic = htonl(COLUMNAR_MAGIC);
+    hdr.version = htonl(COLUMNAR_VERSION);
+    hdr.columns = htonl(COL_MAX);
+
+    if ( fwrite(&hdr, sizeof(hdr), 1, context.file) != 1 )
+        FatalError("%s: can't write %s: %s\n", S_NAME, name.c_str(), get_error(errno));
+
+    context.size = sizeof(hdr);
+}
+
+void ColumnarLogger::close_file()
+{
+    if ( context.file )
+        fclose(context.file);
+
+    context.file = nullptr;
+}
+
+void ColumnarLogger::write_block()
+{
+    if ( context.block->empty() )
+        return;
+
+    unsigned rows = context.block->size();
+    size_t n = context.block->write(context.file, level, col_stats);
+
+    if ( !n )
+        ErrorMessage("%s: block write failed, %u events dropped: %s\n",
+            S_NAME, rows, get_error(errno));
+
+    context.size += n;
+
+    if ( limit && context.size >= limit )
+    {
+        close_file();
+        open_file();
+    }
+}
+
+void ColumnarLogger::open()
+{
+    context.block = new ColumnarBlock(block_rows);
+    open_file();
+}
+
+void ColumnarLogger::close()
+{
+    if ( !context.block )
+        return;
+
+    write_block();
+    close_file();
+
+    delete context.block;
+    context.block = nullptr;
+}
+
+void ColumnarLogger::alert(Packet* p, const char*, Event* event)
+{
+    if ( !context.block->add(p, event) )
+    {
+        col_stats.dropped++;
+        return;
+    }
+    col_stats.rows++;
+
+    if ( context.block->full() )
+        write_block();
+}
+
+//-------------------------------------------------------------------------
+// api stuff
+//-------------------------------------------------------------------------
+
+static Module* mod_ctor()
+{ return new ColumnarModule; }
+
+static void mod_dtor(Module* m)
+{ delete m; }
+
+static Logger* col_ctor(SnortConfig*, Module* mod)
+{ return new ColumnarLogger((ColumnarModule*)mod); }
+
+static void col_dtor(Logger* p)
+{ delete p; }
+
+static LogApi col_api
+{
+    {
+        PT_LOGGER,
+        S_NAME,
+        s_help,
+        LOGAPI_PLUGIN_V0,
+        0,
+        mod_ctor,
+        mod_dtor
+    },
+    OUTPUT_TYPE_FLAG__ALERT,
+    col_ctor,
+    col_dtor
+};
+
+#ifdef BUILDING_SO
+SO_PUBLIC const BaseApi* snort_plugins[] =
+{
+    &col_api.base,
+    nullptr
+};
+#else
+const BaseApi* alert_columnar = &col_api.base;
+#endif
+
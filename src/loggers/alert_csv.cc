@@ -28,6 +28,7 @@
 #include <stdlib.h>
 
 #include <string>
+#include <vector>
 
 #include "framework/logger.h"
 #include "framework/module.h"
@@ -71,6 +72,30 @@ using namespace std;
 #define csv_deflt \
     "timestamp gid sid rev src_addr src_port dst_addr dst_port"
 
+// the field list is compiled once so alert() doesn't have to compare
+// each configured name against every known field for every event
+enum CsvField
+{
+    CSV_TIMESTAMP, CSV_GID, CSV_SID, CSV_REV, CSV_MSG, CSV_PROTO,
+    CSV_SRC_ADDR, CSV_DST_ADDR, CSV_SRC_PORT, CSV_DST_PORT,
+    CSV_ETH_SRC, CSV_ETH_DST, CSV_ETH_TYPE, CSV_ETH_LEN,
+    CSV_TTL, CSV_TOS, CSV_ID, CSV_IP_LEN, CSV_DGM_LEN,
+    CSV_ICMP_TYPE, CSV_ICMP_CODE, CSV_ICMP_ID, CSV_ICMP_SEQ,
+    CSV_TCP_FLAGS, CSV_TCP_SEQ, CSV_TCP_ACK, CSV_TCP_LEN, CSV_TCP_WIN,
+    CSV_UDP_LEN, CSV_MAX
+};
+
+static const char* csv_names[CSV_MAX] =
+{
+    "timestamp", "gid", "sid", "rev", "msg", "proto",
+    "src_addr", "dst_addr", "src_port", "dst_port",
+    "eth_src", "eth_dst", "eth_type", "eth_len",
+    "ttl", "tos", "id", "ip_len", "dgm_len",
+    "icmp_type", "icmp_code", "icmp_id", "icmp_seq",
+    "tcp_flags", "tcp_seq", "tcp_ack", "tcp_len", "tcp_win",
+    "udp_len"
+};
+
 static const Parameter s_params[] =
 {
     { "file", Parameter::PT_BOOL, nullptr, "false",
@@ -152,7 +177,6 @@ bool CsvModule::end(const char*, int, SnortConfig*)
 class CsvLogger : public Logger {
 public:
     CsvLogger(CsvModule*);
-    ~CsvLogger();
 
     void open() override;
     void close() override;
@@ -162,8 +186,7 @@ public:
 public:
     string file;
     unsigned long limit;
-    char** args;
-    int numargs;
+    vector<CsvField> fields;
 };
 
 
@@ -171,11 +194,21 @@ CsvLogger::CsvLogger(CsvModule* m)
 {
     file = m->file ? F_NAME : "stdout";
     limit = m->limit;
-    args = mSplit(m->csvargs.c_str(), " \n\t", 0, &numargs, 0);
-}
 
-CsvLogger::~CsvLogger()
-{
+    int numargs;
+    char** args = mSplit(m->csvargs.c_str(), " \n\t", 0, &numargs, 0);
+
+    for ( int i = 0; i < numargs; ++i )
+    {
+        for ( int f = 0; f < CSV_MAX; ++f )
+        {
+            if ( !strcasecmp(args[i], csv_names[f]) )
+            {
+                fields.push_back((CsvField)f);
+                break;
+            }
+        }
+    }
     mSplitFree(&args, numargs);
 }
 
@@ -192,8 +225,6 @@ void CsvLogger::close()
 
 void CsvLogger::alert(Packet *p, const char *msg, Event *event)
 {
-    int num;
-    char *type;
     char tcpFlags[9];
     const eth::EtherHdr *eh = nullptr;
 
@@ -202,36 +233,34 @@ void CsvLogger::alert(Packet *p, const char *msg, Event *event)
     if (p->proto_bits & PROTO_BIT__ETH)
         eh = layer::get_eth_layer(p);
 
-    // TBD an enum would be an improvement here
-    for (num = 0; num < numargs; num++)
+    for (unsigned num = 0; num < fields.size(); num++)
     {
-        type = args[num];
-
-        if (!strcasecmp("timestamp", type))
+        switch ( fields[num] )
         {
+        case CSV_TIMESTAMP:
             LogTimeStamp(csv_log, p);
-        }
-        else if (!strcasecmp("gid", type))
-        {
+            break;
+
+        case CSV_GID:
             if (event != NULL)
-                TextLog_Print(csv_log, "%lu",  (unsigned long) event->sig_info->generator);
-        }
-        else if (!strcasecmp("sid", type))
-        {
+                TextLog_PutUInt(csv_log, event->sig_info->generator);
+            break;
+
+        case CSV_SID:
             if (event != NULL)
-                TextLog_Print(csv_log, "%lu",  (unsigned long) event->sig_info->id);
-        }
-        else if (!strcasecmp("rev", type))
-        {
+                TextLog_PutUInt(csv_log, event->sig_info->id);
+            break;
+
+        case CSV_REV:
             if (event != NULL)
-                TextLog_Print(csv_log, "%lu",  (unsigned long) event->sig_info->rev);
-        }
-        else if (!strcasecmp("msg", type))
-        {
+                TextLog_PutUInt(csv_log, event->sig_info->rev);
+            break;
+
+        case CSV_MSG:
             TextLog_Quote(csv_log, msg);  /* Don't fatal */
-        }
-        else if (!strcasecmp("proto", type))
-        {
+            break;
+
+        case CSV_PROTO:
             // api returns zero if invalid
             switch (p->type())
             {
@@ -247,153 +276,158 @@ void CsvLogger::alert(Packet *p, const char *msg, Event *event)
                 default:
                     break;
             }
-        }
-        else if (!strcasecmp("eth_src", type))
-        {
+            break;
+
+        case CSV_ETH_SRC:
             if (eh)
             {
                 TextLog_Print(csv_log, "%02X:%02X:%02X:%02X:%02X:%02X", eh->ether_src[0],
                         eh->ether_src[1], eh->ether_src[2], eh->ether_src[3],
                         eh->ether_src[4], eh->ether_src[5]);
             }
-        }
-        else if (!strcasecmp("eth_dst", type))
-        {
+            break;
+
+        case CSV_ETH_DST:
             if (eh)
             {
                 TextLog_Print(csv_log, "%02X:%02X:%02X:%02X:%02X:%02X", eh->ether_dst[0],
                         eh->ether_dst[1], eh->ether_dst[2], eh->ether_dst[3],
                         eh->ether_dst[4], eh->ether_dst[5]);
             }
-        }
-        else if (!strcasecmp("eth_type", type))
-        {
+            break;
+
+        case CSV_ETH_TYPE:
             if (eh != NULL)
                 TextLog_Print(csv_log, "0x%X", ntohs(eh->ether_type));
-        }
-        else if (!strcasecmp("eth_len", type))
-        {
+            break;
+
+        case CSV_ETH_LEN:
             if (eh != NULL)
                 TextLog_Print(csv_log, "0x%X", p->pkth->pktlen);
-        }
-        else if (!strcasecmp("udp_len", type))
-        {
+            break;
+
+        case CSV_UDP_LEN:
             if (p->ptrs.udph != NULL)
-                TextLog_Print(csv_log, "%d", ntohs(p->ptrs.udph->uh_len));
-        }
-        else if (!strcasecmp("src_port", type))
-        {
+                TextLog_PutUInt(csv_log, ntohs(p->ptrs.udph->uh_len));
+            break;
+
+        case CSV_SRC_PORT:
             // api return 0 if invalid
             switch (p->type())
             {
                 case PktType::UDP:
                 case PktType::TCP:
-                    TextLog_Print(csv_log, "%d", p->ptrs.sp);
+                    TextLog_PutUInt(csv_log, p->ptrs.sp);
                     break;
                 default:
                     break;
             }
-        }
-        else if (!strcasecmp("dst_port", type))
-        {
+            break;
+
+        case CSV_DST_PORT:
             switch (p->type())
             {
                 case PktType::UDP:
                 case PktType::TCP:
-                    TextLog_Print(csv_log, "%d", p->ptrs.dp);
+                    TextLog_PutUInt(csv_log, p->ptrs.dp);
                     break;
                 default:
                     break;
             }
-        }
-        else if (!strcasecmp("src_addr", type))
-        {
+            break;
+
+        // csv has always logged unobfuscated addresses
+        case CSV_SRC_ADDR:
             if (p->has_ip())
-                TextLog_Puts(csv_log, inet_ntoa(p->ptrs.ip_api.get_src()));
-        }
-        else if (!strcasecmp("dst_addr", type))
-        {
+                LogIpAddress(csv_log, p->ptrs.ip_api.get_src(), false);
+            break;
+
+        case CSV_DST_ADDR:
             if (p->has_ip())
-                TextLog_Puts(csv_log, inet_ntoa(p->ptrs.ip_api.get_dst()));
-        }
-        else if (!strcasecmp("icmp_type", type))
-        {
+                LogIpAddress(csv_log, p->ptrs.ip_api.get_dst(), false);
+            break;
+
+        case CSV_ICMP_TYPE:
             if (p->ptrs.icmph != NULL)
-                TextLog_Print(csv_log, "%d", p->ptrs.icmph->type);
-        }
-        else if (!strcasecmp("icmp_code", type))
-        {
+                TextLog_PutUInt(csv_log, p->ptrs.icmph->type);
+            break;
+
+        case CSV_ICMP_CODE:
             if (p->ptrs.icmph != NULL)
-                TextLog_Print(csv_log, "%d", p->ptrs.icmph->code);
-        }
-        else if (!strcasecmp("icmp_id", type))
-        {
+                TextLog_PutUInt(csv_log, p->ptrs.icmph->code);
+            break;
+
+        case CSV_ICMP_ID:
             if (p->ptrs.icmph != NULL)
-                TextLog_Print(csv_log, "%d", ntohs(p->ptrs.icmph->s_icmp_id));
-        }
-        else if (!strcasecmp("icmp_seq", type))
-        {
+                TextLog_PutUInt(csv_log, ntohs(p->ptrs.icmph->s_icmp_id));
+            break;
+
+        case CSV_ICMP_SEQ:
             if (p->ptrs.icmph != NULL)
-                TextLog_Print(csv_log, "%d", ntohs(p->ptrs.icmph->s_icmp_seq));
-        }
-        else if (!strcasecmp("ttl", type))
-        {
+                TextLog_PutUInt(csv_log, ntohs(p->ptrs.icmph->s_icmp_seq));
+            break;
+
+        case CSV_TTL:
             if (p->has_ip())
-                TextLog_Print(csv_log, "%d",p->ptrs.ip_api.ttl());
-        }
-        else if (!strcasecmp("tos", type))
-        {
+                TextLog_PutUInt(csv_log, p->ptrs.ip_api.ttl());
+            break;
+
+        case CSV_TOS:
             if (p->has_ip())
-                TextLog_Print(csv_log, "%d", p->ptrs.ip_api.tos());
-        }
-        else if (!strcasecmp("id", type))
-        {
+                TextLog_PutUInt(csv_log, p->ptrs.ip_api.tos());
+            break;
+
+        case CSV_ID:
             if (p->has_ip())
-                TextLog_Print(csv_log, "%u", p->ptrs.ip_api.id());
-        }
-        else if (!strcasecmp("ip_len", type))
-        {
+                TextLog_PutUInt(csv_log, p->ptrs.ip_api.id());
+            break;
+
+        case CSV_IP_LEN:
             if (p->has_ip())
-                TextLog_Print(csv_log, "%d", p->ptrs.ip_api.pay_len());
-        }
-        else if (!strcasecmp("dgm_len", type))
-        {
+                TextLog_PutUInt(csv_log, p->ptrs.ip_api.pay_len());
+            break;
+
+        case CSV_DGM_LEN:
             if (p->has_ip())
             {
                 // XXX might cause a bug when IPv6 is printed?
-                TextLog_Print(csv_log, "%d", p->ptrs.ip_api.dgram_len());
+                TextLog_PutUInt(csv_log, p->ptrs.ip_api.dgram_len());
             }
-        }
-        else if (!strcasecmp("tcp_seq", type))
-        {
+            break;
+
+        case CSV_TCP_SEQ:
             if (p->ptrs.tcph != NULL)
                 TextLog_Print(csv_log, "0x%lX", (u_long)ntohl(p->ptrs.tcph->th_seq));
-        }
-        else if (!strcasecmp("tcp_ack", type))
-        {
+            break;
+
+        case CSV_TCP_ACK:
             if (p->ptrs.tcph != NULL)
                 TextLog_Print(csv_log, "0x%lX", (u_long)ntohl(p->ptrs.tcph->th_ack));
-        }
-        else if (!strcasecmp("tcp_len", type))
-        {
+            break;
+
+        case CSV_TCP_LEN:
             if (p->ptrs.tcph != NULL)
-                TextLog_Print(csv_log, "%d", (p->ptrs.tcph->off()));
-        }
-        else if (!strcasecmp("tcp_win", type))
-        {
+                TextLog_PutUInt(csv_log, p->ptrs.tcph->off());
+            break;
+
+        case CSV_TCP_WIN:
             if (p->ptrs.tcph != NULL)
                 TextLog_Print(csv_log, "0x%X", ntohs(p->ptrs.tcph->th_win));
-        }
-        else if (!strcasecmp("tcp_flags",type))
-        {
+            break;
+
+        case CSV_TCP_FLAGS:
             if (p->ptrs.tcph != NULL)
             {
                 CreateTCPFlagString(p->ptrs.tcph, tcpFlags);
-                TextLog_Print(csv_log, "%s", tcpFlags);
+                TextLog_Puts(csv_log, tcpFlags);
             }
+            break;
+
+        default:
+            break;
         }
 
-        if (num < numargs - 1)
+        if (num < fields.size() - 1)
             TextLog_Putc(csv_log, ',');
     }
 
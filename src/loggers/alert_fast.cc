@@ -43,6 +43,7 @@
 #include <sys/types.h>
 
 #include <string>
+#include <unordered_map>
 
 #include "framework/logger.h"
 #include "framework/module.h"
@@ -59,6 +60,7 @@
 #include "packet_io/sfdaq.h"
 #include "packet_io/intf.h"
 #include "events/event.h"
+#include "detection/signature.h"
 
 /* full buf was chosen to allow printing max size packets
  * in hex/ascii mode:
@@ -74,6 +76,20 @@ using namespace std;
 #define S_NAME "alert_fast"
 #define F_NAME S_NAME ".txt"
 
+// the text between the time stamp / action and the addresses depends only
+// on the rule so it is formatted the first time a rule fires on a thread
+// and then copied for subsequent events.
+struct FastRuleText
+{
+    const SigInfo* sig;
+    const char* msg;
+    string head;   // [gid:sid:rev] <intf> msg [**]
+    string prio;   // [Classification: x] [Priority: n]
+};
+
+typedef unordered_map<const SigInfo*, FastRuleText> FastRuleMap;
+static THREAD_LOCAL FastRuleMap* fast_rules = nullptr;
+
 //-------------------------------------------------------------------------
 // module stuff
 //-------------------------------------------------------------------------
@@ -181,12 +197,16 @@ void FastLogger::open()
 {
     unsigned sz = packet ? FULL_BUF : FAST_BUF;
     fast_log = TextLog_Init(file.c_str(), sz, limit);
+    fast_rules = new FastRuleMap;
 }
 
 void FastLogger::close()
 {
     if ( fast_log )
         TextLog_Term(fast_log);
+
+    delete fast_rules;
+    fast_rules = nullptr;
 }
 
 #ifdef REG_TEST
@@ -244,6 +264,72 @@ static const char* get_pkt_type(Packet* p)
 
 #endif
 
+static void format_head(string& s, const char* msg, const Event* event)
+{
+    char buf[64];
+
+    if ( event )
+    {
+        snprintf(buf, sizeof(buf), "[%lu:%lu:%lu] ",
+            (unsigned long) event->sig_info->generator,
+            (unsigned long) event->sig_info->id,
+            (unsigned long) event->sig_info->rev);
+        s += buf;
+    }
+
+    if ( ScAlertInterface() )
+    {
+        s += " <";
+        s += PRINT_INTERFACE(DAQ_GetInterfaceSpec());
+        s += "> ";
+    }
+
+    if ( msg )
+    {
+#ifdef REG_TEST
+        string tmp = msg + 1;
+        tmp.pop_back();
+        s += tmp;
+#else
+        s += msg;
+#endif
+    }
+    s += " [**] ";
+}
+
+static void format_prio(string& s, const Event* event)
+{
+    const SigInfo* si = event->sig_info;
+
+    if ( si->classType && si->classType->name )
+    {
+        s += "[Classification: ";
+        s += si->classType->name;
+        s += "] ";
+    }
+    s += "[Priority: ";
+    s += to_string(si->priority);
+    s += "] ";
+}
+
+static const FastRuleText* get_rule_text(const char* msg, const Event* event)
+{
+    FastRuleText& frt = (*fast_rules)[event->sig_info];
+
+    // the map is keyed on the rule so also check the message in case the
+    // SigInfo was freed and another allocated at the same address
+    if ( frt.sig != event->sig_info || frt.msg != msg || frt.head.empty() )
+    {
+        frt.sig = event->sig_info;
+        frt.msg = msg;
+        frt.head.clear();
+        frt.prio.clear();
+        format_head(frt.head, msg, event);
+        format_prio(frt.prio, event);
+    }
+    return &frt;
+}
+
 void FastLogger::alert(Packet *p, const char *msg, Event *event)
 {
     LogTimeStamp(fast_log, p);
@@ -268,37 +354,29 @@ void FastLogger::alert(Packet *p, const char *msg, Event *event)
 #else
         TextLog_Puts(fast_log, " [**] ");
 #endif
+    }
 
-        if(event != NULL)
-        {
-            TextLog_Print(fast_log, "[%lu:%lu:%lu] ",
-                    (unsigned long) event->sig_info->generator,
-                    (unsigned long) event->sig_info->id,
-                    (unsigned long) event->sig_info->rev);
-        }
-
-        if (ScAlertInterface())
-        {
-            TextLog_Print(fast_log, " <%s> ", PRINT_INTERFACE(DAQ_GetInterfaceSpec()));
-        }
-
-        if (msg != NULL)
-        {
-#ifdef REG_TEST
-            string tmp = msg + 1;
-            tmp.pop_back();
-            TextLog_Puts(fast_log, tmp.c_str());
-#else
-            TextLog_Puts(fast_log, msg);
-#endif
-        }
-        TextLog_Puts(fast_log, " [**] ");
+    const FastRuleText* frt = nullptr;
+
+    if ( event )
+    {
+        frt = get_rule_text(msg, event);
+        TextLog_Write(fast_log, frt->head.c_str(), frt->head.size());
+    }
+    else
+    {
+        string head;
+        format_head(head, msg, event);
+        TextLog_Write(fast_log, head.c_str(), head.size());
     }
 
     /* print the packet header to the alert file */
     if ( p->has_ip() )
     {
-        LogPriorityData(fast_log, event, 0);
+        if ( frt )
+            TextLog_Write(fast_log, frt->prio.c_str(), frt->prio.size());
+        else
+            LogPriorityData(fast_log, event, 0);
 #ifndef REG_TEST
         TextLog_Print(fast_log, "{%s} ", get_pkt_type(p));
 #else
@@ -35,7 +35,8 @@
 #include "time/profiler.h"
 #include "utils/stats.h"
 
-static THREAD_LOCAL ProfileStats luaLogPerfStats;
+static THREAD_LOCAL ProfileStats luaLogPerfStats[MAX_LUA_SCRIPTS];
+static unsigned num_scripts = 0;
 
 //-------------------------------------------------------------------------
 // ffi stuff
@@ -67,10 +68,20 @@ struct SnortPacket
     unsigned dp;
 };
 
+#define MAX_LUA_BATCH 64
+
+struct SnortEvents
+{
+    unsigned num;
+    SnortEvent event[MAX_LUA_BATCH];
+    SnortPacket packet[MAX_LUA_BATCH];
+};
+
 extern "C" {
 // ensure Lua can link with this
 const SnortEvent* get_event();
 const SnortPacket* get_packet();
+const SnortEvents* get_events();
 }
 
 static THREAD_LOCAL Event* event;
@@ -79,6 +90,8 @@ static THREAD_LOCAL SnortEvent lua_event;
 static THREAD_LOCAL Packet* packet;
 static THREAD_LOCAL SnortPacket lua_packet;
 
+static THREAD_LOCAL SnortEvents* lua_events;
+
 SO_PUBLIC const SnortEvent* get_event()
 {
     assert(event);
@@ -121,6 +134,12 @@ SO_PUBLIC const SnortPacket* get_packet()
     return &lua_packet;
 }
 
+SO_PUBLIC const SnortEvents* get_events()
+{
+    assert(lua_events);
+    return lua_events;
+}
+
 //-------------------------------------------------------------------------
 // module stuff
 //-------------------------------------------------------------------------
@@ -130,6 +149,9 @@ static const Parameter s_params[] =
     { "args", Parameter::PT_STRING, nullptr, nullptr,
       "luajit logger arguments" },
 
+    { "batch", Parameter::PT_INT, "1:64", "1",
+      "maximum number of events passed to alert_batch() at once if defined" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
@@ -140,25 +162,38 @@ class LuaLogModule : public Module
 {
 public:
     LuaLogModule(const char* name) : Module(name, s_help, s_params)
-    { };
+    {
+        slot = num_scripts < MAX_LUA_SCRIPTS ? num_scripts++ : MAX_LUA_SCRIPTS - 1;
+    };
 
     bool begin(const char*, int, SnortConfig*) override
     {
         args.clear();
+        batch = 1;
         return true;
     };
 
     bool set(const char*, Value& v, SnortConfig*) override
     {
-        args = v.get_string();
+        if ( v.is("args") )
+            args = v.get_string();
+
+        else if ( v.is("batch") )
+            batch = v.get_long();
+
+        else
+            return false;
+
         return true;
     };
 
     ProfileStats* get_profile() const override
-    { return &luaLogPerfStats; };
+    { return luaLogPerfStats + slot; };
 
 public:
     std::string args;
+    unsigned batch;
+    unsigned slot;
 };
 
 //-------------------------------------------------------------------------
@@ -172,12 +207,22 @@ public:
     ~LuaJitLogger();
 
     void alert(Packet*, const char*, Event*) override;
+    void flush() override;
 
     static const struct LogApi* get_api();
 
+private:
+    void call(lua_State*, int ref);
+    void flush_batch(unsigned id);
+
 private:
     std::string config;
     struct lua_State** lua;
+    int* alert_ref;
+    int* batch_ref;
+    SnortEvents* events;
+    unsigned batch;
+    unsigned slot;
 };
 
 LuaJitLogger::LuaJitLogger(const char* name, std::string& chunk, LuaLogModule* mod)
@@ -190,13 +235,41 @@ LuaJitLogger::LuaJitLogger(const char* name, std::string& chunk, LuaLogModule* m
     unsigned max = get_instance_max();
 
     lua = new lua_State*[max];
+    alert_ref = new int[max];
+    batch_ref = new int[max];
+    events = nullptr;
+    batch = mod->batch;
+    slot = mod->slot;
 
     // FIXIT-L might make more sense to have one instance
     // with one lua state in each thread instead of one
     // instance with one lua state per thread
     // (same for LuaJitOption)
     for ( unsigned i = 0; i < max; ++i )
+    {
         init_chunk(lua[i], chunk, name, config);
+
+        lua_getglobal(lua[i], "alert");
+        alert_ref[i] = luaL_ref(lua[i], LUA_REGISTRYINDEX);
+
+        lua_getglobal(lua[i], "alert_batch");
+
+        if ( batch > 1 && lua_isfunction(lua[i], -1) )
+            batch_ref[i] = luaL_ref(lua[i], LUA_REGISTRYINDEX);
+        else
+        {
+            lua_pop(lua[i], 1);
+            batch_ref[i] = LUA_NOREF;
+        }
+    }
+
+    if ( batch > 1 )
+    {
+        events = new SnortEvents[max];
+
+        for ( unsigned i = 0; i < max; ++i )
+            events[i].num = 0;
+    }
 }
 
 LuaJitLogger::~LuaJitLogger()
@@ -207,26 +280,78 @@ LuaJitLogger::~LuaJitLogger()
         term_chunk(lua[i]);
 
     delete[] lua;
+    delete[] alert_ref;
+    delete[] batch_ref;
+    delete[] events;
+}
+
+void LuaJitLogger::call(lua_State* L, int ref)
+{
+    lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
+
+    if ( lua_pcall(L, 0, 1, 0) )
+    {
+        const char* err = lua_tostring(L, -1);
+        ErrorMessage("%s\n", err);
+    }
+    lua_pop(L, 1);
+}
+
+void LuaJitLogger::flush_batch(unsigned id)
+{
+    if ( !events[id].num )
+        return;
+
+    lua_events = events + id;
+    call(lua[id], batch_ref[id]);
+
+    events[id].num = 0;
+    lua_events = nullptr;
+}
+
+// queued events are passed on when the batch is full, when an event for
+// another packet arrives, or at the end of the packet
+void LuaJitLogger::flush()
+{
+    unsigned id = get_instance_id();
+
+    if ( !events || batch_ref[id] == LUA_NOREF || !events[id].num )
+        return;
+
+    PROFILE_VARS;
+    MODULE_PROFILE_START(luaLogPerfStats[slot]);
+    flush_batch(id);
+    MODULE_PROFILE_END(luaLogPerfStats[slot]);
 }
 
 void LuaJitLogger::alert(Packet* p, const char*, Event* e)
 {
     PROFILE_VARS;
-    MODULE_PROFILE_START(luaLogPerfStats);
+    MODULE_PROFILE_START(luaLogPerfStats[slot]);
 
     packet = p;
     event = e;
 
-    lua_State* L = lua[get_instance_id()];
-    lua_getglobal(L, "alert");
+    unsigned id = get_instance_id();
 
-    if ( lua_pcall(L, 0, 1, 0) )
+    if ( !events || batch_ref[id] == LUA_NOREF )
+        call(lua[id], alert_ref[id]);
+
+    else
     {
-        const char* err = lua_tostring(L, -1);
-        ErrorMessage("%s\n", err);
-        MODULE_PROFILE_END(luaLogPerfStats);
+        SnortEvents& q = events[id];
+        uint64_t num = pc.total_from_daq;
+
+        if ( q.num && q.packet[q.num - 1].num != num )
+            flush_batch(id);
+
+        q.event[q.num] = *get_event();
+        q.packet[q.num] = *get_packet();
+
+        if ( ++q.num >= batch )
+            flush_batch(id);
     }
-    MODULE_PROFILE_END(luaLogPerfStats);
+    MODULE_PROFILE_END(luaLogPerfStats[slot]);
 }
 
 //-------------------------------------------------------------------------
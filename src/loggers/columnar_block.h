@@ -0,0 +1,298 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// columnar_block.h
+
+#ifndef COLUMNAR_BLOCK_H
+#define COLUMNAR_BLOCK_H
+
+// ColumnarBlock accumulates events for alert_columnar and writes them as
+// one block of compressed columns.  it is defined here rather than in the
+// plugin so that the unit tests can exercise it when the plugin is dynamic.
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "framework/counts.h"
+#include "protocols/packet.h"
+#include "protocols/icmp4.h"
+#include "events/event.h"
+#include "detection/signature.h"
+#include "packet_io/active.h"
+#include "utils/util.h"
+#include "columnar_common.h"
+
+struct ColumnarStats
+{
+    PegCount rows;
+    PegCount blocks;
+    PegCount raw_bytes;
+    PegCount bytes;
+    PegCount dropped;
+};
+
+class ColumnarBlock
+{
+public:
+    ColumnarBlock(unsigned rows);
+    ~ColumnarBlock();
+
+    // returns false if the block is full
+    bool add(Packet*, Event*);
+
+    bool full() const
+    { return rows == max_rows; }
+
+    bool empty() const
+    { return rows == 0; }
+
+    unsigned size() const
+    { return rows; }
+
+    // returns bytes written or 0 on error.  the block is emptied either
+    // way; on error the rows are counted as dropped and the file is cut
+    // back to where the block started so it remains readable.
+    size_t write(FILE*, int level, ColumnarStats&);
+
+private:
+    void reset();
+
+    uint8_t* cell(unsigned col)
+    { return data[col] + rows * columnar_width[col]; }
+
+    void put32(unsigned col, uint32_t v)
+    { v = htonl(v); memcpy(cell(col), &v, 4); }
+
+    void put16(unsigned col, uint16_t v)
+    { v = htons(v); memcpy(cell(col), &v, 2); }
+
+    void put8(unsigned col, uint8_t v)
+    { *cell(col) = v; }
+
+    void put_addr(unsigned col, const sfip_t*);
+
+private:
+    uint8_t* data[COL_MAX];
+    uint8_t* zbuf;
+    unsigned long zbuf_sz;
+
+    unsigned max_rows;
+    unsigned rows;
+    ColumnarBlockHeader hdr;
+};
+
+inline ColumnarBlock::ColumnarBlock(unsigned n)
+{
+    max_rows = n;
+    reset();
+
+    for ( unsigned i = 0; i < COL_MAX; ++i )
+        data[i] = (uint8_t*)SnortAlloc(max_rows * columnar_width[i]);
+
+    // the widest column bounds every compressed column
+    zbuf_sz = compressBound(max_rows * 16);
+    zbuf = (uint8_t*)SnortAlloc(zbuf_sz);
+}
+
+inline ColumnarBlock::~ColumnarBlock()
+{
+    for ( unsigned i = 0; i < COL_MAX; ++i )
+        free(data[i]);
+
+    free(zbuf);
+}
+
+inline void ColumnarBlock::reset()
+{
+    rows = 0;
+    memset(&hdr, 0, sizeof(hdr));
+}
+
+inline void ColumnarBlock::put_addr(unsigned col, const sfip_t* ip)
+{
+    uint8_t* p = cell(col);
+
+    if ( ip->is_ip6() )
+    {
+        memcpy(p, ip->ip8, 16);
+        return;
+    }
+    memset(p, 0, 10);
+    p[10] = p[11] = 0xff;
+    memcpy(p + 12, ip->ip8, 4);
+}
+
+inline bool ColumnarBlock::add(Packet* p, Event* event)
+{
+    if ( full() )
+        return false;
+
+    uint32_t sec = event ? event->ref_time.tv_sec : p->pkth->ts.tv_sec;
+    uint32_t sid = event ? event->sig_info->id : 0;
+
+    if ( !rows || sec < hdr.min_second )
+        hdr.min_second = sec;
+
+    if ( !rows || sec > hdr.max_second )
+        hdr.max_second = sec;
+
+    if ( !rows || sid < hdr.min_sid )
+        hdr.min_sid = sid;
+
+    if ( !rows || sid > hdr.max_sid )
+        hdr.max_sid = sid;
+
+    unsigned bit = columnar_bloom_bit(sid);
+    hdr.sid_bloom[bit >> 5] |= (1u << (bit & 31));
+
+    put32(COL_SECONDS, sec);
+    put32(COL_MICROSECONDS, event ? event->ref_time.tv_usec : p->pkth->ts.tv_usec);
+    put32(COL_EVENT_ID, event ? event->event_id : 0);
+    put32(COL_GID, event ? event->sig_info->generator : 0);
+    put32(COL_SID, sid);
+    put32(COL_REV, event ? event->sig_info->rev : 0);
+    put32(COL_CLASS, event ? event->sig_info->class_id : 0);
+    put32(COL_PRIORITY, event ? event->sig_info->priority : 0);
+
+    if ( p->has_ip() )
+    {
+        put_addr(COL_SRC_ADDR, p->ptrs.ip_api.get_src());
+        put_addr(COL_DST_ADDR, p->ptrs.ip_api.get_dst());
+        put8(COL_PROTO, p->get_ip_proto_next());
+    }
+    else
+    {
+        memset(cell(COL_SRC_ADDR), 0, 16);
+        memset(cell(COL_DST_ADDR), 0, 16);
+        put8(COL_PROTO, 0);
+    }
+
+    if ( p->type() == PktType::ICMP )
+    {
+        put16(COL_SRC_PORT, p->ptrs.icmph->type);
+        put16(COL_DST_PORT, p->ptrs.icmph->code);
+    }
+    else
+    {
+        put16(COL_SRC_PORT, p->ptrs.sp);
+        put16(COL_DST_PORT, p->ptrs.dp);
+    }
+
+    put32(COL_PKT_LEN, p->pkth->pktlen);
+
+    if ( Active_PacketWasDropped() )
+        put8(COL_ACTION, COL_ACTION_BLOCKED);
+
+    else if ( Active_PacketWouldBeDropped() )
+        put8(COL_ACTION, COL_ACTION_WOULD_DROP);
+
+    else
+        put8(COL_ACTION, COL_ACTION_NONE);
+
+    ++rows;
+    return true;
+}
+
+inline size_t ColumnarBlock::write(FILE* file, int level, ColumnarStats& stats)
+{
+    ColumnarColumnHeader cols[COL_MAX];
+    uint32_t length = 0;
+    uLong raw_bytes = 0;
+    long start = ftell(file);
+    long end = -1;
+
+    ColumnarBlockHeader out = hdr;
+    out.magic = htonl(COLUMNAR_BLOCK_MAGIC);
+    out.rows = htonl(rows);
+    out.min_second = htonl(hdr.min_second);
+    out.max_second = htonl(hdr.max_second);
+    out.min_sid = htonl(hdr.min_sid);
+    out.max_sid = htonl(hdr.max_sid);
+
+    for ( unsigned i = 0; i < COLUMNAR_BLOOM_WORDS; ++i )
+        out.sid_bloom[i] = htonl(hdr.sid_bloom[i]);
+
+    // the column headers need the compressed sizes so reserve space for
+    // the headers, write the data, and then go back and fill them in
+    if ( start < 0 || fseek(file, sizeof(out) + sizeof(cols), SEEK_CUR) )
+        goto fail;
+
+    for ( unsigned i = 0; i < COL_MAX; ++i )
+    {
+        uLongf zlen = zbuf_sz;
+        uLong raw = rows * columnar_width[i];
+
+        if ( compress2(zbuf, &zlen, data[i], raw, level) != Z_OK )
+            goto fail;
+
+        if ( fwrite(zbuf, zlen, 1, file) != 1 )
+            goto fail;
+
+        cols[i].id = htonl(i);
+        cols[i].raw_length = htonl(raw);
+        cols[i].length = htonl(zlen);
+
+        length += zlen;
+        raw_bytes += raw;
+    }
+    end = ftell(file);
+    out.length = htonl(length);
+
+    if ( end < 0 ||
+        fseek(file, start, SEEK_SET) ||
+        fwrite(&out, sizeof(out), 1, file) != 1 ||
+        fwrite(cols, sizeof(cols), 1, file) != 1 ||
+        fseek(file, end, SEEK_SET) ||
+        fflush(file) )
+        goto fail;
+
+    stats.blocks++;
+    stats.raw_bytes += raw_bytes;
+    stats.bytes += length;
+
+    reset();
+    return end - start;
+
+fail:
+    // a partial block would make the rest of the file unreadable so drop
+    // this block and cut the file back to where it started.  the file
+    // should be unbuffered so that nothing is left pending to be written
+    // past the cut.
+    stats.dropped += rows;
+    reset();
+
+    if ( start >= 0 )
+    {
+        int err = errno;
+        clearerr(file);
+        fseek(file, start, SEEK_SET);
+
+        if ( ftruncate(fileno(file), start) )
+            err = errno;
+
+        errno = err;
+    }
+    return 0;
+}
+
+#endif
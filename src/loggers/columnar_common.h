@@ -0,0 +1,104 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+#ifndef COLUMNAR_COMMON_H
+#define COLUMNAR_COMMON_H
+
+//-------------------------------------------------------------------------
+// alert_columnar file format, shared by the logger and the reader tool
+//
+// file:   ColumnarFileHeader followed by blocks
+// block:  ColumnarBlockHeader, COL_MAX ColumnarColumnHeaders, then the
+//         zlib compressed data of each column in column order
+// column: one fixed width value per row (see columnar_width)
+//
+// all integers, including column values, are in network order.  the
+// block header carries the time and sid ranges of its rows plus a small
+// sid bloom filter so readers can skip whole blocks without inflating.
+//-------------------------------------------------------------------------
+
+#include <stdint.h>
+
+#define COLUMNAR_MAGIC        0x534e4331  // "SNC1"
+#define COLUMNAR_BLOCK_MAGIC  0x424c4b31  // "BLK1"
+#define COLUMNAR_VERSION      1
+
+#define COLUMNAR_BLOOM_WORDS  8           // 256 bit sid filter
+
+enum ColumnarColumn
+{
+    COL_SECONDS,
+    COL_MICROSECONDS,
+    COL_EVENT_ID,
+    COL_GID,
+    COL_SID,
+    COL_REV,
+    COL_CLASS,
+    COL_PRIORITY,
+    COL_SRC_ADDR,       // IPv4 is stored as ::ffff:a.b.c.d
+    COL_DST_ADDR,
+    COL_SRC_PORT,       // or icmp type
+    COL_DST_PORT,       // or icmp code
+    COL_PROTO,
+    COL_PKT_LEN,
+    COL_ACTION,         // see ColumnarAction
+    COL_MAX
+};
+
+enum ColumnarAction
+{
+    COL_ACTION_NONE = 0,
+    COL_ACTION_BLOCKED = 1,
+    COL_ACTION_WOULD_DROP = 2
+};
+
+static const unsigned columnar_width[COL_MAX] =
+{ 4, 4, 4, 4, 4, 4, 4, 4, 16, 16, 2, 2, 1, 4, 1 };
+
+struct ColumnarFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t columns;
+};
+
+struct ColumnarBlockHeader
+{
+    uint32_t magic;
+    uint32_t rows;
+    uint32_t min_second;
+    uint32_t max_second;
+    uint32_t min_sid;
+    uint32_t max_sid;
+    uint32_t sid_bloom[COLUMNAR_BLOOM_WORDS];
+    uint32_t length;    // total compressed bytes following the column headers
+};
+
+struct ColumnarColumnHeader
+{
+    uint32_t id;
+    uint32_t raw_length;
+    uint32_t length;
+};
+
+// host order in, bit number out
+static inline unsigned columnar_bloom_bit(uint32_t sid)
+{ return (sid * 2654435761u) >> 24; }
+
+#endif
+
@@ -33,6 +33,7 @@ extern const BaseApi* alert_sf_socket;
 #endif
 
 #ifdef STATIC_LOGGERS
+extern const BaseApi* alert_columnar;
 extern const BaseApi* alert_csv;
 extern const BaseApi* alert_fast;
 extern const BaseApi* alert_full;
@@ -52,6 +53,7 @@ const BaseApi* loggers[] =
 
 #ifdef STATIC_LOGGERS
     // alerters
+    alert_columnar,
     alert_csv,
     alert_fast,
     alert_full,
@@ -39,6 +39,8 @@
 #include <netinet/in.h>
 
 #include <string>
+#include <thread>
+#include <chrono>
 
 #include "framework/logger.h"
 #include "framework/module.h"
@@ -64,6 +66,8 @@
 #include "protocols/layer.h"
 #include "protocols/vlan.h"
 #include "protocols/icmp4.h"
+#include "utils/byte_ring.h"
+#include "utils/stats.h"
 
 using namespace std;
 
@@ -77,6 +81,9 @@ typedef struct _Unified2Config
     int nostamp;
     int mpls_event_types;
     int vlan_event_types;
+    bool async;
+    unsigned async_buffer;
+    unsigned flush_interval;
 } Unified2Config;
 
 typedef struct _Unified2LogCallbackData
@@ -88,6 +95,8 @@ typedef struct _Unified2LogCallbackData
 
 } Unified2LogCallbackData;
 
+class U2Writer;
+
 struct U2
 {
     int base_proto;
@@ -95,11 +104,28 @@ struct U2
     char filepath[STD_BUF];
     FILE* stream;
     unsigned int current;
+    U2Writer* writer;
+};
+
+struct U2Stats
+{
+    PegCount async_records;
+    PegCount async_bytes;
+    PegCount async_stalls;
+};
+
+static const PegInfo u2_pegs[] =
+{
+    { "async records", "records queued for the writer thread" },
+    { "async bytes", "bytes queued for the writer thread" },
+    { "async stalls", "times a packet thread waited for room in the ring" },
+    { nullptr, nullptr }
 };
 
 /* -------------------- Global Variables ----------------------*/
 
 static THREAD_LOCAL U2 u2;
+static THREAD_LOCAL U2Stats u2_stats;
 
 /* Used for buffering header and payload of unified records so only one
  * write is necessary. */
@@ -222,6 +248,134 @@ static inline void Unified2RotateFile(Unified2Config *config)
     Unified2InitFile(config);
 }
 
+/* In async mode the writer thread owns the file, including rotation */
+static inline void Unified2CheckLimit(Unified2Config *config, uint32_t len)
+{
+    if ( config->limit && !u2.writer && (u2.current + len) > config->limit )
+        Unified2RotateFile(config);
+}
+
+//-------------------------------------------------------------------------
+// async writer
+//
+// In async mode each packet thread serializes records exactly as before
+// but Unified2Write() copies them into a lock free ring instead of the
+// file.  A dedicated writer thread opens the file and drains the ring,
+// batching all pending records into a single write and flush.  When the
+// ring is empty the writer sleeps for flush_interval ms, which bounds
+// the delay before an event reaches the file.  If the ring is full the
+// packet thread waits for room rather than dropping the event.
+//
+// The writer thread has its own (thread local) u2 so the existing file
+// handling, rotation, and error recovery code is used unchanged.
+//-------------------------------------------------------------------------
+
+/* batches are limited to a few maximum size records */
+constexpr unsigned u2_batch_sz = 4 * u2_buf_sz;
+
+class U2Writer
+{
+public:
+    U2Writer(Unified2Config*);
+    ~U2Writer();
+
+    void put(const uint8_t*, uint32_t);
+
+private:
+    void run(SnortConfig*, std::string filepath);
+    unsigned drain();
+
+private:
+    Unified2Config* config;
+    ByteRing ring;
+    uint8_t* batch;
+    std::atomic<bool> done;
+    std::thread* writer;
+};
+
+U2Writer::U2Writer(Unified2Config* c) : config(c), ring(c->async_buffer), done(false)
+{
+    batch = new uint8_t[u2_batch_sz];
+    writer = new std::thread(&U2Writer::run, this, snort_conf, std::string(u2.filepath));
+}
+
+U2Writer::~U2Writer()
+{
+    done = true;
+    writer->join();
+    delete writer;
+    delete[] batch;
+}
+
+void U2Writer::put(const uint8_t* buf, uint32_t len)
+{
+    if ( !ring.put(buf, len) )
+    {
+        u2_stats.async_stalls++;
+
+        while ( !ring.put(buf, len) )
+            std::this_thread::yield();
+    }
+    u2_stats.async_records++;
+    u2_stats.async_bytes += len;
+}
+
+unsigned U2Writer::drain()
+{
+    unsigned records = 0;
+    uint32_t used = 0;
+    uint32_t len;
+
+    while ( (len = ring.peek()) )
+    {
+        if ( config->limit && (u2.current + used + len) > config->limit )
+        {
+            if ( used )
+                Unified2Write(batch, used, config);
+
+            used = 0;
+            Unified2RotateFile(config);
+        }
+        else if ( used + len > u2_batch_sz )
+        {
+            Unified2Write(batch, used, config);
+            used = 0;
+        }
+        ring.get(batch + used, len);
+        used += len;
+        records++;
+    }
+
+    if ( used )
+        Unified2Write(batch, used, config);
+
+    return records;
+}
+
+void U2Writer::run(SnortConfig* sc, std::string filepath)
+{
+    snort_conf = sc;
+    SnortSnprintf(u2.filepath, sizeof(u2.filepath), "%s", filepath.c_str());
+    u2.writer = nullptr;
+    Unified2InitFile(config);
+
+    while ( true )
+    {
+        if ( drain() )
+            continue;
+
+        if ( done )
+            break;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(config->flush_interval));
+    }
+    // the producer is gone once done is set so this catches the stragglers
+    drain();
+
+    if ( u2.stream )
+        fclose(u2.stream);
+}
+
 static void _AlertIP4_v2(Packet *p, const char*, Unified2Config *config, Event *event)
 {
     Serial_Unified2_Header hdr;
@@ -303,8 +457,7 @@ static void _AlertIP4_v2(Packet *p, const char*, Unified2Config *config, Event *
         }
     }
 
-    if ( config->limit && (u2.current + write_len) > config->limit )
-        Unified2RotateFile(config);
+    Unified2CheckLimit(config, write_len);
 
     hdr.length = htonl(sizeof(Unified2IDSEvent));
     hdr.type = htonl(UNIFIED2_IDS_EVENT_VLAN);
@@ -413,8 +566,7 @@ static void _AlertIP6_v2(Packet *p, const char*, Unified2Config *config, Event *
         }
     }
 
-    if ( config->limit && (u2.current + write_len) > config->limit )
-        Unified2RotateFile(config);
+    Unified2CheckLimit(config, write_len);
 
     hdr.length = htonl(sizeof(Unified2IDSEventIPv6));
     hdr.type = htonl(UNIFIED2_IDS_EVENT_IPV6_VLAN);
@@ -474,8 +626,7 @@ void _WriteExtraData(Unified2Config *config,
     alertHdr.event_length = htonl(write_len - sizeof(Serial_Unified2_Header));
 
 
-    if ( config->limit && (u2.current + write_len) > config->limit )
-        Unified2RotateFile(config);
+    Unified2CheckLimit(config, write_len);
 
     hdr.length = htonl(write_len - sizeof(Serial_Unified2_Header));
     hdr.type = htonl(UNIFIED2_EXTRA_DATA);
@@ -615,8 +766,7 @@ static void _Unified2LogPacketAlert(
         logheader.packet_length = 0;
     }
 
-    if ( config->limit && (u2.current + write_len) > config->limit )
-        Unified2RotateFile(config);
+    Unified2CheckLimit(config, write_len);
 
     hdr.length = htonl(sizeof(Serial_Unified2Packet) - 4 + pkt_length);
     hdr.type = htonl(UNIFIED2_PACKET);
@@ -670,9 +820,7 @@ static int Unified2LogStreamCallback(DAQ_PktHdr_t *pkth,
 
     write_len += pkth->caplen;
 
-    if ( unifiedData->config->limit &&
-        (u2.current + write_len) > unifiedData->config->limit )
-        Unified2RotateFile(unifiedData->config);
+    Unified2CheckLimit(unifiedData->config, write_len);
 
     hdr.type = htonl(UNIFIED2_PACKET);
     hdr.length = htonl(sizeof(Serial_Unified2Packet) - 4 + pkth->caplen);
@@ -742,9 +890,7 @@ static ObRet Unified2LogObfuscationCallback(const DAQ_PktHdr_t *pkth,
             return OB_RET_ERROR;
         }
 
-        if ( unifiedData->config->limit &&
-            (u2.current + record_len) > unifiedData->config->limit )
-            Unified2RotateFile(unifiedData->config);
+        Unified2CheckLimit(unifiedData->config, record_len);
 
         hdr.type = htonl(UNIFIED2_PACKET);
         hdr.length = htonl((sizeof(Serial_Unified2Packet) - 4) + pkth->caplen);
@@ -894,6 +1040,12 @@ static void Unified2Write(uint8_t *buf, uint32_t buf_len, Unified2Config *config
     size_t fwcount = 0;
     int ffstatus = 0;
 
+    if ( u2.writer )
+    {
+        u2.writer->put(buf, buf_len);
+        return;
+    }
+
     /* Nothing to write or nothing to write to */
     if ((buf == NULL) || (config == NULL) || (u2.stream == NULL))
         return;
@@ -1062,6 +1214,15 @@ static const Parameter s_params[] =
     { "vlan_event_types", Parameter::PT_BOOL, nullptr, "false",
       "include vlan IDs in events" },
 
+    { "async", Parameter::PT_BOOL, nullptr, "false",
+      "write to file from a dedicated thread instead of the packet thread" },
+
+    { "async_buffer", Parameter::PT_INT, "128:", "1024",
+      "size of each packet thread's async event ring in kilobytes" },
+
+    { "flush_interval", Parameter::PT_INT, "1:", "100",
+      "maximum milliseconds an idle async writer waits before writing" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
@@ -1077,12 +1238,21 @@ public:
     bool begin(const char*, int, SnortConfig*) override;
     bool end(const char*, int, SnortConfig*) override;
 
+    const PegInfo* get_pegs() const override
+    { return u2_pegs; }
+
+    PegCount* get_counts() const override
+    { return (PegCount*)&u2_stats; }
+
 public:
     unsigned limit;
     unsigned units;
     bool nostamp;
     bool mpls;
     bool vlan;
+    bool async;
+    unsigned async_buffer;
+    unsigned flush_interval;
 };
 
 bool U2Module::set(const char*, Value& v, SnortConfig*)
@@ -1102,6 +1272,15 @@ bool U2Module::set(const char*, Value& v, SnortConfig*)
     else if ( v.is("vlan_event_types") )
         vlan = v.get_bool();
 
+    else if ( v.is("async") )
+        async = v.get_bool();
+
+    else if ( v.is("async_buffer") )
+        async_buffer = v.get_long();
+
+    else if ( v.is("flush_interval") )
+        flush_interval = v.get_long();
+
     else
         return false;
 
@@ -1114,6 +1293,9 @@ bool U2Module::begin(const char*, int, SnortConfig*)
     units = 0;
     nostamp = ScNoOutputTimestamp();
     mpls = vlan = false;
+    async = false;
+    async_buffer = 1024;
+    flush_interval = 100;
     return true;
 }
 
@@ -1150,6 +1332,9 @@ U2Logger::U2Logger(U2Module* m)
     config.nostamp = m->nostamp;
     config.mpls_event_types = m->mpls;
     config.vlan_event_types = m->vlan;
+    config.async = m->async;
+    config.async_buffer = m->async_buffer * 1024;
+    config.flush_interval = m->flush_interval;
 }
 
 U2Logger::~U2Logger()
@@ -1172,13 +1357,21 @@ void U2Logger::open()
     }
     u2.base_proto = htonl(DAQ_GetBaseProtocol());
 
-    Unified2InitFile(&config);
+    if ( config.async )
+        u2.writer = new U2Writer(&config);
+    else
+        Unified2InitFile(&config);
 
     stream.reg_xtra_data_log(AlertExtraData, &config);
 }
 
 void U2Logger::close()
 {
+    if ( u2.writer )
+    {
+        delete u2.writer;
+        u2.writer = nullptr;
+    }
     if ( u2.stream )
         fclose(u2.stream);
 }
@@ -60,12 +60,17 @@ using namespace std;
 #include "target_based/sftarget_reader.h"
 #include "flow/flow_control.h"
 #include "helpers/swapper.h"
+#include "time/latency.h"
 #include "time/periodic.h"
 
 #ifdef UNIT_TEST
 #include "test/unit_test.h"
 #endif
 
+#ifdef BENCHMARK
+#include "test/bench.h"
+#endif
+
 //#include "framework/so_rule.h"
 
 //-------------------------------------------------------------------------
@@ -284,6 +289,18 @@ int main_dump_stats(lua_State*)
     return 0;
 }
 
+int main_dump_latency(lua_State*)
+{
+    string s;
+    latency_format(s, true);
+
+    if ( s.empty() )
+        s = "== latency histograms are not enabled\n";
+
+    request.respond(s.c_str());
+    return 0;
+}
+
 int main_rotate_stats(lua_State*)
 {
     request.respond("== rotating stats\n");
@@ -683,6 +700,11 @@ static bool set_mode()
         }
     }
 
+#ifdef BENCHMARK
+    if ( bench_enabled() )
+        exit(bench());
+#endif
+
     if ( ScTestMode() or (!Trough_GetQCount() and !use_shell(snort_conf)) )
     {
         LogMessage("\nSnort successfully validated the configuration.\n");
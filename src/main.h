@@ -25,6 +25,7 @@ struct lua_State;
 const char* get_prompt();
 
 int main_dump_stats(lua_State* = nullptr);
+int main_dump_latency(lua_State* = nullptr);
 int main_rotate_stats(lua_State* = nullptr);
 int main_reload_config(lua_State* = nullptr);
 int main_reload_hosts(lua_State* = nullptr);
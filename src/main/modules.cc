@@ -47,7 +47,9 @@ using namespace std;
 #include "filters/sfrf.h"
 #include "filters/rate_filter.h"
 #include "codecs/codec_module.h"
+#include "time/latency.h"
 #include "time/ppm_module.h"
+#include "time/shed_module.h"
 #include "parser/parse_ip.h"
 #include "target_based/sftarget_data.h"
 #include "detection/fpcreate.h"
@@ -220,6 +222,9 @@ static const Parameter search_engine_params[] =
     { "no_stream_inserts", Parameter::PT_BOOL, nullptr, "false",
       "don't inspect reassembled payload - good for performance, bad for detection" },
 
+    { "parallel_port_tables", Parameter::PT_BOOL, nullptr, "false",
+      "compile the port tables of each protocol on a separate thread" },
+
     { "search_method", Parameter::PT_STRING, nullptr, "ac_bnfa_q",
       "set fast pattern algorithm - choose available search engine" },
 
@@ -296,6 +301,12 @@ bool SearchEngineModule::set(const char*, Value& v, SnortConfig* sc)
     else if ( v.is("no_stream_inserts") )
         fpSetStreamInsert(fp);
 
+    else if ( v.is("parallel_port_tables") )
+    {
+        if ( v.get_bool() )
+            fpDetectSetParallelPortTables(fp);
+    }
+
     else if ( v.is("search_method") )
     {
         if ( fpSetDetectSearchMethod(fp, v.get_string()) )
@@ -328,6 +339,9 @@ static const Parameter profile_rule_params[] =
       "avg_ticks_per_match | avg_ticks_per_no_match",
       "avg_ticks", "sort by given field" },
 
+    { "sample", Parameter::PT_INT, "1:", "1",
+      "time every Nth packet and scale results by N" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
@@ -340,6 +354,9 @@ static const Parameter profile_module_params[] =
       "checks | avg_ticks | total_ticks", "avg_ticks",
       "sort by given field" },
 
+    { "sample", Parameter::PT_INT, "1:", "1",
+      "time every Nth packet and scale results by N" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
@@ -351,6 +368,12 @@ static const Parameter profile_params[] =
     { "modules", Parameter::PT_TABLE, profile_module_params, nullptr,
       "" },
 
+    { "json", Parameter::PT_BOOL, nullptr, "false",
+      "write rule, option, and module ticks to profile.json at shutdown" },
+
+    { "stacks", Parameter::PT_BOOL, nullptr, "false",
+      "write collapsed stacks for flame graph tools to profile.stacks at shutdown" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
@@ -382,6 +405,17 @@ bool ProfileModule::set(const char* fqn, Value& v, SnortConfig* sc)
     const char* spr = "profile.rules";
     const char* spp = "profile.modules";
 
+    if ( v.is("json") )
+    {
+        sc->profile_json = v.get_bool();
+        return true;
+    }
+    else if ( v.is("stacks") )
+    {
+        sc->profile_stacks = v.get_bool();
+        return true;
+    }
+
     if ( !strncmp(fqn, spr, strlen(spr)) )
         p = &sc->profile_rules;
 
@@ -397,6 +431,9 @@ bool ProfileModule::set(const char* fqn, Value& v, SnortConfig* sc)
     else if ( v.is("sort") )
         p->sort = v.get_long() + 1;
 
+    else if ( v.is("sample") )
+        p->sample = v.get_long();
+
     else
         return false;
 
@@ -404,6 +441,48 @@ bool ProfileModule::set(const char* fqn, Value& v, SnortConfig* sc)
 }
 #endif
 
+//-------------------------------------------------------------------------
+// latency module
+//-------------------------------------------------------------------------
+
+static const Parameter latency_params[] =
+{
+    { "histograms", Parameter::PT_BOOL, nullptr, "false",
+      "record packet, detection, and inspector latency distributions" },
+
+    { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
+};
+
+#define latency_help \
+    "configure per thread latency histograms (see dump_latency)"
+
+class LatencyModule : public Module
+{
+public:
+    LatencyModule() : Module("latency", latency_help, latency_params) { };
+    bool set(const char*, Value&, SnortConfig*) override;
+    bool end(const char*, int, SnortConfig*) override;
+};
+
+bool LatencyModule::set(const char*, Value& v, SnortConfig* sc)
+{
+    if ( v.is("histograms") )
+        sc->latency_histograms = v.get_bool();
+
+    else
+        return false;
+
+    return true;
+}
+
+bool LatencyModule::end(const char*, int, SnortConfig* sc)
+{
+    if ( sc->latency_histograms )
+        latency_init();
+
+    return true;
+}
+
 //-------------------------------------------------------------------------
 // classification module
 //-------------------------------------------------------------------------
@@ -550,10 +629,10 @@ static const Parameter alerts_params[] =
       "enable or disable ips rules" },
 
     { "detection_filter_memcap", Parameter::PT_INT, "0:", "1048576",
-      "set available memory for filters" },
+      "set available memory for filters per packet thread" },
 
     { "event_filter_memcap", Parameter::PT_INT, "0:", "1048576",
-      "set available memory for filters" },
+      "set available memory for filters per packet thread" },
 
     { "flowbits_size", Parameter::PT_INT, "0:2048", "1024",
       "maximum number of allowed unique flowbits" },
@@ -562,7 +641,7 @@ static const Parameter alerts_params[] =
       "change the order of rule action application" },
 
     { "rate_filter_memcap", Parameter::PT_INT, "0:", "1048576",
-      "set available memory for filters" },
+      "set available memory for filters per packet thread" },
 
     { "reference_net", Parameter::PT_STRING, nullptr, nullptr,
       "set the CIDR for homenet "
@@ -1480,7 +1559,7 @@ static const Parameter event_filter_params[] =
       "number of events in interval before tripping; -1 to disable" },
 
     { "seconds", Parameter::PT_INT, "0:", "0",
-      "count interval" },
+      "count interval; aligned to multiples of seconds with multiple packet threads" },
 
     { "ip", Parameter::PT_STRING, nullptr, nullptr,
       "restrict filter to these addresses according to track" },
@@ -1570,7 +1649,7 @@ static const Parameter rate_filter_params[] =
       "number of events in interval before tripping" },
 
     { "seconds", Parameter::PT_INT, "0:", "1",
-      "count interval" },
+      "count interval; aligned to multiples of seconds with multiple packet threads" },
 
     { "new_action", Parameter::PT_SELECT,
       // FIXIT-L this list should be defined globally
@@ -1905,6 +1984,7 @@ void module_init()
 #ifdef PERF_PROFILING
     ModuleManager::add_module(new ProfileModule);
 #endif
+    ModuleManager::add_module(new LatencyModule);
     ModuleManager::add_module(new ReferencesModule);
     ModuleManager::add_module(new RuleStateModule);
     ModuleManager::add_module(new SearchEngineModule);
@@ -1923,6 +2003,7 @@ void module_init()
 #ifdef PPM_MGR
     ModuleManager::add_module(new PpmModule);
 #endif
+    ModuleManager::add_module(new ShedModule);
 
     // these modules should be in ips policy
     ModuleManager::add_module(new EventFilterModule);
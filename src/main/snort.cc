@@ -97,6 +97,8 @@ using namespace std;
 #include "managers/action_manager.h"
 #include "detection/sfrim.h"
 #include "ppm.h"
+#include "time/latency.h"
+#include "time/shed.h"
 #include "profiler.h"
 #include "utils/strvec.h"
 #include "packet_io/intf.h"
@@ -498,6 +500,7 @@ static void SnortCleanup()
 #ifdef PERF_PROFILING
     CleanupProfileStatsNodeList();
 #endif
+    latency_term();
 
     /* free allocated memory */
     if (snort_conf == snort_cmd_line_conf)
@@ -746,8 +749,15 @@ DAQ_Verdict packet_callback(
     int inject = 0;
     DAQ_Verdict verdict = DAQ_VERDICT_PASS;
     PROFILE_VARS;
+    LATENCY_VARS;
+    SHED_VARS;
 
+#ifdef PERF_PROFILING
+    SampleProfiles();
+#endif
     MODULE_PROFILE_START(totalPerfStats);
+    LATENCY_START();
+    SHED_START();
 
     pc.total_from_daq++;
 
@@ -776,6 +786,9 @@ DAQ_Verdict packet_callback(
 
     ActionManager::execute(s_packet);
 
+    // pass on any events queued by batching loggers
+    EventManager::flush_outputs();
+
     if ( Active_PacketWasDropped() )
     {
         if ( verdict == DAQ_VERDICT_PASS )
@@ -846,6 +859,8 @@ DAQ_Verdict packet_callback(
     else if ( break_time() )
         DAQ_BreakLoop(0);
 
+    SHED_END();
+    LATENCY_END(packet);
     MODULE_PROFILE_END(totalPerfStats);
     return verdict;
 }
@@ -905,6 +920,12 @@ void snort_thread_init(const char* intf)
 
     otnx_match_data_init(snort_conf->num_rule_types);
 
+    if ( snort_conf->latency_histograms )
+        latency_tinit();
+
+    shed_tinit(&snort_conf->shed_config);
+
+    OpenLogger();
     EventManager::open_outputs();
     IpsManager::setup_options();
     ActionManager::thread_init(snort_conf);
@@ -925,6 +946,7 @@ void snort_thread_term()
 
     IpsManager::clear_options();
     EventManager::close_outputs();
+    CloseLogger();
     CodecManager::thread_term();
 
     if ( s_packet )
@@ -944,6 +966,8 @@ void snort_thread_term()
 
     otnx_match_data_term();
     detection_filter_term();
+    RateFilter_Term();
+    sfthreshold_term();
     EventTrace_Term();
     CleanupTag();
 
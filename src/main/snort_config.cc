@@ -255,6 +255,7 @@ void SnortConfSetup(SnortConfig *sc)
     ModuleManager::load_commands(sc);
 
     fpCreateFastPacketDetection(sc);
+    compile_file_config(sc->file_config);
     pcre_setup(sc);
 #ifdef PPM_MGR
     //PPM_PRINT_CFG(&sc->ppm_cfg);
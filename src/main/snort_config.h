@@ -30,6 +30,7 @@
 #include "detection/rules.h"
 #include "sfip/sfip_t.h"
 #include "time/ppm.h"
+#include "time/shed.h"
 #include "main/policy.h"
 #include "utils/util.h"
 #include "protocols/packet.h"
@@ -133,8 +134,18 @@ struct SnortConfig
 #ifdef PERF_PROFILING
     ProfileConfig profile_rules;
     ProfileConfig profile_preprocs;
+    bool profile_json;
+    bool profile_stacks;
 #endif
 
+    //------------------------------------------------------
+    // latency module stuff
+    bool latency_histograms;
+
+    //------------------------------------------------------
+    // load_shed module stuff
+    ShedConfig shed_config;
+
     //------------------------------------------------------
     // process stuff
     int user_id;
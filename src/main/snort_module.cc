@@ -49,6 +49,10 @@ using namespace std;
 #include "test/unit_test.h"
 #endif
 
+#ifdef BENCHMARK
+#include "test/bench.h"
+#endif
+
 //-------------------------------------------------------------------------
 // commands
 //-------------------------------------------------------------------------
@@ -58,6 +62,7 @@ static const Command snort_cmds[] =
 {
     { "show_plugins", main_dump_plugins, "show available plugins" },
     { "dump_stats", main_dump_stats, "show summary statistics" },
+    { "dump_latency", main_dump_latency, "show merged latency histograms" },
     { "rotate_stats", main_rotate_stats, "roll perfmonitor log files" },
     { "reload_config", main_reload_config, "load new configuration" },
 
@@ -236,6 +241,11 @@ static const Parameter s_params[] =
       "process alert, drop, sdrop, or reject before pass; "
        "default is pass before alert, drop,..." },
 
+#ifdef BENCHMARK
+    { "--bench", Parameter::PT_STRING, nullptr, nullptr,
+      "<list> benchmark the given components with the -r pcaps and exit; "
+      "components are mpse, decode, log, stream, inspect, or all" },
+#endif
     { "--bpf", Parameter::PT_STRING, nullptr, nullptr,
       "<filter options> are standard BPF options, as seen in TCPDump" },
 
@@ -612,6 +622,10 @@ bool SnortModule::set(const char*, Value& v, SnortConfig* sc)
     else if ( v.is("--alert-before-pass") )
         ConfigAlertBeforePass(sc, v.get_string());
 
+#ifdef BENCHMARK
+    else if ( v.is("--bench") )
+        bench_mode(v.get_string());
+#endif
     else if ( v.is("--bpf") )
         sc->bpf_filter = SnortStrdup(v.get_string());
 
@@ -32,6 +32,7 @@
 #include "obfuscation.h"
 #include "packet_io/active.h"
 #include "ppm.h"
+#include "time/latency.h"
 #include "snort.h"
 #include "log/messages.h"
 #include "target_based/sftarget_protocol_reference.h"
@@ -72,9 +73,11 @@ struct PHClass
     const InspectApi& api;
     bool* init;  // call pin->tinit()
     bool* term;  // call pin->tterm()
+    unsigned latency_id;
 
     PHClass(const InspectApi& p) : api(p)
     { 
+        latency_id = latency_register(p.base.name);
         init = new bool[get_instance_max()];
         term = new bool[get_instance_max()];
         for ( unsigned i = 0; i < get_instance_max(); ++i )
@@ -114,6 +117,7 @@ PHInstance::PHInstance(PHClass& p) : pp_class(p)
     if ( handler )
     {
         handler->set_api(&p.api);
+        handler->set_latency_id(p.latency_id);
         handler->add_ref();
     }
 }
@@ -642,6 +646,8 @@ void InspectorManager::print_config(SnortConfig *sc)
 static inline void execute(
     Packet* p, PHInstance** prep, unsigned num)
 {
+    LATENCY_VARS;
+
     for ( unsigned i = 0; i < num; ++i, ++prep )
     {
         if ( p->packet_flags & PKT_PASS_RULE )
@@ -656,7 +662,11 @@ static inline void execute(
             break;
 
         if ( ((unsigned)p->type() & ppc.api.proto_bits) )
+        {
+            LATENCY_START();
             (*prep)->handler->eval(p);
+            LATENCY_END(inspector[ppc.latency_id]);
+        }
     }
 }
 
@@ -692,7 +702,12 @@ void InspectorManager::full_inspection(FrameworkPolicy* fp, Packet* p)
 
     // FIXIT-M need list of gadgets for ambiguous wizardry
     else if ( flow->gadget && PacketHasPAFPayload(p) )
+    {
+        LATENCY_VARS;
+        LATENCY_START();
         flow->gadget->eval(p);
+        LATENCY_END(inspector[flow->gadget->get_latency_id()]);
+    }
 }
 
 void InspectorManager::execute (Packet* p)
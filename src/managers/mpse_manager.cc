@@ -84,6 +84,16 @@ const MpseApi* MpseManager::get_search_api(const char* name)
     return api;
 }
 
+// returns the name of the idx-th registered engine or nullptr
+const char* MpseManager::get_search_name(unsigned idx)
+{
+    for ( auto* p : s_engines )
+        if ( !idx-- )
+            return p->base.name;
+
+    return nullptr;
+}
+
 Mpse* MpseManager::get_search_engine(
     SnortConfig* sc,
     const MpseApi* api,
@@ -42,6 +42,7 @@ public:
 
     static void instantiate(const MpseApi*, Module*, SnortConfig*);
     static const MpseApi* get_search_api(const char* type);
+    static const char* get_search_name(unsigned idx);
     static void delete_search_engine(Mpse*);
 
     static Mpse* get_search_engine(const char*);
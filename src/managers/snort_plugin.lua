@@ -28,6 +28,13 @@ struct SnortBuffer
 };
 const struct SnortBuffer* get_buffer();
 
+struct SnortBuffers
+{
+    unsigned num;
+    struct SnortBuffer buf[16];
+};
+const struct SnortBuffers* get_buffers();
+
 struct SnortEvent
 {
     unsigned gid;
@@ -51,5 +58,13 @@ struct SnortPacket
     unsigned dp;
 };
 const struct SnortPacket* get_packet();
+
+struct SnortEvents
+{
+    unsigned num;
+    struct SnortEvent event[64];
+    struct SnortPacket packet[64];
+};
+const struct SnortEvents* get_events();
 ]]
 
@@ -0,0 +1,94 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// bind_index.cc
+
+#include "bind_index.h"
+
+#include <algorithm>
+#include <map>
+using namespace std;
+
+#include "flow/flow.h"
+
+template<size_t N>
+void BindIndex::compile(
+    const vector<Binding*>& bindings, bitset<N> BindWhen::* list,
+    vector<uint16_t>& classes, vector<uint64_t>& masks)
+{
+    map<vector<uint64_t>, uint16_t> sigs;
+    vector<uint64_t> sig(words);
+
+    classes.resize(N);
+    masks.clear();
+
+    for ( unsigned v = 0; v < N; ++v )
+    {
+        fill(sig.begin(), sig.end(), 0);
+
+        for ( unsigned i = 0; i < bindings.size(); ++i )
+        {
+            if ( (bindings[i]->when.*list).test(v) )
+                sig[i / 64] |= (uint64_t)1 << (i % 64);
+        }
+        auto it = sigs.find(sig);
+
+        if ( it == sigs.end() )
+        {
+            it = sigs.insert(make_pair(sig, (uint16_t)sigs.size())).first;
+            masks.insert(masks.end(), sig.begin(), sig.end());
+        }
+        classes[v] = it->second;
+    }
+}
+
+void BindIndex::compile(const vector<Binding*>& bindings)
+{
+    words = (bindings.size() + 63) / 64;
+
+    // a flow has one PktType; check_proto() tests it against the
+    // binding's protos so every value gets its own mask
+    proto_masks.assign(256 * words, 0);
+
+    for ( unsigned p = 0; p < 256; ++p )
+    {
+        for ( unsigned i = 0; i < bindings.size(); ++i )
+        {
+            if ( bindings[i]->when.protos & p )
+                proto_masks[p * words + i / 64] |= (uint64_t)1 << (i % 64);
+        }
+    }
+    compile(bindings, &BindWhen::ports, port_classes, port_masks);
+    compile(bindings, &BindWhen::vlans, vlan_classes, vlan_masks);
+    compile(bindings, &BindWhen::ifaces, iface_classes, iface_masks);
+}
+
+uint64_t BindIndex::get_candidates(const Flow* flow, unsigned w) const
+{
+    unsigned in = Binding::get_iface(flow->iface_in);
+    unsigned out = Binding::get_iface(flow->iface_out);
+    unsigned vlan = Binding::get_vlan(flow->key->vlan_tag);
+
+    uint64_t m = get_mask(proto_masks, (uint8_t)flow->protocol)[w];
+    m &= get_mask(port_masks, port_classes[flow->server_port])[w];
+    m &= get_mask(vlan_masks, vlan_classes[vlan])[w];
+
+    m &= get_mask(iface_masks, iface_classes[in])[w] |
+        get_mask(iface_masks, iface_classes[out])[w];
+
+    return m;
+}
@@ -0,0 +1,73 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// bind_index.h
+
+#ifndef BIND_INDEX_H
+#define BIND_INDEX_H
+
+// the bindings are compiled into masks of the bindings that can match
+// each protocol, server port, vlan and interface.  the port, vlan, and
+// interface values are mapped to classes of values that select the same
+// bindings to keep the masks small.  a flow's candidates are the
+// intersection of its masks; only these are checked for policy, nets,
+// and service, in configuration order.
+
+#include <stdint.h>
+#include <bitset>
+#include <vector>
+
+#include "binding.h"
+
+class BindIndex
+{
+public:
+    void compile(const std::vector<Binding*>&);
+
+    unsigned get_words() const
+    { return words; };
+
+    // candidates for bindings [64*w, 64*w + 63]; these are exactly the
+    // bindings that pass check_proto, check_port, check_vlan, and
+    // check_iface for the flow
+    uint64_t get_candidates(const Flow*, unsigned w) const;
+
+private:
+    template<size_t N>
+    void compile(
+        const std::vector<Binding*>&, std::bitset<N> BindWhen::*,
+        std::vector<uint16_t>& classes, std::vector<uint64_t>& masks);
+
+    const uint64_t* get_mask(const std::vector<uint64_t>& masks, unsigned c) const
+    { return &masks[c * words]; };
+
+private:
+    unsigned words = 0;
+
+    std::vector<uint64_t> proto_masks;
+
+    std::vector<uint16_t> port_classes;
+    std::vector<uint64_t> port_masks;
+
+    std::vector<uint16_t> vlan_classes;
+    std::vector<uint64_t> vlan_masks;
+
+    std::vector<uint16_t> iface_classes;
+    std::vector<uint64_t> iface_masks;
+};
+
+#endif
@@ -21,6 +21,7 @@
 using namespace std;
 
 #include "binding.h"
+#include "bind_index.h"
 #include "bind_module.h"
 #include "flow/flow.h"
 #include "flow/session.h"
@@ -117,14 +118,10 @@ bool Binding::check_proto(const Flow* flow) const
 
 bool Binding::check_iface(const Flow* flow) const
 {
-    int i = flow->iface_in < 0 ? 0 : flow->iface_in;
-
-    if ( when.ifaces.test(i) )
+    if ( when.ifaces.test(get_iface(flow->iface_in)) )
         return true;
 
-    i = flow->iface_out < 0 ? 0 : flow->iface_out;
-
-    if ( when.ifaces.test(i) )
+    if ( when.ifaces.test(get_iface(flow->iface_out)) )
         return true;
 
     return false;
@@ -132,7 +129,7 @@ bool Binding::check_iface(const Flow* flow) const
 
 bool Binding::check_vlan(const Flow* flow) const
 {
-    unsigned v = flow->key->vlan_tag;
+    unsigned v = get_vlan(flow->key->vlan_tag);
     return when.vlans.test(v);
 }
 
@@ -381,6 +378,7 @@ private:
 
 private:
     vector<Binding*> bindings;
+    BindIndex index;
 };
 
 Binder::Binder(vector<Binding*>& v)
@@ -406,6 +404,7 @@ bool Binder::configure(SnortConfig* sc)
         if ( !pb->use.index )
             set_binding(sc, pb);
     }
+    index.compile(bindings);
     return true;
 }
 
@@ -486,37 +485,41 @@ void Binder::set_binding(SnortConfig* sc, Binding* pb)
         ParseError("can't bind %s", key);
 }
 
-// FIXIT-P this is a simple linear search until functionality is nailed
-// down.  performance should be the focus of the next iteration.
+// the index yields the bindings that match the flow's protocol, port,
+// vlan, and interfaces in configuration order; the rest is checked here
 void Binder::get_bindings(Flow* flow, Stuff& stuff)
 {
-    Binding* pb;
-    unsigned i, sz = bindings.size();
-
-    for ( i = 0; i < sz; i++ )
+    for ( unsigned w = 0; w < index.get_words(); ++w )
     {
-        pb = bindings[i];
-
-        if ( !pb->check_all(flow) )
-            continue;
+        uint64_t m = index.get_candidates(flow, w);
 
-        if ( !pb->use.index )
+        while ( m )
         {
-            if ( stuff.update(pb) )
-                return;
-            else
+            Binding* pb = bindings[w * 64 + __builtin_ctzll(m)];
+            m &= m - 1;
+
+            if ( !pb->check_policy(flow) || !pb->check_addr(flow) ||
+                !pb->check_service(flow) )
                 continue;
-        }
 
-        set_policies(snort_conf, pb->use.index - 1);
-        flow->policy_id = pb->use.index - 1;
+            if ( !pb->use.index )
+            {
+                if ( stuff.update(pb) )
+                    return;
+                else
+                    continue;
+            }
 
-        Binder* sub = (Binder*)InspectorManager::get_binder();
+            set_policies(snort_conf, pb->use.index - 1);
+            flow->policy_id = pb->use.index - 1;
 
-        if ( sub )
-        {
-            sub->get_bindings(flow, stuff);
-            return;
+            Binder* sub = (Binder*)InspectorManager::get_binder();
+
+            if ( sub )
+            {
+                sub->get_bindings(flow, stuff);
+                return;
+            }
         }
     }
 }
@@ -534,7 +537,7 @@ void Binder::apply(Flow* flow, Stuff& stuff)
     if ( !stuff.apply_action(flow) )
         return;
 
-    const HostAttributeEntry* host = SFAT_LookupHostEntryByIP(&flow->server_ip);
+    const HostAttributeEntry* host = SFAT_LookupHostEntryByFlow(flow, true);
 
     // setup session
     stuff.apply_session(flow, host);
@@ -20,6 +20,7 @@
 #ifndef BINDER_H
 #define BINDER_H
 
+#include <stdint.h>
 #include <string>
 
 #include "framework/bits.h"
@@ -92,6 +93,14 @@ struct Binding
     bool check_port(const Flow*) const;
     bool check_policy(const Flow*) const;
     bool check_service(const Flow*) const;
+
+    // vlan ids are 12 bits and ifaces are configured as 0-255; the checks
+    // and the index must reduce flow values the same way
+    static unsigned get_vlan(uint16_t tag)
+    { return tag & 0xFFF; }
+
+    static unsigned get_iface(int32_t i)
+    { return i < 0 ? 0 : i & 0xFF; }
 };
 
 #endif
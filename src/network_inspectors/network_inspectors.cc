@@ -38,6 +38,7 @@ extern const BaseApi* ips_stream_size;
 
 #ifdef STATIC_INSPECTORS
 extern const BaseApi* nin_arp_spoof;
+extern const BaseApi* nin_reputation;
 #endif
 
 const BaseApi* network_inspectors[] =
@@ -57,6 +58,7 @@ const BaseApi* network_inspectors[] =
 
 #ifdef STATIC_INSPECTORS
     nin_arp_spoof,
+    nin_reputation,
 #endif
     nullptr
 };
@@ -25,6 +25,7 @@
 */
 
 #include "perf.h"
+#include "perf_export.h"
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -45,6 +46,7 @@
 #include "snort_types.h"
 #include "protocols/packet.h"
 #include "snort.h"
+#include "time/latency.h"
 
 THREAD_LOCAL SFBASE sfBase;
 THREAD_LOCAL SFFLOW sfFlow;
@@ -71,6 +73,7 @@ void sfInitPerformanceStatistics(SFPERF *sfPerf)
     sfPerf->max_file_size = MAX_PERF_FILE_SIZE;
     sfPerf->flowip_memcap = 50*1024*1024;
     sfPerf->base_reset = 1;
+    sfPerf->export_interval = 1;
 }
 
 static void WriteTimeStamp(FILE *fh, const char *action)
@@ -501,6 +504,7 @@ void sfPerformanceStats(SFPERF *sfPerf, Packet *p)
                     InitEventStats(&sfEvent);
                 }
 
+                ResetPerfExport();
                 SetSampleTime(sfPerf, p);
             }
         }
@@ -616,6 +620,9 @@ static inline void sfProcessBaseStats(SFPERF *sfPerf)
             sfPerf->perf_flags & SFPERF_CONSOLE,
             sfPerf->perf_flags & SFPERF_MAX_BASE_STATS);
 
+    if (sfPerf->perf_flags & SFPERF_CONSOLE)
+        latency_show_thread();
+
     if ((sfPerf->fh != NULL)
             && sfCheckFileSize(sfPerf->fh, sfPerf->max_file_size))
     {
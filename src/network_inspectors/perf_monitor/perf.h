@@ -74,6 +74,8 @@ typedef struct _SFPERF
     char *flowip_file;
     FILE *flowip_fh;
     uint32_t flowip_memcap;
+    char *export_file;
+    uint32_t export_interval;
 } SFPERF;
 
 
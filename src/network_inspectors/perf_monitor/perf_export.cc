@@ -0,0 +1,223 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// perf_export.cc
+
+#include "perf_export.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "perf_export_common.h"
+#include "perf_module.h"
+#include "log/messages.h"
+#include "main/thread.h"
+#include "packet_io/sfdaq.h"
+#include "utils/util.h"
+
+static_assert(PE_TCP_BLOCK - PE_IP4_TRIM + 1 == PERF_COUNT_MAX,
+    "export counters must include all perf_monitor pegs");
+
+static THREAD_LOCAL int export_fd = -1;
+static THREAD_LOCAL struct sockaddr_un export_addr;
+
+static THREAD_LOCAL time_t export_time = 0;  // of next snapshot
+static THREAD_LOCAL uint32_t export_seq = 0;
+static THREAD_LOCAL uint32_t export_epoch = 0;
+
+void InitPerfExport(SFPERF* sfPerf)
+{
+    export_time = 0;
+    export_seq = export_epoch = 0;
+
+    if ( !sfPerf->export_file )
+        return;
+
+    export_fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+
+    if ( export_fd < 0 )
+    {
+        ErrorMessage("perfmonitor: Cannot create export socket: %s\n",
+            get_error(errno));
+        return;
+    }
+
+    if ( fcntl(export_fd, F_SETFL, O_NONBLOCK) < 0 )
+    {
+        ErrorMessage("perfmonitor: Cannot set export socket nonblocking: %s\n",
+            get_error(errno));
+        ClosePerfExport();
+        return;
+    }
+
+    // length was checked when configured
+    memset(&export_addr, 0, sizeof(export_addr));
+    export_addr.sun_family = AF_UNIX;
+    strncpy(export_addr.sun_path, sfPerf->export_file, sizeof(export_addr.sun_path) - 1);
+}
+
+void ClosePerfExport()
+{
+    if ( export_fd >= 0 )
+        close(export_fd);
+
+    export_fd = -1;
+}
+
+// called when perf_monitor clears its counters at the end of an interval
+void ResetPerfExport()
+{
+    ++export_epoch;
+}
+
+static void GetCounts(uint64_t* c)
+{
+    c[PE_WIRE_PKTS] = sfBase.total_wire_packets;
+    c[PE_IPFRAG_PKTS] = sfBase.total_ipfragmented_packets;
+    c[PE_IPREASS_PKTS] = sfBase.total_ipreassembled_packets;
+    c[PE_PKTS] = sfBase.total_packets;
+    c[PE_REBUILT_PKTS] = sfBase.total_rebuilt_packets;
+    c[PE_BLOCKED_PKTS] = sfBase.total_blocked_packets;
+    c[PE_INJECTED_PKTS] = sfBase.total_injected_packets;
+    c[PE_WIRE_BYTES] = sfBase.total_wire_bytes;
+    c[PE_IPFRAG_BYTES] = sfBase.total_ipfragmented_bytes;
+    c[PE_IPREASS_BYTES] = sfBase.total_ipreassembled_bytes;
+    c[PE_BYTES] = sfBase.total_bytes;
+    c[PE_REBUILT_BYTES] = sfBase.total_rebuilt_bytes;
+    c[PE_BLOCKED_BYTES] = sfBase.total_blocked_bytes;
+    c[PE_MPLS_PKTS] = sfBase.total_mpls_packets;
+    c[PE_MPLS_BYTES] = sfBase.total_mpls_bytes;
+    c[PE_BLOCKED_MPLS_PKTS] = sfBase.total_blocked_mpls_packets;
+    c[PE_BLOCKED_MPLS_BYTES] = sfBase.total_blocked_mpls_bytes;
+    c[PE_TCP_FILTERED_PKTS] = sfBase.total_tcp_filtered_packets;
+    c[PE_UDP_FILTERED_PKTS] = sfBase.total_udp_filtered_packets;
+
+    c[PE_ALERTS] = sfBase.iAlerts;
+    c[PE_TOTAL_ALERTS] = sfBase.total_iAlerts;
+    c[PE_SYNS] = sfBase.iSyns;
+    c[PE_SYN_ACKS] = sfBase.iSynAcks;
+
+    c[PE_TCP_SESSIONS] = sfBase.iTotalSessions;
+    c[PE_NEW_TCP_SESSIONS] = sfBase.iNewSessions;
+    c[PE_DELETED_TCP_SESSIONS] = sfBase.iDeletedSessions;
+    c[PE_MAX_TCP_SESSIONS] = sfBase.iMaxSessions;
+    c[PE_MAX_TCP_SESSIONS_INTERVAL] = sfBase.iMaxSessionsInterval;
+    c[PE_MIDSTREAM_TCP_SESSIONS] = sfBase.iMidStreamSessions;
+    c[PE_CLOSED_TCP_SESSIONS] = sfBase.iClosedSessions;
+    c[PE_PRUNED_TCP_SESSIONS] = sfBase.iPrunedSessions;
+    c[PE_DROPPED_ASYNC_TCP_SESSIONS] = sfBase.iDroppedAsyncSessions;
+    c[PE_INITIALIZING_TCP_SESSIONS] = sfBase.iSessionsInitializing;
+    c[PE_ESTABLISHED_TCP_SESSIONS] = sfBase.iSessionsEstablished;
+    c[PE_CLOSING_TCP_SESSIONS] = sfBase.iSessionsClosing;
+    c[PE_UDP_SESSIONS] = sfBase.iTotalUDPSessions;
+    c[PE_NEW_UDP_SESSIONS] = sfBase.iNewUDPSessions;
+    c[PE_DELETED_UDP_SESSIONS] = sfBase.iDeletedUDPSessions;
+    c[PE_MAX_UDP_SESSIONS] = sfBase.iMaxUDPSessions;
+
+    c[PE_STREAM_FLUSHES] = sfBase.iStreamFlushes;
+    c[PE_STREAM_FAULTS] = sfBase.iStreamFaults;
+    c[PE_STREAM_TIMEOUTS] = sfBase.iStreamTimeouts;
+    c[PE_STREAM_MEMORY] = sfBase.stream_mem_in_use;
+
+    c[PE_FRAG_CREATES] = sfBase.iFragCreates;
+    c[PE_FRAG_COMPLETES] = sfBase.iFragCompletes;
+    c[PE_FRAG_INSERTS] = sfBase.iFragInserts;
+    c[PE_FRAG_DELETES] = sfBase.iFragDeletes;
+    c[PE_FRAG_AUTO_FREES] = sfBase.iFragAutoFrees;
+    c[PE_FRAG_FLUSHES] = sfBase.iFragFlushes;
+    c[PE_FRAG_TIMEOUTS] = sfBase.iFragTimeouts;
+    c[PE_FRAG_FAULTS] = sfBase.iFragFaults;
+    c[PE_MAX_FRAGS] = sfBase.iMaxFrags;
+    c[PE_CURRENT_FRAGS] = sfBase.iCurrentFrags;
+    c[PE_FRAG_MEMORY] = sfBase.frag_mem_in_use;
+
+    c[PE_ATTRIBUTE_HOSTS] = sfBase.iAttributeHosts;
+    c[PE_ATTRIBUTE_RELOADS] = sfBase.iAttributeReloads;
+
+    for ( unsigned i = 0; i < PERF_COUNT_MAX; ++i )
+        c[PE_IP4_TRIM + i] = sfBase.iPegs[i];
+
+    c[PE_QUALIFIED_EVENTS] = sfEvent.QEvents;
+    c[PE_NONQUALIFIED_EVENTS] = sfEvent.NQEvents;
+    c[PE_TOTAL_EVENTS] = sfEvent.TotalEvents;
+
+    c[PE_FLOW_PKTS] = sfFlow.pktTotal;
+    c[PE_FLOW_BYTES] = sfFlow.byteTotal;
+    c[PE_FLOW_TCP_HIGH_PORT_PKTS] = sfFlow.portTcpHigh;
+    c[PE_FLOW_TCP_PKTS] = sfFlow.portTcpTotal;
+    c[PE_FLOW_UDP_HIGH_PORT_PKTS] = sfFlow.portUdpHigh;
+    c[PE_FLOW_UDP_PKTS] = sfFlow.portUdpTotal;
+    c[PE_FLOW_ICMP_PKTS] = sfFlow.typeIcmpTotal;
+
+    const DAQ_Stats_t* ps = DAQ_GetStats();
+    c[PE_DAQ_HW_RECEIVED] = ps->hw_packets_received;
+    c[PE_DAQ_HW_DROPPED] = ps->hw_packets_dropped;
+    c[PE_DAQ_RECEIVED] = ps->packets_received;
+    c[PE_DAQ_FILTERED] = ps->packets_filtered;
+    c[PE_DAQ_INJECTED] = ps->packets_injected;
+
+    c[PE_PERF_PKTS] = pmstats.total_packets;
+}
+
+static void SendPerfExport(const struct timeval& tv)
+{
+    uint64_t buf[PERF_EXPORT_MAX_SIZE / sizeof(uint64_t)];
+    PerfExportHeader* h = (PerfExportHeader*)buf;
+
+    h->magic = PERF_EXPORT_MAGIC;
+    h->version = PERF_EXPORT_VERSION;
+    h->thread = get_instance_id();
+    h->seq = export_seq++;
+    h->epoch = export_epoch;
+    h->sec = tv.tv_sec;
+    h->usec = tv.tv_usec;
+    h->count = PE_MAX;
+    h->reserved = 0;
+
+    GetCounts((uint64_t*)(h + 1));
+
+    if ( sendto(export_fd, buf, sizeof(buf), 0,
+        (struct sockaddr*)&export_addr, sizeof(export_addr)) < 0 )
+        ++pmstats.export_drops;
+    else
+        ++pmstats.exports;
+}
+
+// packet time drives the interval so pcaps export at the same points
+// every run; a step back of more than one interval restarts it
+void UpdatePerfExport(SFPERF* sfPerf, Packet* p)
+{
+    if ( export_fd < 0 || !p->pkth )
+        return;
+
+    time_t now = p->pkth->ts.tv_sec;
+
+    if ( now < export_time && export_time - now <= sfPerf->export_interval )
+        return;
+
+    export_time = now + sfPerf->export_interval;
+    SendPerfExport(p->pkth->ts);
+}
+
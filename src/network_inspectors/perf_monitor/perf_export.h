@@ -0,0 +1,35 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// perf_export.h
+
+#ifndef PERF_EXPORT_H
+#define PERF_EXPORT_H
+
+// per packet thread snapshots of the raw perf_monitor counters sent to a
+// local unix socket; see perf_export_common.h for the format.  sends never
+// block; snapshots are dropped if the reader isn't keeping up or absent.
+
+#include "perf.h"
+
+void InitPerfExport(SFPERF*);
+void UpdatePerfExport(SFPERF*, Packet*);
+void ResetPerfExport();
+void ClosePerfExport();
+
+#endif
+
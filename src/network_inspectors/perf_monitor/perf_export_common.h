@@ -0,0 +1,286 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// perf_export_common.h
+
+#ifndef PERF_EXPORT_COMMON_H
+#define PERF_EXPORT_COMMON_H
+
+//-------------------------------------------------------------------------
+// perf_monitor export format, shared by perf_monitor and the reader tool
+//
+// each packet thread sends one datagram per export interval to a local
+// unix socket bound by the reader.  a datagram is a PerfExportHeader
+// followed by count uint64_t counters in PerfExportCounter order.
+//
+// everything is in host order since the socket is local.  counters are
+// raw; rates, percentages, and totals across threads are left to the
+// reader.  perf_monitor clears most base, flow, and event counters at
+// the end of each of its own reporting intervals and bumps the epoch when
+// it does so.  daq counters are never cleared.
+//-------------------------------------------------------------------------
+
+#include <stdint.h>
+
+#define PERF_EXPORT_MAGIC    0x534e5031  // "SNP1"
+#define PERF_EXPORT_VERSION  1
+
+struct PerfExportHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t thread;    // packet thread instance id
+    uint32_t seq;       // snapshots sent by this thread
+    uint32_t epoch;     // perf_monitor intervals completed by this thread
+    uint64_t sec;       // packet time of the snapshot
+    uint64_t usec;
+    uint32_t count;     // counters following
+    uint32_t reserved;
+};
+
+enum PerfExportCounter
+{
+    PE_WIRE_PKTS,
+    PE_IPFRAG_PKTS,
+    PE_IPREASS_PKTS,
+    PE_PKTS,
+    PE_REBUILT_PKTS,
+    PE_BLOCKED_PKTS,
+    PE_INJECTED_PKTS,
+    PE_WIRE_BYTES,
+    PE_IPFRAG_BYTES,
+    PE_IPREASS_BYTES,
+    PE_BYTES,
+    PE_REBUILT_BYTES,
+    PE_BLOCKED_BYTES,
+    PE_MPLS_PKTS,
+    PE_MPLS_BYTES,
+    PE_BLOCKED_MPLS_PKTS,
+    PE_BLOCKED_MPLS_BYTES,
+    PE_TCP_FILTERED_PKTS,
+    PE_UDP_FILTERED_PKTS,
+
+    PE_ALERTS,
+    PE_TOTAL_ALERTS,
+    PE_SYNS,
+    PE_SYN_ACKS,
+
+    PE_TCP_SESSIONS,
+    PE_NEW_TCP_SESSIONS,
+    PE_DELETED_TCP_SESSIONS,
+    PE_MAX_TCP_SESSIONS,
+    PE_MAX_TCP_SESSIONS_INTERVAL,
+    PE_MIDSTREAM_TCP_SESSIONS,
+    PE_CLOSED_TCP_SESSIONS,
+    PE_PRUNED_TCP_SESSIONS,
+    PE_DROPPED_ASYNC_TCP_SESSIONS,
+    PE_INITIALIZING_TCP_SESSIONS,
+    PE_ESTABLISHED_TCP_SESSIONS,
+    PE_CLOSING_TCP_SESSIONS,
+    PE_UDP_SESSIONS,
+    PE_NEW_UDP_SESSIONS,
+    PE_DELETED_UDP_SESSIONS,
+    PE_MAX_UDP_SESSIONS,
+
+    PE_STREAM_FLUSHES,
+    PE_STREAM_FAULTS,
+    PE_STREAM_TIMEOUTS,
+    PE_STREAM_MEMORY,
+
+    PE_FRAG_CREATES,
+    PE_FRAG_COMPLETES,
+    PE_FRAG_INSERTS,
+    PE_FRAG_DELETES,
+    PE_FRAG_AUTO_FREES,
+    PE_FRAG_FLUSHES,
+    PE_FRAG_TIMEOUTS,
+    PE_FRAG_FAULTS,
+    PE_MAX_FRAGS,
+    PE_CURRENT_FRAGS,
+    PE_FRAG_MEMORY,
+
+    PE_ATTRIBUTE_HOSTS,
+    PE_ATTRIBUTE_RELOADS,
+
+    // normalizer pegs in PerfCounts order
+    PE_IP4_TRIM,
+    PE_IP4_TOS,
+    PE_IP4_DF,
+    PE_IP4_RF,
+    PE_IP4_TTL,
+    PE_IP4_OPTS,
+    PE_ICMP4_ECHO,
+    PE_IP6_TTL,
+    PE_IP6_OPTS,
+    PE_ICMP6_ECHO,
+    PE_TCP_SYN_OPT,
+    PE_TCP_OPT,
+    PE_TCP_PAD,
+    PE_TCP_RSV,
+    PE_TCP_NS,
+    PE_TCP_URG,
+    PE_TCP_URP,
+    PE_TCP_TRIM,
+    PE_TCP_ECN_PKT,
+    PE_TCP_ECN_SSN,
+    PE_TCP_TS_ECR,
+    PE_TCP_TS_NOP,
+    PE_TCP_IPS_DATA,
+    PE_TCP_BLOCK,
+
+    PE_QUALIFIED_EVENTS,
+    PE_NONQUALIFIED_EVENTS,
+    PE_TOTAL_EVENTS,
+
+    PE_FLOW_PKTS,
+    PE_FLOW_BYTES,
+    PE_FLOW_TCP_HIGH_PORT_PKTS,
+    PE_FLOW_TCP_PKTS,
+    PE_FLOW_UDP_HIGH_PORT_PKTS,
+    PE_FLOW_UDP_PKTS,
+    PE_FLOW_ICMP_PKTS,
+
+    PE_DAQ_HW_RECEIVED,
+    PE_DAQ_HW_DROPPED,
+    PE_DAQ_RECEIVED,
+    PE_DAQ_FILTERED,
+    PE_DAQ_INJECTED,
+
+    PE_PERF_PKTS,
+    PE_MAX
+};
+
+static const char* const perf_export_names[] =
+{
+    "wire_packets",
+    "ipfrag_packets",
+    "ipreass_packets",
+    "packets",
+    "rebuilt_packets",
+    "blocked_packets",
+    "injected_packets",
+    "wire_bytes",
+    "ipfrag_bytes",
+    "ipreass_bytes",
+    "bytes",
+    "rebuilt_bytes",
+    "blocked_bytes",
+    "mpls_packets",
+    "mpls_bytes",
+    "blocked_mpls_packets",
+    "blocked_mpls_bytes",
+    "tcp_filtered_packets",
+    "udp_filtered_packets",
+
+    "alerts",
+    "total_alerts",
+    "syns",
+    "syn_acks",
+
+    "tcp_sessions",
+    "new_tcp_sessions",
+    "deleted_tcp_sessions",
+    "max_tcp_sessions",
+    "max_tcp_sessions_interval",
+    "midstream_tcp_sessions",
+    "closed_tcp_sessions",
+    "pruned_tcp_sessions",
+    "dropped_async_tcp_sessions",
+    "initializing_tcp_sessions",
+    "established_tcp_sessions",
+    "closing_tcp_sessions",
+    "udp_sessions",
+    "new_udp_sessions",
+    "deleted_udp_sessions",
+    "max_udp_sessions",
+
+    "stream_flushes",
+    "stream_faults",
+    "stream_timeouts",
+    "stream_memory",
+
+    "frag_creates",
+    "frag_completes",
+    "frag_inserts",
+    "frag_deletes",
+    "frag_auto_frees",
+    "frag_flushes",
+    "frag_timeouts",
+    "frag_faults",
+    "max_frags",
+    "current_frags",
+    "frag_memory",
+
+    "attribute_hosts",
+    "attribute_reloads",
+
+    "ip4::trim",
+    "ip4::tos",
+    "ip4::df",
+    "ip4::rf",
+    "ip4::ttl",
+    "ip4::opts",
+    "icmp4::echo",
+    "ip6::ttl",
+    "ip6::opts",
+    "icmp6::echo",
+    "tcp::syn_opt",
+    "tcp::opt",
+    "tcp::pad",
+    "tcp::rsv",
+    "tcp::ns",
+    "tcp::urg",
+    "tcp::urp",
+    "tcp::trim",
+    "tcp::ecn_pkt",
+    "tcp::ecn_ssn",
+    "tcp::ts_ecr",
+    "tcp::ts_nop",
+    "tcp::ips_data",
+    "tcp::block",
+
+    "event::qualified",
+    "event::nonqualified",
+    "event::total",
+
+    "flow::packets",
+    "flow::bytes",
+    "flow::tcp_high_port_packets",
+    "flow::tcp_packets",
+    "flow::udp_high_port_packets",
+    "flow::udp_packets",
+    "flow::icmp_packets",
+
+    "daq::hw_received",
+    "daq::hw_dropped",
+    "daq::received",
+    "daq::filtered",
+    "daq::injected",
+
+    "perf_monitor::packets"
+};
+
+static_assert(sizeof(perf_export_names) / sizeof(perf_export_names[0]) == PE_MAX,
+    "perf_export_names must match PerfExportCounter");
+
+static_assert(sizeof(PerfExportHeader) % sizeof(uint64_t) == 0,
+    "counters must be aligned");
+
+#define PERF_EXPORT_MAX_SIZE (sizeof(PerfExportHeader) + PE_MAX * sizeof(uint64_t))
+
+#endif
+
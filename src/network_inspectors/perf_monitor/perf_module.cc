@@ -73,9 +73,23 @@ static const Parameter s_params[] =
     { "flow_ip_file", Parameter::PT_BOOL, nullptr, "false",
       "output host pair statistics to " FLIP_FILE " instead of stdout" },
 
+    { "export", Parameter::PT_STRING, nullptr, nullptr,
+      "send binary snapshots of the raw counters to this unix socket" },
+
+    { "export_seconds", Parameter::PT_INT, "1:", "1",
+      "export interval" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
+static const PegInfo perf_pegs[] =
+{
+    { "packets", "total packets" },
+    { "snapshots exported", "counter snapshots sent to the export socket" },
+    { "snapshots dropped", "counter snapshots that could not be sent" },
+    { nullptr, nullptr }
+};
+
 //-------------------------------------------------------------------------
 // perf attributes
 //-------------------------------------------------------------------------
@@ -159,6 +173,16 @@ bool PerfMonModule::set(const char*, Value& v, SnortConfig*)
             config.flowip_file = SnortStrdup(FLIP_FILE);
         }
     }
+    else if ( v.is("export") )
+    {
+        if ( config.export_file )
+            free(config.export_file);
+
+        config.export_file = SnortStrdup(v.get_string());
+    }
+    else if ( v.is("export_seconds") )
+        config.export_interval = v.get_long();
+
     else
         return false;
 
@@ -178,7 +202,7 @@ void PerfMonModule::get_config(SFPERF& cfg)
 }
 
 const PegInfo* PerfMonModule::get_pegs() const
-{ return simple_pegs; }
+{ return perf_pegs; }
 
 PegCount* PerfMonModule::get_counts() const
 { return (PegCount*)&pmstats; }
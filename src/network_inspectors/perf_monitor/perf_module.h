@@ -27,7 +27,14 @@
 #define PERF_NAME "perf_monitor"
 #define PERF_HELP "performance monitoring and flow statistics collection"
 
-extern THREAD_LOCAL SimpleStats pmstats;
+struct PerfMonStats
+{
+    PegCount total_packets;
+    PegCount exports;
+    PegCount export_drops;
+};
+
+extern THREAD_LOCAL PerfMonStats pmstats;
 extern THREAD_LOCAL ProfileStats perfmonStats;
 
 class PerfMonModule : public Module
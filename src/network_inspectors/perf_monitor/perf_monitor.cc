@@ -33,11 +33,13 @@
 #include <errno.h>
 #include <unistd.h>
 #include <sys/stat.h>
+#include <sys/un.h>
 
 #include <string>
 
 #include "perf.h"
 #include "perf_base.h"
+#include "perf_export.h"
 #include "perf_module.h"
 #include "main/analyzer.h"
 #include "snort_types.h"
@@ -53,7 +55,7 @@
 
 THREAD_LOCAL SFPERF* perfmon_config = nullptr;
 
-THREAD_LOCAL SimpleStats pmstats;
+THREAD_LOCAL PerfMonStats pmstats;
 THREAD_LOCAL ProfileStats perfmonStats;
 
 /* This function changes the perfmon log files permission if exists.
@@ -193,6 +195,10 @@ static void PrintConfig(SFPERF* pconfig)
     }
     LogMessage("  Console Mode:     %s\n",
             (pconfig->perf_flags & SFPERF_CONSOLE) ? "ACTIVE" : "INACTIVE");
+    LogMessage("  Export Socket:    %s\n",
+            (pconfig->export_file != NULL) ? pconfig->export_file : "INACTIVE");
+    if (pconfig->export_file != NULL)
+        LogMessage("    Export Interval:  %u seconds\n", pconfig->export_interval);
 }
 
 //-------------------------------------------------------------------------
@@ -231,6 +237,9 @@ PerfMonitor::~PerfMonitor ()
 
     if ( config.flowip_file )
         free(config.flowip_file);
+
+    if ( config.export_file )
+        free(config.export_file);
 }
 
 void PerfMonitor::show(SnortConfig*)
@@ -278,12 +287,20 @@ bool PerfMonitor::configure(SnortConfig*)
             return false;
         }
     }
+
+    if ( config.export_file &&
+        strlen(config.export_file) >= sizeof(((struct sockaddr_un*)0)->sun_path) )
+    {
+        ParseError("perfmonitor: export socket path is too long '%s'.", config.export_file);
+        return false;
+    }
     return true;
 }
 
 void PerfMonitor::tinit()
 {
     InitPerfStats(&config);
+    InitPerfExport(&config);
 }
 
 void PerfMonitor::tterm()
@@ -294,6 +311,7 @@ void PerfMonitor::tterm()
     sfCloseBaseStatsFile(&config);
     sfCloseFlowStatsFile(&config);
     sfCloseFlowIPStatsFile(&config);
+    ClosePerfExport();
 
     FreeFlowStats(&sfFlow);
 #ifdef LINUX_SMP
@@ -336,6 +354,8 @@ void PerfMonitor::eval(Packet *p)
     sfPerformanceStats(&config, p);
     ++pmstats.total_packets;
 
+    UpdatePerfExport(&config, p);
+
     MODULE_PROFILE_END(perfmonStats);
 }
 
@@ -37,6 +37,10 @@
 #include <string.h>
 #include <ctype.h>
 
+#include <algorithm>
+#include <set>
+#include <vector>
+
 #include "util.h"
 #include "snort_bounds.h"
 #include "sfip/sf_ip.h"
@@ -58,6 +62,275 @@
    For a single IPAddress the implied Mask is 32 bits,or 255.255.255.255, or 0xffffffff, or -1.
 
 */
+/*
+   COMPILED LOOKUP
+
+   ipset_contains() used to walk every CIDR and every port range in list
+   order until the first entry containing the address and port.  The
+   list is compiled into sorted tables of disjoint address ranges, one
+   for IPv4 and one for IPv6; IPv4 entries also appear in the IPv6 table
+   where they cover the mapped and compatible forms, as sfip_contains()
+   does.  Each range holds the result directly when its first covering
+   entry matches any port, otherwise the covering entries whose ports
+   must still be checked, in list order.  A lookup is a binary search
+   plus, at most, a few port checks.
+*/
+struct IpsetKey6
+{
+    uint64_t hi, lo;
+
+    bool operator<(const IpsetKey6& rhs) const
+    { return hi < rhs.hi || (hi == rhs.hi && lo < rhs.lo); }
+
+    bool operator==(const IpsetKey6& rhs) const
+    { return hi == rhs.hi && lo == rhs.lo; }
+};
+
+struct IpsetEntry
+{
+    uint32_t first, count;  // port ranges
+    bool wild;
+    char notflag;
+};
+
+struct IpsetRange
+{
+    uint32_t first, count;  // candidate entries
+    int result;             // -1 when candidates must be checked
+};
+
+struct IpsetLpm
+{
+    std::vector<uint32_t> start4;
+    std::vector<IpsetRange> range4;
+
+    std::vector<IpsetKey6> start6;
+    std::vector<IpsetRange> range6;
+
+    std::vector<uint32_t> cand;
+    std::vector<IpsetEntry> ent;
+    std::vector<PORTRANGE> port;
+};
+
+template <typename Key>
+struct IpsetSpan
+{
+    Key lo, hi;
+    uint32_t ent;
+};
+
+static inline bool key_next(uint32_t k, uint32_t& n)
+{
+    n = k + 1;
+    return n != 0;
+}
+
+static inline bool key_next(const IpsetKey6& k, IpsetKey6& n)
+{
+    n.lo = k.lo + 1;
+    n.hi = k.hi + (n.lo == 0);
+    return n.lo || n.hi;
+}
+
+template <typename Key>
+struct IpsetEdge
+{
+    Key key;
+    uint32_t span;
+    bool open;
+
+    bool operator<(const IpsetEdge& rhs) const
+    { return key < rhs.key; }
+};
+
+template <typename Key>
+static void ipset_build(
+    IpsetLpm* lpm, std::vector<IpsetSpan<Key> >& spans,
+    std::vector<Key>& start, std::vector<IpsetRange>& range)
+{
+    // each span opens at lo and closes at hi + 1
+    std::vector<IpsetEdge<Key> > edges;
+    edges.reserve(2 * spans.size());
+
+    for ( uint32_t i = 0; i < spans.size(); ++i )
+    {
+        Key n;
+        edges.push_back({ spans[i].lo, i, true });
+
+        if ( key_next(spans[i].hi, n) )
+            edges.push_back({ n, i, false });
+    }
+    std::sort(edges.begin(), edges.end());
+
+    // spans are in list order, which is match precedence, so the active
+    // set is ordered by span index
+    std::set<uint32_t> active;
+    Key k = Key();
+    unsigned i = 0;
+
+    while ( true )
+    {
+        for ( ; i < edges.size() && edges[i].key == k; ++i )
+        {
+            if ( edges[i].open )
+                active.insert(edges[i].span);
+            else
+                active.erase(edges[i].span);
+        }
+
+        IpsetRange r = { (uint32_t)lpm->cand.size(), 0, 0 };
+
+        for ( auto s : active )
+        {
+            const IpsetEntry& e = lpm->ent[spans[s].ent];
+
+            if ( e.wild && !r.count )
+            {
+                r.result = !e.notflag;
+                break;
+            }
+            lpm->cand.push_back(spans[s].ent);
+            r.count++;
+            r.result = -1;
+
+            if ( e.wild )
+                break;
+        }
+
+        if ( r.count || !range.size() || range.back().count ||
+            range.back().result != r.result )
+        {
+            start.push_back(k);
+            range.push_back(r);
+        }
+
+        if ( i == edges.size() )
+            break;
+
+        k = edges[i].key;
+    }
+}
+
+static void ipset_drop_lpm(IPSET* ipc)
+{
+    delete ipc->lpm;
+    ipc->lpm = nullptr;
+}
+
+static void ipset_compile(IPSET* ipc)
+{
+    IpsetLpm* lpm = new IpsetLpm;
+    std::vector<IpsetSpan<uint32_t> > spans4;
+    std::vector<IpsetSpan<IpsetKey6> > spans6;
+
+    SF_LNODE* cur_ip;
+
+    for ( IP_PORT* p = (IP_PORT*)sflist_first(&ipc->ip_list, &cur_ip);
+        p; p = (IP_PORT*)sflist_next(&cur_ip) )
+    {
+        IpsetEntry e = { (uint32_t)lpm->port.size(), 0, false, p->notflag };
+        SF_LNODE* cur_port;
+
+        for ( PORTRANGE* pr = (PORTRANGE*)sflist_first(&p->portset.port_list, &cur_port);
+            pr; pr = (PORTRANGE*)sflist_next(&cur_port) )
+        {
+            if ( pr->port_hi == 0 )
+                e.wild = true;
+
+            lpm->port.push_back(*pr);
+            e.count++;
+        }
+
+        if ( !e.count )
+            continue;  // can't match any port
+
+        uint32_t idx = lpm->ent.size();
+        lpm->ent.push_back(e);
+
+        unsigned bits = sfip_bits(&p->ip);
+
+        if ( p->ip.family == AF_INET )
+        {
+            uint32_t mask = bits ? ~0u << (32 - bits) : 0;
+            uint32_t lo = ntohl(p->ip.ip32[0]) & mask;
+            uint32_t hi = lo | ~mask;
+
+            spans4.push_back({ lo, hi, idx });
+
+            // the mapped (::ffff:a.b.c.d) and compatible (::a.b.c.d) forms
+            spans6.push_back({ { 0, 0xffff00000000ull | lo }, { 0, 0xffff00000000ull | hi }, idx });
+            spans6.push_back({ { 0, lo }, { 0, hi }, idx });
+        }
+        else
+        {
+            IpsetKey6 lo, hi;
+            lo.hi = ((uint64_t)ntohl(p->ip.ip32[0]) << 32) | ntohl(p->ip.ip32[1]);
+            lo.lo = ((uint64_t)ntohl(p->ip.ip32[2]) << 32) | ntohl(p->ip.ip32[3]);
+
+            uint64_t mhi = bits >= 64 ? ~0ull : (bits ? ~0ull << (64 - bits) : 0);
+            uint64_t mlo = bits <= 64 ? 0 : (bits >= 128 ? ~0ull : ~0ull << (128 - bits));
+
+            lo.hi &= mhi;
+            lo.lo &= mlo;
+            hi.hi = lo.hi | ~mhi;
+            hi.lo = lo.lo | ~mlo;
+
+            spans6.push_back({ lo, hi, idx });
+        }
+    }
+
+    ipset_build(lpm, spans4, lpm->start4, lpm->range4);
+    ipset_build(lpm, spans6, lpm->start6, lpm->range6);
+
+    delete ipc->lpm;
+    ipc->lpm = lpm;
+}
+
+template <typename Key>
+static int ipset_lookup(
+    const IpsetLpm* lpm, const std::vector<Key>& start,
+    const std::vector<IpsetRange>& range, const Key& k, unsigned short port)
+{
+    // start[0] is the lowest key so there is always a range
+    unsigned i = std::upper_bound(start.begin(), start.end(), k) - start.begin() - 1;
+    const IpsetRange& r = range[i];
+
+    if ( r.result >= 0 )
+        return r.result;
+
+    for ( unsigned c = r.first; c < r.first + r.count; ++c )
+    {
+        const IpsetEntry& e = lpm->ent[lpm->cand[c]];
+
+        if ( e.wild )
+            return !e.notflag;
+
+        for ( unsigned j = e.first; j < e.first + e.count; ++j )
+        {
+            const PORTRANGE& pr = lpm->port[j];
+
+            if ( port >= pr.port_lo && port <= pr.port_hi )
+                return !e.notflag;
+        }
+    }
+    return 0;
+}
+
+static int ipset_lpm_contains(const IpsetLpm* lpm, const sfip_t* ip, unsigned short port)
+{
+    if ( sfip_family(ip) == AF_INET )
+    {
+        uint32_t k = ntohl(ip->ip32[0]);
+        return ipset_lookup(lpm, lpm->start4, lpm->range4, k, port);
+    }
+
+    IpsetKey6 k;
+    k.hi = ((uint64_t)ntohl(ip->ip32[0]) << 32) | ntohl(ip->ip32[1]);
+    k.lo = ((uint64_t)ntohl(ip->ip32[2]) << 32) | ntohl(ip->ip32[3]);
+
+    return ipset_lookup(lpm, lpm->start6, lpm->range6, k, port);
+}
+
 IPSET * ipset_new(void)
 {
     IPSET * p = (IPSET *)SnortAlloc( sizeof(IPSET));
@@ -78,6 +351,9 @@ IPSET * ipset_copy( IPSET *ipsp )
     {
         ipset_add(newset, &ip_port->ip, &ip_port->portset, ip_port->notflag);
     }
+    if ( ipsp->lpm )
+        ipset_compile(newset);
+
     return newset;
 }
 
@@ -94,6 +370,7 @@ void ipset_free( IPSET * ipc )
             p = (IP_PORT *) sflist_next(&cursor);
         }
         sflist_static_free_all(&ipc->ip_list, free);
+        ipset_drop_lpm(ipc);
         free( ipc );
     }
 }
@@ -102,6 +379,8 @@ int ipset_add (IPSET * ipset, sfip_t *ip, void * vport, int notflag)
 {
     if( !ipset ) return -1;
 
+    ipset_drop_lpm(ipset);
+
     {
         PORTSET  * portset = (PORTSET *) vport;
         IP_PORT *p = (IP_PORT*)calloc( 1,sizeof(IP_PORT) );
@@ -131,6 +410,9 @@ int ipset_contains( IPSET *ipc, const sfip_t *ip, void *port)
     else
         portu = 0;
 
+    if ( ipc->lpm )
+        return ipset_lpm_contains(ipc->lpm, ip, portu);
+
     SF_LNODE* cur_ip;
 
     for(p =(IP_PORT*)sflist_first( &ipc->ip_list, &cur_ip );
@@ -446,6 +728,7 @@ int ipset_parse(IPSET *ipset, const char *ipstr)
     if (open_bracket)
         return -8;
 
+    ipset_compile(ipset);
     return 0;
 }
 
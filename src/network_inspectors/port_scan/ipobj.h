@@ -52,8 +52,11 @@ struct IP_PORT{
     char notflag;
 };
 
+struct IpsetLpm;
+
 struct IPSET{
     SF_LIST ip_list;
+    IpsetLpm* lpm;  // compiled form of ip_list used by ipset_contains()
 };
 
 
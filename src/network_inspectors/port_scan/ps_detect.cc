@@ -109,7 +109,6 @@
 #include "snort.h"
 #include "protocols/packet.h"
 #include "packet_time.h"
-#include "sfxhash.h"
 #include "ipobj.h"
 #include "stream/stream_api.h"
 #include "sfip/sf_ip.h"
@@ -135,7 +134,29 @@ typedef struct s_PS_ALERT_CONF
 
 } PS_ALERT_CONF;
 
-static THREAD_LOCAL SFXHASH *portscan_hash = NULL;
+/*
+**  Trackers live in a fixed size, open addressed table sized from the
+**  memcap.  A key probes at most PS_PROBES consecutive slots; when none
+**  is free the stalest evictable tracker in that window is replaced, so
+**  memory stays bounded and a flood of new scanners costs a handful of
+**  cache lines per packet instead of node allocation and list walks.
+*/
+#define PS_PROBES 8
+
+struct PS_SLOT
+{
+    uint32_t hash;    // 0 when the slot is empty
+    PS_HASH_KEY key;
+    PS_TRACKER tracker;
+};
+
+struct PS_TABLE
+{
+    PS_SLOT *slots;
+    uint32_t mask;
+};
+
+static THREAD_LOCAL PS_TABLE *portscan_hash = NULL;
 
 /*
 **  Scanning configurations.  This is where we configure what the thresholds
@@ -225,19 +246,13 @@ PortscanConfig::~PortscanConfig()
 **    ps_tracker_free::
 */
 /**
-**  This function is passed into the hash algorithm, so that
-**  we only reuse nodes that aren't priority nodes.  We have to make
-**  sure that we only track so many priority nodes, otherwise we could
-**  have all priority nodes and not be able to allocate more.
+**  Check whether a tracker may be evicted.  We only reuse nodes that
+**  aren't active priority nodes.  We have to make sure that we only
+**  track so many priority nodes, otherwise we could have all priority
+**  nodes and not be able to allocate more.
 */
-static int ps_tracker_free(void *key, void *data)
+static int ps_tracker_free(PS_TRACKER *tracker, time_t now)
 {
-    PS_TRACKER *tracker;
-
-    if(!key || !data)
-        return 0;
-
-    tracker = (PS_TRACKER *)data;
     if(!tracker->priority_node)
         return 0;
 
@@ -245,17 +260,35 @@ static int ps_tracker_free(void *key, void *data)
     **  Cycle through the protos to see if it's past the time.
     **  We only get here if we ARE a priority node.
     */
-    if(tracker->proto.window >= packet_time())
+    if(tracker->proto.window >= now)
         return 1;
 
     return 0;
 }
 
+static uint32_t ps_hash_key(const PS_HASH_KEY *key)
+{
+    const uint32_t *w = (const uint32_t *)key;
+    uint32_t h = 2166136261u;
+
+    for ( unsigned i = 0; i < sizeof(*key) / sizeof(*w); i++ )
+    {
+        h ^= w[i];
+        h *= 16777619u;
+    }
+    h ^= h >> 15;
+    h *= 0x2c1b3c6d;
+    h ^= h >> 12;
+
+    return h ? h : 1;
+}
+
 void ps_cleanup(void)
 {
     if (portscan_hash != NULL)
     {
-        sfxhash_delete(portscan_hash);
+        free(portscan_hash->slots);
+        free(portscan_hash);
         portscan_hash = NULL;
     }
 }
@@ -265,21 +298,21 @@ void ps_init_hash(unsigned long memcap)
     if ( portscan_hash )
         return;
 
-    int rows = 0;
-    int factor = 0;
-#if SIZEOF_LONG_INT == 8
-    factor = 125;
-#else
-    factor = 250;
-#endif
+    unsigned long rows = memcap / sizeof(PS_SLOT);
+    unsigned long size = PS_PROBES;
+
+    while ( size * 2 <= rows )
+        size *= 2;
 
-    rows = memcap/factor;
+    portscan_hash = (PS_TABLE *)calloc(1, sizeof(*portscan_hash));
 
-    portscan_hash = sfxhash_new(rows, sizeof(PS_HASH_KEY), sizeof(PS_TRACKER),
-                                memcap, 1, ps_tracker_free, NULL, 1);
+    if ( portscan_hash )
+        portscan_hash->slots = (PS_SLOT *)calloc(size, sizeof(PS_SLOT));
 
-    if (portscan_hash == NULL)
+    if ( !portscan_hash || !portscan_hash->slots )
         FatalError("Failed to initialize portscan hash table.\n");
+
+    portscan_hash->mask = size - 1;
 }
 
 /*
@@ -292,7 +325,10 @@ void ps_init_hash(unsigned long memcap)
 void ps_reset(void)
 {
     if (portscan_hash != NULL)
-        sfxhash_make_empty(portscan_hash);
+    {
+        memset(portscan_hash->slots, 0,
+            (portscan_hash->mask + 1) * sizeof(PS_SLOT));
+    }
 }
 
 /*
@@ -440,21 +476,6 @@ int PortScan::ps_filter_ignore(PS_PKT *ps_pkt)
     return 0;
 }
 
-/*
-**  NAME
-**    ps_tracker_init::
-*/
-/**
-**  Right now all we do is memset, but just in case we want to do more
-**  initialization has been extracted.
-*/
-static int ps_tracker_init(PS_TRACKER *tracker)
-{
-    memset(tracker, 0x00, sizeof(PS_TRACKER));
-
-    return 0;
-}
-
 /*
 **  NAME
 **    ps_tracker_get::
@@ -465,26 +486,44 @@ static int ps_tracker_init(PS_TRACKER *tracker)
 */
 static int ps_tracker_get(PS_TRACKER **ht, PS_HASH_KEY *key)
 {
-    int iRet;
+    PS_TABLE *t = portscan_hash;
+    uint32_t hash = ps_hash_key(key);
+    PS_SLOT *victim = NULL;
+    time_t now = packet_time();
 
-    *ht = (PS_TRACKER *)sfxhash_find(portscan_hash, (void *)key);
-    if(!(*ht))
+    for ( unsigned i = 0; i < PS_PROBES; i++ )
     {
-        iRet = sfxhash_add(portscan_hash, (void *)key, NULL);
-        if(iRet == SFXHASH_OK)
-        {
-            *ht = (PS_TRACKER *)sfxhash_mru(portscan_hash);
-            if(!(*ht))
-                return -1;
+        PS_SLOT *slot = t->slots + ((hash + i) & t->mask);
 
-            ps_tracker_init(*ht);
+        if ( !slot->hash )
+        {
+            // keys are never removed, only replaced, so an
+            // empty slot ends the probe sequence
+            victim = slot;
+            break;
         }
-        else
+
+        if ( slot->hash == hash && !memcmp(&slot->key, key, sizeof(*key)) )
         {
-            return -1;
+            *ht = &slot->tracker;
+            return 0;
         }
+
+        if ( ps_tracker_free(&slot->tracker, now) )
+            continue;
+
+        if ( !victim || slot->tracker.proto.window < victim->tracker.proto.window )
+            victim = slot;
     }
 
+    if ( !victim )
+        return -1;
+
+    victim->hash = hash;
+    victim->key = *key;
+    memset(&victim->tracker, 0x00, sizeof(PS_TRACKER));
+
+    *ht = &victim->tracker;
     return 0;
 }
 
@@ -677,6 +716,22 @@ int PortScan::ps_proto_update_window(PS_PROTO *proto, time_t pkt_time)
 **  @param u_short  port/ip_proto to track
 **  @param time_t   time the packet was received. update windows.
 */
+/*
+**  Only a fingerprint of the last address is kept to count address
+**  changes; it is never 0 so the first address always counts.
+*/
+static inline uint32_t ps_ip_hash(const sfip_t *ip)
+{
+    uint32_t h = ip->ip32[0] ^ (ip->ip32[1] * 31) ^
+        (ip->ip32[2] * 131) ^ (ip->ip32[3] * 8191) ^ (uint32_t)ip->family;
+
+    h ^= h >> 16;
+    h *= 0x7feb352d;
+    h ^= h >> 15;
+
+    return h ? h : 1;
+}
+
 int PortScan::ps_proto_update(PS_PROTO *proto, int ps_cnt, int pri_cnt, const sfip_t *ip,
         u_short port, time_t pkt_time)
 {
@@ -726,10 +781,12 @@ int PortScan::ps_proto_update(PS_PROTO *proto, int ps_cnt, int pri_cnt, const sf
     if(proto->connection_count < 0)
         proto->connection_count = 0;
 
-    if(!sfip_unset_equals(&proto->u_ips, ip))
+    uint32_t ip_hash = ps_ip_hash(ip);
+
+    if(proto->u_ip_hash != ip_hash)
     {
         proto->u_ip_count++;
-        sfip_copy(proto->u_ips, ip);
+        proto->u_ip_hash = ip_hash;
     }
 
     /* we need to do the IP comparisons in host order */
@@ -69,7 +69,7 @@ struct PS_PROTO
 
     sfip_t           high_ip;
     sfip_t           low_ip;
-    sfip_t           u_ips;
+    uint32_t         u_ip_hash;
 
     unsigned short open_ports[PS_OPEN_PORTS];
     unsigned char  open_ports_cnt;
@@ -0,0 +1,452 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// reputation.cc blocks or trusts flows whose source or destination address
+// appears on a configured list.  both lists are compiled into a single
+// sfrt_flat DIR-8x16 table held in one segment buffer; every reference
+// within the table is an offset from its start so the finished table is
+// shrunk to its used size, never written again, and shared read-only by
+// all packet threads.  a reload builds a new table with the new config
+// and the swapper retires the old one with it.
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "reputation_module.h"
+
+#include "detection/detect.h"
+#include "events/event_queue.h"
+#include "flow/flow.h"
+#include "framework/inspector.h"
+#include "log/messages.h"
+#include "packet_io/active.h"
+#include "parser/parser.h"
+#include "protocols/packet.h"
+#include "sfip/sf_ip.h"
+#include "sfrt/sfrt.h"
+#include "sfrt/sfrt_flat.h"
+#include "stream/stream_api.h"
+#include "time/profiler.h"
+#include "utils/segment_mem.h"
+
+THREAD_LOCAL ProfileStats reputationPerfStats;
+
+#define REP_BLACK 0x01
+#define REP_WHITE 0x02
+
+//-------------------------------------------------------------------------
+// list loading
+//-------------------------------------------------------------------------
+
+struct RepAddr
+{
+    sfip_t ip;
+    uint8_t bits;
+};
+
+typedef std::vector<RepAddr> RepAddrList;
+
+// one address or CIDR per line; # starts a comment
+static void load_list(const std::string& file, uint8_t bits, RepAddrList& list)
+{
+    if ( file.empty() )
+        return;
+
+    std::ifstream in(file);
+
+    if ( !in )
+    {
+        ParseError("%s: can't open %s", MOD_NAME, file.c_str());
+        return;
+    }
+
+    std::string line;
+    unsigned num = 0;
+
+    while ( std::getline(in, line) )
+    {
+        ++num;
+
+        size_t pos = line.find('#');
+
+        if ( pos != std::string::npos )
+            line.erase(pos);
+
+        pos = line.find_first_not_of(" \t\r");
+
+        if ( pos == std::string::npos )
+            continue;
+
+        line.erase(0, pos);
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+
+        RepAddr ra;
+
+        if ( sfip_pton(line.c_str(), &ra.ip) != SFIP_SUCCESS || !ra.ip.bits )
+        {
+            ParseWarning("%s: %s(%u) invalid address '%s'",
+                MOD_NAME, file.c_str(), num, line.c_str());
+            continue;
+        }
+        ra.bits = bits;
+        list.push_back(ra);
+    }
+}
+
+//-------------------------------------------------------------------------
+// table building
+//-------------------------------------------------------------------------
+
+// each prefix owns one byte of list bits.  sfrt_flat calls this when a new
+// prefix is stored (SAVE_TO_CURRENT with *current == 0), when a prefix is
+// added again or a less specific one covers it (SAVE_TO_CURRENT), and when
+// a more specific prefix is carved out of an existing one (SAVE_TO_NEW).
+// the bits of every covering prefix are merged so a lookup returns the
+// union of all lists containing the address.
+static int64_t update_entry(
+    INFO* current, INFO new_entry, SaveDest dest, uint8_t* base)
+{
+    if ( dest == SAVE_TO_NEW )
+    {
+        base[new_entry] |= base[*current];
+        return 0;
+    }
+
+    if ( !*current )
+    {
+        MEM_OFFSET off = segment_calloc(1, 1);
+
+        if ( !off )
+            return -1;
+
+        base[off] = base[new_entry];
+        *current = off;
+        return 1;
+    }
+
+    base[*current] |= base[new_entry];
+    return 0;
+}
+
+class Reputation : public Inspector {
+public:
+    Reputation(ReputationModule*);
+    ~Reputation();
+
+    void show(SnortConfig*) override;
+    void eval(Packet*) override;
+
+private:
+    void build(const RepAddrList&);
+    int fill(const RepAddrList&);
+    uint8_t lookup(const sfip_t*);
+    void blacklist(Packet*);
+    void whitelist(Packet*);
+
+private:
+    ReputationConfig* config;
+
+    uint8_t* segment;
+    size_t size;
+    table_flat_t* table;
+    unsigned entries;
+};
+
+Reputation::Reputation(ReputationModule* mod)
+{
+    config = mod->get_config();
+    segment = nullptr;
+    size = 0;
+    table = nullptr;
+    entries = 0;
+
+    RepAddrList list;
+    load_list(config->blacklist, REP_BLACK, list);
+    load_list(config->whitelist, REP_WHITE, list);
+
+    if ( list.size() )
+        build(list);
+}
+
+Reputation::~Reputation ()
+{
+    free(segment);
+    delete config;
+}
+
+// the table is sized from the entries and grown by rebuilding it in a
+// larger buffer until everything fits or the memcap is reached.  ipv4
+// uses 16,8,4,4 bit levels and ipv6 uses 8 bit levels; each entry is
+// counted as adding one sub table per level below the root.
+static size_t sub_table_size(unsigned width)
+{
+    return sizeof(dir_sub_table_flat_t) + (1 << width) * sizeof(DIR_Entry);
+}
+
+static size_t table_size(const RepAddrList& list)
+{
+    size_t n = sizeof(table_flat_t) + 2 * sizeof(dir_table_flat_t) +
+        sub_table_size(16) + sub_table_size(8) + sizeof(INFO) + 2;
+
+    for ( const auto& ra : list )
+    {
+        n += sizeof(INFO) + 1;
+
+        if ( ra.ip.is_ip4() )
+        {
+            n += (ra.ip.bits > 16) ? sub_table_size(8) : 0;
+            n += (ra.ip.bits > 24) ? sub_table_size(4) : 0;
+            n += (ra.ip.bits > 28) ? sub_table_size(4) : 0;
+        }
+        else if ( ra.ip.bits > 8 )
+            n += ((ra.ip.bits - 1) / 8) * sub_table_size(8);
+    }
+    return n;
+}
+
+// returns the number of entries that didn't fit or -1 if the table
+// couldn't be created
+int Reputation::fill(const RepAddrList& list)
+{
+    // the table is the first allocation so it sits at offset 0 as
+    // required by dir8x_lookup().
+    table = sfrt_flat_new(DIR_8x16, IPv6, list.size() + 1, config->memcap);
+
+    if ( !table )
+        return -1;
+
+    MEM_OFFSET lists[2];
+    lists[0] = segment_calloc(1, 1);
+    lists[1] = segment_calloc(1, 1);
+
+    if ( !lists[0] || !lists[1] )
+        return -1;
+
+    segment[lists[0]] = REP_BLACK;
+    segment[lists[1]] = REP_WHITE;
+
+    int dropped = 0;
+
+    for ( const auto& ra : list )
+    {
+        sfip_t ip = ra.ip;
+        INFO info = (ra.bits == REP_BLACK) ? lists[0] : lists[1];
+
+        if ( sfrt_flat_insert(&ip, (unsigned char)ip.bits, info,
+            RT_FAVOR_ALL, table, update_entry) != RT_SUCCESS )
+            ++dropped;
+    }
+    return dropped;
+}
+
+void Reputation::build(const RepAddrList& list)
+{
+    size_t cap = (size_t)config->memcap << 20;
+    size_t want = table_size(list);
+    int dropped;
+
+    // segment memory is a single global arena shared by all sfrt_flat
+    // tables so it is pointed at this buffer only while building
+    SegmentMemState saved;
+    segment_memsave(&saved);
+
+    while ( true )
+    {
+        size = (want < cap) ? want : cap;
+        segment = (uint8_t*)malloc(size);
+
+        if ( !segment )
+        {
+            ParseError("%s: can't allocate %zu bytes", MOD_NAME, size);
+            dropped = -1;
+            break;
+        }
+        segment_meminit(segment, size);
+        dropped = fill(list);
+
+        if ( !dropped || size == cap )
+            break;
+
+        free(segment);
+        want *= 2;
+    }
+
+    if ( dropped < 0 )
+    {
+        if ( segment )
+            ParseError("%s: can't create lookup table; memcap too small", MOD_NAME);
+
+        free(segment);
+        segment = nullptr;
+        table = nullptr;
+        size = 0;
+        segment_memrestore(&saved);
+        return;
+    }
+    if ( dropped )
+        ParseWarning("%s: %d entries dropped; memcap may be too small", MOD_NAME, dropped);
+
+    entries = sfrt_flat_num_entries(table);
+
+    // nothing is allocated from the segment after this so give back
+    // the unused tail; the table only holds offsets so it can move
+    size -= segment_unusedmem();
+    uint8_t* tmp = (uint8_t*)realloc(segment, size);
+
+    if ( tmp )
+        segment = tmp;
+
+    table = (table_flat_t*)segment;
+    segment_memrestore(&saved);
+}
+
+void Reputation::show(SnortConfig*)
+{
+    LogMessage("reputation\n");
+    LogMessage("    blacklist: %s\n", config->blacklist.c_str());
+    LogMessage("    whitelist: %s\n", config->whitelist.c_str());
+    LogMessage("    priority: %s\n",
+        config->priority == REP_PRI_BLACKLIST ? "blacklist" : "whitelist");
+    LogMessage("    white: %s\n",
+        config->white == REP_WHITE_TRUST ? "trust" : "unblack");
+    LogMessage("    entries: %u\n", entries);
+    LogMessage("    memory: %zu bytes\n", size);
+}
+
+inline uint8_t Reputation::lookup(const sfip_t* ip)
+{
+    uint8_t* bits = (uint8_t*)sfrt_flat_dir8x_lookup((void*)ip, table);
+    return bits ? *bits : 0;
+}
+
+void Reputation::blacklist(Packet* p)
+{
+    ++reputation_stats.blacklisted;
+    SnortEventqAdd(GID_REPUTATION, REPUTATION_EVENT_BLACKLIST);
+
+    if ( Flow* flow = p->flow )
+    {
+        flow->set_state(Flow::BLOCK);
+        stream.drop_traffic(flow, SSN_DIR_BOTH);
+    }
+    DisableInspection(p);
+    Active_DropPacket();
+}
+
+void Reputation::whitelist(Packet* p)
+{
+    ++reputation_stats.whitelisted;
+    SnortEventqAdd(GID_REPUTATION, REPUTATION_EVENT_WHITELIST);
+
+    if ( config->white != REP_WHITE_TRUST )
+        return;
+
+    if ( Flow* flow = p->flow )
+    {
+        flow->set_state(Flow::ALLOW);
+        stream.stop_inspection(flow, p, SSN_DIR_BOTH, -1, 0);
+    }
+    DisableInspection(p);
+    p->ptrs.decode_flags |= DECODE_PKT_TRUST;
+}
+
+void Reputation::eval(Packet* p)
+{
+    if ( !table || !p->ptrs.ip_api.is_valid() )
+        return;
+
+    PROFILE_VARS;
+    MODULE_PROFILE_START(reputationPerfStats);
+    ++reputation_stats.packets;
+
+    uint8_t bits =
+        lookup(p->ptrs.ip_api.get_src()) | lookup(p->ptrs.ip_api.get_dst());
+
+    if ( bits == (REP_BLACK | REP_WHITE) )
+        bits = (config->priority == REP_PRI_BLACKLIST) ? REP_BLACK : REP_WHITE;
+
+    if ( bits == REP_BLACK )
+        blacklist(p);
+
+    else if ( bits == REP_WHITE )
+        whitelist(p);
+
+    MODULE_PROFILE_END(reputationPerfStats);
+}
+
+//-------------------------------------------------------------------------
+// api stuff
+//-------------------------------------------------------------------------
+
+static Module* mod_ctor()
+{ return new ReputationModule; }
+
+static void mod_dtor(Module* m)
+{ delete m; }
+
+static Inspector* rep_ctor(Module* m)
+{
+    return new Reputation((ReputationModule*)m);
+}
+
+static void rep_dtor(Inspector* p)
+{ delete p; }
+
+static const InspectApi rep_api =
+{
+    {
+        PT_INSPECTOR,
+        MOD_NAME,
+        MOD_HELP,
+        INSAPI_PLUGIN_V0,
+        0,
+        mod_ctor,
+        mod_dtor
+    },
+    IT_NETWORK,
+    (uint16_t)PktType::ANY_IP,
+    nullptr, // buffers
+    nullptr, // service
+    nullptr, // pinit
+    nullptr, // pterm
+    nullptr, // tinit
+    nullptr, // tterm
+    rep_ctor,
+    rep_dtor,
+    nullptr, // ssn
+    nullptr, // reset
+};
+
+#ifdef BUILDING_SO
+SO_PUBLIC const BaseApi* snort_plugins[] =
+{
+    &rep_api.base,
+    nullptr
+};
+#else
+const BaseApi* nin_reputation = &rep_api.base;
+#endif
+
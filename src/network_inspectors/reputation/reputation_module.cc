@@ -0,0 +1,139 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// reputation_module.cc
+
+#include "reputation_module.h"
+
+#define REPUTATION_EVENT_BLACKLIST_STR \
+    "packets blacklisted"
+#define REPUTATION_EVENT_WHITELIST_STR \
+    "packets whitelisted"
+
+THREAD_LOCAL ReputationStats reputation_stats;
+
+static const PegInfo reputation_pegs[] =
+{
+    { "packets", "total packets checked" },
+    { "blacklisted", "packets blocked by blacklist" },
+    { "whitelisted", "packets trusted by whitelist" },
+    { nullptr, nullptr }
+};
+
+//-------------------------------------------------------------------------
+// reputation stuff
+//-------------------------------------------------------------------------
+
+static const Parameter s_params[] =
+{
+    { "blacklist", Parameter::PT_STRING, nullptr, nullptr,
+      "file with one address or CIDR per line to block" },
+
+    { "whitelist", Parameter::PT_STRING, nullptr, nullptr,
+      "file with one address or CIDR per line to trust" },
+
+    { "memcap", Parameter::PT_INT, "1:4095", "500",
+      "maximum total MB of memory allocated for the lookup table" },
+
+    { "priority", Parameter::PT_ENUM, "blacklist | whitelist", "whitelist",
+      "list that wins when an address is on both" },
+
+    { "white", Parameter::PT_ENUM, "unblack | trust", "unblack",
+      "unblack only skips blocking; trust also stops inspection of the flow" },
+
+    { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
+};
+
+static const RuleMap s_rules[] =
+{
+    { REPUTATION_EVENT_BLACKLIST, REPUTATION_EVENT_BLACKLIST_STR },
+    { REPUTATION_EVENT_WHITELIST, REPUTATION_EVENT_WHITELIST_STR },
+
+    { 0, nullptr }
+};
+
+//-------------------------------------------------------------------------
+// reputation module
+//-------------------------------------------------------------------------
+
+ReputationModule::ReputationModule() :
+    Module(MOD_NAME, MOD_HELP, s_params)
+{
+    config = nullptr;
+}
+
+ReputationModule::~ReputationModule()
+{
+    if ( config )
+        delete config;
+}
+
+const RuleMap* ReputationModule::get_rules() const
+{ return s_rules; }
+
+ProfileStats* ReputationModule::get_profile() const
+{ return &reputationPerfStats; }
+
+bool ReputationModule::set(const char*, Value& v, SnortConfig*)
+{
+    if ( v.is("blacklist") )
+        config->blacklist = v.get_string();
+
+    else if ( v.is("whitelist") )
+        config->whitelist = v.get_string();
+
+    else if ( v.is("memcap") )
+        config->memcap = v.get_long();
+
+    else if ( v.is("priority") )
+        config->priority = (ReputationPriority)v.get_long();
+
+    else if ( v.is("white") )
+        config->white = (ReputationWhite)v.get_long();
+
+    else
+        return false;
+
+    return true;
+}
+
+ReputationConfig* ReputationModule::get_config()
+{
+    ReputationConfig* temp = config;
+    config = nullptr;
+    return temp;
+}
+
+bool ReputationModule::begin(const char*, int, SnortConfig*)
+{
+    if ( !config )
+    {
+        config = new ReputationConfig;
+        config->memcap = 500;
+        config->priority = REP_PRI_WHITELIST;
+        config->white = REP_WHITE_UNBLACK;
+    }
+    return true;
+}
+
+const PegInfo* ReputationModule::get_pegs() const
+{ return reputation_pegs; }
+
+PegCount* ReputationModule::get_counts() const
+{ return (PegCount*)&reputation_stats; }
+
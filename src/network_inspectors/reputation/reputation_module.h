@@ -0,0 +1,94 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// reputation_module.h
+
+#ifndef REPUTATION_MODULE_H
+#define REPUTATION_MODULE_H
+
+#include <string>
+
+#include "framework/module.h"
+#include "main/thread.h"
+
+#define MOD_NAME "reputation"
+#define MOD_HELP "block or trust flows by source and destination address"
+
+#define GID_REPUTATION 136
+
+#define REPUTATION_EVENT_BLACKLIST 1
+#define REPUTATION_EVENT_WHITELIST 2
+
+struct ReputationStats
+{
+    PegCount packets;
+    PegCount blacklisted;
+    PegCount whitelisted;
+};
+
+extern THREAD_LOCAL ReputationStats reputation_stats;
+extern THREAD_LOCAL ProfileStats reputationPerfStats;
+
+enum ReputationPriority
+{
+    REP_PRI_BLACKLIST,
+    REP_PRI_WHITELIST
+};
+
+enum ReputationWhite
+{
+    REP_WHITE_UNBLACK,
+    REP_WHITE_TRUST
+};
+
+struct ReputationConfig
+{
+    std::string blacklist;
+    std::string whitelist;
+
+    uint32_t memcap;  // MB
+    ReputationPriority priority;
+    ReputationWhite white;
+};
+
+class ReputationModule : public Module
+{
+public:
+    ReputationModule();
+    ~ReputationModule();
+
+    bool set(const char*, Value&, SnortConfig*) override;
+    bool begin(const char*, int, SnortConfig*) override;
+
+    ReputationConfig* get_config();
+
+    const PegInfo* get_pegs() const override;
+    PegCount* get_counts() const override;
+
+    unsigned get_gid() const override
+    { return GID_REPUTATION; };
+
+    const RuleMap* get_rules() const override;
+    ProfileStats* get_profile() const override;
+
+private:
+    ReputationConfig* config;
+};
+
+#endif
+
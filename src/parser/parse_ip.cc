@@ -72,6 +72,7 @@ sfip_var_t* sfip_var_from_string(const char *addr)
         }
     }
 
+    sfvar_compile(ret);
     return ret;
 }
 
@@ -1404,7 +1404,11 @@ void parse_rule_nets(
     if ( s_ignore )
         return;
 
-    ProcessIP(sc, s, &rtn, src ? SRC : DST, 0);
+    if ( ProcessIP(sc, s, &rtn, src ? SRC : DST, 0) )
+        return;
+
+    // rule headers are checked per packet so build the lookup table now
+    sfvar_compile(src ? rtn.sip : rtn.dip);
 }
 
 void parse_rule_ports(
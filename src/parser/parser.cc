@@ -37,6 +37,7 @@
 #include <pwd.h>
 #include <fnmatch.h>
 
+#include <chrono>
 #include <iostream>
 #include <string>
 
@@ -68,6 +69,7 @@
 #include "filters/detection_filter.h"
 #include "detection/sfrim.h"
 #include "utils/sfportobject.h"
+#include "utils/stats.h"
 #include "packet_io/active.h"
 #include "file_api/libs/file_config.h"
 #include "actions/actions.h"
@@ -181,27 +183,6 @@ static void FreeOutputLists(ListHead *list)
         EventManager::release_outputs(list->LogList);
 }
 
-/* Finish processing/setup Port Tables */
-static void finish_portlist_table(FastPatternConfig *fp, const char *s, PortTable *pt)
-{
-    PortTableSortUniqRules(pt);
-
-    if( fpDetectGetDebugPrintRuleGroupsUnCompiled(fp) )
-    {
-        LogMessage("***\n***Port-Table : %s Ports/Rules-UnCompiled\n",s);
-        PortTablePrintInputEx( pt, rule_index_map_print_index );
-    }
-
-    PortTableCompile( pt );
-
-    if( fpDetectGetDebugPrintRuleGroupsCompiled(fp) )
-    {
-        LogMessage("***\n***Port-Table : %s Ports/Rules-Compiled\n",s);
-        PortTablePrintCompiledEx( pt, rule_index_map_print_index );
-        LogMessage("*** End of Compiled Group\n");
-    }
-}
-
 static rule_port_tables_t * PortTablesNew(void)
 {
     rule_port_tables_t *rpt =
@@ -301,52 +282,67 @@ static rule_port_tables_t * PortTablesNew(void)
     return rpt;
 }
 
-static void PortTablesFinish(rule_port_tables_t *port_tables, FastPatternConfig *fp)
+// returns the seconds spent compiling the tables
+static double PortTablesFinish(rule_port_tables_t *port_tables, FastPatternConfig *fp)
 {
-    /* TCP-SRC */
-    if (fpDetectGetDebugPrintRuleGroupsCompiled(fp))
+    struct
     {
-        LogMessage("*** TCP-Any-Any Port List\n");
-        PortObjectPrintEx(port_tables->tcp_anyany,
-                          rule_index_map_print_index);
+        const char* name;
+        PortTable* pt;
+        const char* proto;
+        PortObject* anyany;
     }
-
-    finish_portlist_table(fp, "tcp src", port_tables->tcp_src);
-    finish_portlist_table(fp, "tcp dst", port_tables->tcp_dst);
-
-    /* UDP-SRC */
-    if (fpDetectGetDebugPrintRuleGroupsCompiled(fp))
+    tables[] =
+    {
+        { "tcp src", port_tables->tcp_src, "TCP", port_tables->tcp_anyany },
+        { "tcp dst", port_tables->tcp_dst, nullptr, nullptr },
+        { "udp src", port_tables->udp_src, "UDP", port_tables->udp_anyany },
+        { "udp dst", port_tables->udp_dst, nullptr, nullptr },
+        { "icmp src", port_tables->icmp_src, "ICMP", port_tables->icmp_anyany },
+        { "icmp dst", port_tables->icmp_dst, nullptr, nullptr },
+        { "ip src", port_tables->ip_src, "IP", port_tables->ip_anyany },
+        { "ip dst", port_tables->ip_dst, nullptr, nullptr },
+    };
+    const unsigned num_tables = sizeof(tables) / sizeof(tables[0]);
+
+    for ( unsigned i = 0; i < num_tables; ++i )
     {
-        LogMessage("*** UDP-Any-Any Port List\n");
-        PortObjectPrintEx(port_tables->udp_anyany,
-                          rule_index_map_print_index);
+        PortTableSortUniqRules(tables[i].pt);
+
+        if ( fpDetectGetDebugPrintRuleGroupsUnCompiled(fp) )
+        {
+            LogMessage("***\n***Port-Table : %s Ports/Rules-UnCompiled\n", tables[i].name);
+            PortTablePrintInputEx(tables[i].pt, rule_index_map_print_index);
+        }
     }
 
-    finish_portlist_table(fp, "udp src", port_tables->udp_src);
-    finish_portlist_table(fp, "udp dst", port_tables->udp_dst);
+    auto start = std::chrono::steady_clock::now();
 
-    /* ICMP-SRC */
-    if (fpDetectGetDebugPrintRuleGroupsCompiled(fp))
-    {
-        LogMessage("*** ICMP-Any-Any Port List\n");
-        PortObjectPrintEx(port_tables->icmp_anyany,
-                          rule_index_map_print_index);
-    }
+    PortTable* pts[num_tables];
 
-    finish_portlist_table(fp, "icmp src", port_tables->icmp_src);
-    finish_portlist_table(fp, "icmp dst", port_tables->icmp_dst);
+    for ( unsigned i = 0; i < num_tables; ++i )
+        pts[i] = tables[i].pt;
 
-    /* IP-SRC */
-    if (fpDetectGetDebugPrintRuleGroupsCompiled(fp))
+    // each protocol's src and dst tables go to one thread
+    PortTablesCompile(pts, num_tables, fpDetectGetParallelPortTables(fp) != 0);
+
+    std::chrono::duration<double> secs = std::chrono::steady_clock::now() - start;
+
+    if ( fpDetectGetDebugPrintRuleGroupsCompiled(fp) )
     {
-        LogMessage("IP-Any-Any Port List\n");
-        PortObjectPrintEx(port_tables->ip_anyany,
-                          rule_index_map_print_index);
+        for ( unsigned i = 0; i < num_tables; ++i )
+        {
+            if ( tables[i].anyany )
+            {
+                LogMessage("*** %s-Any-Any Port List\n", tables[i].proto);
+                PortObjectPrintEx(tables[i].anyany, rule_index_map_print_index);
+            }
+            LogMessage("***\n***Port-Table : %s Ports/Rules-Compiled\n", tables[i].name);
+            PortTablePrintCompiledEx(tables[i].pt, rule_index_map_print_index);
+            LogMessage("*** End of Compiled Group\n");
+        }
     }
 
-    finish_portlist_table(fp, "ip src", port_tables->ip_src);
-    finish_portlist_table(fp, "ip dst", port_tables->ip_dst);
-
     RuleListSortUniq(port_tables->tcp_anyany->rule_list);
     RuleListSortUniq(port_tables->udp_anyany->rule_list);
     RuleListSortUniq(port_tables->icmp_anyany->rule_list);
@@ -355,6 +351,8 @@ static void PortTablesFinish(rule_port_tables_t *port_tables, FastPatternConfig
     RuleListSortUniq(port_tables->udp_nocontent->rule_list);
     RuleListSortUniq(port_tables->icmp_nocontent->rule_list);
     RuleListSortUniq(port_tables->ip_nocontent->rule_list);
+
+    return secs.count();
 }
 
 static void OtnInit(SnortConfig *sc)
@@ -834,9 +832,12 @@ void ParseRules(SnortConfig *sc)
     /*FindMaxSegSize();*/
 
     /* Compile/Finish and Print the PortList Tables */
-    PortTablesFinish(sc->port_tables, sc->fast_pattern_config);
+    double secs = PortTablesFinish(sc->port_tables, sc->fast_pattern_config);
 
     parse_rule_print();
+
+    if ( get_rule_count() )
+        LogStat("port table compile secs", secs);
 }
 
 /****************************************************************************
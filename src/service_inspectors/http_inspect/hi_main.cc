@@ -79,6 +79,7 @@
 #include "file_api/file_api.h"
 #include "sf_email_attach_decode.h"
 #include "protocols/tcp.h"
+#include "time/shed.h"
 
 const HiSearchToken hi_patterns[] =
 {
@@ -139,6 +140,7 @@ HttpsessionData* SetNewHttpsessionData(Packet *p, void*)
 {
     HttpFlowData* fd = new HttpFlowData;
     p->flow->set_application_data(fd);
+    fd->session.shed_norm = SHED_SKIP(p->flow, SHED_HTTP_NORM, http_norm_skipped);
     return &fd->session;
 }
 
@@ -113,6 +113,7 @@ typedef struct _HttpsessionData
     uint8_t log_flags;
     uint8_t cli_small_chunk_count;
     uint8_t srv_small_chunk_count;
+    bool shed_norm;  /* no decompression or js normalization under load */
     MimeState *mime_ssn;
 } HttpsessionData;
 
@@ -811,7 +811,7 @@ static inline int hi_server_extract_body(
 
 static void SetGzipBuffers(HttpsessionData *hsd, HI_SESSION *session)
 {
-    if ((hsd != NULL) && (hsd->decomp_state == NULL)
+    if ((hsd != NULL) && (hsd->decomp_state == NULL) && !hsd->shed_norm
             && (session != NULL) && (session->server_conf != NULL)
             && (session->global_conf != NULL) && session->server_conf->extract_gzip)
     {
@@ -1603,7 +1603,8 @@ static int HttpResponseInspection(HI_SESSION *session, Packet *p, const unsigned
             }
 
             if ((get_decode_utf_state_charset(&(sd->utf_state)) != CHARSET_DEFAULT)
-                    || (ServerConf->normalize_javascript && Server->response.body_size))
+                    || (ServerConf->normalize_javascript && !sd->shed_norm
+                        && Server->response.body_size))
             {
                 if ( Server->response.body_size < sizeof(HttpDecodeBuf.data) )
                 {
@@ -255,7 +255,8 @@ int hi_server_norm(HI_SESSION *session, HttpsessionData *hsd)
         }
     }
 
-    if (session->server_conf->normalize_javascript && (ServerResp->body_size > 0))
+    if (session->server_conf->normalize_javascript && !(hsd && hsd->shed_norm)
+        && (ServerResp->body_size > 0))
     {
         int js_present, status, index;
         char *ptr, *start, *end;
@@ -27,6 +27,7 @@ namespace NHttpEnums {
 static const int MAXOCTETS = 63780;
 static const int DATABLOCKSIZE = 16384;
 static const uint32_t NHTTP_GID = 219;
+static const int MAX_PIPELINE = 100;
 
 // Field status codes for when no valid value is present in length or integer value. Positive values are actual length
 // or field value.
@@ -40,6 +41,10 @@ typedef enum { SRC__NOTCOMPUTE=-4, SRC_CLIENT=0, SRC_SERVER=1 } SourceId;
 typedef enum { SEC_DISCARD = -10, SEC_CLOSED = -9, SEC_ABORT = -8, SEC__NOTCOMPUTE=-4, SEC__NOTPRESENT=-1,
    SEC_REQUEST = 2, SEC_STATUS, SEC_HEADER, SEC_BODY, SEC_CHUNK, SEC_TRAILER } SectionType;
 
+// Peg counts
+typedef enum { PEG_REQUEST = 0, PEG_RESPONSE, PEG_PIPELINED_FLOWS, PEG_PIPELINED_REQUESTS, PEG_PIPELINE_OVERFLOWS,
+   PEG_PIPELINE_UNDERFLOWS, PEG_COUNT__MAX } PegCounts;
+
 // Result of scanning by splitter
 typedef enum { SCAN_NOTFOUND, SCAN_FOUND, SCAN_DISCARD, SCAN_DISCARD_CONTINUE, SCAN_ABORT } ScanResult;
 
@@ -113,6 +118,7 @@ typedef enum {
    INF_URISLASHDOTDOT,
    INF_URIROOTTRAV,
    INF_TOOMUCHLEADINGWS,
+   INF_PIPELINEOVERFLOW,
 } Infraction;
 
 // Formats for output from a header normalization function
@@ -21,12 +21,14 @@
 #include "nhttp_test_manager.h"
 #include "nhttp_flow_data.h"
 #include "nhttp_transaction.h"
+#include "nhttp_module.h"
 
 using namespace NHttpEnums;
 
 unsigned NHttpFlowData::nhttp_flow_id = 0;
 
-NHttpFlowData::NHttpFlowData() : FlowData(nhttp_flow_id) {
+NHttpFlowData::NHttpFlowData(int max_pipeline_) : FlowData(nhttp_flow_id), max_pipeline(max_pipeline_) {
+    assert(max_pipeline > 0);
     /* FIXIT-L Temporary printf while we shake out stream interface */
     if (!NHttpTestManager::use_test_input() && NHttpTestManager::use_test_output()) {
         printf("Flow Data construct %p\n", (void*)this);
@@ -82,15 +84,22 @@ void NHttpFlowData::show(FILE* out_file) const {
        pipeline_overflow, pipeline_underflow);
 }
 
+// The queue holds one more slot than max_pipeline so that front == back always means empty.
 bool NHttpFlowData::add_to_pipeline(NHttpTransaction* latest) {
     assert(!pipeline_overflow && !pipeline_underflow);
-    int new_back = (pipeline_back+1) % MAX_PIPELINE;
+    if (pipeline == nullptr) {
+        pipeline = new NHttpTransaction*[max_pipeline+1];
+        NHttpModule::increment_peg_counts(PEG_PIPELINED_FLOWS);
+    }
+    int new_back = (pipeline_back+1) % (max_pipeline+1);
     if (new_back == pipeline_front) {
         pipeline_overflow = true;
+        NHttpModule::increment_peg_counts(PEG_PIPELINE_OVERFLOWS);
         return false;
     }
     pipeline[pipeline_back] = latest;
     pipeline_back = new_back;
+    NHttpModule::increment_peg_counts(PEG_PIPELINED_REQUESTS);
     return true;
 }
 
@@ -100,14 +109,19 @@ NHttpTransaction* NHttpFlowData::take_from_pipeline() {
         return nullptr;
     }
     int old_front = pipeline_front;
-    pipeline_front = (pipeline_front+1) % MAX_PIPELINE;
+    pipeline_front = (pipeline_front+1) % (max_pipeline+1);
     return pipeline[old_front];
 }
 
 void NHttpFlowData::delete_pipeline() {
-   for (int k=pipeline_front; k != pipeline_back; k = (k+1) % MAX_PIPELINE) {
+   if (pipeline == nullptr) {
+       return;
+   }
+   for (int k=pipeline_front; k != pipeline_back; k = (k+1) % (max_pipeline+1)) {
        delete pipeline[k];
    }
+   delete[] pipeline;
+   pipeline = nullptr;
 }
 
 
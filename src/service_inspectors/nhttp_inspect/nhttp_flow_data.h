@@ -31,7 +31,7 @@ class NHttpTransaction;
 class NHttpFlowData : public FlowData
 {
 public:
-    NHttpFlowData();
+    NHttpFlowData(int max_pipeline_ = NHttpEnums::MAX_PIPELINE);
     ~NHttpFlowData();
     void show(FILE* out_file) const;
     static unsigned nhttp_flow_id;
@@ -86,9 +86,11 @@ private:
     int64_t body_octets[2] = { NHttpEnums::STAT_NOTPRESENT, NHttpEnums::STAT_NOTPRESENT }; // number of user data octets seen so far (regular body or chunks)
 
     // Transaction management including pipelining
+    // The pipeline is a circular queue of requests still waiting for their responses. It is not allocated until the
+    // client actually pipelines so ordinary flows do not pay for it.
     NHttpTransaction* transaction[2] = { nullptr, nullptr };
-    static const int MAX_PIPELINE = 100;  // requests seen - responses seen <= MAX_PIPELINE
-    NHttpTransaction* pipeline[MAX_PIPELINE];
+    const int max_pipeline;  // requests seen - responses seen <= max_pipeline
+    NHttpTransaction** pipeline = nullptr;
     int pipeline_front = 0;
     int pipeline_back = 0;
     bool pipeline_overflow = false;
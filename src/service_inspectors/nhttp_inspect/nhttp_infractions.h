@@ -29,11 +29,11 @@
 class NHttpInfractions {
 public:
     NHttpInfractions() {};
-    NHttpInfractions(int inf) : infractions(1 << inf) { assert((inf >= 0) && (inf < 64)); };
+    NHttpInfractions(int inf) : infractions((uint64_t)1 << inf) { assert((inf >= 0) && (inf < 64)); };
     bool found_new(int inf) {
        assert((inf >= 0) && (inf < 64));
-       const bool ret_val = ((1 << inf) & infractions & ~previous_infractions) != 0;
-       previous_infractions |= (1 << inf) & infractions;
+       const bool ret_val = (((uint64_t)1 << inf) & infractions & ~previous_infractions) != 0;
+       previous_infractions |= ((uint64_t)1 << inf) & infractions;
        return ret_val; };
     bool none_found() const { return infractions == 0; };
     NHttpInfractions& operator+=(const NHttpInfractions& rhs) { infractions |= rhs.infractions;
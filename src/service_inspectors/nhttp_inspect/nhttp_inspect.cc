@@ -31,11 +31,12 @@
 #include "nhttp_msg_chunk.h"
 #include "nhttp_msg_trailer.h"
 #include "nhttp_test_manager.h"
+#include "nhttp_module.h"
 #include "nhttp_inspect.h"
 
 using namespace NHttpEnums;
 
-NHttpInspect::NHttpInspect(bool test_input, bool test_output)
+NHttpInspect::NHttpInspect(bool test_input, bool test_output, int max_pipeline_) : max_pipeline(max_pipeline_)
 {
     if (test_input) {
         NHttpTestManager::activate_test_input();
@@ -85,8 +86,14 @@ ProcessResult NHttpInspect::process(const uint8_t* data, const uint16_t dsize, F
     NHttpMsgSection *msg_section = nullptr;
 
     switch (session_data->section_type[source_id]) {
-      case SEC_REQUEST: msg_section = new NHttpMsgRequest(data, dsize, session_data, source_id, buf_owner); break;
-      case SEC_STATUS: msg_section = new NHttpMsgStatus(data, dsize, session_data, source_id, buf_owner); break;
+      case SEC_REQUEST:
+        NHttpModule::increment_peg_counts(PEG_REQUEST);
+        msg_section = new NHttpMsgRequest(data, dsize, session_data, source_id, buf_owner);
+        break;
+      case SEC_STATUS:
+        NHttpModule::increment_peg_counts(PEG_RESPONSE);
+        msg_section = new NHttpMsgStatus(data, dsize, session_data, source_id, buf_owner);
+        break;
       case SEC_HEADER: msg_section = new NHttpMsgHeader(data, dsize, session_data, source_id, buf_owner); break;
       case SEC_BODY: msg_section = new NHttpMsgBody(data, dsize, session_data, source_id, buf_owner); break;
       case SEC_CHUNK: msg_section = new NHttpMsgChunk(data, dsize, session_data, source_id, buf_owner); break;
@@ -32,12 +32,13 @@ class NHttpApi;
 
 class NHttpInspect : public Inspector {
 public:
-    NHttpInspect(bool test_input, bool test_output);
+    NHttpInspect(bool test_input, bool test_output, int max_pipeline_);
 
     bool get_buf(InspectionBuffer::Type, Packet*, InspectionBuffer&) override;
     bool get_buf(unsigned, Packet*, InspectionBuffer&) override;
     bool configure(SnortConfig*) override { return true; };
     void show(SnortConfig*) override { LogMessage("NHttpInspect\n"); };
+    int get_max_pipeline() const { return max_pipeline; };
     void eval(Packet*) override { return; };
     void tinit() override {};
     void tterm() override {};
@@ -50,6 +51,8 @@ private:
 
     NHttpEnums::ProcessResult process(const uint8_t* data, const uint16_t dsize, Flow* const flow,
        NHttpEnums::SourceId source_id_, bool buf_owner) const;
+
+    const int max_pipeline;
 };
 
 #endif
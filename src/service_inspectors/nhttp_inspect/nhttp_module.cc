@@ -27,11 +27,24 @@
 const Parameter NHttpModule::nhttp_params[] =
     {{ "test_input", Parameter::PT_BOOL, nullptr, "false", "read HTTP messages from text file" },
      { "test_output", Parameter::PT_BOOL, nullptr, "false", "print out HTTP section data" },
+     { "max_pipeline", Parameter::PT_INT, "1:1000", "100", "maximum number of outstanding pipelined requests per flow" },
      { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }};
 
+const PegInfo NHttpModule::peg_names[NHttpEnums::PEG_COUNT__MAX+1] =
+    {{ "requests", "HTTP request messages inspected" },
+     { "responses", "HTTP response messages inspected" },
+     { "pipelined flows", "flows with more than one outstanding request" },
+     { "pipelined requests", "requests queued behind an outstanding request" },
+     { "pipeline overflows", "requests beyond max_pipeline that could not be queued" },
+     { "pipeline underflows", "responses that arrived without a matching request" },
+     { nullptr, nullptr }};
+
+THREAD_LOCAL PegCount NHttpModule::peg_counts[NHttpEnums::PEG_COUNT__MAX] = { };
+
 bool NHttpModule::begin(const char*, int, SnortConfig*) {
     test_input = false;
     test_output = false;
+    max_pipeline = NHttpEnums::MAX_PIPELINE;
     return true;
 }
 
@@ -42,6 +55,9 @@ bool NHttpModule::set(const char*, Value &val, SnortConfig*) {
     else if (val.is("test_output")) {
         test_output = val.get_bool();
     }
+    else if (val.is("max_pipeline")) {
+        max_pipeline = val.get_long();
+    }
     else {
         return false;
     }
@@ -21,6 +21,8 @@
 #define NHTTP_MODULE_H
 
 #include "framework/module.h"
+#include "framework/counts.h"
+#include "main/thread.h"
 
 #include "nhttp_enum.h"
 
@@ -38,12 +40,19 @@ public:
     const RuleMap* get_rules() const override { return nhttp_events; };
     bool get_test_input() const { return test_input; };
     bool get_test_output() const { return test_output; };
+    int get_max_pipeline() const { return max_pipeline; };
+    const PegInfo* get_pegs() const override { return peg_names; };
+    PegCount* get_counts() const override { return peg_counts; };
+    static void increment_peg_counts(NHttpEnums::PegCounts counter) { peg_counts[counter]++; };
 
 private:
     static const Parameter nhttp_params[];
     static const RuleMap nhttp_events[];
+    static const PegInfo peg_names[];
+    static THREAD_LOCAL PegCount peg_counts[];
     bool test_input = false;
     bool test_output = false;
+    int max_pipeline = NHttpEnums::MAX_PIPELINE;
 };
 
 #endif
@@ -94,6 +94,7 @@ const Field& NHttpMsgRequest::get_uri_norm_legacy() {
 
 void NHttpMsgRequest::gen_events() {
     if (method_id == METH__OTHER) create_event(EVENT_UNKNOWN_METHOD);
+    if (infractions && INF_PIPELINEOVERFLOW) create_event(EVENT_PIPELINE_MAX);
 
     // URI character encoding events
     if (uri && (uri->get_uri_infractions() && INF_URIPERCENTASCII)) create_event(EVENT_ASCII);
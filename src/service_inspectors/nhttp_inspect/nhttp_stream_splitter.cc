@@ -95,7 +95,7 @@ StreamSplitter::Status NHttpStreamSplitter::scan (Flow* flow, const uint8_t* dat
     // here.
     NHttpFlowData* session_data = (NHttpFlowData*)flow->get_application_data(NHttpFlowData::nhttp_flow_id);
     if (session_data == nullptr) {
-        flow->set_application_data(session_data = new NHttpFlowData);
+        flow->set_application_data(session_data = new NHttpFlowData(my_inspector->get_max_pipeline()));
     }
     assert(session_data != nullptr);
 
@@ -107,7 +107,7 @@ StreamSplitter::Status NHttpStreamSplitter::scan (Flow* flow, const uint8_t* dat
         uint8_t* test_data = nullptr;
         NHttpTestManager::get_test_input_source()->scan(test_data, length, source_id, tcp_close, need_break);
         if (need_break) {
-            session_data = new NHttpFlowData;
+            session_data = new NHttpFlowData(my_inspector->get_max_pipeline());
             flow->set_application_data(session_data);
         }
         if (length == 0) {
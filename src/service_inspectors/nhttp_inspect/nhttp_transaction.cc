@@ -25,6 +25,7 @@
 #include "nhttp_msg_status.h"
 #include "nhttp_msg_header.h"
 #include "nhttp_msg_trailer.h"
+#include "nhttp_module.h"
 
 using namespace NHttpEnums;
 
@@ -64,7 +65,9 @@ NHttpTransaction* NHttpTransaction::attach_my_transaction(NHttpFlowData* session
                 delete session_data->transaction[SRC_CLIENT];
             }
             else if (!session_data->add_to_pipeline(session_data->transaction[SRC_CLIENT])) {
-                // The pipeline is full and just overflowed. FIXIT-M we should alert and set infraction.
+                // The pipeline is full and just overflowed. The request section under construction picks up the
+                // infraction and generates the alert.
+                session_data->infractions[SRC_CLIENT] += INF_PIPELINEOVERFLOW;
                 delete session_data->transaction[SRC_CLIENT];
             }
         }
@@ -86,6 +89,7 @@ NHttpTransaction* NHttpTransaction::attach_my_transaction(NHttpFlowData* session
             }
             else {
                 session_data->pipeline_underflow = true;
+                NHttpModule::increment_peg_counts(PEG_PIPELINE_UNDERFLOWS);
                 session_data->transaction[SRC_SERVER] = new NHttpTransaction;
             }
         }
@@ -34,6 +34,7 @@ extern const BaseApi* sin_ftp_server;
 extern const BaseApi* sin_ftp_data;
 extern const BaseApi* sin_nhttp;
 extern const BaseApi* sin_rpc_decode;
+extern const BaseApi* sin_ssl;
 extern const BaseApi* sin_telnet;
 extern const BaseApi* sin_wizard;
 #endif
@@ -50,6 +51,7 @@ const BaseApi* service_inspectors[] =
     sin_ftp_data,
     sin_nhttp,
     sin_rpc_decode,
+    sin_ssl,
     sin_telnet,
     sin_wizard,
 #endif
@@ -0,0 +1,400 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// ssl.cc follows the record layer of SSL/TLS sessions identified by the
+// wizard.  only the 5 byte record headers and the handshake message type
+// are examined; record bodies are skipped.  once the handshake completes
+// and application data flows the payload is useless to rules so the flow
+// is ignored in both directions.  that stops reassembly and detection and
+// gives the remaining packets a whitelist verdict that DAQs supporting it
+// use to offload the flow.
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <assert.h>
+#include <string.h>
+
+#include "ssl_module.h"
+
+#include "detection/detect.h"
+#include "events/event_queue.h"
+#include "flow/flow.h"
+#include "framework/inspector.h"
+#include "log/messages.h"
+#include "packet_io/sfdaq.h"
+#include "protocols/packet.h"
+#include "stream/stream_api.h"
+#include "time/profiler.h"
+
+THREAD_LOCAL ProfileStats sslPerfStats;
+
+//-------------------------------------------------------------------------
+// record layer
+//-------------------------------------------------------------------------
+
+#define SSL_REC_HDR_LEN 5
+#define SSL_REC_MAX_LEN (16384 + 2048)  // TLSCiphertext limit
+
+#define SSL_CHANGE_CIPHER 20
+#define SSL_ALERT         21
+#define SSL_HANDSHAKE     22
+#define SSL_APP_DATA      23
+#define SSL_HEARTBEAT     24
+
+#define SSL_HS_CLIENT_HELLO 1
+#define SSL_HS_SERVER_HELLO 2
+
+#define SSL_CLIENT_HELLO 0x01
+#define SSL_SERVER_HELLO 0x02
+#define SSL_CCS_CLIENT   0x04
+#define SSL_CCS_SERVER   0x08
+#define SSL_APP_CLIENT   0x10
+#define SSL_APP_SERVER   0x20
+#define SSL_DONE         0x40  // encrypted or not ssl; stop scanning
+
+// a record header, and the handshake type that follows it, may be split
+// across segments so each direction buffers up to 6 bytes of it
+struct SslDir
+{
+    uint32_t skip;  // record body bytes still to pass over
+    uint8_t hdr[SSL_REC_HDR_LEN + 1];
+    uint8_t hlen;
+};
+
+class SslFlowData : public FlowData
+{
+public:
+    SslFlowData() : FlowData(flow_id)
+    {
+        memset(dir, 0, sizeof(dir));
+        flags = 0;
+        records = 0;
+    };
+
+    static void init()
+    { flow_id = FlowData::get_flow_id(); };
+
+public:
+    static unsigned flow_id;
+    SslDir dir[2];  // [0] = from client, [1] = from server
+    uint32_t records;
+    uint8_t flags;
+};
+
+unsigned SslFlowData::flow_id = 0;
+
+static bool valid_header(const uint8_t* h)
+{
+    if ( h[0] < SSL_CHANGE_CIPHER || h[0] > SSL_HEARTBEAT )
+        return false;
+
+    // SSL 3.0 through TLS 1.3
+    if ( h[1] != 3 || h[2] > 4 )
+        return false;
+
+    return ((h[3] << 8) | h[4]) <= SSL_REC_MAX_LEN;
+}
+
+static void process_record(
+    SslFlowData* fd, bool c2s, const uint8_t* h, Packet* p)
+{
+    ++sslstats.records;
+    ++fd->records;
+
+    switch ( h[0] )
+    {
+    case SSL_CHANGE_CIPHER:
+        ++sslstats.change_ciphers;
+        fd->flags |= c2s ? SSL_CCS_CLIENT : SSL_CCS_SERVER;
+        break;
+
+    case SSL_ALERT:
+        ++sslstats.alerts;
+        break;
+
+    case SSL_APP_DATA:
+        fd->flags |= c2s ? SSL_APP_CLIENT : SSL_APP_SERVER;
+        break;
+
+    case SSL_HANDSHAKE:
+        // handshake messages are encrypted after change cipher spec
+        if ( fd->flags & (c2s ? SSL_CCS_CLIENT : SSL_CCS_SERVER) )
+            break;
+
+        if ( c2s && h[5] == SSL_HS_CLIENT_HELLO )
+        {
+            ++sslstats.client_hellos;
+
+            if ( fd->flags & SSL_SERVER_HELLO )
+                SnortEventqAdd(GID_SSL, SSL_INVALID_CLIENT_HELLO);
+
+            fd->flags |= SSL_CLIENT_HELLO;
+        }
+        else if ( !c2s && h[5] == SSL_HS_SERVER_HELLO )
+        {
+            ++sslstats.server_hellos;
+
+            if ( !(fd->flags & SSL_CLIENT_HELLO) && !stream.is_midstream(p->flow) )
+                SnortEventqAdd(GID_SSL, SSL_INVALID_SERVER_HELLO);
+
+            fd->flags |= SSL_SERVER_HELLO;
+        }
+        break;
+    }
+}
+
+// SSLv2 compatible client hello: 2 byte length with the high bit set
+// followed by message type 1; only accepted as the first client record
+static bool sslv2_hello(SslFlowData* fd, SslDir& d, const uint8_t* data, unsigned len)
+{
+    if ( fd->records || len < 3 || !(data[0] & 0x80) || data[2] != SSL_HS_CLIENT_HELLO )
+        return false;
+
+    ++sslstats.records;
+    ++sslstats.client_hellos;
+    ++fd->records;
+
+    fd->flags |= SSL_CLIENT_HELLO;
+    d.skip = (((data[0] & 0x7F) << 8) | data[1]) + 2;
+    return true;
+}
+
+// returns false when the data is not SSL/TLS
+static bool scan(SslFlowData* fd, bool c2s, const uint8_t* data, unsigned len, Packet* p)
+{
+    SslDir& d = fd->dir[c2s ? 0 : 1];
+
+    if ( c2s && !d.hlen && !d.skip )
+        sslv2_hello(fd, d, data, len);
+
+    while ( len )
+    {
+        if ( d.skip )
+        {
+            unsigned n = (d.skip < len) ? d.skip : len;
+            d.skip -= n;
+            data += n;
+            len -= n;
+            continue;
+        }
+
+        while ( d.hlen < SSL_REC_HDR_LEN && len )
+        {
+            d.hdr[d.hlen++] = *data++;
+            --len;
+        }
+
+        if ( d.hlen < SSL_REC_HDR_LEN )
+            break;
+
+        if ( !valid_header(d.hdr) )
+            return false;
+
+        uint32_t rec_len = (d.hdr[3] << 8) | d.hdr[4];
+
+        if ( d.hdr[0] == SSL_HANDSHAKE && rec_len )
+        {
+            if ( d.hlen == SSL_REC_HDR_LEN )
+            {
+                if ( !len )
+                    break;
+
+                d.hdr[d.hlen++] = *data++;
+                --len;
+            }
+        }
+        else
+            d.hdr[SSL_REC_HDR_LEN] = 0;
+
+        process_record(fd, c2s, d.hdr, p);
+
+        d.skip = rec_len - (d.hlen - SSL_REC_HDR_LEN);
+        d.hlen = 0;
+    }
+    return true;
+}
+
+static bool is_encrypted(const SslConfig* conf, uint8_t f)
+{
+    if ( !(f & SSL_SERVER_HELLO) )
+        return false;
+
+    // TLS 1.2 and earlier: both sides switched ciphers
+    if ( (f & SSL_CCS_CLIENT) && (f & SSL_CCS_SERVER) &&
+        (f & (SSL_APP_CLIENT | SSL_APP_SERVER)) )
+        return true;
+
+    // TLS 1.3 encrypts everything after the server hello
+    if ( (f & SSL_APP_CLIENT) && (f & SSL_APP_SERVER) )
+        return true;
+
+    return conf->trust_servers && (f & SSL_APP_SERVER);
+}
+
+//-------------------------------------------------------------------------
+// class stuff
+//-------------------------------------------------------------------------
+
+class Ssl : public Inspector
+{
+public:
+    Ssl(SslConfig*);
+    ~Ssl();
+
+    void show(SnortConfig*) override;
+    void eval(Packet*) override;
+
+private:
+    void bypass(Packet*);
+
+private:
+    SslConfig* config;
+};
+
+Ssl::Ssl(SslConfig* pc)
+{
+    config = pc;
+}
+
+Ssl::~Ssl()
+{
+    if ( config )
+        delete config;
+}
+
+void Ssl::show(SnortConfig*)
+{
+    LogMessage("%s\n", SSL_NAME);
+    LogMessage("    inspect_encrypted: %s\n", config->inspect_encrypted ? "true" : "false");
+    LogMessage("    trust_servers: %s\n", config->trust_servers ? "true" : "false");
+}
+
+void Ssl::bypass(Packet* p)
+{
+    ++sslstats.bypassed;
+
+    if ( DAQ_CanWhitelist() )
+        ++sslstats.offloaded;
+
+    // ignoring both directions flushes what is queued, disables
+    // detection, and makes later packets whitelist verdicts
+    stream.stop_inspection(p->flow, p, SSN_DIR_BOTH, -1, 0);
+}
+
+void Ssl::eval(Packet* p)
+{
+    PROFILE_VARS;
+
+    // precondition - what we registered for
+    assert(p->flow);
+
+    SslFlowData* fd =
+        (SslFlowData*)p->flow->get_application_data(SslFlowData::flow_id);
+
+    if ( !fd )
+    {
+        fd = new SslFlowData;
+        p->flow->set_application_data(fd);
+    }
+    else if ( fd->flags & SSL_DONE )
+        return;
+
+    MODULE_PROFILE_START(sslPerfStats);
+    ++sslstats.packets;
+
+    bool c2s = (p->packet_flags & PKT_FROM_CLIENT) != 0;
+
+    if ( !scan(fd, c2s, p->data, p->dsize, p) )
+    {
+        ++sslstats.unrecognized;
+        fd->flags |= SSL_DONE;
+    }
+    else if ( is_encrypted(config, fd->flags) )
+    {
+        fd->flags |= SSL_DONE;
+
+        if ( !config->inspect_encrypted )
+            bypass(p);
+    }
+
+    MODULE_PROFILE_END(sslPerfStats);
+}
+
+//-------------------------------------------------------------------------
+// api stuff
+//-------------------------------------------------------------------------
+
+static Module* mod_ctor()
+{ return new SslModule; }
+
+static void mod_dtor(Module* m)
+{ delete m; }
+
+static void ssl_init()
+{
+    SslFlowData::init();
+}
+
+static Inspector* ssl_ctor(Module* m)
+{
+    SslModule* mod = (SslModule*)m;
+    return new Ssl(mod->get_data());
+}
+
+static void ssl_dtor(Inspector* p)
+{
+    delete p;
+}
+
+static const InspectApi ssl_api =
+{
+    {
+        PT_INSPECTOR,
+        SSL_NAME,
+        SSL_HELP,
+        INSAPI_PLUGIN_V0,
+        0,
+        mod_ctor,
+        mod_dtor
+    },
+    IT_SERVICE,
+    (uint16_t)PktType::TCP,
+    nullptr, // buffers
+    "ssl",
+    ssl_init,
+    nullptr, // pterm
+    nullptr, // tinit
+    nullptr, // tterm
+    ssl_ctor,
+    ssl_dtor,
+    nullptr, // ssn
+    nullptr  // reset
+};
+
+#ifdef BUILDING_SO
+SO_PUBLIC const BaseApi* snort_plugins[] =
+{
+    &ssl_api.base,
+    nullptr
+};
+#else
+const BaseApi* sin_ssl = &ssl_api.base;
+#endif
+
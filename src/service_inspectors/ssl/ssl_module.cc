@@ -0,0 +1,121 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// ssl_module.cc
+
+#include "ssl_module.h"
+
+#define SSL_INVALID_CLIENT_HELLO_STR \
+    "client hello after server hello"
+#define SSL_INVALID_SERVER_HELLO_STR \
+    "server hello without client hello"
+
+THREAD_LOCAL SslStats sslstats;
+
+static const PegInfo ssl_pegs[] =
+{
+    { "packets", "total packets processed" },
+    { "records", "TLS records seen" },
+    { "client hellos", "client hello messages" },
+    { "server hellos", "server hello messages" },
+    { "change ciphers", "change cipher spec records" },
+    { "alerts", "alert records" },
+    { "unrecognized", "flows that stopped looking like SSL/TLS" },
+    { "bypassed", "encrypted flows no longer inspected" },
+    { "offloaded", "bypassed flows whitelisted by the DAQ" },
+    { nullptr, nullptr }
+};
+
+static const Parameter s_params[] =
+{
+    { "inspect_encrypted", Parameter::PT_BOOL, nullptr, "false",
+      "keep inspecting the flow once application data is encrypted" },
+
+    { "trust_servers", Parameter::PT_BOOL, nullptr, "false",
+      "bypass on server application data without waiting for the client" },
+
+    { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
+};
+
+static const RuleMap ssl_rules[] =
+{
+    { SSL_INVALID_CLIENT_HELLO, SSL_INVALID_CLIENT_HELLO_STR },
+    { SSL_INVALID_SERVER_HELLO, SSL_INVALID_SERVER_HELLO_STR },
+
+    { 0, nullptr }
+};
+
+//-------------------------------------------------------------------------
+// ssl module
+//-------------------------------------------------------------------------
+
+SslModule::SslModule() : Module(SSL_NAME, SSL_HELP, s_params)
+{
+    conf = nullptr;
+}
+
+SslModule::~SslModule()
+{
+    if ( conf )
+        delete conf;
+}
+
+const RuleMap* SslModule::get_rules() const
+{ return ssl_rules; }
+
+const PegInfo* SslModule::get_pegs() const
+{ return ssl_pegs; }
+
+PegCount* SslModule::get_counts() const
+{ return (PegCount*)&sslstats; }
+
+ProfileStats* SslModule::get_profile() const
+{ return &sslPerfStats; }
+
+SslConfig* SslModule::get_data()
+{
+    SslConfig* tmp = conf;
+    conf = nullptr;
+    return tmp;
+}
+
+bool SslModule::begin(const char*, int, SnortConfig*)
+{
+    if ( !conf )
+    {
+        conf = new SslConfig;
+        conf->inspect_encrypted = false;
+        conf->trust_servers = false;
+    }
+    return true;
+}
+
+bool SslModule::set(const char*, Value& v, SnortConfig*)
+{
+    if ( v.is("inspect_encrypted") )
+        conf->inspect_encrypted = v.get_bool();
+
+    else if ( v.is("trust_servers") )
+        conf->trust_servers = v.get_bool();
+
+    else
+        return false;
+
+    return true;
+}
+
@@ -0,0 +1,81 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// ssl_module.h
+
+#ifndef SSL_MODULE_H
+#define SSL_MODULE_H
+
+#include "framework/module.h"
+#include "main/thread.h"
+
+#define GID_SSL 137
+
+#define SSL_INVALID_CLIENT_HELLO   1
+#define SSL_INVALID_SERVER_HELLO   2
+
+#define SSL_NAME "ssl"
+#define SSL_HELP "track SSL/TLS handshakes and stop inspecting encrypted data"
+
+struct SslStats
+{
+    PegCount packets;
+    PegCount records;
+    PegCount client_hellos;
+    PegCount server_hellos;
+    PegCount change_ciphers;
+    PegCount alerts;
+    PegCount unrecognized;
+    PegCount bypassed;
+    PegCount offloaded;
+};
+
+extern THREAD_LOCAL SslStats sslstats;
+extern THREAD_LOCAL ProfileStats sslPerfStats;
+
+struct SslConfig
+{
+    bool inspect_encrypted;
+    bool trust_servers;
+};
+
+class SslModule : public Module
+{
+public:
+    SslModule();
+    ~SslModule();
+
+    bool set(const char*, Value&, SnortConfig*) override;
+    bool begin(const char*, int, SnortConfig*) override;
+
+    unsigned get_gid() const override
+    { return GID_SSL; };
+
+    const RuleMap* get_rules() const override;
+    const PegInfo* get_pegs() const override;
+    PegCount* get_counts() const override;
+    ProfileStats* get_profile() const override;
+
+    SslConfig* get_data();
+
+private:
+    SslConfig* conf;
+};
+
+#endif
+
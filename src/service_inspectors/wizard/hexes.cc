@@ -15,19 +15,16 @@
 // with this program; if not, write to the Free Software Foundation, Inc.,
 // 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 //--------------------------------------------------------------------------
-// magic.cc author Russ Combs <rucombs@cisco.com>
+// hexes.cc author Russ Combs <rucombs@cisco.com>
 
 #include <ctype.h>
 #include <stdlib.h>
-#include <strings.h>
 
 #include "magic.h"
 
 using namespace std;
 
-#define WILD 0x100
-
-bool HexBook::translate(const char* in, HexVector& out)
+static bool translate(const char* in, HexVector& out)
 {
     bool hex = false;
     string byte;
@@ -45,9 +42,9 @@ bool HexBook::translate(const char* in, HexVector& out)
         else if ( !hex )
         {
             if ( in[i] == '?' )
-                out.push_back(WILD);
+                out.push_back(MAGIC_WILD);
             else
-                out.push_back(in[i]);
+                out.push_back((uint8_t)in[i]);
         }
         else if ( in[i] != ' ' )
         {
@@ -56,7 +53,7 @@ bool HexBook::translate(const char* in, HexVector& out)
 
             byte += in[i];
         }
-        else 
+        else
             push = true;
 
         if ( push && byte.size() )
@@ -70,99 +67,13 @@ bool HexBook::translate(const char* in, HexVector& out)
     return true;
 }
 
-//-------------------------------------------------------------------------
-
-void HexBook::add_spell(
-    const char* key, const char* val, HexVector& hv, unsigned i, MagicPage* p)
-{
-    while ( i < hv.size() )
-    {
-        MagicPage* t = new MagicPage(*this);
-        int c = hv[i];
-
-        if ( c == WILD )
-            p->any = t;
-        else
-            p->next[c] = t;
-
-        p = t;
-        ++i;
-    }
-    p->key = key;
-    p->value = val;
-}
-
-bool HexBook::add_spell(const char* key, const char* val)
+bool MagicBook::add_hex(const char* key, const char* val)
 {
     HexVector hv;
 
     if ( !translate(key, hv) )
         return false;
 
-    unsigned i = 0;
-    MagicPage* p = root;
-
-    while ( i < hv.size() )
-    {
-        int c = hv[i];
-
-        if ( c == WILD && p->any )
-            p = p->any;
-
-        else if ( p->next[c] )
-            p = p->next[c];
-
-        else
-            break;
-
-        ++i;
-    }
-    if ( p->key == key )
-        return false;
-
-    add_spell(key, val, hv, i, p);
-    return true;
-}
-
-const MagicPage* HexBook::find_spell(
-    const uint8_t* s, unsigned n, const MagicPage* p, unsigned i) const
-{
-    while ( i < n )
-    {
-        int c = s[i];
-
-        if ( p->next[c] )
-        {
-            if ( p->any )
-            {
-                if ( const MagicPage* q = find_spell(s, n, p->next[c], i+1) )
-                    return q;
-            }
-            else
-            {
-                p = p->next[c];
-                ++i;
-                continue;
-            }
-        }
-        if ( p->any )
-        {
-            if ( const MagicPage* q = find_spell(s, n, p->any, i+1) )
-                return q;
-        }
-        break;
-    }
-    return p;
+    return add(key, val, hv, true);
 }
 
-const char* HexBook::find_spell(
-    const uint8_t* data, unsigned len, const MagicPage*& p) const
-{
-    p = find_spell(data, len, p, 0);
-
-    if ( !p->value.empty() )
-        return p->value.c_str();
-
-    return nullptr;
-}
- 
@@ -19,25 +19,277 @@
 
 #include "magic.h"
 
-MagicPage::MagicPage(const MagicBook& b) : book(b)
-{ 
-    for ( int i = 0; i < 256; ++i ) next[i] = nullptr;
-    any = nullptr;
-}
+#include <ctype.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+
+using namespace std;
+
+// the shortest prefix scanned before giving up; a longer hex or spell
+// raises it to its own length
+#define MAGIC_MIN_DEPTH 16
+
+// bounds the subset construction; real books need a few hundred
+#define MAGIC_MAX_STATES 65536
 
-MagicPage::~MagicPage()
-{ 
-    for ( int i = 0; i < 256; ++i ) 
+//-------------------------------------------------------------------------
+// compilation is a subset construction over the positions of all spells
+// or hexes.  a position is (spell, index of the next element to match);
+// a glob matches zero bytes by also holding the following position and
+// any number of bytes by holding itself.  a spell that has matched
+// nothing yet also holds itself on whitespace.
+//-------------------------------------------------------------------------
+
+typedef pair<unsigned, unsigned> MagicPos;
+typedef vector<MagicPos> MagicSet;
+
+static inline bool is_space(int c)
+{ return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+static void insert(const HexVector& hv, MagicSet& set, unsigned s, unsigned i)
+{
+    while ( true )
     {
-        if ( next[i] && next[i] != this )
-            delete next[i];
+        set.push_back(MagicPos(s, i));
+
+        if ( i >= hv.size() || hv[i] != MAGIC_GLOB )
+            break;
+
+        ++i;
     }
-    delete any;
+}
+
+static void normalize(MagicSet& set)
+{
+    sort(set.begin(), set.end());
+    set.erase(unique(set.begin(), set.end()), set.end());
 }
 
 MagicBook::MagicBook()
-{ root = new MagicPage(*this); }
+{
+    max_depth = MAGIC_MIN_DEPTH;
+    hexes.classes = texts.classes = 0;
+}
+
+MagicBook::~MagicBook() { }
+
+bool MagicBook::add(
+    const char* key, const char* val, HexVector& hv, bool hex)
+{
+    for ( auto& s : spells )
+    {
+        if ( s.hex == hex && s.hv == hv )
+            return false;
+    }
+    Spell s;
+    s.hv.swap(hv);
+    s.key = key;
+    s.value = val;
+    s.hex = hex;
+
+    spells.push_back(s);
+
+    if ( s.hv.size() > max_depth )
+        max_depth = s.hv.size();
+
+    return true;
+}
+
+bool MagicBook::compile(MagicDfa& dfa, bool hex)
+{
+    // byte classes - bytes that no element or whitespace skip can tell
+    // apart share a column in the transition table
+    vector<unsigned> preds;
+
+    for ( auto& s : spells )
+    {
+        if ( s.hex != hex )
+            continue;
+
+        for ( auto e : s.hv )
+        {
+            if ( e < MAGIC_WILD )
+                preds.push_back(hex ? e : toupper(e));
+        }
+    }
+    sort(preds.begin(), preds.end());
+    preds.erase(unique(preds.begin(), preds.end()), preds.end());
+
+    map<string, unsigned> sigs;
+    vector<int> reps;
+
+    for ( int b = 0; b < 256; ++b )
+    {
+        string sig;
+
+        for ( auto p : preds )
+            sig += ((int)p == (hex ? b : toupper(b))) ? '1' : '0';
+
+        if ( !hex )
+            sig += is_space(b) ? '1' : '0';
+
+        auto it = sigs.find(sig);
+
+        if ( it == sigs.end() )
+        {
+            it = sigs.insert(make_pair(sig, reps.size())).first;
+            reps.push_back(b);
+        }
+        dfa.xlat[b] = it->second;
+    }
+    dfa.classes = reps.size();
+    dfa.trans.clear();
+    dfa.accept.clear();
+
+    // states - 0 is dead and 1 is the start
+    map<MagicSet, unsigned> ids;
+    vector<MagicSet> sets(2);
+
+    for ( unsigned s = 0; s < spells.size(); ++s )
+    {
+        if ( spells[s].hex == hex )
+            insert(spells[s].hv, sets[1], s, 0);
+    }
+    if ( sets[1].empty() )
+        return true;
+
+    normalize(sets[1]);
+    ids[sets[0]] = 0;
+    ids[sets[1]] = 1;
+
+    for ( unsigned n = 0; n < sets.size(); ++n )
+    {
+        unsigned hit = 0;
+
+        // the first added wins a tie
+        for ( auto& p : sets[n] )
+        {
+            if ( p.second == spells[p.first].hv.size() && !hit )
+                hit = p.first + 1;
+        }
+        dfa.accept.push_back(hit);
+
+        for ( unsigned k = 0; k < dfa.classes; ++k )
+        {
+            int b = reps[k];
+            MagicSet next;
+
+            for ( auto& p : sets[n] )
+            {
+                const HexVector& hv = spells[p.first].hv;
+                unsigned i = p.second;
+
+                if ( !hex && !i && is_space(b) )
+                    insert(hv, next, p.first, 0);
+
+                if ( i >= hv.size() )
+                    continue;
+
+                uint16_t e = hv[i];
+
+                if ( e == MAGIC_GLOB )
+                    insert(hv, next, p.first, i);
+
+                else if ( e == MAGIC_WILD || (hex ? e == b : toupper(e) == toupper(b)) )
+                    insert(hv, next, p.first, i + 1);
+            }
+            normalize(next);
+
+            auto it = ids.find(next);
+
+            if ( it == ids.end() )
+            {
+                if ( sets.size() >= MAGIC_MAX_STATES )
+                {
+                    dfa.trans.clear();
+                    dfa.accept.clear();
+                    return false;
+                }
+                it = ids.insert(make_pair(next, sets.size())).first;
+                sets.push_back(next);
+            }
+            dfa.trans.push_back(it->second);
+        }
+    }
+    return true;
+}
+
+bool MagicBook::compile()
+{
+    return compile(hexes, true) && compile(texts, false);
+}
+
+void MagicBook::reset(MagicState& ms) const
+{
+    ms.hex = hexes.accept.empty() ? 0 : 1;
+    ms.spell = texts.accept.empty() ? 0 : 1;
+    ms.depth = 0;
+    ms.hit = 0;
 
-MagicBook::~MagicBook()
-{ delete root; }
+    if ( ms.hex && hexes.accept[1] )
+    {
+        ms.hit = hexes.accept[1];
+        ms.spell = 0;
+    }
+    else if ( ms.spell )
+        ms.hit = texts.accept[1];
+}
+
+const char* MagicBook::find_spell(
+    const uint8_t* data, unsigned len, MagicState& ms, unsigned& scanned) const
+{
+    unsigned h = ms.hex;
+    unsigned s = ms.spell;
+    unsigned hit = ms.hit;
+    unsigned n = 0;
+
+    if ( len > max_depth - ms.depth )
+        len = max_depth - ms.depth;
+
+    const uint32_t* ht = hexes.trans.data();
+    const uint32_t* ha = hexes.accept.data();
+    const uint32_t* st = texts.trans.data();
+    const uint32_t* sa = texts.accept.data();
+
+    // any hex beats any spell so spells are dropped on the first hex hit
+    while ( n < len && (h || s) )
+    {
+        unsigned c = data[n++];
+
+        if ( h )
+        {
+            h = ht[h * hexes.classes + hexes.xlat[c]];
+
+            if ( ha[h] )
+            {
+                hit = ha[h];
+                s = 0;
+            }
+        }
+        if ( s )
+        {
+            s = st[s * texts.classes + texts.xlat[c]];
+
+            if ( sa[s] )
+                hit = sa[s];
+        }
+    }
+    ms.depth += n;
+
+    if ( ms.depth >= max_depth )
+        h = s = 0;
+
+    ms.hex = h;
+    ms.spell = s;
+    ms.hit = hit;
+
+    scanned = n;
+
+    if ( hit )
+        return spells[hit-1].value.c_str();
+
+    return nullptr;
+}
 
@@ -17,84 +17,101 @@
 //--------------------------------------------------------------------------
 // magic.h author Russ Combs <rucombs@cisco.com>
 
+#include <stdint.h>
+
 #include <string>
 #include <vector>
 
 #ifndef MAGIC_H
 #define MAGIC_H
 
-class MagicBook;
-
-struct MagicPage
-{
-    std::string key;
-    std::string value;
-
-    MagicPage* next[256];
-    MagicPage* any;
+typedef std::vector<uint16_t> HexVector;
 
-    const MagicBook& book;
+// HexVector elements other than literal bytes
+#define MAGIC_WILD 0x100  // exactly one arbitrary byte
+#define MAGIC_GLOB 0x200  // any number of arbitrary bytes
 
-    MagicPage(const MagicBook&);
-    ~MagicPage();
+// position of one flow direction in a compiled book.  a state of 0 is
+// dead: no further data can match anything of that kind.
+struct MagicState
+{
+    unsigned hex;
+    unsigned spell;
+    unsigned depth;
+    unsigned hit;
 };
 
-typedef std::vector<uint16_t> HexVector;
+//-------------------------------------------------------------------------
+// a book holds all the spells and hexes for one direction and compiles
+// them into anchored dfas, one per kind, that are stepped together so the
+// service is identified in one pass over the first bytes of the flow,
+// resuming across segments.  (a single product dfa would multiply the
+// states of long wild hexes by those of the spells.)
+//
+// spells - a sequence of case insensitive text strings with wild cards
+// designated by * (indicating any number of arbitrary bytes).  leading
+// whitespace in the data is skipped.
+//
+// hexes - a sequence of pipe delimited hex, text literals, and wild chars
+// designated by '?' (indicating one arbitrary byte)
+//
+// when several match, a hex wins over a spell and a longer match wins
+// over a shorter one.  the dfas give up after max_depth bytes so globs
+// can't scan the whole flow.
+//-------------------------------------------------------------------------
 
 class MagicBook
 {
 public:
-    virtual ~MagicBook();
+    MagicBook();
+    ~MagicBook();
 
-    virtual bool add_spell(const char* key, const char* val) = 0;
-    virtual const char* find_spell(const uint8_t*, unsigned len, const MagicPage*&) const = 0;
+    bool add_spell(const char* key, const char* val);
+    bool add_hex(const char* key, const char* val);
 
-    const MagicPage* page1()
-    { return root; };
+    // must be called after the last add and before the first find
+    bool compile();
 
-protected:
-    MagicBook();
-    MagicPage* root;
-};
+    void reset(MagicState&) const;
 
-//-------------------------------------------------------------------------
-// spells - a sequence of case insensitive text strings with wild cards
-// designated by * (indicating any number of arbitrary bytes)
-//-------------------------------------------------------------------------
+    // scan data from the given state.  returns the service if identified
+    // and sets scanned to the number of bytes examined.
+    const char* find_spell(
+        const uint8_t*, unsigned len, MagicState&, unsigned& scanned) const;
 
-class SpellBook : public MagicBook
-{
-public:
-    SpellBook();
-    ~SpellBook() { };
+    bool done(const MagicState& s) const
+    { return !s.hex && !s.spell; }
 
-    bool add_spell(const char*, const char*);
-    const char* find_spell(const uint8_t*, unsigned len, const MagicPage*&) const;
+    unsigned get_state_count() const
+    { return hexes.accept.size() + texts.accept.size(); }
 
 private:
-    bool translate(const char*, HexVector&);
-    void add_spell(const char*, const char*, HexVector&, unsigned, MagicPage*);
-    const MagicPage* find_spell(const uint8_t*, unsigned, const MagicPage*, unsigned) const;
-};
+    struct Spell
+    {
+        HexVector hv;
+        std::string key;
+        std::string value;
+        bool hex;
+    };
 
-//-------------------------------------------------------------------------
-// hexes - a sequence of pipe delimited hex, text literals, and wild chars
-// designated by '?' (indicating one arbitrary byte)
-//-------------------------------------------------------------------------
+    struct MagicDfa
+    {
+        uint16_t xlat[256];            // byte -> equivalence class
+        unsigned classes;
 
-class HexBook : public MagicBook
-{
-public:
-    HexBook() { };
-    ~HexBook() { };
+        std::vector<uint32_t> trans;   // state * classes -> state
+        std::vector<uint32_t> accept;  // state -> spell index + 1 or 0
+    };
 
-    bool add_spell(const char*, const char*);
-    const char* find_spell(const uint8_t*, unsigned len, const MagicPage*&) const;
+    bool add(const char* key, const char* val, HexVector&, bool hex);
+    bool compile(MagicDfa&, bool hex);
 
-private:
-    bool translate(const char*, HexVector&);
-    void add_spell(const char*, const char*, HexVector&, unsigned, MagicPage*);
-    const MagicPage* find_spell(const uint8_t*, unsigned, const MagicPage*, unsigned) const;
+    std::vector<Spell> spells;
+
+    MagicDfa hexes;
+    MagicDfa texts;
+
+    unsigned max_depth;
 };
 
 #endif
@@ -17,25 +17,9 @@
 //--------------------------------------------------------------------------
 // spells.cc author Russ Combs <rucombs@cisco.com>
 
-#include <ctype.h>
-#include <strings.h>
-
 #include "magic.h"
 
-using namespace std;
-
-#define WILD 0x100
-
-SpellBook::SpellBook()
-{
-    // allows skipping leading whitespace only
-    root->next[(int)' '] = root;
-    root->next[(int)'\t'] = root;
-    root->next[(int)'\r'] = root;
-    root->next[(int)'\n'] = root;
-}
-
-bool SpellBook::translate(const char* in, HexVector& out)
+static bool translate(const char* in, HexVector& out)
 {
     bool wild = false;
     unsigned i = 0;
@@ -45,9 +29,9 @@ bool SpellBook::translate(const char* in, HexVector& out)
         if ( wild )
         {
             if ( in[i] != '*' )
-                out.push_back(WILD);
+                out.push_back(MAGIC_GLOB);
 
-            out.push_back(in[i]);
+            out.push_back((uint8_t)in[i]);
             wild = false;
         }
         else
@@ -55,113 +39,20 @@ bool SpellBook::translate(const char* in, HexVector& out)
             if ( in[i] == '*' )
                 wild = true;
             else
-                out.push_back(in[i]);
+                out.push_back((uint8_t)in[i]);
         }
         ++i;
     }
     return true;
 }
 
-void SpellBook::add_spell(
-    const char* key, const char* val, HexVector& hv, unsigned i, MagicPage* p)
-{
-    while ( i < hv.size() )
-    {
-        MagicPage* t = new MagicPage(*this);
-
-        if ( hv[i] == WILD )
-            p->any = t;
-        else
-            p->next[toupper(hv[i])] = t;
-
-        p = t;
-        ++i;
-    }
-    p->key = key;
-    p->value = val;
-}
-
-bool SpellBook::add_spell(const char* key, const char* val)
+bool MagicBook::add_spell(const char* key, const char* val)
 {
     HexVector hv;
 
     if ( !translate(key, hv) )
         return false;
 
-    unsigned i = 0;
-    MagicPage* p = root;
-
-    while ( i < hv.size() )
-    {
-        int c = toupper(hv[i]);
-
-        if ( c == WILD && p->any )
-            p = p->any;
-
-        else if ( p->next[c] )
-            p = p->next[c];
-
-        else
-            break;
-
-        ++i;
-    }
-    if ( p->key == key )
-        return false;
-
-    add_spell(key, val, hv, i, p);
-    return true;
-}
-
-const MagicPage* SpellBook::find_spell(
-    const uint8_t* s, unsigned n, const MagicPage* p, unsigned i) const
-{
-    while ( i < n )
-    {
-        int c = toupper(s[i]);
-
-        if ( p->next[c] )
-        {
-            if ( p->any )
-            {
-                if ( const MagicPage* q = find_spell(s, n, p->next[c], i+1) )
-                    return q;
-            }
-            else
-            {
-                p = p->next[c];
-                ++i;
-                continue;
-            }
-        }
-        if ( p->any )
-        {
-            while ( i < n )
-            {
-                if ( const MagicPage* q = find_spell(s, n, p->any, i) )
-                    return q;
-                ++i;
-            }
-        }
-        break;
-    }
-    return p;
+    return add(key, val, hv, false);
 }
 
-const char* SpellBook::find_spell(
-    const uint8_t* data, unsigned len, const MagicPage*& p) const
-{
-    // FIXIT-L make configurable upper bound to limit globbing
-    unsigned max = 16;
-
-    if ( len > max )
-        len = max;
-    
-    p = find_spell(data, len, p, 0);
-
-    if ( !p->value.empty() )
-        return p->value.c_str();
-
-    return nullptr;
-}
- 
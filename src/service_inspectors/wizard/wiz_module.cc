@@ -102,19 +102,14 @@ static const Parameter s_params[] =
 
 WizardModule::WizardModule() : Module(WIZ_NAME, WIZ_HELP, s_params)
 {
-    c2s_hexes = nullptr;
-    s2c_hexes = nullptr;
-    c2s_spells = nullptr;
-    s2c_spells = nullptr;
+    c2s_book = nullptr;
+    s2c_book = nullptr;
 }
 
 WizardModule::~WizardModule()
 {
-    delete c2s_hexes;
-    delete s2c_hexes;
-
-    delete c2s_spells;
-    delete s2c_spells;
+    delete c2s_book;
+    delete s2c_book;
 }
 
 ProfileStats* WizardModule::get_profile() const
@@ -148,11 +143,11 @@ bool WizardModule::begin(const char* fqn, int, SnortConfig*)
 {
     if ( !strcmp(fqn, "wizard") )
     {
-        c2s_hexes = new HexBook;
-        s2c_hexes = new HexBook;
+        delete c2s_book;
+        delete s2c_book;
 
-        c2s_spells = new SpellBook;
-        s2c_spells = new SpellBook;
+        c2s_book = new MagicBook;
+        s2c_book = new MagicBook;
     }
     else if ( !strcmp(fqn, "wizard.hexes") )
         hex = true;
@@ -178,7 +173,12 @@ bool WizardModule::begin(const char* fqn, int, SnortConfig*)
 void WizardModule::add_spells(MagicBook* b, string& service)
 {
     for ( auto p : spells )
-        b->add_spell(p.c_str(), service.c_str());
+    {
+        if ( hex )
+            b->add_hex(p.c_str(), service.c_str());
+        else
+            b->add_spell(p.c_str(), service.c_str());
+    }
 }
 
 bool WizardModule::end(const char*, int idx, SnortConfig*)
@@ -186,56 +186,23 @@ bool WizardModule::end(const char*, int idx, SnortConfig*)
     if ( !idx )
         return true;
 
-    if ( hex )
-    {
-        if ( c2s )
-            add_spells(c2s_hexes, service);
-        else
-            add_spells(s2c_hexes, service);
-    }
+    if ( c2s )
+        add_spells(c2s_book, service);
     else
-    {
-        if ( c2s )
-            add_spells(c2s_spells, service);
-        else
-            add_spells(s2c_spells, service);
-    }
+        add_spells(s2c_book, service);
+
     spells.clear();
     service.clear();
 
     return true;
 }
 
-MagicBook* WizardModule::get_book(bool c2s, bool hex)
+MagicBook* WizardModule::get_book(bool c2s)
 {
-    int k = c2s ? 1 : 0;
-    k |= (hex ? 2 : 0);
-
-    MagicBook* b = nullptr;
-
-    switch ( k )
-    {
-    case 0:
-        b = s2c_spells;
-        s2c_spells = nullptr;
-        break;
-
-    case 1:
-        b = c2s_spells;
-        c2s_spells = nullptr;
-        break;
-
-    case 2:
-        b = s2c_hexes;
-        s2c_hexes = nullptr;
-        break;
-
-    case 3:
-        b = c2s_hexes;
-        c2s_hexes = nullptr;
-        break;
-    }
-    return b;
+    MagicBook*& b = c2s ? c2s_book : s2c_book;
+    MagicBook* ret = b;
+    b = nullptr;
+    return ret;
 }
 
 const PegInfo* WizardModule::get_pegs() const
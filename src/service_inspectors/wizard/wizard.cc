@@ -34,6 +34,7 @@ using namespace std;
 #include "time/profiler.h"
 #include "utils/stats.h"
 #include "log/messages.h"
+#include "parser/parser.h"
 
 THREAD_LOCAL ProfileStats wizPerfStats;
 
@@ -41,16 +42,22 @@ struct WizStats
 {
     PegCount tcp_scans;
     PegCount tcp_hits;
+    PegCount tcp_misses;
     PegCount udp_scans;
     PegCount udp_hits;
+    PegCount udp_misses;
+    PegCount bytes_scanned;
 };
 
 const PegInfo wiz_pegs[] =
 {
     { "tcp scans", "tcp payload scans" },
     { "tcp hits", "tcp identifications" },
+    { "tcp misses", "tcp flows given up without identification" },
     { "udp scans", "udp payload scans" },
     { "udp hits", "udp identifications" },
+    { "udp misses", "udp payloads not identified" },
+    { "bytes scanned", "payload bytes examined by the wizard" },
     { nullptr, nullptr }
 };
 
@@ -62,8 +69,8 @@ THREAD_LOCAL WizStats tstats;
 
 struct Wand
 {
-    const MagicPage* hex;
-    const MagicPage* spell;
+    const MagicBook* book;
+    MagicState state;
 };
 
 class Wizard;
@@ -99,14 +106,10 @@ public:
 
     void reset(Wand&, bool tcp, bool c2s);
     bool cast_spell(Wand&, Flow*, const uint8_t*, unsigned);
-    bool spellbind(const MagicPage*&, Flow*, const uint8_t*, unsigned);
 
 public:
-    MagicBook* c2s_hexes;
-    MagicBook* s2c_hexes;
-
-    MagicBook* c2s_spells;
-    MagicBook* s2c_spells;
+    MagicBook* c2s_book;
+    MagicBook* s2c_book;
 };
 
 //-------------------------------------------------------------------------
@@ -132,11 +135,17 @@ StreamSplitter::Status MagicSplitter::scan (
     Flow* f, const uint8_t* data, uint32_t len,
     uint32_t, uint32_t*)
 {
+    if ( wand.book->done(wand.state) )
+        return SEARCH;
+
     ++tstats.tcp_scans;
 
     if ( wizard->cast_spell(wand, f, data, len) )
         ++tstats.tcp_hits;
 
+    else if ( wand.book->done(wand.state) )
+        ++tstats.tcp_misses;
+
     return SEARCH;
 }
 
@@ -146,34 +155,23 @@ StreamSplitter::Status MagicSplitter::scan (
 
 Wizard::Wizard(WizardModule* m)
 {
-    c2s_hexes = m->get_book(true, true);
-    s2c_hexes = m->get_book(false, true);
+    c2s_book = m->get_book(true);
+    s2c_book = m->get_book(false);
 
-    c2s_spells = m->get_book(true, false);
-    s2c_spells = m->get_book(false, false);
+    if ( !c2s_book->compile() || !s2c_book->compile() )
+        ParseError("%s: too many spells and hexes to compile", WIZ_NAME);
 }
 
 Wizard::~Wizard()
 {
-    delete c2s_hexes;
-    delete s2c_hexes;
-
-    delete c2s_spells;
-    delete s2c_spells;
+    delete c2s_book;
+    delete s2c_book;
 }
 
 void Wizard::reset(Wand& w, bool /*tcp*/, bool c2s)
 {
-    if ( c2s )
-    {
-        w.hex = c2s_hexes->page1();
-        w.spell = c2s_spells->page1();
-    }
-    else
-    {
-        w.hex = s2c_hexes->page1();
-        w.spell = s2c_spells->page1();
-    }
+    w.book = c2s ? c2s_book : s2c_book;
+    w.book->reset(w.state);
 }
 
 void Wizard::eval(Packet* p)
@@ -189,6 +187,8 @@ void Wizard::eval(Packet* p)
 
     if ( cast_spell(wand, p->flow, p->data, p->dsize) )
         ++tstats.udp_hits;
+    else
+        ++tstats.udp_misses;
 
     ++tstats.udp_scans;
 }
@@ -198,23 +198,14 @@ StreamSplitter* Wizard::get_splitter(bool c2s)
     return new MagicSplitter(c2s, this);
 }
 
-bool Wizard::spellbind(
-    const MagicPage*& m, Flow* f, const uint8_t* data, unsigned len)
-{
-    f->service = m->book.find_spell(data, len, m);
-    return f->service != nullptr;
-}
-
 bool Wizard::cast_spell(
     Wand& w, Flow* f, const uint8_t* data, unsigned len)
 {
-    if ( w.hex && spellbind(w.hex, f, data, len) )
-        return true;
-
-    if ( w.spell && spellbind(w.spell, f, data, len) )
-        return true;
+    unsigned n;
+    f->service = w.book->find_spell(data, len, w.state, n);
+    tstats.bytes_scanned += n;
 
-    return false;
+    return f->service != nullptr;
 }
 
 //-------------------------------------------------------------------------
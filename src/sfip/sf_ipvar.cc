@@ -31,6 +31,9 @@
 #include <ctype.h>
 #include <stdio.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "util.h"
 #include "sf_vartable.h"
 
@@ -40,6 +43,7 @@
 static SFIP_RET sfvar_list_compare(sfip_node_t *, sfip_node_t *);
 static inline void sfip_node_free ( sfip_node_t * );
 static inline void sfip_node_freelist ( sfip_node_t * );
+static void sfvar_drop_lpm(sfip_var_t *);
 
 
 static inline sfip_var_t *_alloc_var(void)
@@ -65,6 +69,7 @@ void sfvar_free(sfip_var_t *var)
         // XXX
     }
 
+    sfvar_drop_lpm(var);
     free(var);
 }
 
@@ -188,6 +193,8 @@ SFIP_RET sfvar_add(sfip_var_t *dst, sfip_var_t *src)
 
     if(!dst || !src) return SFIP_ARG_ERR;
 
+    sfvar_drop_lpm(dst);
+
     oldhead = dst->head;
     oldneg = dst->neg_head;
 
@@ -236,6 +243,8 @@ SFIP_RET sfvar_add_node(sfip_var_t *var, sfip_node_t *node, int negated)
 
     if(!var || !node) return SFIP_ARG_ERR;
 
+    sfvar_drop_lpm(var);
+
     /* XXX */
     /* As of this writing, 11/20/06, nodes are always added to
      * the list, regardless of the mode (list or table). */
@@ -730,6 +739,7 @@ sfip_var_t *sfvar_alloc(vartable_t *table, const char *variable, SFIP_RET *statu
                 *status = SFIP_SUCCESS;
 
             sfvar_free(ret);
+            sfvar_compile(aliased);
             return aliased;
         }
     }
@@ -765,6 +775,7 @@ sfip_var_t *sfvar_alloc(vartable_t *table, const char *variable, SFIP_RET *statu
         return NULL;
     }
 
+    sfvar_compile(ret);
     return ret;
 }
 
@@ -822,6 +833,214 @@ sfip_var_t *sfvar_deep_copy(const sfip_var_t *var)
 }
 
 
+/* Compiled lookup for sfvar_ip_in.
+ *
+ * Each family is flattened into a sorted list of range start addresses
+ * over the whole address space.  Adjacent ranges always have opposite
+ * results so only the result of the first range is kept and a lookup is
+ * a binary search for the last start <= ip.  The negated entries are
+ * folded in when the ranges are built, so the result is the same as the
+ * list walk: contained in some positive entry (or there are none) and
+ * not contained in any negated entry of the same family. */
+
+struct sfip_lpm_key_t
+{
+    uint64_t hi, lo;
+
+    bool operator<(const sfip_lpm_key_t& rhs) const
+    { return hi < rhs.hi || (hi == rhs.hi && lo < rhs.lo); }
+
+    bool operator==(const sfip_lpm_key_t& rhs) const
+    { return hi == rhs.hi && lo == rhs.lo; }
+};
+
+struct sfip_lpm_t
+{
+    std::vector<uint32_t> start4;
+    std::vector<sfip_lpm_key_t> start6;
+    bool first4;
+    bool first6;
+};
+
+struct sfip_lpm_edge_t
+{
+    sfip_lpm_key_t key;
+    int pos;
+    int neg;
+
+    bool operator<(const sfip_lpm_edge_t& rhs) const
+    { return key < rhs.key; }
+};
+
+static inline sfip_lpm_key_t _lpm_key6(const uint32_t *ip32)
+{
+    sfip_lpm_key_t k;
+    k.hi = ((uint64_t)ntohl(ip32[0]) << 32) | ntohl(ip32[1]);
+    k.lo = ((uint64_t)ntohl(ip32[2]) << 32) | ntohl(ip32[3]);
+    return k;
+}
+
+/* Adds the start and end+1 edges of the cidr.  v4 addresses are kept in
+ * the low word so the same code handles both families. */
+static void _lpm_add_edges(std::vector<sfip_lpm_edge_t>& edges, const sfip_t *ip, int negated)
+{
+    sfip_lpm_key_t lo, hi;
+    int bits = sfip_bits(ip);
+
+    if(sfip_family(ip) == AF_INET)
+    {
+        uint64_t mask = bits ? (~(uint64_t)0 << (32 - bits)) & 0xffffffff : 0;
+        lo.hi = hi.hi = 0;
+        lo.lo = ntohl(ip->ip32[0]) & mask;
+        hi.lo = lo.lo | (~mask & 0xffffffff);
+    }
+    else
+    {
+        lo = hi = _lpm_key6(ip->ip32);
+        uint64_t mhi = bits >= 64 ? ~(uint64_t)0 : (bits ? ~(uint64_t)0 << (64 - bits) : 0);
+        uint64_t mlo = bits <= 64 ? 0 : (bits >= 128 ? ~(uint64_t)0 : ~(uint64_t)0 << (128 - bits));
+        lo.hi &= mhi;
+        lo.lo &= mlo;
+        hi.hi = lo.hi | ~mhi;
+        hi.lo = lo.lo | ~mlo;
+    }
+
+    sfip_lpm_edge_t e;
+    e.key = lo;
+    e.pos = negated ? 0 : 1;
+    e.neg = negated ? 1 : 0;
+    edges.push_back(e);
+
+    /* end + 1; nothing to close at the top of the address space */
+    bool top = (sfip_family(ip) == AF_INET) ? (hi.lo == 0xffffffff) :
+        (hi.hi == ~(uint64_t)0 && hi.lo == ~(uint64_t)0);
+
+    if(top)
+        return;
+
+    if(++hi.lo == 0)
+        ++hi.hi;
+
+    e.key = hi;
+    e.pos = -e.pos;
+    e.neg = -e.neg;
+    edges.push_back(e);
+}
+
+static void _lpm_build(
+    std::vector<sfip_lpm_edge_t>& edges, bool any_pos, std::vector<sfip_lpm_key_t>& starts, bool& first)
+{
+    std::stable_sort(edges.begin(), edges.end());
+
+    int pos = 0, neg = 0;
+    bool cur = any_pos;
+    size_t i = 0;
+
+    /* the address space below the first edge */
+    sfip_lpm_key_t zero = { 0, 0 };
+
+    while(i < edges.size() && edges[i].key == zero)
+    {
+        pos += edges[i].pos;
+        neg += edges[i].neg;
+        i++;
+    }
+    first = cur = !neg && (any_pos || pos);
+    starts.push_back(zero);
+
+    while(i < edges.size())
+    {
+        sfip_lpm_key_t key = edges[i].key;
+
+        for( ; i < edges.size() && edges[i].key == key; i++)
+        {
+            pos += edges[i].pos;
+            neg += edges[i].neg;
+        }
+        bool val = !neg && (any_pos || pos);
+
+        if(val != cur)
+        {
+            starts.push_back(key);
+            cur = val;
+        }
+    }
+}
+
+static void sfvar_drop_lpm(sfip_var_t *var)
+{
+    delete var->lpm;
+    var->lpm = NULL;
+}
+
+SFIP_RET sfvar_compile(sfip_var_t *var)
+{
+    sfip_node_t *idx;
+    std::vector<sfip_lpm_edge_t> edges4, edges6;
+
+    if(!var)
+        return SFIP_ARG_ERR;
+
+    sfvar_drop_lpm(var);
+
+    /* no positive entries, or an unset one, matches anything that
+     * isn't negated regardless of family; see _sfvar_ip_in4 */
+    bool any_pos = !var->head;
+
+    for(idx = var->head; idx; idx = idx->next)
+    {
+        if(!sfip_is_set(idx->ip))
+            any_pos = true;
+
+        else if(sfip_family(idx->ip) == AF_INET)
+            _lpm_add_edges(edges4, idx->ip, 0);
+
+        else
+            _lpm_add_edges(edges6, idx->ip, 0);
+    }
+
+    for(idx = var->neg_head; idx; idx = idx->next)
+    {
+        if(sfip_family(idx->ip) == AF_INET)
+            _lpm_add_edges(edges4, idx->ip, 1);
+        else
+            _lpm_add_edges(edges6, idx->ip, 1);
+    }
+
+    sfip_lpm_t *lpm = new sfip_lpm_t;
+    std::vector<sfip_lpm_key_t> starts;
+
+    _lpm_build(edges4, any_pos, starts, lpm->first4);
+
+    lpm->start4.reserve(starts.size());
+
+    for(unsigned i = 0; i < starts.size(); i++)
+        lpm->start4.push_back((uint32_t)starts[i].lo);
+
+    _lpm_build(edges6, any_pos, lpm->start6, lpm->first6);
+
+    var->lpm = lpm;
+    return SFIP_SUCCESS;
+}
+
+static inline int _sfvar_lpm_in4(const sfip_lpm_t *lpm, const sfip_t *ip)
+{
+    uint32_t key = ntohl(ip->ip32[0]);
+    size_t n = std::upper_bound(lpm->start4.begin(), lpm->start4.end(), key) -
+        lpm->start4.begin() - 1;
+
+    return lpm->first4 ^ (n & 1);
+}
+
+static inline int _sfvar_lpm_in6(const sfip_lpm_t *lpm, const sfip_t *ip)
+{
+    sfip_lpm_key_t key = _lpm_key6(ip->ip32);
+    size_t n = std::upper_bound(lpm->start6.begin(), lpm->start6.end(), key) -
+        lpm->start6.begin() - 1;
+
+    return lpm->first6 ^ (n & 1);
+}
+
 /* Support function for sfvar_ip_in  */
 static inline int _sfvar_ip_in4(sfip_var_t *var, const sfip_t *ip)
 {
@@ -967,6 +1186,14 @@ int sfvar_ip_in(sfip_var_t *var, const sfip_t *ip)
     if(!var || !ip)
         return 0;
 
+    if(var->lpm)
+    {
+        if(sfip_family(ip) == AF_INET)
+            return _sfvar_lpm_in4(var->lpm, ip);
+
+        return _sfvar_lpm_in6(var->lpm, ip);
+    }
+
 #if 0
     if(var->mode == SFIP_TABLE)
     {
@@ -54,6 +54,9 @@ typedef struct _ip_node {
                     /* Should merge them later */
 } sfip_node_t;
 
+/* Compiled form of a variable's lists; see sfvar_compile */
+struct sfip_lpm_t;
+
 /* An IP variable onkect */
 struct sfip_var_t {
     /* Selects whether or not to use the list, the table,
@@ -68,6 +71,10 @@ struct sfip_var_t {
      * or the IP routing table */
 //    sfrt rt;
 
+    /* Lookup table compiled from the lists by sfvar_compile.  When set,
+     * sfvar_ip_in uses it instead of walking the lists. */
+    sfip_lpm_t *lpm;
+
     /* Linked list of IP variables for the variable table */
     sfip_var_t *next;
 
@@ -84,7 +91,8 @@ struct vartable_t {
 };
 
 /* Creates a new variable that is an alias of another variable
- * Does a "deep" copy so it owns it's own pointers */
+ * Does a "deep" copy so it owns it's own pointers
+ * The lookup table is not copied; see sfvar_compile */
 sfip_var_t * sfvar_create_alias(const sfip_var_t *alias_from, const char *alias_to);
 
 /* Returns 1 if the two variables are aliases of each other, 0 otherwise */
@@ -122,6 +130,10 @@ sfip_var_t *sfvar_deep_copy(const sfip_var_t *src);
 /* Free an allocated variable */
 void sfvar_free(sfip_var_t *var);
 
+/* Builds the lookup table used by sfvar_ip_in from the current lists.
+ * The table is dropped if nodes are added afterwards. */
+SFIP_RET sfvar_compile(sfip_var_t *var);
+
 /* Returns non-zero if ip is contained in 'var', 0 otherwise */
 /* If either argument is NULL, 0 is returned. */
 int sfvar_ip_in(sfip_var_t *var, const sfip_t *ip);
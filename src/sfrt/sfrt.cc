@@ -199,6 +199,7 @@ table_t *sfrt_new(char table_type, char ip_type, long data_size, uint32_t mem_ca
         case DIR_16x7_4x4:
         case DIR_16x8:
         case DIR_8x16:
+        case DIR_16_4x4_16_4x28:
             table->insert = sfrt_dir_insert;
             table->lookup = sfrt_dir_lookup;
             table->free = sfrt_dir_free;
@@ -260,6 +261,14 @@ table_t *sfrt_new(char table_type, char ip_type, long data_size, uint32_t mem_ca
             table->rt6 = sfrt_dir_new(mem_cap, 16,
                             8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8);
             break;
+        /* Narrow strides below the root keep sparse host tables small at
+         * the cost of deeper lookups. */
+        case DIR_16_4x4_16_4x28:
+            table->rt = sfrt_dir_new(mem_cap, 5, 16,4,4,4,4);
+            table->rt6 = sfrt_dir_new(mem_cap, 29, 16,
+                            4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+                            4,4,4,4,4,4,4,4,4,4,4,4,4,4);
+            break;
     };
 
     if((!table->rt) || (!table->rt6))
@@ -135,6 +135,7 @@ enum types
    DIR_16x7_4x4,
    DIR_16x8,
    DIR_8x16,
+   DIR_16_4x4_16_4x28,
    IPv4,
    IPv6
 };
@@ -300,7 +300,7 @@ int sfrt_flat_insert(void *adr, unsigned char len, INFO ptr,
         return RT_INSERT_FAILURE;
     }
 
-    tuple = sfrt_dir_flat_lookup(ip, table->rt);
+    tuple = sfrt_dir_flat_lookup(ip, rt);
 
     base = (uint8_t *)segment_basePtr();
     data = (INFO *)(&base[table->data]);
@@ -502,8 +502,9 @@ int sfrt_dir_flat_insert(const sfip_t *ip, int len, word data_index,
 
 
 
+    sfip_t h_ip;
     IPLOOKUP iplu;
-    iplu.ip = ip;
+    iplu.ip = &h_ip;
     iplu.bits = 0;
 
     base = (uint8_t *)segment_basePtr();
@@ -514,6 +515,16 @@ int sfrt_dir_flat_insert(const sfip_t *ip, int len, word data_index,
         return DIR_INSERT_FAILURE;
     }
 
+    /* The sub tables are indexed in host order, the same as sfrt_dir */
+    h_ip.family = ip->family;
+    h_ip.ip32[0] = ntohl(ip->ip32[0]);
+    if (ip->family != AF_INET)
+    {
+        h_ip.ip32[1] = ntohl(ip->ip32[1]);
+        h_ip.ip32[2] = ntohl(ip->ip32[2]);
+        h_ip.ip32[3] = ntohl(ip->ip32[3]);
+    }
+
     /* Find the sub table in which to insert */
     return _dir_sub_insert(&iplu, len, len, data_index,
             0, behavior, root->sub_table, root, updateEntry, data);
@@ -581,8 +592,9 @@ tuple_flat_t sfrt_dir_flat_lookup(const sfip_t *ip, TABLE_PTR table_ptr)
 {
     dir_table_flat_t *root;
     uint8_t *base = (uint8_t *)segment_basePtr();
+    sfip_t h_ip;
     IPLOOKUP iplu;
-    iplu.ip = ip;
+    iplu.ip = &h_ip;
     iplu.bits = 0;
 
     if(!table_ptr )
@@ -591,6 +603,15 @@ tuple_flat_t sfrt_dir_flat_lookup(const sfip_t *ip, TABLE_PTR table_ptr)
         return ret;
     }
 
+    h_ip.family = ip->family;
+    h_ip.ip32[0] = ntohl(ip->ip32[0]);
+    if (ip->family != AF_INET)
+    {
+        h_ip.ip32[1] = ntohl(ip->ip32[1]);
+        h_ip.ip32[2] = ntohl(ip->ip32[2]);
+        h_ip.ip32[3] = ntohl(ip->ip32[3]);
+    }
+
     root = (dir_table_flat_t *)(&base[table_ptr]);
 
     if(!root->sub_table)
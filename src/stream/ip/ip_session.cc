@@ -129,6 +129,7 @@ bool IpSession::setup (Packet* p)
 
     sfip_copy(flow->client_ip, p->ptrs.ip_api.get_src());
     sfip_copy(flow->server_ip, p->ptrs.ip_api.get_dst());
+    flow->clear_hosts();
 
 #ifdef ENABLE_EXPECTED_IP
     if ( flow_con->expected_session(flow, p))
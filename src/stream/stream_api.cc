@@ -352,7 +352,7 @@ StreamFlowData *Stream::get_flow_data(Packet *p)
     if (!flow)
         return NULL;
 
-    return flow->flowdata;
+    return &flow->flowdata;
 }
 
 void Stream::init_active_response(Packet* p, Flow* flow)
@@ -423,9 +423,8 @@ void Stream::set_application_protocol_id_from_host_entry(
 
 int16_t Stream::get_application_protocol_id(Flow* flow)
 {
-    /* Not caching the source and dest host_entry in the session so we can
-     * swap the table out after processing this packet if we need
-     * to.  */
+    /* The flow caches its host entries only until the attribute table
+     * is swapped or updated. */
     HostAttributeEntry *host_entry = NULL;
     int16_t protocol = 0;
 
@@ -443,7 +442,7 @@ int16_t Stream::get_application_protocol_id(Flow* flow)
         set_ip_protocol(flow);
     }
 
-    host_entry = SFAT_LookupHostEntryByIP(&flow->server_ip);
+    host_entry = SFAT_LookupHostEntryByFlow(flow, true);
     if (host_entry)
     {
         set_application_protocol_id_from_host_entry(flow, host_entry, SSN_DIR_FROM_SERVER);
@@ -454,7 +453,7 @@ int16_t Stream::get_application_protocol_id(Flow* flow)
         }
     }
 
-    host_entry = SFAT_LookupHostEntryByIP(&flow->client_ip);
+    host_entry = SFAT_LookupHostEntryByFlow(flow, false);
 
     if (host_entry)
     {
@@ -4230,6 +4230,7 @@ static void NewTcpSession(
 
             lwssn->client_ip = lwssn->server_ip;
             lwssn->server_ip = ip;
+            lwssn->clear_hosts();
 
             lwssn->client_port = lwssn->server_port;
             lwssn->server_port = port;
@@ -6664,6 +6665,7 @@ void TcpSession::update_direction(
     flow->client_port = flow->server_port;
     flow->server_ip = tmpIp;
     flow->server_port = tmpPort;
+    flow->clear_hosts();
 
 #ifdef HAVE_DAQ_ADDRESS_SPACE_ID
     SwapPacketHeaderFoo(this);
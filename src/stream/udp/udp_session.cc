@@ -207,6 +207,7 @@ void UdpSession::update_direction(
     flow->client_port = flow->server_port;
     flow->server_ip = tmpIp;
     flow->server_port = tmpPort;
+    flow->clear_hosts();
 }
 
 int UdpSession::process(Packet *p)
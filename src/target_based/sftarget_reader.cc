@@ -36,6 +36,9 @@
 #include <unistd.h>
 #include <time.h>
 
+#include <algorithm>
+#include <atomic>
+
 #include "mstring.h"
 #include "util.h"
 #include "parser.h"
@@ -50,17 +53,39 @@
 #include "snort_debug.h"
 #include "utils/stats.h"
 #include "sfip/sf_ip.h"
+#include "flow/flow.h"
 
 #define ATTRIBUTE_MAP_MAX_ROWS 1024
 
+// sfrt takes the memcap in MB and keeps it in bytes in 32 bits
+#define ATTRIBUTE_MAX_MEMCAP 4095
+
 struct tTargetBasedConfig
 {
     table_t* lookupTable;
 
+    // flows cache their hosts with the generation of the table they came
+    // from; it changes when the table is replaced or updated.  packet
+    // threads add hosts to the shared table so prefixes are published
+    // before the generation that makes flows look again.
+    std::atomic<unsigned> generation;
+
+    // the leading 16 bits of every address covered by a host entry.
+    // most addresses are not in the table; those miss here without a
+    // walk through the trie.  bits are only ever set.
+    static const unsigned prefix_words = 65536 / 64;
+    std::atomic<uint64_t> ip4_prefixes[prefix_words];
+    std::atomic<uint64_t> ip6_prefixes[prefix_words];
+
     tTargetBasedConfig();
     ~tTargetBasedConfig();
+
+    void add_prefix(const sfip_t*);
+    bool has_prefix(const sfip_t*) const;
 };
 
+static std::atomic<unsigned> sfat_generation(0);
+
 void SFAT_CleanupCallback(void *host_attr_ent)
 {
     HostAttributeEntry *host_entry = (HostAttributeEntry*)host_attr_ent;
@@ -75,7 +100,18 @@ tTargetBasedConfig::tTargetBasedConfig()
     // FIXIT-M init before snort_conf; move to filename and load separately
     // this is a hack to get it going
     uint32_t max = snort_conf ? ScMaxAttrHosts() : DEFAULT_MAX_ATTRIBUTE_HOSTS;
-    lookupTable = sfrt_new(DIR_8x16, IPv6, max + 1, (max>>6) + 1);
+    uint32_t cap = std::min((max>>6) + 1, (uint32_t)ATTRIBUTE_MAX_MEMCAP);
+
+    // host entries are mostly sparse /32s and /128s; the narrow strides
+    // take a fraction of the memory of DIR_8x16 for these
+    lookupTable = sfrt_new(DIR_16_4x4_16_4x28, IPv6, max + 1, cap);
+
+    for ( unsigned i = 0; i < prefix_words; ++i )
+    {
+        ip4_prefixes[i].store(0, std::memory_order_relaxed);
+        ip6_prefixes[i].store(0, std::memory_order_relaxed);
+    }
+    generation.store(++sfat_generation, std::memory_order_release);
 }
 
 tTargetBasedConfig::~tTargetBasedConfig()
@@ -84,6 +120,29 @@ tTargetBasedConfig::~tTargetBasedConfig()
     sfrt_free(lookupTable);
 }
 
+static inline unsigned get_prefix(const sfip_t* ip)
+{
+    return (ip->ip8[0] << 8) | ip->ip8[1];
+}
+
+void tTargetBasedConfig::add_prefix(const sfip_t* ip)
+{
+    std::atomic<uint64_t>* map = ip->is_ip4() ? ip4_prefixes : ip6_prefixes;
+    unsigned n = ip->bits < 16 ? 1 << (16 - ip->bits) : 1;
+    unsigned first = get_prefix(ip) & ~(n - 1);
+
+    for ( unsigned i = first; i < first + n; ++i )
+        map[i / 64].fetch_or((uint64_t)1 << (i % 64), std::memory_order_relaxed);
+}
+
+bool tTargetBasedConfig::has_prefix(const sfip_t* ip) const
+{
+    const std::atomic<uint64_t>* map = ip->is_ip4() ? ip4_prefixes : ip6_prefixes;
+    unsigned i = get_prefix(ip);
+
+    return map[i / 64].load(std::memory_order_relaxed) & ((uint64_t)1 << (i % 64));
+}
+
 static THREAD_LOCAL tTargetBasedConfig* curr_cfg = NULL;
 static tTargetBasedConfig* next_cfg = NULL;
 
@@ -256,7 +315,10 @@ int SFAT_AddHostEntryToMap(HostAttributeEntry* host)
     ret = sfrt_insert(ipAddr, (unsigned char)ipAddr->bits, host,
                         RT_FAVOR_SPECIFIC, next_cfg->lookupTable);
 
-    if (ret != RT_SUCCESS)
+    if (ret == RT_SUCCESS)
+        next_cfg->add_prefix(ipAddr);
+
+    else
     {
         if (ret == RT_POLICY_TABLE_EXCEEDED)
         {
@@ -287,18 +349,51 @@ int SFAT_AddHostEntryToMap(HostAttributeEntry* host)
 
 HostAttributeEntry *SFAT_LookupHostEntryByIP(const sfip_t *ipAddr)
 {
-    if ( !curr_cfg )
+    if ( !curr_cfg || !curr_cfg->has_prefix(ipAddr) )
         return NULL;
 
     return (HostAttributeEntry*)sfrt_lookup((sfip_t*)ipAddr, curr_cfg->lookupTable);
 }
 
+HostAttributeEntry *SFAT_LookupHostEntryByFlow(Flow* flow, bool server)
+{
+    if ( !curr_cfg )
+        return NULL;
+
+    // acquire before the lookups so they see every prefix added
+    // before this generation was published
+    unsigned gen = curr_cfg->generation.load(std::memory_order_acquire);
+
+    if ( flow->host_gen != gen )
+    {
+        flow->client_host = SFAT_LookupHostEntryByIP(&flow->client_ip);
+        flow->server_host = SFAT_LookupHostEntryByIP(&flow->server_ip);
+        flow->host_gen = gen;
+    }
+    return server ? flow->server_host : flow->client_host;
+}
+
+static HostAttributeEntry* LookupHostEntryByPacket(Packet* p, const sfip_t* ip)
+{
+    Flow* flow = p->flow;
+
+    if ( flow )
+    {
+        if ( sfip_fast_equals_raw(ip, &flow->server_ip) )
+            return SFAT_LookupHostEntryByFlow(flow, true);
+
+        if ( sfip_fast_equals_raw(ip, &flow->client_ip) )
+            return SFAT_LookupHostEntryByFlow(flow, false);
+    }
+    return SFAT_LookupHostEntryByIP(ip);
+}
+
 HostAttributeEntry *SFAT_LookupHostEntryBySrc(Packet *p)
 {
     if (!p || !p->ptrs.ip_api.is_valid())
         return NULL;
 
-    return SFAT_LookupHostEntryByIP(p->ptrs.ip_api.get_src());
+    return LookupHostEntryByPacket(p, p->ptrs.ip_api.get_src());
 }
 
 HostAttributeEntry *SFAT_LookupHostEntryByDst(Packet *p)
@@ -306,7 +401,7 @@ HostAttributeEntry *SFAT_LookupHostEntryByDst(Packet *p)
     if (!p || !p->ptrs.ip_api.is_valid())
         return NULL;
 
-    return SFAT_LookupHostEntryByIP(p->ptrs.ip_api.get_dst());
+    return LookupHostEntryByPacket(p, p->ptrs.ip_api.get_dst());
 }
 
 void SFAT_Cleanup(void)
@@ -381,6 +476,11 @@ void SFAT_UpdateApplicationProtocol(sfip_t *ipAddr, uint16_t port, uint16_t prot
             FreeHostEntry(host_entry);
             return;
         }
+        curr_cfg->add_prefix(ipAddr);
+
+        // flows that cached a miss for this address must look again;
+        // release so readers of the new generation see the prefix
+        curr_cfg->generation.store(++sfat_generation, std::memory_order_release);
         service = NULL;
     }
     else
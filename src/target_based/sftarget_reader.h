@@ -52,6 +52,10 @@ uint32_t SFAT_NumberOfHosts(void);
 HostAttributeEntry *SFAT_LookupHostEntryByIP(const sfip_t *ipAddr);
 HostAttributeEntry *SFAT_LookupHostEntryBySrc(Packet *p);
 HostAttributeEntry *SFAT_LookupHostEntryByDst(Packet *p);
+
+// the flow caches its client and server entries until the table changes
+class Flow;
+HostAttributeEntry *SFAT_LookupHostEntryByFlow(Flow*, bool server);
 void SFAT_UpdateApplicationProtocol(
     sfip_t *ipAddr, uint16_t port, uint16_t protocol, uint16_t id);
 
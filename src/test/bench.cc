@@ -0,0 +1,624 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// bench.cc
+
+// micro-benchmarks for the hot paths that are otherwise only measured by
+// end-to-end pcap runs.  packets from the -r pcaps are loaded into memory
+// once and then replayed through each component in isolation.  each
+// component is run once to warm up and then BENCH_RUNS more times; the
+// median is reported so that results are repeatable from run to run.
+
+#include "bench.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "main/snort.h"
+#include "main/snort_config.h"
+#include "detection/fpcreate.h"
+#include "detection/treenodes.h"
+#include "events/event_queue.h"
+#include "flow/flow.h"
+#include "flow/flow_control.h"
+#include "framework/inspector.h"
+#include "framework/mpse.h"
+#include "hash/sfghash.h"
+#include "ips_options/ips_content.h"
+#include "log/log_text.h"
+#include "log/messages.h"
+#include "log/text_log.h"
+#include "managers/inspector_manager.h"
+#include "managers/mpse_manager.h"
+#include "packet_io/active.h"
+#include "packet_io/sfdaq.h"
+#include "packet_io/trough.h"
+#include "parser/parser.h"
+#include "protocols/packet.h"
+#include "protocols/packet_manager.h"
+#include "stream/stream.h"
+#include "time/cpuclock.h"
+#include "time/packet_time.h"
+
+#define BENCH_RUNS 5
+
+#define BENCH_MPSE    0x01
+#define BENCH_DECODE  0x02
+#define BENCH_STREAM  0x04
+#define BENCH_INSPECT 0x08
+#define BENCH_LOG     0x10
+#define BENCH_ALL     0x1F
+
+static unsigned s_components = 0;
+
+//-------------------------------------------------------------------------
+// packets
+//-------------------------------------------------------------------------
+
+struct BenchPacket
+{
+    DAQ_PktHdr_t pkth;
+    unsigned offset;     // of raw packet in s_data
+    unsigned payload;    // offset of decoded payload in raw packet
+    unsigned dsize;
+};
+
+static vector<BenchPacket> s_pkts;
+static vector<uint8_t> s_data;
+
+static DAQ_Verdict collect(void*, const DAQ_PktHdr_t* pkth, const uint8_t* pkt)
+{
+    BenchPacket bp;
+    bp.pkth = *pkth;
+    bp.offset = s_data.size();
+    bp.payload = bp.dsize = 0;
+
+    s_data.insert(s_data.end(), pkt, pkt + pkth->caplen);
+    s_pkts.push_back(bp);
+
+    return DAQ_VERDICT_PASS;
+}
+
+static inline const uint8_t* get_data(const BenchPacket& bp)
+{ return &s_data[bp.offset]; }
+
+// the first pcap is opened by snort_thread_init()
+static void load_pcaps()
+{
+    while ( true )
+    {
+        DAQ_Acquire(0, collect, nullptr);
+
+        const char* pcap = Trough_First();
+
+        if ( !pcap )
+            break;
+
+        DAQ_Stop();
+        DAQ_Delete();
+        DAQ_New(snort_conf, pcap);
+        DAQ_Start();
+    }
+}
+
+static void reset_packet()
+{
+    SnortEventqReset();
+    Active_Reset();
+    PacketManager::encode_reset();
+}
+
+static void find_payloads(Packet* p)
+{
+    for ( auto& bp : s_pkts )
+    {
+        const uint8_t* pkt = get_data(bp);
+        PacketManager::decode(p, &bp.pkth, pkt);
+
+        if ( p->data >= pkt && p->data + p->dsize <= pkt + bp.pkth.caplen )
+        {
+            bp.payload = p->data - pkt;
+            bp.dsize = p->dsize;
+        }
+        reset_packet();
+    }
+}
+
+//-------------------------------------------------------------------------
+// results
+//-------------------------------------------------------------------------
+
+struct BenchResult
+{
+    string name;
+    uint64_t pkts;
+    uint64_t bytes;
+    vector<uint64_t> ticks;    // one per run
+
+    BenchResult(const string& s)
+    { name = s; pkts = bytes = 0; }
+};
+
+static vector<BenchResult> s_results;
+
+static BenchResult& get_result(const string& name)
+{
+    for ( auto& r : s_results )
+        if ( r.name == name )
+            return r;
+
+    s_results.push_back(BenchResult(name));
+    return s_results.back();
+}
+
+static void show_results()
+{
+    double ticks_per_usec = get_ticks_per_usec();
+
+    LogMessage("%s\n", LOG_DIV);
+    LogMessage("Benchmarks (median of %u runs):\n", BENCH_RUNS);
+    LogMessage("%28s %10s %12s %12s %12s %12s\n", "component",
+        "packets", "bytes", "cycles/pkt", "bytes/cycle", "pkts/sec");
+
+    for ( auto& r : s_results )
+    {
+        if ( r.ticks.empty() )
+            continue;
+
+        sort(r.ticks.begin(), r.ticks.end());
+        uint64_t ticks = r.ticks[r.ticks.size() / 2];
+
+        double per_pkt = r.pkts ? (double)ticks / r.pkts : 0.0;
+        double per_tick = ticks ? (double)r.bytes / ticks : 0.0;
+        double per_sec = ticks ? r.pkts * ticks_per_usec * 1e6 / ticks : 0.0;
+
+        LogMessage("%28s %10" PRIu64 " %12" PRIu64 " %12.1f %12.4f %12.0f\n",
+            r.name.c_str(), r.pkts, r.bytes, per_pkt, per_tick, per_sec);
+    }
+}
+
+//-------------------------------------------------------------------------
+// search engines
+//-------------------------------------------------------------------------
+
+// patterns are taken from the content options of the loaded rules
+static unsigned add_patterns(Mpse* mpse)
+{
+    SnortConfig* sc = snort_conf;
+    unsigned num = 0;
+
+    if ( !sc->otn_map )
+        return 0;
+
+    for ( SFGHASH_NODE* hn = sfghash_findfirst(sc->otn_map); hn;
+        hn = sfghash_findnext(sc->otn_map) )
+    {
+        OptTreeNode* otn = (OptTreeNode*)hn->data;
+
+        for ( OptFpList* ofl = otn->opt_func; ofl; ofl = ofl->next )
+        {
+            PatternMatchData* pmd = get_pmd(ofl);
+
+            if ( !pmd || pmd->negated || !pmd->pattern_size )
+                continue;
+
+            mpse->add_pattern(
+                sc, (uint8_t*)pmd->pattern_buf, pmd->pattern_size,
+                pmd->no_case, false, pmd, 0);
+
+            ++num;
+        }
+    }
+    return num;
+}
+
+static int count_match(void*, void*, int, void* data, void*)
+{
+    ++*(uint64_t*)data;
+    return 0;
+}
+
+static void bench_engine(const MpseApi* api)
+{
+    Mpse* mpse = MpseManager::get_search_engine(
+        snort_conf, api, false, nullptr, nullptr, nullptr);
+
+    unsigned num = add_patterns(mpse);
+
+    if ( !num )
+    {
+        LogMessage("bench: no content patterns loaded for mpse\n");
+        MpseManager::delete_search_engine(mpse);
+        return;
+    }
+    mpse->prep_patterns(snort_conf, nullptr, nullptr);
+
+    BenchResult& r = get_result(string("mpse:") + api->base.name);
+    uint64_t matches = 0;
+
+    for ( unsigned run = 0; run <= BENCH_RUNS; ++run )
+    {
+        uint64_t start, end, bytes = 0, pkts = 0;
+        matches = 0;
+
+        get_clockticks(start);
+
+        for ( auto& bp : s_pkts )
+        {
+            if ( !bp.dsize )
+                continue;
+
+            int state = 0;
+            mpse->search(get_data(bp) + bp.payload, bp.dsize,
+                count_match, &matches, &state);
+
+            bytes += bp.dsize;
+            ++pkts;
+        }
+        get_clockticks(end);
+
+        if ( run )
+            r.ticks.push_back(end - start);
+
+        r.pkts = pkts;
+        r.bytes = bytes;
+    }
+    LogMessage("bench: %s has %u patterns and %" PRIu64 " matches\n",
+        api->base.name, num, matches);
+
+    MpseManager::delete_search_engine(mpse);
+}
+
+// engines that must be activated are only run if configured since
+// they depend on global setup that has only been done for that one
+static void bench_mpse()
+{
+    const MpseApi* cfg = snort_conf->fast_pattern_config->search_api;
+    const char* name;
+
+    for ( unsigned idx = 0; (name = MpseManager::get_search_name(idx)); ++idx )
+    {
+        const MpseApi* api = MpseManager::get_search_api(name);
+
+        if ( api->activate && api != cfg )
+            continue;
+
+        bench_engine(api);
+    }
+}
+
+//-------------------------------------------------------------------------
+// codecs
+//-------------------------------------------------------------------------
+
+static void bench_decode(Packet* p)
+{
+    BenchResult& r = get_result("decode");
+
+    for ( auto& bp : s_pkts )
+    {
+        r.bytes += bp.pkth.caplen;
+        ++r.pkts;
+    }
+
+    for ( unsigned run = 0; run <= BENCH_RUNS; ++run )
+    {
+        uint64_t start, end;
+        get_clockticks(start);
+
+        for ( auto& bp : s_pkts )
+        {
+            PacketManager::decode(p, &bp.pkth, get_data(bp));
+            SnortEventqReset();
+        }
+        get_clockticks(end);
+
+        if ( run )
+            r.ticks.push_back(end - start);
+    }
+}
+
+//-------------------------------------------------------------------------
+// text loggers
+//-------------------------------------------------------------------------
+
+// the timestamp and addresses are the per event part of an alert_fast
+// line; the buffer is reset instead of flushed so no i/o is timed.
+static void bench_log(Packet* p)
+{
+    BenchResult& r = get_result("log");
+    TextLog* log = TextLog_Init("stdout", 64*K_BYTES, 0);
+
+    for ( auto& bp : s_pkts )
+    {
+        r.bytes += bp.pkth.caplen;
+        ++r.pkts;
+    }
+
+    for ( unsigned run = 0; run <= BENCH_RUNS; ++run )
+    {
+        uint64_t ticks = 0;
+
+        for ( auto& bp : s_pkts )
+        {
+            PacketManager::decode(p, &bp.pkth, get_data(bp));
+
+            uint64_t start, end;
+            get_clockticks(start);
+
+            TextLog_Reset(log);
+            LogTimeStamp(log, p);
+            LogIpAddrs(log, p);
+
+            get_clockticks(end);
+            ticks += end - start;
+
+            SnortEventqReset();
+        }
+        if ( run )
+            r.ticks.push_back(ticks);
+    }
+    TextLog_Reset(log);
+    TextLog_Term(log);
+}
+
+//-------------------------------------------------------------------------
+// stream and service inspectors
+//-------------------------------------------------------------------------
+
+struct BenchCount
+{
+    uint64_t pkts;
+    uint64_t bytes;
+    uint64_t ticks;
+};
+
+static Inspector* s_stream = nullptr;
+static map<string, BenchCount> s_gadgets;
+
+// rebuilt pdus are not inspected while benchmarking stream
+static void ignore_pdu(Packet*) { }
+
+// rebuilt pdus are given only to the flow's service inspector
+static void inspect_pdu(Packet* p)
+{
+    Flow* flow = p->flow;
+
+    if ( !flow )
+        return;
+
+    if ( flow->service && flow->clouseau )
+        InspectorManager::bumble(p);
+
+    if ( !p->dsize || !flow->gadget )
+        return;
+
+    uint64_t start, end;
+    get_clockticks(start);
+
+    flow->gadget->eval(p);
+
+    get_clockticks(end);
+
+    BenchCount& c = s_gadgets[flow->gadget->get_api()->base.name];
+    c.ticks += end - start;
+    c.bytes += p->dsize;
+    ++c.pkts;
+}
+
+// replay all packets through stream, timing tcp packets if requested;
+// flows are purged at the end so every replay starts from scratch
+static void replay(Packet* p, BenchCount* tcp)
+{
+    for ( auto& bp : s_pkts )
+    {
+        packet_time_update(&bp.pkth.ts);
+        set_default_policy();
+
+        PacketManager::decode(p, &bp.pkth, get_data(bp));
+
+        if ( tcp && p->is_tcp() && !(p->packet_flags & PKT_IGNORE) )
+        {
+            uint64_t start, end;
+            get_clockticks(start);
+
+            s_stream->eval(p);
+
+            get_clockticks(end);
+            tcp->ticks += end - start;
+            tcp->bytes += p->dsize;
+            ++tcp->pkts;
+        }
+        else if ( !(p->packet_flags & PKT_IGNORE) )
+            s_stream->eval(p);
+
+        reset_packet();
+    }
+    flow_con->purge_flows(IPPROTO_TCP);
+    flow_con->purge_flows(IPPROTO_UDP);
+    flow_con->purge_flows(IPPROTO_ICMP);
+    flow_con->purge_flows(IPPROTO_IP);
+}
+
+// flow setup, tcp tracking, and reassembly including the pdu splitters
+static void bench_stream(Packet* p)
+{
+    BenchResult& r = get_result("stream_tcp");
+    set_main_hook(ignore_pdu);
+
+    for ( unsigned run = 0; run <= BENCH_RUNS; ++run )
+    {
+        BenchCount tcp = { 0, 0, 0 };
+        replay(p, &tcp);
+
+        if ( run )
+            r.ticks.push_back(tcp.ticks);
+
+        r.pkts = tcp.pkts;
+        r.bytes = tcp.bytes;
+    }
+}
+
+// service inspector processing of reassembled pdus, eg http normalization
+static void bench_inspect(Packet* p)
+{
+    set_main_hook(inspect_pdu);
+
+    for ( unsigned run = 0; run <= BENCH_RUNS; ++run )
+    {
+        s_gadgets.clear();
+        replay(p, nullptr);
+
+        if ( !run )
+            continue;
+
+        for ( auto& g : s_gadgets )
+        {
+            BenchResult& r = get_result("inspect:" + g.first);
+            r.ticks.push_back(g.second.ticks);
+            r.pkts = g.second.pkts;
+            r.bytes = g.second.bytes;
+        }
+    }
+    if ( s_gadgets.empty() )
+        LogMessage("bench: no service inspectors were bound\n");
+}
+
+//-------------------------------------------------------------------------
+// api
+//-------------------------------------------------------------------------
+
+void bench_mode(const char* s)
+{
+    s_components = 0;
+
+    if ( !s )
+        return;
+
+    string list(s);
+    size_t pos = 0;
+
+    while ( pos < list.size() )
+    {
+        size_t end = list.find_first_of(", ", pos);
+
+        if ( end == string::npos )
+            end = list.size();
+
+        string tok = list.substr(pos, end - pos);
+        pos = end + 1;
+
+        if ( tok.empty() )
+            continue;
+
+        if ( tok == "mpse" )
+            s_components |= BENCH_MPSE;
+
+        else if ( tok == "decode" )
+            s_components |= BENCH_DECODE;
+
+        else if ( tok == "stream" )
+            s_components |= BENCH_STREAM;
+
+        else if ( tok == "inspect" )
+            s_components |= BENCH_INSPECT;
+
+        else if ( tok == "log" )
+            s_components |= BENCH_LOG;
+
+        else if ( tok == "all" )
+            s_components |= BENCH_ALL;
+
+        else
+            ParseError("unknown benchmark component '%s'", tok.c_str());
+    }
+}
+
+bool bench_enabled()
+{
+    return s_components != 0;
+}
+
+int bench()
+{
+    const char* pcap = Trough_First();
+
+    if ( !pcap )
+    {
+        ErrorMessage("benchmarks require pcaps (see -r)\n");
+        return EXIT_FAILURE;
+    }
+
+    snort_thread_init(pcap);
+    load_pcaps();
+
+    if ( s_pkts.empty() )
+    {
+        ErrorMessage("benchmarks found no packets in the given pcaps\n");
+        snort_thread_term();
+        return EXIT_FAILURE;
+    }
+
+    Packet* p = PacketManager::encode_new(false);
+    find_payloads(p);
+
+    LogMessage("bench: %zu packets, %zu bytes\n", s_pkts.size(), s_data.size());
+
+    if ( s_components & BENCH_MPSE )
+        bench_mpse();
+
+    if ( s_components & BENCH_DECODE )
+        bench_decode(p);
+
+    if ( s_components & BENCH_LOG )
+        bench_log(p);
+
+    if ( s_components & (BENCH_STREAM|BENCH_INSPECT) )
+    {
+        s_stream = InspectorManager::get_inspector("stream");
+
+        if ( !s_stream )
+            LogMessage("bench: stream is not configured\n");
+
+        else
+        {
+            if ( s_components & BENCH_STREAM )
+                bench_stream(p);
+
+            if ( s_components & BENCH_INSPECT )
+                bench_inspect(p);
+        }
+    }
+    show_results();
+
+    PacketManager::encode_delete(p);
+    snort_thread_term();
+
+    return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,250 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// binder_test.cc
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <vector>
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wgnu-zero-variadic-macro-arguments"
+#endif
+
+#include <check.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+
+#include "flow/flow.h"
+#include "flow/flow_key.h"
+#include "framework/decode_data.h"
+#include "network_inspectors/binder/binding.h"
+#include "network_inspectors/binder/bind_index.h"
+
+//---------------------------------------------------------------
+// the binder walks the index candidates in order and checks the rest of
+// each binding.  it must select the same binding as a linear check_all()
+// over wildcard and specific bindings, including flow values outside the
+// configurable ranges.
+
+#define NUM_FLOWS 2000
+
+static uint32_t s_seed = 1;
+
+static uint32_t next_rand()
+{
+    s_seed = s_seed * 1103515245 + 12345;
+    return s_seed >> 8;
+}
+
+static const unsigned counts[] = { 1, 2, 63, 64, 65, 130, 300 };
+
+#define NUM_COUNTS (sizeof(counts)/sizeof(counts[0]))
+
+static const PktType protos[] =
+{
+    PktType::UNKNOWN, PktType::IP, PktType::TCP, PktType::UDP,
+    PktType::ICMP, PktType::ARP, PktType::ANY, PktType::ANY_IP
+};
+
+#define NUM_PROTOS (sizeof(protos)/sizeof(protos[0]))
+
+// values the bindings use so that flows hit them
+static uint16_t s_ports[8] = { 0, 65535, 80, 443 };
+static uint16_t s_vlans[8] = { 0, 4095, 1, 100 };
+static uint8_t s_ifaces[8] = { 0, 255, 1, 2 };
+
+// half the time a dimension is left wild; otherwise one to three of the
+// known values are set
+template<typename T, size_t N>
+static void set_bits(std::bitset<N>& bits, const T* vals)
+{
+    if ( next_rand() & 1 )
+        return;
+
+    bits.reset();
+
+    for ( unsigned n = next_rand() % 3 + 1; n; --n )
+        bits.set(vals[next_rand() % 8]);
+}
+
+static Binding* make_binding()
+{
+    Binding* pb = new Binding;
+
+    if ( next_rand() & 1 )
+        pb->when.protos = (unsigned)protos[next_rand() % NUM_PROTOS];
+
+    set_bits(pb->when.ports, s_ports);
+    set_bits(pb->when.vlans, s_vlans);
+    set_bits(pb->when.ifaces, s_ifaces);
+
+    if ( !(next_rand() % 4) )
+        pb->when.id = next_rand() % 3 + 1;
+
+    return pb;
+}
+
+// some flow values are out of range for the bindings; vlan tags and
+// ifaces are reduced to their configurable bits by the checks and the
+// index alike
+static void make_flow(Flow& flow, FlowKey& key)
+{
+    flow.protocol = (next_rand() % 4) ?
+        protos[next_rand() % NUM_PROTOS] : (PktType)(next_rand() & 0xFF);
+
+    flow.server_port = (next_rand() % 4) ?
+        s_ports[next_rand() % 8] : next_rand();
+
+    key.vlan_tag = s_vlans[next_rand() % 8];
+
+    if ( !(next_rand() % 4) )
+        key.vlan_tag |= (next_rand() % 16) << 12;
+
+    int32_t ifaces[2];
+
+    for ( auto& i : ifaces )
+    {
+        switch ( next_rand() % 4 )
+        {
+        case 0: i = -1; break;
+        case 1: i = s_ifaces[next_rand() % 8] + 256 * (next_rand() % 4); break;
+        default: i = s_ifaces[next_rand() % 8]; break;
+        }
+    }
+    flow.iface_in = ifaces[0];
+    flow.iface_out = ifaces[1];
+    flow.policy_id = next_rand() % 4;
+    flow.key = &key;
+}
+
+// as Binder::get_bindings() does it
+static int indexed(
+    const BindIndex& index, const std::vector<Binding*>& bindings, const Flow* flow)
+{
+    for ( unsigned w = 0; w < index.get_words(); ++w )
+    {
+        uint64_t m = index.get_candidates(flow, w);
+
+        while ( m )
+        {
+            unsigned i = w * 64 + __builtin_ctzll(m);
+            m &= m - 1;
+
+            if ( bindings[i]->check_policy(flow) && bindings[i]->check_addr(flow) &&
+                bindings[i]->check_service(flow) )
+                return i;
+        }
+    }
+    return -1;
+}
+
+static int linear(const std::vector<Binding*>& bindings, const Flow* flow)
+{
+    for ( unsigned i = 0; i < bindings.size(); ++i )
+    {
+        if ( bindings[i]->check_all(flow) )
+            return i;
+    }
+    return -1;
+}
+
+static bool candidate(const BindIndex& index, const Flow* flow, unsigned i)
+{
+    return (index.get_candidates(flow, i / 64) >> (i % 64)) & 1;
+}
+
+static int SelectCheck(int c)
+{
+    unsigned num = counts[c];
+    int ret = 1;
+
+    for ( unsigned k = 4; k < 8; ++k )
+    {
+        s_ports[k] = next_rand();
+        s_vlans[k] = next_rand() % 4096;
+        s_ifaces[k] = next_rand();
+    }
+
+    std::vector<Binding*> bindings;
+
+    for ( unsigned i = 0; i < num; ++i )
+        bindings.push_back(make_binding());
+
+    BindIndex index;
+    index.compile(bindings);
+
+    for ( unsigned t = 0; t < NUM_FLOWS && ret; ++t )
+    {
+        Flow flow;
+        FlowKey key;
+        make_flow(flow, key);
+
+        for ( unsigned i = 0; i < num; ++i )
+        {
+            Binding* pb = bindings[i];
+
+            bool exp = pb->check_proto(&flow) && pb->check_port(&flow) &&
+                pb->check_vlan(&flow) && pb->check_iface(&flow);
+
+            if ( exp != candidate(index, &flow, i) )
+            {
+                printf("bindings %u flow %u: binding %u exp %d\n", num, t, i, exp);
+                ret = 0;
+                break;
+            }
+        }
+
+        int exp = linear(bindings, &flow);
+        int got = indexed(index, bindings, &flow);
+
+        if ( exp != got )
+        {
+            printf("bindings %u flow %u: exp %d, got %d\n", num, t, exp, got);
+            ret = 0;
+        }
+    }
+
+    for ( auto* pb : bindings )
+        delete pb;
+
+    return ret;
+}
+
+//---------------------------------------------------------------
+
+START_TEST (test_select)
+{
+    fail_unless(SelectCheck(_i) == 1, "SelectCheck()");
+}
+END_TEST
+
+Suite* TEST_SUITE_binder(void)
+{
+    Suite* ps = suite_create("binder");
+
+    TCase* tc = tcase_create("index");
+    tcase_add_loop_test(tc, test_select, 0, NUM_COUNTS);
+    suite_add_tcase(ps, tc);
+
+    return ps;
+}
@@ -0,0 +1,244 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// columnar_test.cc
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wgnu-zero-variadic-macro-arguments"
+#endif
+
+#include <check.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+
+#include "loggers/columnar_block.h"
+
+//---------------------------------------------------------------
+
+#define NUM_ROWS 256
+
+static uint32_t s_seed = 1;
+
+static uint32_t next_rand()
+{
+    s_seed = s_seed * 1103515245 + 12345;
+    return s_seed >> 8;
+}
+
+static void fill(ColumnarBlock& b)
+{
+    DAQ_PktHdr_t pkth;
+    memset(&pkth, 0, sizeof(pkth));
+
+    Packet p;
+    p.reset();
+    p.pkth = &pkth;
+
+    while ( !b.full() )
+    {
+        pkth.ts.tv_sec = next_rand();
+        pkth.ts.tv_usec = next_rand() % 1000000;
+        pkth.pktlen = next_rand() % 65536;
+        p.ptrs.sp = next_rand();
+        p.ptrs.dp = next_rand();
+        b.add(&p, nullptr);
+    }
+}
+
+static long file_size(FILE* f)
+{
+    struct stat st;
+
+    if ( fstat(fileno(f), &st) )
+        return -1;
+
+    return st.st_size;
+}
+
+// the file starts with a few bytes standing in for the file header
+static FILE* open_file()
+{
+    FILE* f = tmpfile();
+
+    if ( !f )
+        return nullptr;
+
+    setvbuf(f, nullptr, _IONBF, 0);
+
+    ColumnarFileHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+
+    if ( fwrite(&hdr, sizeof(hdr), 1, f) != 1 )
+    {
+        fclose(f);
+        return nullptr;
+    }
+    return f;
+}
+
+//---------------------------------------------------------------
+// a full block refuses more rows
+
+static int FullCheck(int)
+{
+    ColumnarBlock b(NUM_ROWS);
+    fill(b);
+
+    DAQ_PktHdr_t pkth;
+    memset(&pkth, 0, sizeof(pkth));
+
+    Packet p;
+    p.reset();
+    p.pkth = &pkth;
+
+    if ( b.add(&p, nullptr) || b.size() != NUM_ROWS )
+        return 0;
+
+    return 1;
+}
+
+//---------------------------------------------------------------
+// a good write empties the block and leaves the file at the end of it
+
+static int WriteCheck(int i)
+{
+    FILE* f = open_file();
+
+    if ( !f )
+        return 0;
+
+    ColumnarStats stats;
+    memset(&stats, 0, sizeof(stats));
+
+    ColumnarBlock b(NUM_ROWS);
+    fill(b);
+
+    long start = ftell(f);
+    size_t n = b.write(f, i, stats);
+
+    ColumnarBlockHeader hdr;
+    int ok = n > 0 && b.empty() && stats.blocks == 1 && !stats.dropped &&
+        ftell(f) == start + (long)n && file_size(f) == start + (long)n &&
+        !fseek(f, start, SEEK_SET) && fread(&hdr, sizeof(hdr), 1, f) == 1 &&
+        ntohl(hdr.magic) == COLUMNAR_BLOCK_MAGIC && ntohl(hdr.rows) == NUM_ROWS;
+
+    fclose(f);
+    return ok;
+}
+
+//---------------------------------------------------------------
+// a write that fails partway (here because the file size limit is hit)
+// must drop the rows, empty the block, and cut the file back to where
+// the block started so that the next block can be written in its place.
+
+static const unsigned cuts[] = { 0, 1, 64, 128, 512, 1024, 2048 };
+
+#define NUM_CUTS (sizeof(cuts)/sizeof(cuts[0]))
+
+static int FailCheck(int i)
+{
+    FILE* f = open_file();
+
+    if ( !f )
+        return 0;
+
+    ColumnarStats stats;
+    memset(&stats, 0, sizeof(stats));
+
+    ColumnarBlock b(NUM_ROWS);
+    fill(b);
+
+    long start = ftell(f);
+
+    struct rlimit save, lim;
+    getrlimit(RLIMIT_FSIZE, &save);
+    lim = save;
+    lim.rlim_cur = start + cuts[i];
+
+    void (*sig)(int) = signal(SIGXFSZ, SIG_IGN);
+    setrlimit(RLIMIT_FSIZE, &lim);
+
+    size_t n = b.write(f, 0, stats);
+
+    setrlimit(RLIMIT_FSIZE, &save);
+    signal(SIGXFSZ, sig);
+
+    int ok = 1;
+
+    if ( n || !b.empty() || stats.dropped != NUM_ROWS || stats.blocks )
+    {
+        printf("cut[%d]: wrote %zu, rows %u, dropped %llu\n", i, n, b.size(),
+            (unsigned long long)stats.dropped);
+        ok = 0;
+    }
+    else if ( ftell(f) != start || file_size(f) != start )
+    {
+        printf("cut[%d]: start %ld, pos %ld, size %ld\n", i, start, ftell(f), file_size(f));
+        ok = 0;
+    }
+    else
+    {
+        fill(b);
+        n = b.write(f, 0, stats);
+        ok = n > 0 && file_size(f) == start + (long)n && stats.blocks == 1;
+    }
+    fclose(f);
+    return ok;
+}
+
+//---------------------------------------------------------------
+
+START_TEST (test_full)
+{
+    fail_unless(FullCheck(_i) == 1, "FullCheck()");
+}
+END_TEST
+
+START_TEST (test_write)
+{
+    fail_unless(WriteCheck(_i) == 1, "WriteCheck()");
+}
+END_TEST
+
+START_TEST (test_fail)
+{
+    fail_unless(FailCheck(_i) == 1, "FailCheck()");
+}
+END_TEST
+
+Suite* TEST_SUITE_columnar(void)
+{
+    Suite* ps = suite_create("columnar");
+
+    TCase* tc = tcase_create("block");
+    tcase_add_test(tc, test_full);
+    tcase_add_loop_test(tc, test_write, 0, 10);
+    tcase_add_loop_test(tc, test_fail, 0, NUM_CUTS);
+    suite_add_tcase(ps, tc);
+
+    return ps;
+}
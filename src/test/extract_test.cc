@@ -0,0 +1,281 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// extract_test.cc
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wgnu-zero-variadic-macro-arguments"
+#endif
+
+#include <check.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+
+#include "ips_options/extract.h"
+
+//---------------------------------------------------------------
+// the kernels returned by get_byte_extractor() and get_string_extractor()
+// must agree with byte_extract() and string_extract():  both fail or both
+// succeed with the same value.  on success byte_extract() returns 0 where
+// the kernel returns the width, and string_extract() returns the number
+// of bytes parsed just like the kernel.
+
+#define MAX_BUF 24
+#define NUM_TRIALS 20000
+
+static uint32_t s_seed = 1;
+
+static uint32_t next_rand()
+{
+    s_seed = s_seed * 1103515245 + 12345;
+    return s_seed >> 8;
+}
+
+struct Input
+{
+    uint8_t buf[MAX_BUF];
+    unsigned len;   // end of buffer
+    int off;        // ptr - start, may be out of bounds
+};
+
+static void dump(const char* what, const Input& in, int size, int mode, int old_rc,
+    uint32_t old_val, int new_rc, uint32_t new_val)
+{
+    printf("%s mode %d size %d off %d len %u: old %d/%u new %d/%u [", what,
+        mode, size, in.off, in.len, old_rc, old_val, new_rc, new_val);
+
+    for ( unsigned i = 0; i < in.len; ++i )
+        printf(i ? " %02X" : "%02X", in.buf[i]);
+
+    printf("]\n");
+}
+
+static int CompareBinary(int endianess, int size, const Input& in)
+{
+    ByteExtractor extract = get_byte_extractor(endianess, size);
+
+    const uint8_t* start = in.buf;
+    const uint8_t* end = in.buf + in.len;
+    const uint8_t* ptr = start + in.off;
+
+    uint32_t old_val = 0, new_val = 0;
+    int old_rc = byte_extract(endianess, size, ptr, start, end, &old_val);
+    int new_rc = extract(size, ptr, start, end, &new_val);
+
+    if ( old_rc < 0 && new_rc < 0 )
+        return 1;
+
+    if ( !old_rc && new_rc == size && old_val == new_val )
+        return 1;
+
+    dump("binary", in, size, endianess, old_rc, old_val, new_rc, new_val);
+    return 0;
+}
+
+static int CompareString(int base, int size, const Input& in)
+{
+    ByteExtractor extract = get_string_extractor(base);
+
+    const uint8_t* start = in.buf;
+    const uint8_t* end = in.buf + in.len;
+    const uint8_t* ptr = start + in.off;
+
+    uint32_t old_val = 0, new_val = 0;
+    int old_rc = string_extract(size, base, ptr, start, end, &old_val);
+    int new_rc = extract(size, ptr, start, end, &new_val);
+
+    if ( old_rc < 0 && new_rc < 0 )
+        return 1;
+
+    if ( old_rc == new_rc && old_val == new_val )
+        return 1;
+
+    dump("string", in, size, base, old_rc, old_val, new_rc, new_val);
+    return 0;
+}
+
+//---------------------------------------------------------------
+// binary: every endianess including the dce (ENDIAN_FUNC) variants, which
+// neither implementation supports, and sizes around the valid 1-4.  the
+// pointer ranges from before the start to past the end so that short
+// buffers and partial fits are covered.
+
+static int BinaryCheck(int endianess)
+{
+    Input in;
+
+    for ( unsigned t = 0; t < NUM_TRIALS; ++t )
+    {
+        for ( unsigned i = 0; i < MAX_BUF; ++i )
+            in.buf[i] = next_rand();
+
+        in.len = next_rand() % 9;
+        in.off = (int)(next_rand() % (in.len + 5)) - 2;
+
+        for ( int size = 0; size <= 5; ++size )
+        {
+            if ( !CompareBinary(endianess, size, in) )
+                return 0;
+        }
+    }
+    return 1;
+}
+
+//---------------------------------------------------------------
+// strings: bytes are drawn mostly from characters that matter to the
+// parser so that digits, signs, space, 0x prefixes, embedded nuls, and
+// digits of a larger base all show up in and just past the window.
+
+static const char s_chars[] =
+    "0123456789012345678901234567890123456789abcdefABCDEFgGzZ"
+    "xXxX++--  \t\n\v\f\r";
+
+static uint8_t rand_char()
+{
+    unsigned r = next_rand() % 64;
+
+    if ( r < sizeof(s_chars) - 1 )
+        return s_chars[r];
+
+    if ( r & 1 )
+        return 0;
+
+    return next_rand();
+}
+
+static const int bases[] = { 8, 10, 16 };
+
+#define NUM_BASES (sizeof(bases)/sizeof(bases[0]))
+
+static int StringCheck(int b)
+{
+    Input in;
+
+    for ( unsigned t = 0; t < NUM_TRIALS; ++t )
+    {
+        for ( unsigned i = 0; i < MAX_BUF; ++i )
+            in.buf[i] = rand_char();
+
+        in.len = next_rand() % (MAX_BUF + 1);
+        in.off = (int)(next_rand() % (in.len + 5)) - 2;
+
+        for ( int size = -1; size <= PARSELEN + 1; ++size )
+        {
+            if ( !CompareString(bases[b], size, in) )
+                return 0;
+        }
+    }
+    return 1;
+}
+
+//---------------------------------------------------------------
+// specific cases are tried at every base, window size, and offset within
+// a buffer that ends exactly at the string and one that has more digits
+// after it.
+
+struct Case
+{
+    const char* s;
+    unsigned len;
+};
+
+#define CASE(s) { s, sizeof(s) - 1 }
+
+static const Case s_cases[] =
+{
+    CASE(""), CASE(" "), CASE("          "), CASE("\t\n\v\f\r 1"), CASE("0"),
+    CASE("00000000000"), CASE("7"), CASE("8"), CASE("9"), CASE("a"), CASE("f"),
+    CASE("g"), CASE("12345678"), CASE("123456789"), CASE("1234567890"),
+    CASE("12345678901"), CASE("4294967295"), CASE("4294967296"),
+    CASE("9999999999"), CASE("37777777777"), CASE("40000000000"),
+    CASE("ffffffff"), CASE("100000000"), CASE("FFFFFFFFFF"), CASE("+1"),
+    CASE("+"), CASE("-1"), CASE("+-1"), CASE("-+1"), CASE("++1"), CASE("+ 1"),
+    CASE(" +12"), CASE(" -12"), CASE("0x"), CASE("0X"), CASE("0x1"),
+    CASE("0xg"), CASE("0x0x1"), CASE("+0x1f"), CASE(" 0xFFFFFFFF"),
+    CASE("0x100000000"), CASE("x1"), CASE("1x1"), CASE("12 34"),
+    CASE("12\0" "34"), CASE("\0" "1234"), CASE("0019"), CASE("08"),
+    CASE("0o7"), CASE("123abc"), CASE("1234567\0" "9"),
+};
+
+#define NUM_CASES (sizeof(s_cases)/sizeof(s_cases[0]))
+
+static int CaseCheck(int c)
+{
+    const char* s = s_cases[c].s;
+    unsigned n = s_cases[c].len;
+
+    for ( unsigned pad = 0; pad < 2; ++pad )
+    {
+        Input in;
+        memset(in.buf, '9', sizeof(in.buf));
+        memcpy(in.buf, s, n);
+        in.len = pad ? MAX_BUF : n;
+
+        for ( in.off = -1; in.off <= (int)n; ++in.off )
+        {
+            for ( unsigned b = 0; b < NUM_BASES; ++b )
+            {
+                for ( int size = 0; size <= PARSELEN + 1; ++size )
+                {
+                    if ( !CompareString(bases[b], size, in) )
+                        return 0;
+                }
+            }
+        }
+    }
+    return 1;
+}
+
+//---------------------------------------------------------------
+
+START_TEST (test_binary)
+{
+    fail_unless(BinaryCheck(_i) == 1, "BinaryCheck()");
+}
+END_TEST
+
+START_TEST (test_string)
+{
+    fail_unless(StringCheck(_i) == 1, "StringCheck()");
+}
+END_TEST
+
+START_TEST (test_case)
+{
+    fail_unless(CaseCheck(_i) == 1, "CaseCheck()");
+}
+END_TEST
+
+Suite* TEST_SUITE_extract(void)
+{
+    Suite* ps = suite_create("extract");
+
+    TCase* tc = tcase_create("kernels");
+    tcase_add_loop_test(tc, test_binary, 0, 4);
+    tcase_add_loop_test(tc, test_string, 0, NUM_BASES);
+    tcase_add_loop_test(tc, test_case, 0, NUM_CASES);
+    suite_add_tcase(ps, tc);
+
+    return ps;
+}
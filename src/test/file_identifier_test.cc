@@ -0,0 +1,150 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// file_identifier_test.cc
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wgnu-zero-variadic-macro-arguments"
+#endif
+
+#include <check.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+
+#include "file_api/libs/file_config.h"
+#include "file_api/libs/file_identifier.h"
+#include "file_api/libs/file_lib.h"
+
+//---------------------------------------------------------------
+// file data arrives in chunks.  a magic may be split across them and
+// a type matched early is replaced by a longer magic that matches in
+// a later chunk.  when the file ends first, the last type matched
+// on the way stands.
+
+#define ZIP 1
+#define JAR 2
+#define PDF 3
+
+static const char* rules[] =
+{
+    "type:ZIP; id:1; category:Archive; content:| 50 4B 03 04 |; offset:0;",
+    "type:JAR; id:2; category:Archive; content:| 50 4B 03 04 |; offset:0; "
+        "content:| 4D 45 54 41 2D 49 4E 46 2F |; offset:30;",
+    "type:PDF; id:3; category:PDF; content:| 25 50 44 46 |; offset:0;",
+};
+
+#define NUM_RULES (sizeof(rules)/sizeof(rules[0]))
+
+#define JAR_DATA "PK\3\4\24\0\10\0\10\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0" \
+    "META-INF/MANIFEST.MF"
+
+struct IdData
+{
+    const char* data;
+    unsigned len;
+    unsigned chunk;
+    uint32_t type;
+};
+
+static IdData idData[] =
+{
+    { "%PDF-1.4\n", 9, 2, PDF },
+    { "%PDF-1.4\n", 9, 1, PDF },
+    { "%PDF-1.4\n", 9, 9, PDF },
+    { "PK\3\4\24\0\0\0\10\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0", 36, 2, ZIP },
+    { JAR_DATA, sizeof(JAR_DATA)-1, 10, JAR },
+    { JAR_DATA, sizeof(JAR_DATA)-1, 32, JAR },
+    { JAR_DATA, sizeof(JAR_DATA)-1, sizeof(JAR_DATA)-1, JAR },
+    { "PK\3\4\24\0\0\0\10\0", 10, 4, ZIP },
+    { "%PD", 3, 2, SNORT_FILE_TYPE_UNKNOWN },
+    { "GIF89a", 6, 3, SNORT_FILE_TYPE_UNKNOWN },
+};
+
+#define NUM_DATA (sizeof(idData)/sizeof(idData[0]))
+
+static void* s_conf = nullptr;
+
+static void Init(void)
+{
+    for ( unsigned i = 0; i < NUM_RULES; ++i )
+        parse_file_rule(rules[i], &s_conf);
+
+    compile_file_identifiers(s_conf);
+}
+
+static void Term(void)
+{
+    free_file_rules(s_conf);
+    free_file_identifiers(s_conf);
+    free(s_conf);
+    s_conf = nullptr;
+}
+
+static uint32_t Identify(const uint8_t* buf, unsigned len, unsigned chunk)
+{
+    FileContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.file_config = s_conf;
+
+    for ( unsigned pos = 0; pos < len; pos += chunk )
+    {
+        unsigned n = (len - pos < chunk) ? len - pos : chunk;
+        FilePosition fp;
+
+        if ( !pos )
+            fp = (n == len) ? SNORT_FILE_FULL : SNORT_FILE_START;
+        else
+            fp = (pos + n == len) ? SNORT_FILE_END : SNORT_FILE_MIDDLE;
+
+        file_type_id(&ctx, (uint8_t*)buf + pos, n, fp);
+        ctx.processed_bytes += n;
+    }
+    return ctx.file_type_id;
+}
+
+static int IdCheck(int i)
+{
+    const IdData* p = idData + i;
+    return Identify((const uint8_t*)p->data, p->len, p->chunk) == p->type;
+}
+
+//---------------------------------------------------------------
+
+START_TEST (test_identify)
+{
+    fail_unless(IdCheck(_i) == 1, "IdCheck()");
+}
+END_TEST
+
+Suite* TEST_SUITE_file_identifier(void)
+{
+    Suite* ps = suite_create("file_identifier");
+
+    TCase* tc = tcase_create("chunked");
+    tcase_add_unchecked_fixture(tc, Init, Term);
+    tcase_add_loop_test(tc, test_identify, 0, NUM_DATA);
+    suite_add_tcase(ps, tc);
+
+    return ps;
+}
+
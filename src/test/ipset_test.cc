@@ -0,0 +1,154 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// ipset_test.cc
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wgnu-zero-variadic-macro-arguments"
+#endif
+
+#include <check.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+
+#include "network_inspectors/port_scan/ipobj.h"
+#include "sfip/sf_ip.h"
+
+//---------------------------------------------------------------
+// ipset_parse() compiles the set into a range table; without the
+// table ipset_contains() walks the list.  both must agree.  there is
+// no ipv4 /0 here because sfip_contains() shifts a 32 bit value by 32
+// when it compares one with a mapped ipv6 address.
+
+static const char* sets[] =
+{
+    "10.1.2.3",
+    "!10.0.0.0/8",
+    "[10.0.0.0/8,!10.1.0.0/16,192.168.1.0/24 80,192.168.1.128/25 1000-2000,"
+        "!192.168.1.200/32 80]",
+    "[1.2.3.4,1.2.3.4/30 22,0.0.0.0/1 8080,192.0.0.0/2 8080]",
+    "[0.0.0.0/1 80,128.0.0.0/1 80,255.255.255.255,0.0.0.0]",
+    "[2001:db8::/32,!2001:db8:1::/48 443,::ffff:172.16.0.0/108,"
+        "!::ffff:192.168.0.0/112 53,192.168.0.0/16]",
+    "[2001:db8::/32 53,::/1 80,ffff::/16]",
+    "[10.0.0.0/8 22,10.0.0.0/16 80,10.0.0.0/24 443,10.0.0.0/30,!10.0.0.1]",
+};
+
+#define NUM_SETS (sizeof(sets)/sizeof(sets[0]))
+
+static const unsigned short ports[] = { 0, 22, 53, 80, 443, 999, 1000, 1500, 2000, 8080 };
+
+#define NUM_PORTS (sizeof(ports)/sizeof(ports[0]))
+
+#define NUM_IPS 20000
+
+static uint32_t s_seed = 1;
+
+static uint32_t next_rand()
+{
+    s_seed = s_seed * 1103515245 + 12345;
+    return (s_seed >> 8) ^ (s_seed << 16);
+}
+
+// addresses are drawn near the ones in the sets so most lookups land
+// on an edge or inside an entry
+static void rand_ip(sfip_t* ip)
+{
+    static const uint8_t v4[] = { 0, 1, 10, 172, 192, 255 };
+    static const uint16_t v6[] = { 0x0000, 0x2001, 0x7fff, 0x8000, 0xffff };
+
+    uint32_t r = next_rand();
+    char buf[64];
+
+    switch ( r % 3 )
+    {
+    case 0:
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u",
+            v4[(r >> 2) % sizeof(v4)], (r >> 8) & 3, next_rand() & 3, next_rand() & 0xff);
+        break;
+
+    case 1:
+        snprintf(buf, sizeof(buf), "%x:%x:%x::%x",
+            v6[(r >> 2) % (sizeof(v6)/sizeof(v6[0]))], 0xdb8 * ((r >> 8) & 1),
+            (r >> 9) & 3, next_rand() & 0xffff);
+        break;
+
+    default:
+        snprintf(buf, sizeof(buf), "::ffff:%u.%u.%u.%u",
+            (r & 8) ? 172 : 192, (r & 16) ? 16 : 168, (r >> 8) & 0xff, next_rand() & 0xff);
+        break;
+    }
+    sfip_pton(buf, ip);
+}
+
+static int LookupCheck(int i)
+{
+    IPSET* set = ipset_new();
+
+    if ( ipset_parse(set, sets[i]) || !set->lpm )
+    {
+        ipset_free(set);
+        return 0;
+    }
+
+    IpsetLpm* lpm = set->lpm;
+    int ok = 1;
+    s_seed = i + 1;
+
+    for ( unsigned n = 0; ok && n < NUM_IPS; ++n )
+    {
+        sfip_t ip;
+        rand_ip(&ip);
+
+        unsigned short port = ports[next_rand() % NUM_PORTS];
+        int got = ipset_contains(set, &ip, &port);
+
+        set->lpm = nullptr;
+        int exp = ipset_contains(set, &ip, &port);
+        set->lpm = lpm;
+
+        ok = (got == exp);
+    }
+    ipset_free(set);
+    return ok;
+}
+
+//---------------------------------------------------------------
+
+START_TEST (test_lookup)
+{
+    fail_unless(LookupCheck(_i) == 1, "LookupCheck()");
+}
+END_TEST
+
+Suite* TEST_SUITE_ipset(void)
+{
+    Suite* ps = suite_create("ipset");
+
+    TCase* tc = tcase_create("lookup");
+    tcase_add_loop_test(tc, test_lookup, 0, NUM_SETS);
+    suite_add_tcase(ps, tc);
+
+    return ps;
+}
+
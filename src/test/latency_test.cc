@@ -0,0 +1,153 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// latency_test.cc
+
+#include <stdio.h>
+#include <stdint.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wgnu-zero-variadic-macro-arguments"
+#endif
+
+#include <check.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+
+#include "time/latency.h"
+
+//---------------------------------------------------------------
+// each bucket covers [get_limit(i-1)+1, get_limit(i)] and its width is
+// at most 1/8 of its lower bound.  the last bucket ends at UINT64_MAX.
+
+static int IndexCheck(int i)
+{
+    uint64_t lim = LatencyHistogram::get_limit(i);
+    uint64_t low = i ? LatencyHistogram::get_limit(i - 1) + 1 : 0;
+
+    if ( low > lim )
+        return 0;
+
+    if ( LatencyHistogram::get_index(low) != (unsigned)i ||
+        LatencyHistogram::get_index(lim) != (unsigned)i )
+        return 0;
+
+    if ( i + 1 < LATENCY_BUCKETS )
+        return LatencyHistogram::get_index(lim + 1) == (unsigned)i + 1;
+
+    return lim == UINT64_MAX;
+}
+
+static int PrecisionCheck(int i)
+{
+    uint64_t lim = LatencyHistogram::get_limit(i);
+    uint64_t low = i ? LatencyHistogram::get_limit(i - 1) + 1 : 0;
+
+    if ( i < LATENCY_SUB_BUCKETS )
+        return low == lim;
+
+    return (lim - low) <= low / LATENCY_SUB_BUCKETS;
+}
+
+//---------------------------------------------------------------
+// percentiles report the limit of the bucket that covers them, but
+// never more than the max recorded
+
+struct PctData
+{
+    uint64_t value;
+    unsigned count;
+    uint64_t extra;     // recorded once if not 0
+    double pct;
+    uint64_t expect;
+};
+
+static PctData pctData[] =
+{
+    { 0, 0, 0, 50.0, 0 },
+    { 3, 1, 0, 50.0, 3 },
+    { 7, 4, 8, 50.0, 7 },
+    { 7, 4, 8, 100.0, 8 },
+    { 15, 1, 16, 50.0, 15 },
+    { 15, 1, 16, 100.0, 16 },
+    { 16, 1, 17, 100.0, 17 },
+    { 100, 100, 1000000, 50.0, 103 },
+    { 100, 100, 1000000, 99.0, 103 },
+    { 100, 100, 1000000, 100.0, 1000000 },
+    { 1000, 3, 0, 100.0, 1000 },
+    { UINT64_MAX, 1, 0, 100.0, UINT64_MAX },
+};
+
+#define NUM_PCTS (sizeof(pctData)/sizeof(pctData[0]))
+
+static int PctCheck(int i)
+{
+    PctData* p = pctData + i;
+    LatencyHistogram h;
+
+    for ( unsigned n = 0; n < p->count; ++n )
+        h.record(p->value);
+
+    if ( p->extra )
+        h.record(p->extra);
+
+    uint64_t got = h.get_percentile(p->pct);
+
+    if ( got == p->expect )
+        return 1;
+
+    printf("pct[%d]: exp %llu, got %llu\n", i,
+        (unsigned long long)p->expect, (unsigned long long)got);
+    return 0;
+}
+
+//---------------------------------------------------------------
+
+START_TEST (test_index)
+{
+    fail_unless(IndexCheck(_i) == 1, "IndexCheck()");
+}
+END_TEST
+
+START_TEST (test_precision)
+{
+    fail_unless(PrecisionCheck(_i) == 1, "PrecisionCheck()");
+}
+END_TEST
+
+START_TEST (test_percentile)
+{
+    fail_unless(PctCheck(_i) == 1, "PctCheck()");
+}
+END_TEST
+
+Suite* TEST_SUITE_latency(void)
+{
+    Suite* ps = suite_create("latency");
+
+    TCase* tc = tcase_create("histogram");
+    tcase_add_loop_test(tc, test_index, 0, LATENCY_BUCKETS);
+    tcase_add_loop_test(tc, test_precision, 0, LATENCY_BUCKETS);
+    tcase_add_loop_test(tc, test_percentile, 0, NUM_PCTS);
+    suite_add_tcase(ps, tc);
+
+    return ps;
+}
+
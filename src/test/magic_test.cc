@@ -0,0 +1,248 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// magic_test.cc
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wgnu-zero-variadic-macro-arguments"
+#endif
+
+#include <check.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+
+#include "service_inspectors/wizard/magic.h"
+
+//---------------------------------------------------------------
+// one book like the default wizard configuration plus a hex that
+// conflicts with a spell
+
+struct MagicKey
+{
+    const char* key;
+    const char* value;
+};
+
+static const MagicKey spells[] =
+{
+    { "*SSH", "ssh" },
+    { "220", "banner" },
+    { "220*SMTP", "smtp" },
+    { "220*FTP", "ftp" },
+    { "GET", "http" },
+    { "HTTP/", "http" },
+    { "**OK", "imap" },
+    { "SIP/", "sip" },
+};
+
+static const MagicKey hexes[] =
+{
+    { "|05 00|", "dcerpc" },
+    { "|53 49 50|", "hex sip" },    // "SIP"
+    { "??|00 00|", "modbus" },
+};
+
+#define NUM_SPELLS (sizeof(spells)/sizeof(spells[0]))
+#define NUM_HEXES (sizeof(hexes)/sizeof(hexes[0]))
+
+static MagicBook* book = nullptr;
+
+static void Init()
+{
+    book = new MagicBook;
+
+    for ( unsigned i = 0; i < NUM_SPELLS; ++i )
+        book->add_spell(spells[i].key, spells[i].value);
+
+    for ( unsigned i = 0; i < NUM_HEXES; ++i )
+        book->add_hex(hexes[i].key, hexes[i].value);
+
+    book->compile();
+}
+
+static void Term()
+{
+    delete book;
+    book = nullptr;
+}
+
+//---------------------------------------------------------------
+
+struct MagicData
+{
+    const char* data;
+    unsigned len;
+    const char* expect;
+};
+
+#define MD(s, e) { s, sizeof(s) - 1, e }
+
+static const MagicData magicData[] =
+{
+    // globs match any number of bytes, including none
+    MD("SSH-2.0-OpenSSH", "ssh"),
+    MD("xxxxSSH-2.0", "ssh"),
+    MD("   ssh-2.0", "ssh"),
+    MD("SS", nullptr),
+    MD("xxxxxxxxxxxxxxxxSSH", nullptr),   // past the depth
+
+    // the longest match wins
+    MD("220 hello", "banner"),
+    MD("220 x ESMTP", "smtp"),
+    MD("220 ftp ready", "ftp"),
+    MD("220", "banner"),
+
+    // spells are case insensitive and skip leading whitespace
+    MD("get / HTTP/1.1", "http"),
+    MD("\r\n GET /", "http"),
+    MD("HTTP/1.1 200 OK", "http"),
+    MD("*OK IMAP", "imap"),
+    MD("* OK IMAP", nullptr),
+    MD("GE", nullptr),
+
+    // a hex beats a spell, even a longer one; hexes are case sensitive
+    MD("SIP/2.0 200 OK", "hex sip"),
+    MD("sip/2.0 200 OK", "sip"),
+    MD("\x05\x00\x0b\x03", "dcerpc"),
+    MD("\x01\x02\x00\x00\x00", "modbus"),
+    MD("\x01\x02\x00\x01\x00", nullptr),
+    MD(" \x05\x00", nullptr),
+    MD("", nullptr),
+};
+
+#define NUM_DATA (sizeof(magicData)/sizeof(magicData[0]))
+
+// scan the data in segments as the splitter does:  each segment resumes
+// from the state left by the one before until the book is done
+static const char* cast(const MagicData& md, unsigned seg)
+{
+    const uint8_t* data = (const uint8_t*)md.data;
+    const char* svc = nullptr;
+    unsigned len = md.len;
+
+    MagicState state;
+    book->reset(state);
+
+    do
+    {
+        unsigned n = (len < seg) ? len : seg, scanned;
+        svc = book->find_spell(data, n, state, scanned);
+        data += n;
+        len -= n;
+    }
+    while ( len && !book->done(state) );
+
+    return svc;
+}
+
+static bool same(const char* a, const char* b)
+{
+    if ( !a || !b )
+        return a == b;
+
+    return !strcmp(a, b);
+}
+
+static int MagicCheck(int i)
+{
+    const MagicData& md = magicData[i];
+    const char* svc = cast(md, md.len + 1);
+
+    if ( !same(svc, md.expect) )
+    {
+        printf("magic[%d]: exp %s, got %s\n", i,
+            md.expect ? md.expect : "none", svc ? svc : "none");
+        return 0;
+    }
+    return 1;
+}
+
+// every segment size from 1 byte on gives the same result as a single
+// segment; with two bytes "SS" and "H-" split the ssh glob
+static int ResumeCheck(int i)
+{
+    const MagicData& md = magicData[i];
+
+    for ( unsigned seg = 1; seg <= md.len; ++seg )
+    {
+        const char* svc = cast(md, seg);
+
+        if ( !same(svc, md.expect) )
+        {
+            printf("resume[%d] seg %u: exp %s, got %s\n", i, seg,
+                md.expect ? md.expect : "none", svc ? svc : "none");
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// the scan gives up at the depth whether or not anything matched
+static int DepthCheck(int)
+{
+    uint8_t data[64];
+    memset(data, 'x', sizeof(data));
+
+    MagicState state;
+    book->reset(state);
+
+    unsigned scanned;
+    const char* svc = book->find_spell(data, sizeof(data), state, scanned);
+
+    return !svc && book->done(state) && scanned < sizeof(data);
+}
+
+//---------------------------------------------------------------
+
+START_TEST (test_magic)
+{
+    fail_unless(MagicCheck(_i) == 1, "MagicCheck()");
+}
+END_TEST
+
+START_TEST (test_resume)
+{
+    fail_unless(ResumeCheck(_i) == 1, "ResumeCheck()");
+}
+END_TEST
+
+START_TEST (test_depth)
+{
+    fail_unless(DepthCheck(_i) == 1, "DepthCheck()");
+}
+END_TEST
+
+Suite* TEST_SUITE_magic(void)
+{
+    Suite* ps = suite_create("magic");
+
+    TCase* tc = tcase_create("book");
+    tcase_add_unchecked_fixture(tc, Init, Term);
+    tcase_add_loop_test(tc, test_magic, 0, NUM_DATA);
+    tcase_add_loop_test(tc, test_resume, 0, NUM_DATA);
+    tcase_add_test(tc, test_depth);
+    suite_add_tcase(ps, tc);
+
+    return ps;
+}
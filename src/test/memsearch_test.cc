@@ -0,0 +1,181 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// memsearch_test.cc
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wgnu-zero-variadic-macro-arguments"
+#endif
+
+#include <check.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+
+#include "utils/boyer_moore.h"
+#include "utils/memsearch.h"
+
+//---------------------------------------------------------------
+// content searches patterns shorter than MEMSEARCH_BM_MIN with memsearch
+// and longer ones with boyer-moore.  both must find the same first match
+// as a naive search.
+
+#define MAX_BUF 512
+#define NUM_TRIALS 2000
+
+static uint32_t s_seed = 1;
+
+static uint32_t next_rand()
+{
+    s_seed = s_seed * 1103515245 + 12345;
+    return s_seed >> 8;
+}
+
+static int naive(const uint8_t* buf, int blen, const uint8_t* pat, int plen, bool nocase)
+{
+    for ( int i = 0; i + plen <= blen; ++i )
+    {
+        int j = 0;
+
+        while ( j < plen && (nocase ? toupper(buf[i + j]) : buf[i + j]) == pat[j] )
+            ++j;
+
+        if ( j == plen )
+            return i;
+    }
+    return -1;
+}
+
+// as content does it
+static int search(const uint8_t* buf, int blen, uint8_t* pat, int plen, bool nocase)
+{
+    if ( plen < MEMSEARCH_BM_MIN )
+        return nocase ?
+            memsearch_nocase(buf, blen, pat, plen) : memsearch(buf, blen, pat, plen);
+
+    int* skip = make_skip((char*)pat, plen);
+    int* shift = make_shift((char*)pat, plen);
+
+    int found = nocase ?
+        mSearchCI((const char*)buf, blen, (char*)pat, plen, skip, shift) :
+        mSearch((const char*)buf, blen, (char*)pat, plen, skip, shift);
+
+    free(skip);
+    free(shift);
+    return found;
+}
+
+// a small alphabet makes for many partial matches.  case differences,
+// the bytes on either side of a-z and A-Z, and bytes above 0x7f check that
+// nocase folds exactly like toupper().
+static uint8_t rand_byte()
+{
+    static const uint8_t bytes[] =
+    { 'a', 'a', 'b', 'z', 'A', 'B', 'Z', '`', '{', '@', '[', 0x00, 0xE1, 0xFA };
+    return bytes[next_rand() % sizeof(bytes)];
+}
+
+static const int plens[] =
+{
+    1, 2, 3, 15, 16, 17, 31, 32, 33,
+    MEMSEARCH_BM_MIN - 2, MEMSEARCH_BM_MIN - 1, MEMSEARCH_BM_MIN,
+    MEMSEARCH_BM_MIN + 1, MEMSEARCH_BM_MIN + 2, 2 * MEMSEARCH_BM_MIN + 3
+};
+
+#define NUM_PLENS (sizeof(plens)/sizeof(plens[0]))
+
+// the pattern is planted at the start, at the end, at random, one byte
+// past the end (so it must not be found), or not at all.  the buffer
+// length ranges from a bit less than the pattern to the max so that the
+// tails of the vector loops are covered.
+static int SearchCheck(int i)
+{
+    int plen = plens[i / 2];
+    bool nocase = i & 1;
+
+    uint8_t pat[MAX_BUF], buf[MAX_BUF + 1];
+
+    for ( unsigned t = 0; t < NUM_TRIALS; ++t )
+    {
+        for ( int k = 0; k < plen; ++k )
+            pat[k] = nocase ? toupper(rand_byte()) : rand_byte();
+
+        int blen = plen - 2 + (int)(next_rand() % (MAX_BUF - plen + 3));
+
+        if ( blen < 0 )
+            blen = 0;
+
+        for ( int k = 0; k < blen; ++k )
+            buf[k] = rand_byte();
+
+        int at = -1;
+
+        switch ( t % 5 )
+        {
+        case 0: at = 0; break;
+        case 1: at = blen - plen; break;
+        case 2: at = (blen >= plen) ? next_rand() % (blen - plen + 1) : -1; break;
+        case 3: at = blen - plen + 1; break;
+        }
+
+        for ( int k = 0; at >= 0 && at + k <= blen && k < plen; ++k )
+        {
+            buf[at + k] = pat[k];
+
+            if ( nocase && (next_rand() & 1) )
+                buf[at + k] = tolower(pat[k]);
+        }
+
+        int exp = naive(buf, blen, pat, plen, nocase);
+        int got = search(buf, blen, pat, plen, nocase);
+
+        if ( exp != got )
+        {
+            printf("plen %d blen %d nocase %d: exp %d, got %d\n",
+                plen, blen, nocase, exp, got);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+//---------------------------------------------------------------
+
+START_TEST (test_search)
+{
+    fail_unless(SearchCheck(_i) == 1, "SearchCheck()");
+}
+END_TEST
+
+Suite* TEST_SUITE_memsearch(void)
+{
+    Suite* ps = suite_create("memsearch");
+
+    TCase* tc = tcase_create("naive");
+    tcase_add_loop_test(tc, test_search, 0, 2 * NUM_PLENS);
+    suite_add_tcase(ps, tc);
+
+    return ps;
+}
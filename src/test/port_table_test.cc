@@ -0,0 +1,198 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// port_table_test.cc
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <set>
+#include <vector>
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wgnu-zero-variadic-macro-arguments"
+#endif
+
+#include <check.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+
+#include "snort.h"
+#include "utils/sfportobject.h"
+
+//---------------------------------------------------------------
+// PortTablesCompile() compiles tables on worker threads when asked.
+// with static hashing, the compiled port groups and the order their
+// rules are hashed in must be the same as for a serial compile.
+
+#define NUM_TABLES 8
+#define NUM_OBJS 50
+#define NUM_RULES 1000
+
+static uint32_t s_seed = 1;
+
+static uint32_t next_rand()
+{
+    s_seed = s_seed * 1103515245 + 12345;
+    return (s_seed >> 8) ^ (s_seed << 16);
+}
+
+// random objects resembling rule port usage: mostly well known ports,
+// some ranges, a few wide ranges and negations
+static PortTable* RandTable(unsigned n)
+{
+    PortTable* pt = PortTableNew();
+    PortObject* pos[NUM_OBJS];
+    s_seed = n + 1;
+
+    for ( unsigned i = 0; i < NUM_OBJS; ++i )
+    {
+        PortObject* po = PortObjectNew();
+        unsigned k = 1 + next_rand() % 4;
+
+        for ( unsigned j = 0; j < k; ++j )
+        {
+            unsigned r = next_rand() % 10;
+            int port = (next_rand() & 1) ? next_rand() % 1024 : next_rand() % 65536;
+
+            if ( r < 6 )
+                PortObjectAddPort(po, port, 0);
+
+            else if ( r < 9 )
+            {
+                int hi = port + next_rand() % (r == 8 ? 60000 : 200);
+                PortObjectAddRange(po, port, hi > 65535 ? 65535 : hi, 0);
+            }
+            else
+                PortObjectAddPort(po, port, 1);
+        }
+        PortTableAddObject(pt, po);
+        pos[i] = po;
+    }
+    for ( unsigned r = 0; r < NUM_RULES; ++r )
+        PortObjectAddRule(pos[next_rand() % NUM_OBJS], r);
+
+    PortTableSortUniqRules(pt);
+    return pt;
+}
+
+// everything detection sees of a compiled table, in hash order; the
+// port groups are shared by many ports so each is listed once
+static void Dump(PortTable* pt, std::vector<int>& v)
+{
+    std::set<PortObject2*> seen;
+
+    for ( int i = 0; i < SFPO_MAX_PORTS; ++i )
+    {
+        PortObject2* po = pt->pt_port_object[i];
+
+        if ( !po )
+        {
+            v.push_back(-1);
+            continue;
+        }
+        v.push_back(po->id);
+
+        if ( !seen.insert(po).second )
+            continue;
+
+        v.push_back(po->port_cnt);
+
+        for ( SFGHASH_NODE* n = sfghash_findfirst(po->rule_hash); n;
+            n = sfghash_findnext(po->rule_hash) )
+            v.push_back(*(int*)n->data);
+
+        SF_LNODE* cur;
+
+        for ( PortObjectItem* poi = (PortObjectItem*)sflist_first(po->item_list, &cur);
+            poi; poi = (PortObjectItem*)sflist_next(&cur) )
+        {
+            v.push_back(poi->type);
+            v.push_back(poi->lport);
+            v.push_back(poi->hport);
+        }
+    }
+}
+
+static int run_flags = 0;
+
+static void Init(void)
+{
+    run_flags = snort_conf->run_flags;
+    snort_conf->run_flags |= RUN_FLAG__STATIC_HASH;
+}
+
+static void Term(void)
+{
+    snort_conf->run_flags = run_flags;
+}
+
+static int ParallelCheck(int i)
+{
+    PortTable* serial[NUM_TABLES];
+    PortTable* parallel[NUM_TABLES];
+
+    for ( unsigned n = 0; n < NUM_TABLES; ++n )
+    {
+        serial[n] = RandTable(i * NUM_TABLES + n);
+        parallel[n] = RandTable(i * NUM_TABLES + n);
+    }
+    PortTablesCompile(serial, NUM_TABLES, false);
+    PortTablesCompile(parallel, NUM_TABLES, true);
+
+    int ok = 1;
+
+    for ( unsigned n = 0; n < NUM_TABLES; ++n )
+    {
+        std::vector<int> a, b;
+        Dump(serial[n], a);
+        Dump(parallel[n], b);
+
+        if ( a != b )
+        {
+            printf("table[%d][%u] differs\n", i, n);
+            ok = 0;
+        }
+        PortTableFree(serial[n]);
+        PortTableFree(parallel[n]);
+    }
+    return ok;
+}
+
+//---------------------------------------------------------------
+
+START_TEST (test_parallel)
+{
+    fail_unless(ParallelCheck(_i) == 1, "ParallelCheck()");
+}
+END_TEST
+
+Suite* TEST_SUITE_port_table(void)
+{
+    Suite* ps = suite_create("port_table");
+
+    TCase* tc = tcase_create("parallel");
+    tcase_add_unchecked_fixture(tc, Init, Term);
+    tcase_add_loop_test(tc, test_parallel, 0, 2);
+    suite_add_tcase(ps, tc);
+
+    return ps;
+}
+
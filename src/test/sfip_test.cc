@@ -37,6 +37,8 @@
 
 #include "snort_types.h"
 #include "sfip/sf_ip.h"
+#include "sfip/sf_ipvar.h"
+#include "sfip/sf_vartable.h"
 
 //---------------------------------------------------------------
 
@@ -412,6 +414,152 @@ static int CopyCheck (int i) {
     return (status == SFIP_SUCCESS) && !memcmp(&ip1, &ip2, sizeof(ip1));
 }
 
+//---------------------------------------------------------------
+// the compiled lookup table must give the same answer as the list
+// walk.  each variable is checked with random addresses and with
+// addresses that share all but the last prefix bit of each node so
+// both sides of every edge are covered.
+
+static const char* vars[] = {
+    "any",
+    "10.1.2.3",
+    "[10.0.0.0/8,!10.1.0.0/16]",
+    "[10.0.0.0/8,!10.1.0.0/16,!10.2.3.4]",
+    "[0.0.0.0/1,128.0.0.0/2,255.255.255.255]",
+    "[!192.168.0.0/16,!172.16.0.0/12]",
+    "[192.168.1.0/24,192.168.1.128/25,192.168.2.0/23]",
+    "[2001:db8::/32,!2001:db8:1::/48]",
+    "[10.0.0.0/8,2001:db8::/32,!10.10.10.0/24,!2001:db8::1]",
+    "[::/0,!fe80::/10,!::1]",
+    "[ffff:ffff:ffff:ffff::/64,::/128]",
+};
+
+#define NUM_VARS (sizeof(vars)/sizeof(vars[0]))
+
+#define RAND_IPS 2000
+#define EDGE_IPS 64
+
+static uint32_t s_seed = 1;
+
+static uint32_t next_rand()
+{
+    s_seed = s_seed * 1103515245 + 12345;
+    return (s_seed >> 8) ^ (s_seed << 16);
+}
+
+static void rand_ip(sfip_t* ip, int family)
+{
+    uint32_t raw[4];
+
+    for ( int i = 0; i < 4; ++i )
+        raw[i] = next_rand();
+
+    sfip_set_raw(ip, raw, family);
+}
+
+// randomize the host bits and the last network bit of the node
+static void edge_ip(sfip_t* ip, const sfip_t* node)
+{
+    rand_ip(ip, sfip_family(node));
+
+    int bits = sfip_bits(node);
+
+    if ( bits > 0 )
+        --bits;
+
+    for ( int i = 0; i < bits; ++i )
+    {
+        uint8_t mask = 0x80 >> (i % 8);
+        ip->ip8[i / 8] = (ip->ip8[i / 8] & ~mask) | (node->ip8[i / 8] & mask);
+    }
+}
+
+static int LookupCheck(sfip_var_t* var, sfip_var_t* ref, const sfip_t* ip)
+{
+    int exp = sfvar_ip_in(ref, ip);
+    int got = sfvar_ip_in(var, ip);
+
+    if ( s_debug && got != exp )
+        printf("%s: %s expected %d\n", var->value, sfip_to_str(ip), exp);
+
+    return got == exp;
+}
+
+static int LpmCheck(sfip_var_t* var)
+{
+    // without the table sfvar_ip_in walks the lists
+    sfip_var_t* ref = sfvar_deep_copy(var);
+    int ok = ref && var->lpm && !ref->lpm;
+    sfip_t ip;
+
+    for ( int i = 0; ok && i < RAND_IPS; ++i )
+    {
+        rand_ip(&ip, (i & 1) ? AF_INET6 : AF_INET);
+        ok = LookupCheck(var, ref, &ip);
+    }
+
+    sfip_node_t* lists[] = { var->head, var->neg_head };
+
+    for ( auto node : lists )
+    {
+        for ( ; ok && node; node = node->next )
+        {
+            if ( !sfip_is_set(node->ip) )
+                continue;
+
+            for ( int i = 0; ok && i < EDGE_IPS; ++i )
+            {
+                edge_ip(&ip, node->ip);
+                ok = LookupCheck(var, ref, &ip);
+            }
+            ok = ok && LookupCheck(var, ref, node->ip);
+        }
+    }
+    sfvar_free(ref);
+    return ok;
+}
+
+static int VarCheck(int i)
+{
+    char buf[256];
+    snprintf(buf, sizeof(buf), "VAR %s", vars[i]);
+
+    SFIP_RET status;
+    vartable_t* table = sfvt_alloc_table();
+    sfip_var_t* var = sfvar_alloc(table, buf, &status);
+
+    s_seed = i + 1;
+    int ok = var && status == SFIP_SUCCESS && LpmCheck(var);
+
+    sfvar_free(var);
+    sfvt_free_table(table);
+    return ok;
+}
+
+// aliases are compiled by sfvar_alloc; rule header nets are built
+// with sfvt_add_to_var and compiled when the header is parsed.
+static int AliasCheck(int i)
+{
+    vartable_t* table = sfvt_alloc_table();
+    int ok = sfvt_define(table, "HOME", vars[i]) == SFIP_SUCCESS;
+
+    SFIP_RET status;
+    sfip_var_t* alias = sfvar_alloc(table, "ALIAS $HOME", &status);
+    sfip_var_t* home = sfvt_lookup_var(table, "HOME");
+
+    s_seed = i + 1;
+    ok = ok && alias && home && sfvar_is_alias(alias, home) && LpmCheck(alias);
+    sfvar_free(alias);
+
+    sfip_var_t* net = sfvar_create_alias(home, "NET");
+    ok = ok && net && !net->lpm && sfvt_add_to_var(table, net, "!1.2.3.4") == SFIP_SUCCESS;
+    ok = ok && !net->lpm && sfvar_compile(net) == SFIP_SUCCESS && LpmCheck(net);
+    sfvar_free(net);
+
+    sfvt_free_table(table);
+    return ok;
+}
+
 //---------------------------------------------------------------
 // check specific stuff: http://check.sourceforge.net/
 //
@@ -448,6 +596,18 @@ START_TEST (test_copy)
 }
 END_TEST
 
+START_TEST (test_var)
+{
+    fail_unless(VarCheck(_i) == 1, "VarCheck()");
+}
+END_TEST
+
+START_TEST (test_alias)
+{
+    fail_unless(AliasCheck(_i) == 1, "AliasCheck()");
+}
+END_TEST
+
 Suite* TEST_SUITE_sfip(void)
 {
     Suite* ps = suite_create("sf_ip");
@@ -463,6 +623,11 @@ Suite* TEST_SUITE_sfip(void)
     tcase_add_loop_test(tc, test_raw, 0, 2);
     suite_add_tcase(ps, tc);
 
+    tc = tcase_create("var");
+    tcase_add_loop_test(tc, test_var, 0, NUM_VARS);
+    tcase_add_loop_test(tc, test_alias, 0, NUM_VARS);
+    suite_add_tcase(ps, tc);
+
     return ps;
 }
 
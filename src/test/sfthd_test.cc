@@ -38,6 +38,8 @@
 #include "sfip/sf_ip.h"
 #include "parser/parse_ip.h"
 #include "filters/sfthd.h"
+#include "filters/sfaggr.h"
+#include "hash/sfxhash.h"
 #include "utils/util.h"
 
 //---------------------------------------------------------------
@@ -870,6 +872,104 @@ static int PacketCheck (int i) {
     return 0;
 }
 
+//---------------------------------------------------------------
+// the first event for an ip is tested against the stored node so
+// whatever it changes (threshold reset, aggregate delta) is kept.
+
+static THD_IP_NODE* FindNode (SFXHASH* h, THD_NODE* n, const sfip_t* ip) {
+    THD_IP_NODE_KEY key;
+    memset(&key, 0, sizeof(key));
+
+    key.thd_id = n->thd_id;
+    key.ip = *ip;
+    key.policyId = get_network_policy()->policy_id;
+
+    return (THD_IP_NODE*)sfxhash_find(h, &key);
+}
+
+static int FirstCheck (void) {
+    SFXHASH* h = sfthd_local_new(MEM_DEFAULT);
+    THD_NODE* n = (THD_NODE*)sfthd_create_rule_threshold(
+        1, THD_TRK_SRC, THD_TYPE_THRESHOLD, 1, 60);
+
+    sfip_t sip, dip;
+    sfip_pton("10.1.1.1", &sip);
+    sfip_pton("10.2.2.2", &dip);
+
+    int ok = sfthd_test_local(h, n, &sip, &dip, 100) == 0;
+    THD_IP_NODE* node = FindNode(h, n, &sip);
+
+    // the threshold fired and reset the count on the first event
+    ok = ok && node && node->count == 0 && node->tstart == 100;
+
+    free(n);
+    sfxhash_delete(h);
+    return ok;
+}
+
+static int FirstAggrCheck (void) {
+    SfAggr* agg = sfaggr_new(64);
+    SFXHASH* ha = sfthd_local_new(MEM_DEFAULT);
+    SFXHASH* hb = sfthd_local_new(MEM_DEFAULT);
+    THD_NODE* n = (THD_NODE*)sfthd_create_rule_threshold(
+        2, THD_TRK_SRC, THD_TYPE_LIMIT, 2, 60);
+
+    sfip_t sip, dip;
+    sfip_pton("10.1.1.1", &sip);
+    sfip_pton("10.2.2.2", &dip);
+
+    // thread a logs its limit; if the first event's publication were
+    // dropped, the second would count it again as a peer's
+    int ok = sfthd_test_local(ha, n, &sip, &dip, 100, agg) == 0;
+    ok = ok && sfthd_test_local(ha, n, &sip, &dip, 100, agg) == 0;
+
+    THD_IP_NODE* node = FindNode(ha, n, &sip);
+    ok = ok && node && node->aggr.published == 2 && node->aggr.peers == 0;
+
+    // thread b sees thread a's count on its first event
+    ok = ok && sfthd_test_local(hb, n, &sip, &dip, 100, agg) == -2;
+
+    free(n);
+    sfxhash_delete(hb);
+    sfxhash_delete(ha);
+    sfaggr_free(agg);
+    return ok;
+}
+
+// while counts are aggregated, tracking intervals follow the shared
+// windows (multiples of seconds) instead of starting at the first event,
+// so local and peer counts always cover the same interval
+static int AggrWindowCheck (void) {
+    SfAggr* agg = sfaggr_new(64);
+    SFXHASH* ha = sfthd_local_new(MEM_DEFAULT);
+    SFXHASH* hb = sfthd_local_new(MEM_DEFAULT);
+    THD_NODE* n = (THD_NODE*)sfthd_create_rule_threshold(
+        3, THD_TRK_SRC, THD_TYPE_LIMIT, 2, 10);
+
+    sfip_t sip, dip;
+    sfip_pton("10.1.1.1", &sip);
+    sfip_pton("10.2.2.2", &dip);
+
+    // thread b logs its limit in [90, 100)
+    int ok = sfthd_test_local(hb, n, &sip, &dip, 95, agg) == 0;
+    ok = ok && sfthd_test_local(hb, n, &sip, &dip, 99, agg) == 0;
+
+    // both threads start over at 100 and share the limit until 110
+    ok = ok && sfthd_test_local(ha, n, &sip, &dip, 100, agg) == 0;
+    ok = ok && sfthd_test_local(hb, n, &sip, &dip, 101, agg) == 0;
+    ok = ok && sfthd_test_local(ha, n, &sip, &dip, 102, agg) == -2;
+    ok = ok && sfthd_test_local(hb, n, &sip, &dip, 109, agg) == -2;
+
+    // and again at 110
+    ok = ok && sfthd_test_local(hb, n, &sip, &dip, 110, agg) == 0;
+
+    free(n);
+    sfxhash_delete(hb);
+    sfxhash_delete(ha);
+    sfaggr_free(agg);
+    return ok;
+}
+
 //---------------------------------------------------------------
 
 START_TEST (test_setup)
@@ -902,6 +1002,24 @@ START_TEST (test_cap)
 }
 END_TEST
 
+START_TEST (test_first)
+{
+    fail_unless(FirstCheck() == 1, "FirstCheck()");
+}
+END_TEST
+
+START_TEST (test_first_aggr)
+{
+    fail_unless(FirstAggrCheck() == 1, "FirstAggrCheck()");
+}
+END_TEST
+
+START_TEST (test_aggr_window)
+{
+    fail_unless(AggrWindowCheck() == 1, "AggrWindowCheck()");
+}
+END_TEST
+
 Suite* TEST_SUITE_sfthd(void)
 {
     Suite* ps = suite_create("sfthd");
@@ -924,6 +1042,12 @@ Suite* TEST_SUITE_sfthd(void)
     tcase_add_loop_test(tc, test_packet, 0, NUM_PKTS);
     suite_add_tcase(ps, tc);
 
+    tc = tcase_create("first");
+    tcase_add_test(tc, test_first);
+    tcase_add_test(tc, test_first_aggr);
+    tcase_add_test(tc, test_aggr_window);
+    suite_add_tcase(ps, tc);
+
     return ps;
 }
 
@@ -0,0 +1,209 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// text_log_test.cc
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wgnu-zero-variadic-macro-arguments"
+#endif
+
+#include <check.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+
+#include "log/text_log.h"
+#include "log/log_text.h"
+#include "log/messages.h"
+#include "main/snort.h"
+#include "main/snort_config.h"
+#include "protocols/packet.h"
+#include "sfip/sf_ip.h"
+#include "utils/util.h"
+
+//---------------------------------------------------------------
+
+static const uint64_t uints[] =
+{
+    0, 1, 9, 10, 99, 100, 65535, 4294967295ULL, 18446744073709551615ULL
+};
+
+#define NUM_UINTS (sizeof(uints)/sizeof(uints[0]))
+
+static const char* addrs[] =
+{
+    "0.0.0.0", "1.2.3.4", "9.10.99.100", "10.1.2.3", "192.168.100.200",
+    "255.255.255.255", "::1", "2001:db8::1", "fe80::20c:29ff:fe4f:ab12"
+};
+
+#define NUM_ADDRS (sizeof(addrs)/sizeof(addrs[0]))
+
+// the timestamps are logged in utc with the year so the expected text
+// doesn't depend on the local zone.  the last second rolls over the
+// date and the year.
+struct TsTest
+{
+    time_t sec;
+    suseconds_t usec;
+    const char* text;
+};
+
+static const TsTest stamps[] =
+{
+    { 1420070398, 999999, "12/31/14-23:59:58.999999 " },
+    { 1420070399,      0, "12/31/14-23:59:59.000000 " },
+    { 1420070399,      1, "12/31/14-23:59:59.000001 " },
+    { 1420070399, 999999, "12/31/14-23:59:59.999999 " },
+    { 1420070400,      0, "01/01/15-00:00:00.000000 " },
+    { 1420070400,  12345, "01/01/15-00:00:00.012345 " },
+    { 1420070399, 500000, "12/31/14-23:59:59.500000 " },
+};
+
+#define NUM_STAMPS (sizeof(stamps)/sizeof(stamps[0]))
+
+static TextLog* txt = nullptr;
+static int output_flags = 0;
+
+static void Init()
+{
+    txt = TextLog_Init("stdout", 4*K_BYTES, 0);
+    output_flags = snort_conf->output_flags;
+}
+
+static void Term()
+{
+    snort_conf->output_flags = output_flags;
+    TextLog_Reset(txt);
+    TextLog_Term(txt);
+    txt = nullptr;
+}
+
+//---------------------------------------------------------------
+
+START_TEST (test_put_uint)
+{
+    char exp[32];
+    snprintf(exp, sizeof(exp), "%" PRIu64, uints[_i]);
+
+    TextLog_Reset(txt);
+    ck_assert(TextLog_PutUInt(txt, uints[_i]));
+    ck_assert_str_eq(txt->buf, exp);
+    ck_assert_int_eq(TextLog_Tell(txt), (int)strlen(exp));
+}
+END_TEST
+
+START_TEST (test_write)
+{
+    TextLog_Reset(txt);
+    ck_assert(TextLog_Write(txt, "abc", 3));
+    ck_assert(TextLog_Puts(txt, " -> "));
+    ck_assert(TextLog_PutUInt(txt, 80));
+    ck_assert_str_eq(txt->buf, "abc -> 80");
+}
+END_TEST
+
+//---------------------------------------------------------------
+
+START_TEST (test_ip_address)
+{
+    sfip_t ip;
+    ck_assert_int_eq(sfip_pton(addrs[_i], &ip), SFIP_SUCCESS);
+
+    char exp[INET6_ADDRSTRLEN];
+    sfip_ntop(&ip, exp, sizeof(exp));
+
+    snort_conf->output_flags &= ~OUTPUT_FLAG__OBFUSCATE;
+
+    TextLog_Reset(txt);
+    LogIpAddress(txt, &ip);
+    ck_assert_str_eq(txt->buf, exp);
+
+    if ( ip.is_ip4() )
+        ck_assert_str_eq(txt->buf, addrs[_i]);
+
+    // obfuscation applies unless the caller turns it off
+    snort_conf->output_flags |= OUTPUT_FLAG__OBFUSCATE;
+
+    TextLog_Reset(txt);
+    LogIpAddress(txt, &ip);
+    ck_assert_str_eq(txt->buf, ObfuscateIpToText(&ip));
+
+    TextLog_Reset(txt);
+    LogIpAddress(txt, &ip, false);
+    ck_assert_str_eq(txt->buf, exp);
+
+    snort_conf->output_flags = output_flags;
+}
+END_TEST
+
+// the stamps are logged in order so each one either hits the cached
+// second from the one before or replaces it.
+START_TEST (test_time_stamp)
+{
+    snort_conf->output_flags |= OUTPUT_FLAG__USE_UTC | OUTPUT_FLAG__INCLUDE_YEAR;
+
+    DAQ_PktHdr_t pkth;
+    memset(&pkth, 0, sizeof(pkth));
+
+    Packet p;
+    p.pkth = &pkth;
+
+    for ( unsigned i = 0; i < NUM_STAMPS; ++i )
+    {
+        pkth.ts.tv_sec = stamps[i].sec;
+        pkth.ts.tv_usec = stamps[i].usec;
+
+        char exp[TIMEBUF_SIZE];
+        ts_print(&pkth.ts, exp);
+        ck_assert_str_eq(exp, stamps[i].text);
+
+        TextLog_Reset(txt);
+        LogTimeStamp(txt, &p);
+        ck_assert_str_eq(txt->buf, stamps[i].text);
+    }
+    snort_conf->output_flags = output_flags;
+}
+END_TEST
+
+//---------------------------------------------------------------
+
+Suite* TEST_SUITE_text_log(void)
+{
+    Suite* ps = suite_create("text_log");
+
+    TCase* tc = tcase_create("format");
+    tcase_add_unchecked_fixture(tc, Init, Term);
+    tcase_add_loop_test(tc, test_put_uint, 0, NUM_UINTS);
+    tcase_add_test(tc, test_write);
+    suite_add_tcase(ps, tc);
+
+    tc = tcase_create("log_text");
+    tcase_add_unchecked_fixture(tc, Init, Term);
+    tcase_add_loop_test(tc, test_ip_address, 0, NUM_ADDRS);
+    tcase_add_test(tc, test_time_stamp);
+    suite_add_tcase(ps, tc);
+
+    return ps;
+}
+
@@ -0,0 +1,277 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// latency.cc
+
+#include "latency.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include <mutex>
+#include <vector>
+
+#include "log/messages.h"
+#include "utils/stats.h"
+
+using namespace std;
+
+THREAD_LOCAL LatencyStats* latency_stats = nullptr;
+
+static double ticks_per_usec = 0.0;
+
+static const char* inspector_names[LATENCY_MAX_INSPECTORS];
+static atomic<unsigned> num_inspectors(0);
+
+// per instance stats are kept until exit so the main thread can merge
+// them at any time, including after a packet thread has stopped
+static mutex instance_mutex;
+static vector<LatencyStats*> instances;
+
+//-------------------------------------------------------------------------
+// histogram
+//-------------------------------------------------------------------------
+
+uint64_t LatencyHistogram::get_limit(unsigned idx)
+{
+    if ( idx < LATENCY_SUB_BUCKETS )
+        return idx;
+
+    unsigned shift = (idx >> LATENCY_SUB_BITS) - 1;
+    uint64_t sub = idx & (LATENCY_SUB_BUCKETS - 1);
+    uint64_t low = (LATENCY_SUB_BUCKETS + sub) << shift;
+
+    return low + ((uint64_t)1 << shift) - 1;
+}
+
+void LatencyHistogram::reset()
+{
+    for ( unsigned i = 0; i < LATENCY_BUCKETS; ++i )
+        counts[i].store(0, memory_order_relaxed);
+
+    num.store(0, memory_order_relaxed);
+    sum.store(0, memory_order_relaxed);
+    max.store(0, memory_order_relaxed);
+}
+
+void LatencyHistogram::add(const LatencyHistogram& rhs)
+{
+    for ( unsigned i = 0; i < LATENCY_BUCKETS; ++i )
+        bump(counts[i], rhs.counts[i].load(memory_order_relaxed));
+
+    bump(num, rhs.get_count());
+    bump(sum, rhs.get_sum());
+
+    if ( rhs.get_max() > get_max() )
+        max.store(rhs.get_max(), memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::get_percentile(double pct) const
+{
+    // counts are summed here rather than using num so that a histogram
+    // being written concurrently still yields a consistent answer
+    uint64_t total = 0;
+
+    for ( unsigned i = 0; i < LATENCY_BUCKETS; ++i )
+        total += counts[i].load(memory_order_relaxed);
+
+    if ( !total )
+        return 0;
+
+    uint64_t target = (uint64_t)(pct * total / 100.0 + 0.5);
+
+    if ( !target )
+        target = 1;
+
+    uint64_t seen = 0;
+
+    for ( unsigned i = 0; i < LATENCY_BUCKETS; ++i )
+    {
+        seen += counts[i].load(memory_order_relaxed);
+
+        if ( seen >= target )
+        {
+            uint64_t lim = get_limit(i);
+            return lim < get_max() ? lim : get_max();
+        }
+    }
+    return get_max();
+}
+
+void LatencyStats::add(const LatencyStats& rhs)
+{
+    packet.add(rhs.packet);
+    detect.add(rhs.detect);
+
+    for ( unsigned i = 0; i < LATENCY_MAX_INSPECTORS; ++i )
+        inspector[i].add(rhs.inspector[i]);
+}
+
+//-------------------------------------------------------------------------
+// setup
+//-------------------------------------------------------------------------
+
+void latency_init()
+{
+    if ( ticks_per_usec <= 0.0 )
+        ticks_per_usec = get_ticks_per_usec();
+}
+
+unsigned latency_register(const char* name)
+{
+    unsigned n = num_inspectors.load(memory_order_acquire);
+
+    for ( unsigned i = 0; i < n; ++i )
+        if ( inspector_names[i] == name || !strcmp(inspector_names[i], name) )
+            return i;
+
+    // the last slot is shared by everything that doesn't fit
+    if ( n == LATENCY_MAX_INSPECTORS - 1 )
+        return n;
+
+    inspector_names[n] = name;
+    num_inspectors.store(n + 1, memory_order_release);
+    return n;
+}
+
+void latency_tinit()
+{
+    unsigned id = get_instance_id();
+    lock_guard<mutex> lock(instance_mutex);
+
+    if ( instances.size() <= id )
+        instances.resize(id + 1, nullptr);
+
+    if ( !instances[id] )
+        instances[id] = new LatencyStats;
+
+    latency_stats = instances[id];
+}
+
+void latency_term()
+{
+    lock_guard<mutex> lock(instance_mutex);
+
+    for ( auto* p : instances )
+        delete p;
+
+    instances.clear();
+}
+
+//-------------------------------------------------------------------------
+// reports
+//-------------------------------------------------------------------------
+
+static void format_line(string& s, const char* name, const LatencyHistogram& h)
+{
+    uint64_t n = h.get_count();
+
+    if ( !n )
+        return;
+
+    double scale = (ticks_per_usec > 0.0) ? ticks_per_usec : 1.0;
+    char buf[256];
+
+    snprintf(buf, sizeof(buf),
+        "%20.20s %12" PRIu64 " %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+        name, n, h.get_sum() / scale / n,
+        h.get_percentile(50.0) / scale, h.get_percentile(90.0) / scale,
+        h.get_percentile(99.0) / scale, h.get_percentile(99.9) / scale,
+        h.get_max() / scale);
+
+    s += buf;
+}
+
+static void format_stats(string& s, const LatencyStats& ls, unsigned threads)
+{
+    char buf[256];
+
+    snprintf(buf, sizeof(buf),
+        "latency in %s over %u thread%s\n"
+        "%20.20s %12s %10s %10s %10s %10s %10s %10s\n",
+        (ticks_per_usec > 0.0) ? "usecs" : "ticks", threads,
+        (threads == 1) ? "" : "s",
+        "", "count", "mean", "p50", "p90", "p99", "p99.9", "max");
+
+    s += buf;
+
+    format_line(s, "packet", ls.packet);
+    format_line(s, "detect", ls.detect);
+
+    unsigned n = num_inspectors.load(memory_order_acquire);
+
+    for ( unsigned i = 0; i < n; ++i )
+        format_line(s, inspector_names[i], ls.inspector[i]);
+
+    format_line(s, "other", ls.inspector[LATENCY_MAX_INSPECTORS - 1]);
+}
+
+void latency_format(string& s, bool merged)
+{
+    if ( !merged )
+    {
+        if ( latency_stats )
+            format_stats(s, *latency_stats, 1);
+        return;
+    }
+
+    // about 130 KB; too large for a thread stack
+    LatencyStats* sum = new LatencyStats;
+    unsigned threads = 0;
+    {
+        lock_guard<mutex> lock(instance_mutex);
+
+        for ( auto* p : instances )
+        {
+            if ( p )
+            {
+                sum->add(*p);
+                ++threads;
+            }
+        }
+    }
+    if ( threads )
+        format_stats(s, *sum, threads);
+
+    delete sum;
+}
+
+void latency_show_thread()
+{
+    string s;
+    latency_format(s, false);
+
+    if ( !s.empty() )
+        LogMessage("%s", s.c_str());
+}
+
+void latency_show_all()
+{
+    string s;
+    latency_format(s, true);
+
+    if ( s.empty() )
+        return;
+
+    LogLabel("Latency Histograms");
+    LogMessage("%s", s.c_str());
+}
+
@@ -0,0 +1,144 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// latency.h
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+// fixed bucket latency histograms for packet, detection and inspector
+// time.  buckets are log-linear: values < 8 ticks are exact and each
+// power of 2 above that is split into 8 sub-buckets, so any recorded
+// value is reported to within 12.5% using a fixed 4 KB per histogram.
+// each packet thread is the only writer of its own histograms; other
+// threads may read and merge them at any time.
+
+#include <atomic>
+#include <string>
+
+#include "main/snort_types.h"
+#include "main/thread.h"
+#include "time/cpuclock.h"
+
+#define LATENCY_SUB_BITS     3
+#define LATENCY_SUB_BUCKETS  (1 << LATENCY_SUB_BITS)
+#define LATENCY_BUCKETS      ((64 - LATENCY_SUB_BITS + 1) * LATENCY_SUB_BUCKETS)
+
+// inspector types beyond this share the last histogram
+#define LATENCY_MAX_INSPECTORS 32
+
+class LatencyHistogram
+{
+public:
+    LatencyHistogram()
+    { reset(); }
+
+    static unsigned get_index(uint64_t ticks)
+    {
+        if ( ticks < LATENCY_SUB_BUCKETS )
+            return (unsigned)ticks;
+
+        unsigned msb = 63 - __builtin_clzll(ticks);
+        unsigned sub = (ticks >> (msb - LATENCY_SUB_BITS)) & (LATENCY_SUB_BUCKETS - 1);
+        return ((msb - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS) + sub;
+    }
+
+    // largest value that maps to the given bucket
+    static uint64_t get_limit(unsigned idx);
+
+    // single writer only; relaxed stores keep this a few plain moves
+    void record(uint64_t ticks)
+    {
+        bump(counts[get_index(ticks)], 1);
+        bump(num, 1);
+        bump(sum, ticks);
+
+        if ( ticks > max.load(std::memory_order_relaxed) )
+            max.store(ticks, std::memory_order_relaxed);
+    }
+
+    void add(const LatencyHistogram&);
+    void reset();
+
+    uint64_t get_count() const
+    { return num.load(std::memory_order_relaxed); }
+
+    uint64_t get_sum() const
+    { return sum.load(std::memory_order_relaxed); }
+
+    uint64_t get_max() const
+    { return max.load(std::memory_order_relaxed); }
+
+    // smallest bucket limit covering pct (0-100) of the recorded values
+    uint64_t get_percentile(double pct) const;
+
+private:
+    static void bump(std::atomic<uint64_t>& c, uint64_t n)
+    { c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+
+    std::atomic<uint64_t> counts[LATENCY_BUCKETS];
+    std::atomic<uint64_t> num;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> max;
+};
+
+struct LatencyStats
+{
+    LatencyHistogram packet;
+    LatencyHistogram detect;
+    LatencyHistogram inspector[LATENCY_MAX_INSPECTORS];
+
+    void add(const LatencyStats&);
+};
+
+// null unless latency.histograms is enabled
+extern THREAD_LOCAL LatencyStats* latency_stats;
+
+#define LATENCY_VARS \
+    uint64_t latency_start = 0
+
+#define LATENCY_START() \
+    if ( latency_stats ) get_clockticks(latency_start)
+
+#define LATENCY_END(hist) \
+    if ( latency_stats ) latency_record(latency_stats->hist, latency_start)
+
+static inline void latency_record(LatencyHistogram& h, uint64_t start)
+{
+    uint64_t now = 0;
+    get_clockticks(now);
+    h.record(now - start);
+}
+
+// calibrates the tick rate; called once at startup when enabled
+void latency_init();
+
+// returns a histogram index for the inspector type name; called at
+// configuration time and cached by the inspector
+unsigned latency_register(const char* name);
+
+void latency_tinit();
+void latency_term();
+
+// report this thread's histograms or all threads merged
+void latency_format(std::string&, bool merged);
+
+void latency_show_thread();
+void latency_show_all();
+
+#endif
+
@@ -27,9 +27,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <unistd.h>
 
 #include <mutex>
+#include <string>
+#include <vector>
 using namespace std;
 
 #include "snort.h"
@@ -45,9 +48,45 @@ using namespace std;
 #include "detection_options.h"
 #include "fpdetect.h"
 #include "framework/module.h"
+#include "framework/ips_option.h"
+#include "hash/sfxhash.h"
+#include "log/messages.h"
 
 #ifdef PERF_PROFILING
 
+THREAD_LOCAL bool profile_rules_sample = true;
+THREAD_LOCAL bool profile_modules_sample = true;
+
+static THREAD_LOCAL unsigned rules_countdown = 1;
+static THREAD_LOCAL unsigned modules_countdown = 1;
+
+static inline unsigned get_sample_rate(const ProfileConfig& pc)
+{
+    return pc.sample > 1 ? pc.sample : 1;
+}
+
+static inline bool next_sample(unsigned& countdown, const ProfileConfig& pc)
+{
+    if ( --countdown )
+        return false;
+
+    countdown = get_sample_rate(pc);
+    return true;
+}
+
+// call once per packet from the daq, not for rebuilt packets, so that
+// everything timed for a packet is timed in full
+void SampleProfiles(void)
+{
+    SnortConfig* sc = snort_conf;
+
+    if ( sc->profile_rules.num )
+        profile_rules_sample = next_sample(rules_countdown, sc->profile_rules);
+
+    if ( sc->profile_preprocs.num )
+        profile_modules_sample = next_sample(modules_countdown, sc->profile_preprocs);
+}
+
 /* Data types *****************************************************************/
 typedef struct _ProfileStatsNode
 {
@@ -221,6 +260,10 @@ void PrintWorstRules(int numToPrint)
         LogMessage("Rule Profile Statistics (all rules)\n");
     }
 
+    if ( get_sample_rate(sc->profile_rules) > 1 )
+        LogMessage("(sampled 1 in %u packets; checks, matches and times are estimates)\n",
+            get_sample_rate(sc->profile_rules));
+
     LogMessage(
 #ifdef PPM_MGR
         "%*s%*s%*s%*s%*s%*s%*s%*s%*s%*s%*s%*s\n",
@@ -313,6 +356,16 @@ static void sum_otn_profile_data(OtnState* state)
         state[0].noalerts += state[i].noalerts;
         state[0].alerts += state[i].alerts;
     }
+
+    // alerts are counted on every packet
+    unsigned n = get_sample_rate(snort_conf->profile_rules);
+
+    state[0].ticks *= n;
+    state[0].ticks_match *= n;
+    state[0].ticks_no_match *= n;
+    state[0].checks *= n;
+    state[0].matches *= n;
+    state[0].noalerts *= n;
 }
 
 void CollectRTNProfile(void)
@@ -638,6 +691,7 @@ void ReleaseProfileStats(void)
     stats_mutex.lock();
 
     ProfileStatsNode* node = gProfileStatsNodeList;
+    unsigned n = get_sample_rate(snort_conf->profile_preprocs);
 
     while (node)
     {
@@ -650,10 +704,10 @@ void ReleaseProfileStats(void)
             ps = node->get_data(node->name);
         assert(ps);
 
-        node->stats.ticks += ps->ticks;
+        node->stats.ticks += ps->ticks * n;
         node->stats.ticks_start += ps->ticks_start;
-        node->stats.checks += ps->checks;
-        node->stats.exits += ps->exits;
+        node->stats.checks += ps->checks * n;
+        node->stats.exits += ps->exits * n;
 
         node = node->next;
     }
@@ -694,6 +748,10 @@ void PrintWorstPreprocs(int numToPrint)
     else
         LogMessage("Module Profile Statistics (all)\n");
 
+    if ( get_sample_rate(snort_conf->profile_preprocs) > 1 )
+        LogMessage("(sampled 1 in %u packets; checks, exits and times are estimates)\n",
+            get_sample_rate(snort_conf->profile_preprocs));
+
     LogMessage("%*s%*s%*s%*s%*s%*s%*s%*s%*s\n",
         4, "Num",
        24, "Preprocessor",
@@ -919,7 +977,271 @@ void ShowPreprocProfiles(void)
         }
     }
     PrintWorstPreprocs(sc->profile_preprocs.num);
-    CleanupProfileStatsNodeList();
+}
+
+//-------------------------------------------------------------------------
+// machine readable dumps
+//-------------------------------------------------------------------------
+// modules, option nodes and rules are written as collapsed stacks:
+//
+//     total;detect;rule eval;rule tree eval;tcp;content;pcre;1:1000:1 1234
+//
+// each line carries the self ticks of its last frame so that flame graph
+// tools can sum the children.  option trees are shared across port groups
+// and their nodes are timed without regard to group so the group frame is
+// the rule protocol.  shared option prefixes appear once, ahead of the
+// rules that use them.
+
+struct ProfileStack
+{
+    string stack;
+    uint64_t checks;
+    uint64_t ticks;
+};
+
+static FILE* open_dump(const char* name)
+{
+    string file = snort_conf->log_dir ? snort_conf->log_dir : ".";
+
+    if ( file.back() != '/' )
+        file += '/';
+
+    file += name;
+
+    FILE* fh = fopen(file.c_str(), "w");
+
+    if ( !fh )
+        ErrorMessage("Can't open profile dump %s: %s\n", file.c_str(), get_error(errno));
+
+    return fh;
+}
+
+static void get_node_stack(ProfileStatsNode* node, string& s)
+{
+    if ( node->parent && node->parent != node )
+    {
+        get_node_stack(node->parent, s);
+        s += ';';
+    }
+    s += node->name;
+}
+
+static const char* get_rule_group(detection_option_tree_node_t* node)
+{
+    while ( node->option_type != RULE_OPTION_TYPE_LEAF_NODE )
+    {
+        if ( !node->num_children )
+            return "any";
+
+        node = node->children[0];
+    }
+    RuleTreeNode* rtn = getRtnFromOtn((OptTreeNode*)node->option_data);
+
+    if ( !rtn )
+        return "any";
+
+    switch ( rtn->proto )
+    {
+    case IPPROTO_TCP:  return "tcp";
+    case IPPROTO_UDP:  return "udp";
+    case IPPROTO_ICMP: return "icmp";
+    default:           return "ip";
+    }
+}
+
+static void get_option_stacks(
+    detection_option_tree_node_t* node, const string& parent,
+    unsigned rate, vector<ProfileStack>& v)
+{
+    ProfileStack ps;
+    ps.stack = parent + ';';
+
+    if ( node->option_type == RULE_OPTION_TYPE_LEAF_NODE )
+    {
+        const OptTreeNode* otn = (OptTreeNode*)node->option_data;
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%u:%u:%u",
+            otn->sigInfo.generator, otn->sigInfo.id, otn->sigInfo.rev);
+        ps.stack += buf;
+    }
+    else
+        ps.stack += ((IpsOption*)node->option_data)->get_name();
+
+    ps.checks = ps.ticks = 0;
+
+    for ( unsigned i = 0; i < get_instance_max(); ++i )
+    {
+        ps.checks += node->state[i].checks;
+        ps.ticks += node->state[i].ticks;
+    }
+
+    ps.checks *= rate;
+    ps.ticks *= rate;
+
+    for ( int i = 0; i < node->num_children; ++i )
+        get_option_stacks(node->children[i], ps.stack, rate, v);
+
+    if ( ps.checks )
+        v.push_back(ps);
+}
+
+static void get_rule_stacks(
+    SnortConfig* sc, const string& prefix, vector<ProfileStack>& v)
+{
+    SFXHASH* doth = sc->detection_option_tree_hash_table;
+
+    if ( !doth )
+        return;
+
+    unsigned rate = get_sample_rate(sc->profile_rules);
+
+    for ( SFXHASH_NODE* hn = sfxhash_findfirst(doth); hn; hn = sfxhash_findnext(doth) )
+    {
+        detection_option_tree_node_t* node = (detection_option_tree_node_t*)hn->data;
+        string s = prefix + get_rule_group(node);
+        get_option_stacks(node, s, rate, v);
+    }
+}
+
+static void get_module_stacks(
+    const char* rule_frame, uint64_t rule_ticks, vector<ProfileStack>& v)
+{
+    for ( ProfileStatsNode* idx = gProfileStatsNodeList; idx; idx = idx->next )
+    {
+        if ( !idx->stats.checks )
+            continue;
+
+        uint64_t ticks = idx->stats.ticks;
+
+        for ( ProfileStatsNode* kid = gProfileStatsNodeList; kid; kid = kid->next )
+            if ( kid != idx && kid->parent == idx )
+                ticks = (ticks > kid->stats.ticks) ? ticks - kid->stats.ticks : 0;
+
+        // option and rule stacks nest under the rule tree
+        if ( !strcmp(idx->name, rule_frame) )
+            ticks = (ticks > rule_ticks) ? ticks - rule_ticks : 0;
+
+        ProfileStack ps;
+        get_node_stack(idx, ps.stack);
+        ps.checks = idx->stats.checks;
+        ps.ticks = ticks;
+        v.push_back(ps);
+    }
+}
+
+static void dump_stacks(FILE* fh, const vector<ProfileStack>& v)
+{
+    for ( const auto& ps : v )
+        if ( ps.ticks )
+            fprintf(fh, "%s " STDu64 "\n", ps.stack.c_str(), ps.ticks);
+}
+
+static void dump_json_stacks(
+    FILE* fh, const char* key, const vector<ProfileStack>& v, bool last)
+{
+    fprintf(fh, "  \"%s\": [", key);
+    const char* sep = "\n";
+
+    for ( const auto& ps : v )
+    {
+        fprintf(fh, "%s    { \"stack\": \"%s\", \"checks\": " STDu64 ", \"ticks\": " STDu64 " }",
+            sep, ps.stack.c_str(), ps.checks, ps.ticks);
+        sep = ",\n";
+    }
+    fprintf(fh, "\n  ]%s\n", last ? "" : ",");
+}
+
+static void dump_json_rules(FILE* fh, SnortConfig* sc)
+{
+    fprintf(fh, "  \"rules\": [");
+    const char* sep = "\n";
+
+    for ( SFGHASH_NODE* hn = sfghash_findfirst(sc->otn_map); hn;
+        hn = sfghash_findnext(sc->otn_map) )
+    {
+        const OptTreeNode* otn = (OptTreeNode*)hn->data;
+        const OtnState* state = otn->state;  // summed by CollectRTNProfile()
+
+        if ( !state->checks )
+            continue;
+
+        fprintf(fh,
+            "%s    { \"gid\": %u, \"sid\": %u, \"rev\": %u, "
+            "\"checks\": " STDu64 ", \"matches\": " STDu64 ", \"alerts\": " STDu64 ", "
+            "\"ticks\": " STDu64 ", \"ticks_match\": " STDu64 ", \"ticks_no_match\": " STDu64 " }",
+            sep, otn->sigInfo.generator, otn->sigInfo.id, otn->sigInfo.rev,
+            state->checks, state->matches, state->alerts,
+            state->ticks, state->ticks_match, state->ticks_no_match);
+
+        sep = ",\n";
+    }
+    fprintf(fh, "\n  ],\n");
+}
+
+void DumpProfiles(void)
+{
+    SnortConfig* sc = snort_conf;
+
+    if ( !sc || (!sc->profile_json && !sc->profile_stacks) )
+        return;
+
+    getTicksPerMicrosec();
+    link_nodes();
+
+    const char* rule_frame = "rule tree eval";
+    vector<ProfileStack> rules, modules;
+
+    if ( sc->profile_rules.num )
+    {
+        string prefix;
+        ProfileStatsNode* node = get_node(rule_frame);
+
+        if ( node )
+            get_node_stack(node, prefix);
+        else
+            prefix = rule_frame;
+
+        prefix += ';';
+        get_rule_stacks(sc, prefix, rules);
+    }
+
+    if ( sc->profile_preprocs.num )
+    {
+        uint64_t rule_ticks = 0;
+
+        for ( const auto& ps : rules )
+            rule_ticks += ps.ticks;
+
+        get_module_stacks(rule_frame, rule_ticks, modules);
+    }
+
+    if ( sc->profile_stacks )
+    {
+        if ( FILE* fh = open_dump("profile.stacks") )
+        {
+            dump_stacks(fh, modules);
+            dump_stacks(fh, rules);
+            fclose(fh);
+        }
+    }
+
+    if ( sc->profile_json )
+    {
+        if ( FILE* fh = open_dump("profile.json") )
+        {
+            fprintf(fh, "{\n  \"ticks_per_usec\": %.3f,\n", ticks_per_microsec);
+            fprintf(fh, "  \"rule_sample\": %u,\n", get_sample_rate(sc->profile_rules));
+            fprintf(fh, "  \"module_sample\": %u,\n", get_sample_rate(sc->profile_preprocs));
+
+            if ( sc->profile_rules.num )
+                dump_json_rules(fh, sc);
+
+            dump_json_stacks(fh, "options", rules, false);
+            dump_json_stacks(fh, "modules", modules, true);
+            fprintf(fh, "}\n");
+            fclose(fh);
+        }
+    }
 }
 
 #endif
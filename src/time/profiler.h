@@ -64,8 +64,13 @@ struct ProfileStats
     PROFILE_END_NAMED(node); \
     node_ticks_delta = node_ticks_end - node_ticks_start
 
+// when sampling, only every Nth packet is timed and the results are
+// scaled by N; these are set at the start of each packet
+extern SO_PUBLIC THREAD_LOCAL bool profile_rules_sample;
+extern SO_PUBLIC THREAD_LOCAL bool profile_modules_sample;
+
 #ifndef PROFILING_RULES
-#define PROFILING_RULES ScProfileRules()
+#define PROFILING_RULES (ScProfileRules() && profile_rules_sample)
 #endif
 
 #define NODE_PROFILE_VARS \
@@ -108,7 +113,7 @@ struct ProfileStats
 #define OTN_PROFILE_ALERT(otn) otn->state[get_instance_id()].alerts++;
 
 #ifndef PROFILING_MODULES
-#define PROFILING_MODULES ScProfilePreprocs()
+#define PROFILING_MODULES (ScProfilePreprocs() && profile_modules_sample)
 #endif
 
 #define MODULE_PROFILE_START_NAMED(name, ppstat) \
@@ -163,8 +168,11 @@ struct ProfileConfig
 {
     int num;
     int sort;
+    unsigned sample;  // time every Nth packet; 0 or 1 is every packet
 };
 
+void SampleProfiles(void);
+
 // thread local access method
 typedef ProfileStats* (*get_profile_func)(const char*);
 
@@ -176,6 +184,10 @@ void RegisterProfile(class Module*);
 
 void ShowPreprocProfiles(void);
 void ResetPreprocProfiling(void);
+
+// write profile.json and/or profile.stacks (collapsed stacks for flame
+// graphs) to the log directory; call after Show*Profiles()
+void DumpProfiles(void);
 void ReleaseProfileStats(void);
 void CleanupProfileStatsNodeList(void);
 
@@ -210,6 +222,7 @@ static inline void ShowAllProfiles()
 #ifdef PERF_PROFILING
     ShowPreprocProfiles();
     ShowRuleProfiles();
+    DumpProfiles();
 #endif
 }
 
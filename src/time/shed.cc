@@ -0,0 +1,152 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// shed.cc
+
+#include "shed.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "packet_io/sfdaq.h"
+
+const PegInfo shed_pegs[] =
+{
+    { "windows", "shedding decisions made" },
+    { "raised", "times the shed level was raised" },
+    { "lowered", "times the shed level was lowered" },
+    { "over latency", "windows with average packet time above max_packet_time" },
+    { "over queue", "windows with daq queue depth above max_queue" },
+    { "flows", "new flows set up" },
+    { "flows without pcre", "new flows set up at shed level 1" },
+    { "flows without files", "new flows set up at shed level 2" },
+    { "flows without http norm", "new flows set up at shed level 3" },
+    { "pcre skipped", "pcre options not evaluated due to shedding" },
+    { "files skipped", "file data not processed due to shedding" },
+    { "http norm skipped", "http sessions without decompression or javascript normalization" },
+    { nullptr, nullptr }
+};
+
+THREAD_LOCAL ShedStats shed_stats;
+THREAD_LOCAL const ShedConfig* shed_config = nullptr;
+
+static THREAD_LOCAL unsigned shed_level = 0;
+static THREAD_LOCAL unsigned packets = 0;
+static THREAD_LOCAL unsigned calm = 0;        // consecutive windows well under target
+static THREAD_LOCAL uint64_t avg_ticks = 0;   // moving average, 1/16 weight
+
+void shed_init(ShedConfig* sc)
+{
+    if ( sc->max_pkt_usecs )
+        sc->max_pkt_ticks = (uint64_t)(sc->max_pkt_usecs * get_ticks_per_usec());
+}
+
+void shed_tinit(const ShedConfig* sc)
+{
+    shed_config = sc->enabled() ? sc : nullptr;
+    shed_level = packets = calm = 0;
+    avg_ticks = 0;
+}
+
+static uint64_t get_queue_depth()
+{
+    const DAQ_Stats_t* ps = DAQ_GetStats();
+    uint64_t done = ps->packets_received + ps->packets_filtered;
+
+    return (ps->hw_packets_received > done) ? ps->hw_packets_received - done : 0;
+}
+
+static void decide()
+{
+    bool over = false;
+    bool quiet = true;
+
+    ++shed_stats.windows;
+
+    if ( shed_config->max_pkt_ticks )
+    {
+        if ( avg_ticks > shed_config->max_pkt_ticks )
+        {
+            ++shed_stats.over_latency;
+            over = true;
+        }
+        else if ( avg_ticks > shed_config->max_pkt_ticks / 2 )
+            quiet = false;
+    }
+
+    if ( shed_config->max_queue )
+    {
+        uint64_t depth = get_queue_depth();
+
+        if ( depth > shed_config->max_queue )
+        {
+            ++shed_stats.over_queue;
+            over = true;
+        }
+        else if ( depth > shed_config->max_queue / 2 )
+            quiet = false;
+    }
+
+    if ( over )
+    {
+        calm = 0;
+
+        if ( shed_level < shed_config->max_level )
+        {
+            ++shed_level;
+            ++shed_stats.raised;
+        }
+    }
+    else if ( quiet && shed_level )
+    {
+        if ( ++calm >= shed_config->hold )
+        {
+            --shed_level;
+            ++shed_stats.lowered;
+            calm = 0;
+        }
+    }
+    else
+        calm = 0;
+}
+
+void shed_update(uint64_t start)
+{
+    uint64_t now = 0;
+    get_clockticks(now);
+
+    avg_ticks += ((now - start) >> 4) - (avg_ticks >> 4);
+
+    if ( ++packets < shed_config->window )
+        return;
+
+    packets = 0;
+    decide();
+}
+
+uint8_t shed_new_flow()
+{
+    ++shed_stats.flows;
+
+    if ( !shed_level )
+        return 0;
+
+    ++shed_stats.flows_shed[shed_level - 1];
+    return (uint8_t)((1 << shed_level) - 1);
+}
+
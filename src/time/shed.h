@@ -0,0 +1,98 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// shed.h
+
+#ifndef SHED_H
+#define SHED_H
+
+// adaptive load shedding.  each packet thread tracks a moving average of
+// packet latency and the daq queue depth.  when either exceeds its target
+// for a window of packets the thread raises its shed level, and new flows
+// are set up with the stages for that level disabled.  when both drop
+// well below target for hold windows the level is lowered again.
+// flows keep the fidelity they started with, so degradation is gradual
+// and restoring service does not leave flows with partial state.
+
+#include "main/snort_types.h"
+#include "main/thread.h"
+#include "framework/counts.h"
+#include "time/cpuclock.h"
+
+// stages in the order they are shed
+#define SHED_PCRE      0x01  // pcre rule options fail to match
+#define SHED_FILES     0x02  // no file type or signature processing
+#define SHED_HTTP_NORM 0x04  // no gzip decompression or javascript normalization
+
+#define SHED_MAX_LEVEL 3
+
+struct ShedConfig
+{
+    uint64_t max_pkt_ticks;   // 0 = no latency target
+    unsigned max_pkt_usecs;
+    unsigned max_queue;       // 0 = no queue target
+    unsigned window;          // packets per decision
+    unsigned hold;            // windows below target before lowering
+    unsigned max_level;
+
+    bool enabled() const
+    { return max_pkt_usecs || max_queue; };
+};
+
+struct ShedStats
+{
+    PegCount windows;
+    PegCount raised;
+    PegCount lowered;
+    PegCount over_latency;
+    PegCount over_queue;
+    PegCount flows;
+    PegCount flows_shed[SHED_MAX_LEVEL];
+    PegCount pcre_skipped;
+    PegCount files_skipped;
+    PegCount http_norm_skipped;
+};
+
+extern const PegInfo shed_pegs[];
+extern THREAD_LOCAL ShedStats shed_stats;
+
+// null unless shedding is configured
+extern THREAD_LOCAL const ShedConfig* shed_config;
+
+void shed_init(ShedConfig*);
+void shed_tinit(const ShedConfig*);
+
+#define SHED_VARS \
+    uint64_t shed_start = 0
+
+#define SHED_START() \
+    if ( shed_config ) get_clockticks(shed_start)
+
+#define SHED_END() \
+    if ( shed_config ) shed_update(shed_start)
+
+void shed_update(uint64_t start);
+
+// stages to disable for a flow that is being set up now
+uint8_t shed_new_flow();
+
+// true if the stage was shed for this flow; counts the skip
+#define SHED_SKIP(flow, stage, count) \
+    ((flow) && ((flow)->shed & (stage)) && ++shed_stats.count)
+
+#endif
+
@@ -0,0 +1,108 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// shed_module.cc
+
+#include "shed_module.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "shed.h"
+#include "main/snort_config.h"
+
+//-------------------------------------------------------------------------
+// load_shed attributes
+//-------------------------------------------------------------------------
+
+#define s_name "load_shed"
+#define s_help \
+    "degrade inspection of new flows under load instead of aborting packets"
+
+static const Parameter s_params[] =
+{
+    { "max_packet_time", Parameter::PT_INT, "0:", "0",
+      "average packet latency target (usec), 0 = off" },
+
+    { "max_queue", Parameter::PT_INT, "0:", "0",
+      "daq queue depth target (packets), 0 = off" },
+
+    { "window", Parameter::PT_INT, "1:", "1024",
+      "packets between shedding decisions" },
+
+    { "hold", Parameter::PT_INT, "1:", "8",
+      "windows below half of target before restoring a stage" },
+
+    { "max_level", Parameter::PT_INT, "1:3", "3",
+      "number of stages that may be shed: pcre, then files, then http normalization" },
+
+    { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
+};
+
+//-------------------------------------------------------------------------
+// load_shed module
+//-------------------------------------------------------------------------
+
+ShedModule::ShedModule() : Module(s_name, s_help, s_params) { }
+
+const PegInfo* ShedModule::get_pegs() const
+{ return shed_pegs; }
+
+PegCount* ShedModule::get_counts() const
+{ return (PegCount*)&shed_stats; }
+
+bool ShedModule::begin(const char*, int, SnortConfig* sc)
+{
+    sc->shed_config = ShedConfig();
+    sc->shed_config.window = 1024;
+    sc->shed_config.hold = 8;
+    sc->shed_config.max_level = SHED_MAX_LEVEL;
+    return true;
+}
+
+bool ShedModule::set(const char*, Value& v, SnortConfig* sc)
+{
+    if ( v.is("max_packet_time") )
+        sc->shed_config.max_pkt_usecs = v.get_long();
+
+    else if ( v.is("max_queue") )
+        sc->shed_config.max_queue = v.get_long();
+
+    else if ( v.is("window") )
+        sc->shed_config.window = v.get_long();
+
+    else if ( v.is("hold") )
+        sc->shed_config.hold = v.get_long();
+
+    else if ( v.is("max_level") )
+        sc->shed_config.max_level = v.get_long();
+
+    else
+        return false;
+
+    return true;
+}
+
+bool ShedModule::end(const char*, int, SnortConfig* sc)
+{
+    if ( sc->shed_config.enabled() )
+        shed_init(&sc->shed_config);
+
+    return true;
+}
+
@@ -0,0 +1,158 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+//-------------------------------------------------------------------
+// byte ring - single producer, single consumer queue of variable
+// length records.  the producer and consumer may run on different
+// threads without locking; each record is stored as a 4 byte length
+// followed by the data and may wrap around the end of the store.
+//-------------------------------------------------------------------
+
+#ifndef BYTE_RING_H
+#define BYTE_RING_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+
+class ByteRing {
+public:
+    // size is rounded up to a power of 2
+    ByteRing(unsigned size);
+    ~ByteRing();
+
+    // producer side; false if there isn't room for the record
+    bool put(const uint8_t*, uint32_t len);
+
+    // consumer side; peek returns the length of the next record or 0
+    // if empty and get copies it out and releases the space
+    uint32_t peek();
+    uint32_t get(uint8_t*, uint32_t max);
+
+    unsigned size()
+    { return mask + 1; }
+
+    unsigned used()
+    { return wx.load(std::memory_order_acquire) - rx.load(std::memory_order_acquire); }
+
+    bool empty()
+    { return used() == 0; }
+
+private:
+    void copy_in(unsigned pos, const uint8_t*, unsigned len);
+    void copy_out(unsigned pos, uint8_t*, unsigned len);
+
+private:
+    uint8_t* store;
+    unsigned mask;
+
+    // free running byte offsets; only the producer writes wx and only
+    // the consumer writes rx
+    std::atomic<unsigned> rx;
+    std::atomic<unsigned> wx;
+};
+
+inline ByteRing::ByteRing(unsigned size) : rx(0), wx(0)
+{
+    unsigned sz = 1;
+
+    while ( sz < size )
+        sz <<= 1;
+
+    store = new uint8_t[sz];
+    mask = sz - 1;
+}
+
+inline ByteRing::~ByteRing()
+{
+    delete[] store;
+}
+
+inline void ByteRing::copy_in(unsigned pos, const uint8_t* data, unsigned len)
+{
+    unsigned off = pos & mask;
+    unsigned n = size() - off;
+
+    if ( n > len )
+        n = len;
+
+    memcpy(store + off, data, n);
+
+    if ( n < len )
+        memcpy(store, data + n, len - n);
+}
+
+inline void ByteRing::copy_out(unsigned pos, uint8_t* data, unsigned len)
+{
+    unsigned off = pos & mask;
+    unsigned n = size() - off;
+
+    if ( n > len )
+        n = len;
+
+    memcpy(data, store + off, n);
+
+    if ( n < len )
+        memcpy(data + n, store, len - n);
+}
+
+inline bool ByteRing::put(const uint8_t* data, uint32_t len)
+{
+    unsigned w = wx.load(std::memory_order_relaxed);
+    unsigned r = rx.load(std::memory_order_acquire);
+
+    if ( size() - (w - r) < len + sizeof(len) )
+        return false;
+
+    copy_in(w, (const uint8_t*)&len, sizeof(len));
+    copy_in(w + sizeof(len), data, len);
+
+    wx.store(w + sizeof(len) + len, std::memory_order_release);
+    return true;
+}
+
+inline uint32_t ByteRing::peek()
+{
+    unsigned r = rx.load(std::memory_order_relaxed);
+    unsigned w = wx.load(std::memory_order_acquire);
+
+    if ( r == w )
+        return 0;
+
+    uint32_t len;
+    copy_out(r, (uint8_t*)&len, sizeof(len));
+    return len;
+}
+
+inline uint32_t ByteRing::get(uint8_t* data, uint32_t max)
+{
+    uint32_t len = peek();
+
+    if ( !len || len > max )
+        return 0;
+
+    unsigned r = rx.load(std::memory_order_relaxed);
+    copy_out(r + sizeof(len), data, len);
+
+    rx.store(r + sizeof(len) + len, std::memory_order_release);
+    return len;
+}
+
+#endif
+
@@ -0,0 +1,137 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// memsearch.cc
+
+#include "memsearch.h"
+
+#include <ctype.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static inline bool match_nocase(const uint8_t* buf, const uint8_t* pat, int n)
+{
+    for ( int i = 0; i < n; ++i )
+    {
+        if ( toupper(buf[i]) != pat[i] )
+            return false;
+    }
+    return true;
+}
+
+#ifdef __SSE2__
+// a-z to A-Z as toupper() does in the C locale
+static inline __m128i to_upper(__m128i v)
+{
+    const __m128i lo = _mm_set1_epi8((char)(0x80 + 'a'));
+    const __m128i n = _mm_set1_epi8((char)(0x80 + 26));
+    const __m128i x20 = _mm_set1_epi8(0x20);
+
+    __m128i lower = _mm_cmplt_epi8(_mm_sub_epi8(v, lo), n);
+    return _mm_sub_epi8(v, _mm_and_si128(lower, x20));
+}
+#endif
+
+int memsearch(const uint8_t* buf, int blen, const uint8_t* pat, int plen)
+{
+    if ( plen <= 0 || plen > blen )
+        return -1;
+
+    if ( plen == 1 )
+    {
+        const uint8_t* p = (const uint8_t*)memchr(buf, pat[0], blen);
+        return p ? p - buf : -1;
+    }
+
+    int last = blen - plen;
+    int i = 0;
+
+#ifdef __SSE2__
+    const __m128i first = _mm_set1_epi8((char)pat[0]);
+    const __m128i final = _mm_set1_epi8((char)pat[plen - 1]);
+
+    for ( ; i + 15 <= last; i += 16 )
+    {
+        __m128i f = _mm_loadu_si128((const __m128i*)(buf + i));
+        __m128i l = _mm_loadu_si128((const __m128i*)(buf + i + plen - 1));
+        __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(f, first), _mm_cmpeq_epi8(l, final));
+        unsigned m = _mm_movemask_epi8(eq);
+
+        while ( m )
+        {
+            int j = i + __builtin_ctz(m);
+
+            if ( !memcmp(buf + j + 1, pat + 1, plen - 2) )
+                return j;
+
+            m &= m - 1;
+        }
+    }
+#endif
+
+    for ( ; i <= last; ++i )
+    {
+        if ( buf[i] == pat[0] && buf[i + plen - 1] == pat[plen - 1] &&
+            !memcmp(buf + i + 1, pat + 1, plen - 2) )
+            return i;
+    }
+    return -1;
+}
+
+int memsearch_nocase(const uint8_t* buf, int blen, const uint8_t* pat, int plen)
+{
+    if ( plen <= 0 || plen > blen )
+        return -1;
+
+    int last = blen - plen;
+    int i = 0;
+
+#ifdef __SSE2__
+    const __m128i first = _mm_set1_epi8((char)pat[0]);
+    const __m128i final = _mm_set1_epi8((char)pat[plen - 1]);
+
+    for ( ; i + 15 <= last; i += 16 )
+    {
+        __m128i f = to_upper(_mm_loadu_si128((const __m128i*)(buf + i)));
+        __m128i l = to_upper(_mm_loadu_si128((const __m128i*)(buf + i + plen - 1)));
+        __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(f, first), _mm_cmpeq_epi8(l, final));
+        unsigned m = _mm_movemask_epi8(eq);
+
+        while ( m )
+        {
+            int j = i + __builtin_ctz(m);
+
+            if ( match_nocase(buf + j + 1, pat + 1, plen - 2) )
+                return j;
+
+            m &= m - 1;
+        }
+    }
+#endif
+
+    for ( ; i <= last; ++i )
+    {
+        if ( toupper(buf[i]) == pat[0] && toupper(buf[i + plen - 1]) == pat[plen - 1] &&
+            match_nocase(buf + i + 1, pat + 1, plen - 2) )
+            return i;
+    }
+    return -1;
+}
+
@@ -0,0 +1,41 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// memsearch.h
+
+#ifndef MEMSEARCH_H
+#define MEMSEARCH_H
+
+// single pattern search for content checks.  candidate positions are
+// found by comparing the pattern's first and last bytes against 16 bytes
+// of the buffer at a time and only those are verified.  this beats
+// boyer-moore for the short patterns typical of secondary contents since
+// it needs no tables and rarely verifies a false candidate.
+
+#include <stdint.h>
+
+// patterns at least this long still use boyer-moore; their skips are
+// long enough to pay for the tables
+#define MEMSEARCH_BM_MIN 64
+
+// return the offset of the first occurrence of pat in buf or -1.  the
+// case insensitive version requires an upper case pattern.
+int memsearch(const uint8_t* buf, int blen, const uint8_t* pat, int plen);
+int memsearch_nocase(const uint8_t* buf, int blen, const uint8_t* pat, int plen);
+
+#endif
+
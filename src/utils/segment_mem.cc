@@ -53,6 +53,23 @@ int segment_meminit(uint8_t* buff, size_t mem_cap)
     return 1;
 }
 
+/***************************************************************************
+ * Save and restore the segment state around a private build
+ **************************************************************************/
+void segment_memsave(SegmentMemState* state)
+{
+    state->base_ptr = base_ptr;
+    state->unused_ptr = unused_ptr;
+    state->unused_mem = unused_mem;
+}
+
+void segment_memrestore(const SegmentMemState* state)
+{
+    base_ptr = state->base_ptr;
+    unused_ptr = state->unused_ptr;
+    unused_mem = state->unused_mem;
+}
+
 /***************************************************************************
  * allocate memory block from segment
  * todo:currently, we only allocate memory continuously. Need to reuse freed
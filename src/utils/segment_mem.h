@@ -26,7 +26,18 @@
 
 typedef uint32_t MEM_OFFSET;
 
+/* The allocator state is global.  Callers that build a table in their
+ * own buffer save it first and restore it when done. */
+typedef struct
+{
+    void *base_ptr;
+    MEM_OFFSET unused_ptr;
+    size_t unused_mem;
+} SegmentMemState;
+
 int segment_meminit(uint8_t*, size_t);
+void segment_memsave(SegmentMemState*);
+void segment_memrestore(const SegmentMemState*);
 MEM_OFFSET segment_malloc ( size_t size );
 void segment_free (MEM_OFFSET ptr );
 MEM_OFFSET segment_calloc ( size_t num, size_t size );
@@ -192,7 +192,10 @@
 #include <sys/types.h>
 #include <ctype.h>
 
+#include <algorithm>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include "snort_types.h"
 #include "snort.h"
@@ -1265,37 +1268,156 @@ static SF_LIST * PortObjectItemListFromCharPortArray( char * parray, int n )
 }
 
 /*
- *  Removes Ports in B from A ... A = A - B
+ *  Port sets as sorted, disjoint, non-adjacent ranges.  These give the
+ *  same result as the char port arrays without touching every port of
+ *  wide ranges, which matters when merging many objects with large ranges.
  */
-int PortObjectRemovePorts( PortObject * a,  PortObject * b )
+typedef std::pair<int, int> PortRange;
+typedef std::vector<PortRange> PortRanges;
+
+static void PortRangesMerge( PortRanges& v )
 {
-    int i;
-    int nportsa;
-    int nportsb;
-    SF_LIST * plist;
+    std::sort(v.begin(), v.end());
 
-    std::unique_ptr<char[]> upA(new char[SFPO_MAX_PORTS]);
-    std::unique_ptr<char[]> upB(new char[SFPO_MAX_PORTS]);
+    unsigned n = 0;
+
+    for( unsigned i = 0; i < v.size(); i++ )
+    {
+        if( n && v[i].first <= v[n-1].second + 1 )
+        {
+            if( v[i].second > v[n-1].second )
+                v[n-1].second = v[i].second;
+        }
+        else
+            v[n++] = v[i];
+    }
+    v.resize(n);
+}
 
-    char* pA = upA.get();
-    char* pB = upB.get();
+/* a = a - b */
+static void PortRangesRemove( PortRanges& a, const PortRanges& b )
+{
+    PortRanges out;
+    unsigned j = 0;
 
-    memset(pA,0,SFPO_MAX_PORTS);
-    memset(pB,0,SFPO_MAX_PORTS);
+    for( auto r : a )
+    {
+        while( j < b.size() && b[j].second < r.first )
+            j++;
 
-    /* Create a char array of ports */
-    PortObjectCharPortArray ( pA, a, &nportsa );
+        for( unsigned k = j; k < b.size() && b[k].first <= r.second; k++ )
+        {
+            if( b[k].first > r.first )
+                out.push_back(PortRange(r.first, b[k].first - 1));
 
-    /* Create a char array of ports */
-    PortObjectCharPortArray ( pB, b, &nportsb );
+            r.first = b[k].second + 1;
 
-    for(i=0;i<SFPO_MAX_PORTS;i++)
+            if( r.first > r.second )
+                break;
+        }
+        if( r.first <= r.second )
+            out.push_back(r);
+    }
+    a.swap(out);
+}
+
+/*
+ *  The ports in po as PortObjectCharPortArray() sees them: the ports
+ *  that are not NOT'd, less the NOT'd ports, or all ports less the
+ *  NOT'd ports for a pure NOT list.  Returns the port count.
+ */
+static int PortObjectRanges( PortObject * po, PortRanges& ranges )
+{
+    PortRanges nots;
+    PortObjectItem * poi;
+    SF_LNODE * pos;
+
+    ranges.clear();
+
+    for(poi=(PortObjectItem*)sflist_first(po->item_list,&pos);
+        poi != 0;
+        poi=(PortObjectItem*)sflist_next(&pos) )
     {
-       if( pB[i] ) pA[i] = 0; /* remove portB from A */
+        PortRanges& v = (poi->flags & PORT_OBJECT_NOT_FLAG) ? nots : ranges;
+
+        if( poi->type == PORT_OBJECT_PORT )
+            v.push_back(PortRange(poi->lport, poi->lport));
+
+        else if( poi->type == PORT_OBJECT_RANGE )
+            v.push_back(PortRange(poi->lport, poi->hport));
     }
 
-    /* Convert the array into a Port Object list */
-    plist = PortObjectItemListFromCharPortArray( pA, SFPO_MAX_PORTS );
+    if( po->item_list->count == nots.size() )
+        ranges.push_back(PortRange(0, SFPO_MAX_PORTS - 1));
+
+    PortRangesMerge(ranges);
+    PortRangesMerge(nots);
+    PortRangesRemove(ranges, nots);
+
+    int cnt = 0;
+
+    for( auto& r : ranges )
+        cnt += r.second - r.first + 1;
+
+    return cnt;
+}
+
+static SF_LIST * PortObjectItemListFromRanges( const PortRanges& ranges )
+{
+    SF_LIST * plist = sflist_new();
+
+    if( !plist )
+        return 0;
+
+    for( auto& r : ranges )
+    {
+        PortObjectItem * poi = PortObjectItemNew();
+
+        if( !poi )
+        {
+            sflist_free_all(plist,free);
+            return 0;
+        }
+
+        if( r.first == r.second )
+        {
+            poi->type = PORT_OBJECT_PORT;
+            poi->lport = (unsigned short)r.first;
+        }
+        else
+        {
+            poi->type = PORT_OBJECT_RANGE;
+            poi->lport = (unsigned short)r.first;
+            poi->hport = (unsigned short)r.second;
+        }
+
+        if( sflist_add_tail( plist, poi ) )
+        {
+            sflist_free_all( plist, free );
+            return 0;
+        }
+    }
+    return plist;
+}
+
+/*
+ *  Removes Ports in B from A ... A = A - B
+ */
+int PortObjectRemovePorts( PortObject * a,  PortObject * b )
+{
+    PortRanges ra, rb;
+    SF_LIST * plist;
+
+    if( !PortObjectHasAny(a) )
+        PortObjectRanges(a, ra);
+
+    if( !PortObjectHasAny(b) )
+        PortObjectRanges(b, rb);
+
+    PortRangesRemove(ra, rb);
+
+    /* Convert the ranges into a Port Object list */
+    plist = PortObjectItemListFromRanges( ra );
 
     /* Release the old port list */
     sflist_free_all( a->item_list, free );
@@ -1315,24 +1437,19 @@ int PortObjectRemovePorts( PortObject * a,  PortObject * b )
  */
 int  PortObjectNormalize (PortObject * po )
 {
+    PortRanges ranges;
     SF_LIST * plist;
-    int nports = 0;
+    int nports;
 
      if( PortObjectHasAny ( po ) )
      {
          return  0; /* ANY =65K */
      }
 
-    std::unique_ptr<char[]> upA(new char[SFPO_MAX_PORTS]);
-    char* parray = upA.get();
-
-     memset(parray,0,SFPO_MAX_PORTS);
-
-     /* Create a char array of ports */
-     PortObjectCharPortArray ( parray, po, &nports );
+     nports = PortObjectRanges( po, ranges );
 
-     /* Convert the array into a Port Object list */
-     plist = PortObjectItemListFromCharPortArray( parray, SFPO_MAX_PORTS );
+     /* Convert the ranges into a Port Object list */
+     plist = PortObjectItemListFromRanges( ranges );
      if( !plist )
          return -1;
 
@@ -1498,6 +1615,9 @@ PortObject2 * PortObject2AppendPortObject(PortObject2 * poa, PortObject * pob )
         prid!= 0;
         prid = (int*)sflist_next(&lpos) )
    {
+       if( sfghash_find(poa->rule_hash,prid) )
+           continue;
+
        prid2 = (int*)calloc( 1, sizeof(int));
        if( !prid2 )
            return 0;
@@ -1524,6 +1644,9 @@ PortObject2 * PortObject2AppendPortObject2(PortObject2 * poa, PortObject2 * pob
        if( !prid )
           continue;
 
+       if( sfghash_find(poa->rule_hash,prid) )
+          continue;
+
        prid2 = (int*)calloc( 1, sizeof(int));
        if( !prid2 )
            return 0;
@@ -1816,6 +1939,102 @@ static unsigned PortObject_hash( SFHASHFCN * p, unsigned char *d, int )
     return hash ^ p->hardener;
 }
 
+/*
+ * Build a PortObject2 with the ports and rules of all the objects in pol.
+ * The rule lists are unioned in a bitset first so each rule is added to
+ * the new rule hash just once, no matter how many objects share it.
+ */
+static PortObject2 * PortObject2Merge( void ** pol, int pol_cnt )
+{
+    std::vector<uint64_t> rules;
+    unsigned nrules = 0;
+    SF_LNODE * lpos;
+    int * prid;
+    int i;
+
+    for(i=0;i<pol_cnt;i++)
+    {
+        PortObject * po = (PortObject *)pol[i];
+
+        for(prid=(int*)sflist_first(po->rule_list,&lpos);
+            prid;
+            prid=(int*)sflist_next(&lpos) )
+        {
+            unsigned r = (unsigned)*prid;
+
+            if( r / 64 >= rules.size() )
+                rules.resize(r / 64 + 1, 0);
+
+            if( !(rules[r / 64] & (1ull << (r % 64))) )
+            {
+                rules[r / 64] |= 1ull << (r % 64);
+                nrules++;
+            }
+        }
+    }
+
+    PortObject2 * ponew = PortObject2New(nrules + PO_EXTRA_RULE_CNT);
+    if( !ponew )
+        return NULL;
+
+    PortObject * po = (PortObject *)pol[0];
+    ponew->name = strdup(po->name ? po->name : "dup");
+
+    if( !ponew->name )
+    {
+        PortObject2Free( ponew );
+        return NULL;
+    }
+
+    /* Dup the 1st port objects ports and append the rest */
+    PortObjectItem * poi;
+
+    for(poi =(PortObjectItem*)sflist_first(po->item_list,&lpos);
+        poi != NULL;
+        poi =(PortObjectItem*)sflist_next(&lpos) )
+    {
+        PortObjectItem * poinew = PortObjectItemDup( poi );
+
+        if( !poinew )
+        {
+            PortObject2Free( ponew );
+            return NULL;
+        }
+        PortObjectAddItem( (PortObject*)ponew, poinew, NULL );
+    }
+
+    if( pol_cnt > 1 )
+    {
+        for(i=1;i<pol_cnt;i++)
+            PortObjectAppend( (PortObject*)ponew, (PortObject *)pol[i] );
+
+        PortObjectNormalize( (PortObject*)ponew );
+    }
+
+    for(unsigned w = 0; w < rules.size(); w++)
+    {
+        uint64_t bits = rules[w];
+
+        while( bits )
+        {
+            int b = __builtin_ctzll(bits);
+            bits &= bits - 1;
+
+            prid = (int*)calloc(1,sizeof(int));
+            if( !prid )
+            {
+                PortObject2Free( ponew );
+                return NULL;
+            }
+            *prid = (int)(w * 64 + b);
+
+            if( sfghash_add( ponew->rule_hash, prid, prid ) != SFGHASH_OK )
+                free( prid );
+        }
+    }
+    return ponew;
+}
+
 /*
  * Merge multiple PortObjects into a final PortObject2,
  * this merges ports and rules.
@@ -1862,7 +2081,6 @@ static PortObject2 * _merge_N_pol(
     PortObject2 * pox;
     plx_t       * plx_tmp;
     int           stat;
-    int           i;
 
     /*
     * Check for the merged port object in the plx table
@@ -1884,28 +2102,13 @@ static PortObject2 * _merge_N_pol(
     */
 
 
-    /* Dup the 1st port objects rules and ports */
-    ponew = PortObject2Dup( (PortObject *)pol[0] );
+    /* Merge the ports and rules of all the port objects */
+    ponew = PortObject2Merge( pol, pol_cnt );
     if( !ponew )
     {
         FatalError("Could not Dup2\n");
     }
 
-    /* Merge in all the other port object rules and ports */
-    if( pol_cnt > 1 )
-    {
-        for(i=1;i<pol_cnt;i++)
-        {
-            DEBUG_WRAP(DebugMessage(DEBUG_PORTLISTS,"*** %d rules in object %d\n",
-                                ((PortObject *)pol[i])->rule_list->count,i););
-            PortObjectAppendEx2( ponew, (PortObject *)pol[i] );
-            DEBUG_WRAP(DebugMessage(DEBUG_PORTLISTS,
-                   "*** merged port-object[%d], %d rules\n",
-                   i,ponew->rule_hash->count););
-        }
-        PortObjectNormalize( (PortObject*)ponew );
-    }
-
     DEBUG_WRAP(DebugMessage(DEBUG_PORTLISTS,
                     "*** merged %d port objects, %d rules\n",
                     pol_cnt,ponew->rule_hash->count););
@@ -2141,6 +2344,62 @@ static PortObject2 * PortTableCompileMergePortObjectList2(
 
     return ponew;
 }
+/*
+ * Where an input port object starts or stops touching ports.
+ */
+struct PortEvent
+{
+    int port;
+    unsigned idx;
+    int delta;
+
+    bool operator<(const PortEvent& rhs) const
+    { return port < rhs.port; }
+};
+
+/*
+ * Add the coverage of po as PortObjectHasPort() sees it: the items up
+ * to the first ANY, with a NOT item covering every port.
+ */
+static void PortObjectAddEvents(
+    PortObject * po, unsigned idx, std::vector<PortEvent>& events )
+{
+    PortObjectItem * poi;
+    SF_LNODE * pos;
+
+    for(poi=(PortObjectItem*)sflist_first(po->item_list,&pos);
+        poi;
+        poi=(PortObjectItem*)sflist_next(&pos) )
+    {
+        int lport, hport;
+
+        if( poi->type == PORT_OBJECT_ANY )
+            break;
+
+        if( poi->flags & PORT_OBJECT_NOT_FLAG )
+        {
+            lport = 0;
+            hport = SFPO_MAX_PORTS - 1;
+        }
+        else if( poi->type == PORT_OBJECT_PORT )
+            lport = hport = poi->lport;
+
+        else if( poi->type == PORT_OBJECT_RANGE )
+        {
+            lport = poi->lport;
+            hport = poi->hport;
+        }
+        else
+            continue;
+
+        events.push_back({ lport, idx, 1 });
+        events.push_back({ hport + 1, idx, -1 });
+
+        if( poi->flags & PORT_OBJECT_NOT_FLAG )
+            break;
+    }
+}
+
 /*
  *
  *
@@ -2153,11 +2412,10 @@ int PortTableCompileMergePortObjects( PortTable * p )
     SF_LNODE   * lpos;
     SFGHASH    * mhash;
     SFGHASH    * mhashx;
-    SFGHASH_NODE * node;
     SF_LIST    * plx_list;
+    PortObject * po;
     int          id = PO_INIT_ID;
     int          pol_cnt;
-    char  *      parray = NULL;
     int i;
 
     DEBUG_WRAP(DebugMessage(DEBUG_PORTLISTS,"***\n***Merging PortObjects->PortObjects2\n***\n"););
@@ -2202,178 +2460,120 @@ int PortTableCompileMergePortObjects( PortTable * p )
     /*
      *  For each port, merge rules from all port objects that touch the port
      *  into an optimal object, that may be shared with other ports.
+     *
+     *  The ports are swept in order with the set of touching objects
+     *  updated only where some object's coverage starts or ends, so the
+     *  merge is redone once per distinct run of ports instead of testing
+     *  every object against every port.
      */
-    for(i=0;i<SFPO_MAX_PORTS;i++)
+    std::vector<PortObject*> polist;
+    std::vector<PortEvent> events;
+
+    for(po=(PortObject*)sflist_first(p->pt_polist,&lpos);
+        po;
+        po=(PortObject*)sflist_next(&lpos) )
     {
-        PortObject * po;
+        PortObjectAddEvents(po, polist.size(), events);
+        polist.push_back(po);
+    }
+    std::sort(events.begin(), events.end());
 
-        /* Build a list of port objects touching port 'i' */
-        pol_cnt = 0;
-        for(po=(PortObject*)sflist_first(p->pt_polist,&lpos);
-            po;
-            po=(PortObject*)sflist_next(&lpos) )
-        {
-            if( PortObjectHasPort ( po, i  ) )
-            {
-                if( pol_cnt < SFPO_MAX_LPORTS )
-                {
-                    pol[ pol_cnt++ ] = po;
-                }
-            }
-        }
-        p->pt_port_object[i] = 0;
+    std::vector<unsigned> active(polist.size(), 0);
+    PortObject2* last = NULL;
+    unsigned ev = 0;
+    bool changed = true;
 
-        if( !pol_cnt )
+    for(i=0;i<SFPO_MAX_PORTS;i++)
+    {
+        while ( ev < events.size() && events[ev].port == i )
         {
-            //port not contained in any PortObject
-            continue;
+            active[events[ev].idx] += events[ev].delta;
+            changed = true;
+            ev++;
         }
 
-        DEBUG_WRAP(DebugMessage(DEBUG_PORTLISTS,"*** merging list for port[%d] \n",i);fflush(stdout););
-
-        /* merge the rules into an optimal port object */
-        p->pt_port_object[i] =
-            PortTableCompileMergePortObjectList2( mhash, mhashx, plx_list, pol, pol_cnt, p->pt_lrc );
-        if( !p->pt_port_object[i] )
+        if ( changed )
         {
-            FatalError(" Could not merge PorObjectList on port %d\n",i);
-        }
+            /* Build a list of port objects touching port 'i' */
+            pol_cnt = 0;
 
-        /* give the new compiled port object an id of its own */
-        p->pt_port_object[i]->id = id++;
-
-        DEBUG_WRAP(DebugMessage(DEBUG_PORTLISTS,"\n");fflush(stdout););
-    }
-
-    /*
-     * Normalize the Ports so they indicate only the ports that
-     * reference the composite port object
-     */
+            for ( unsigned j = 0; j < polist.size(); j++ )
+            {
+                if ( active[j] && pol_cnt < SFPO_MAX_LPORTS )
+                    pol[ pol_cnt++ ] = polist[j];
+            }
 
-    /* 1st- Setup bitmasks for collecting ports */
-    for(node=sfghash_findfirst(mhashx);
-        node;
-        node=sfghash_findnext(mhashx) )
-    {
-        unsigned char * buf;
-        PortObject2 * poa;
+            DEBUG_WRAP(DebugMessage(DEBUG_PORTLISTS,"*** merging list for port[%d] \n",i);fflush(stdout););
 
-        poa = (PortObject2*)node->data;
-        if( !poa )
-            continue;
+            /* merge the rules into an optimal port object */
+            last = pol_cnt ? PortTableCompileMergePortObjectList2(
+                mhash, mhashx, plx_list, pol, pol_cnt, p->pt_lrc ) : NULL;
 
-        if (!poa->bitop)
-        {
-            poa->bitop = (BITOP*)calloc(1,sizeof(BITOP));
-            if( !poa->bitop)
-            {
-                FatalError("Memory error in PortTableCompile\n");
-            }
-            buf = (unsigned char*)calloc(1,8192);
-            if( !buf )
-            {
-                FatalError("Memory alloc error in PortObjectCompile()\n");
-            }
-            if( boInitStaticBITOP(poa->bitop,8192,buf) )
+            if( pol_cnt && !last )
             {
-                FatalError("BitOp error in PortObjectCompile()\n");
+                FatalError(" Could not merge PorObjectList on port %d\n",i);
             }
+            changed = false;
         }
-    }
+        p->pt_port_object[i] = last;
 
-    /* Count how many ports each final port-object is used on */
-    for(i=0;i<SFPO_MAX_PORTS;i++)
-    {
-        PortObject2 * poa;
-        poa = p->pt_port_object[i];
-        if(poa)
+        if ( !last )
         {
-            poa->port_cnt++;
-            if( poa->bitop )
-            {
-                if( boSetBit(poa->bitop, (unsigned int) i ) )
-                {
-                    FatalError("BitOp-Set error\n");
-                }
-            }
-            else
-            {
-                FatalError("NULL po->bitop in po on port %d\n",i);
-            }
+            //port not contained in any PortObject
+            continue;
         }
-    }
 
-    /* get a port array 64K bytes */
-    parray = (char*)calloc(1,SFPO_MAX_PORTS);
-    if(!parray)
-    {
-        FatalError("Memory error in PortTableCompile()\n");
+        /* give the new compiled port object an id of its own */
+        last->id = id++;
     }
 
-    /* Process Port-Bitop map and print final port-object usage stats */
-    for(node=sfghash_findfirst(mhashx);
-        node;
-        node=sfghash_findnext(mhashx) )
+    /*
+     * Normalize the Ports so they indicate only the ports that
+     * reference the composite port object.  Each run of ports
+     * assigned to the same object becomes one item in its list.
+     */
+    for(i=0;i<SFPO_MAX_PORTS;)
     {
-        SF_LIST     * plist;
-        PortObject2 * po;
+        PortObject2 * po2 = p->pt_port_object[i];
+        int lport = i;
 
-        po = (PortObject2*)node->data;
-        if( !po )
-        {
-            FatalError("MergePortOBject-NormalizePorts -NULL po\n");
-        }
+        while ( i < SFPO_MAX_PORTS && p->pt_port_object[i] == po2 )
+            i++;
 
-        if( !po->port_cnt )/* port object is not used ignore it */
+        if( !po2 )
             continue;
 
-        if( !po->bitop )
+        if( !po2->port_cnt )
         {
-            //FatalError("MergePortOBject-NormalizePorts -NULL po->bitop\n");
-            continue;
-        }
+            /* replace the merged list on first use */
+            sflist_free_all( po2->item_list, free );
+            po2->item_list = sflist_new();
 
-        /* Convert the bitop bits to a char array */
-        memset(parray,0,SFPO_MAX_PORTS);
-        for(i=0;i<SFPO_MAX_PORTS;i++)
-        {
-          if(  boIsBitSet(po->bitop, i ) )
-          {
-             parray[ i ] = 1;
-          }
+            if( !po2->item_list )
+                FatalError("Memory error in PortTableCompile()\n");
         }
+        po2->port_cnt += i - lport;
+
+        PortObjectItem * poi = PortObjectItemNew();
 
-        /* Release bit buffer for each port object */
-        if( po->bitop )
+        if( !poi )
+            FatalError("Memory error in PortTableCompile()\n");
+
+        if( i - 1 == lport )
         {
-            //if( po->bitop->pucBitBuffer )
-            //{
-            //    free( po->bitop->pucBitBuffer );
-            //    po->bitop->pucBitBuffer = NULL;
-            //}
-            boFreeBITOP(po->bitop);
-            free( po->bitop );
-            po->bitop=NULL;
+            poi->type = PORT_OBJECT_PORT;
+            poi->lport = (unsigned short)lport;
         }
-
-        /* Build a PortObjectItem list from the char array */
-        plist = PortObjectItemListFromCharPortArray( parray, SFPO_MAX_PORTS );
-        if( !plist )
+        else
         {
-           FatalError("MergePortObjects: No PortObjectItems in portobject\n");
+            poi->type = PORT_OBJECT_RANGE;
+            poi->lport = (unsigned short)lport;
+            poi->hport = (unsigned short)(i - 1);
         }
-
-        /* free the original list */
-        sflist_free_all( po->item_list, free );
-
-        /* set the new list - this is a list of port itmes for this port object */
-        po->item_list = plist;
-
-        DEBUG_WRAP(DebugMessage(DEBUG_PORTLISTS,"port-object id = %d, port cnt = %d\n",po->id,po->port_cnt););
+        if( sflist_add_tail( po2->item_list, poi ) )
+            FatalError("Memory error in PortTableCompile()\n");
     }
 
-    if(parray) free(parray);
-
     return 0;
 }
 /*
@@ -2443,9 +2643,14 @@ int PortTableConsistencyCheck( PortTable *p )
         if( !po->port_cnt )/* port object is not used ignore it */
               continue;
 
-        for(i=0;i<SFPO_MAX_PORTS;i++)
+        /* compiled objects hold only plain ports and ranges */
+        for(poi=(PortObjectItem*)sflist_first(po->item_list,&ipos);
+            poi;
+            poi=(PortObjectItem*)sflist_next(&ipos) )
         {
-           if( PortObjectHasPort( (PortObject*)po, i  ) )
+           int hport = (poi->type == PORT_OBJECT_RANGE) ? poi->hport : poi->lport;
+
+           for(i=poi->lport;i<=hport;i++)
            {
               if( parray[i] )
               {
@@ -2550,6 +2755,41 @@ int PortTableCompile( PortTable * p )
 
     return 0;
 }
+
+/*
+* Compile several PortTables, two to a thread if parallel.  The tables
+* share no port objects so they can be compiled at once.  snort_conf is
+* thread local and selects static hashing, so the workers are given this
+* thread's config to hash exactly as a serial compile would.
+*/
+void PortTablesCompile( PortTable ** tables, unsigned num, bool parallel )
+{
+    if( !parallel )
+    {
+        for( unsigned i = 0; i < num; i++ )
+            PortTableCompile(tables[i]);
+        return;
+    }
+
+    SnortConfig* sc = snort_conf;
+    std::vector<std::thread> workers;
+
+    for( unsigned i = 0; i < num; i += 2 )
+    {
+        PortTable ** pt = tables + i;
+        unsigned n = (num - i < 2) ? num - i : 2;
+
+        workers.push_back(std::thread([sc, pt, n]
+        {
+            snort_conf = sc;
+
+            for( unsigned j = 0; j < n; j++ )
+                PortTableCompile(pt[j]);
+        }));
+    }
+    for( auto& w : workers )
+        w.join();
+}
 static int integer_compare( const void *arg1, const void *arg2 )
 {
    if( *(int*)arg1 <  *(int*)arg2 ) return -1;
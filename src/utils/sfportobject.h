@@ -221,6 +221,7 @@ int          PortTableAddObject( PortTable *p, PortObject * po );
 int          PortTableAddObjectRaw( PortTable *p, PortObject * po );
 int          PortTableAddRule  ( PortTable * p, int port, int rule );
 int          PortTableCompile  ( PortTable * P);
+void         PortTablesCompile ( PortTable ** tables, unsigned num, bool parallel );
 void         PortTablePrintInputEx( PortTable * p, 
                     void (*rule_index_map_print)(int index, char *buf, int bufsize) );
 int          PortTablePrintCompiledEx( PortTable * p, 
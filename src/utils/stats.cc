@@ -37,6 +37,7 @@
 #include "managers/codec_manager.h"
 #include "detection/fpcreate.h"
 #include "filters/sfthreshold.h"
+#include "time/latency.h"
 
 #define STATS_SEPARATOR \
     "--------------------------------------------------"
@@ -329,6 +330,7 @@ void PrintStatistics (void)
 {   
     DropStats();
     timing_stats();
+    latency_show_all();
 
     // FIXIT-L below stats need to be made consistent with above
     fpShowEventStats(snort_conf);
@@ -0,0 +1,297 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// colreader.cc reads alert_columnar files and prints csv.  blocks that
+// can't match the sid or time filters are skipped using the block header
+// without being inflated.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <zlib.h>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "columnar_common.h"
+
+struct Filter
+{
+    bool by_sid;
+    uint32_t sid;
+    uint32_t after;
+    uint32_t before;
+};
+
+static void Usage(const char* prog)
+{
+    fprintf(stderr, "usage: %s [-i] [-s sid] [-a secs] [-b secs] <file> [<file> ...]\n", prog);
+    fprintf(stderr, "    -i       print the block index only\n");
+    fprintf(stderr, "    -s sid   print only events with this sid\n");
+    fprintf(stderr, "    -a secs  print only events at or after this time\n");
+    fprintf(stderr, "    -b secs  print only events at or before this time\n");
+}
+
+static uint32_t Get32(const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return ntohl(v);
+}
+
+static uint16_t Get16(const uint8_t* p)
+{
+    uint16_t v;
+    memcpy(&v, p, 2);
+    return ntohs(v);
+}
+
+static void PrintAddr(const uint8_t* p)
+{
+    static const uint8_t v4_prefix[12] =
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff };
+
+    char buf[INET6_ADDRSTRLEN];
+
+    if ( !memcmp(p, v4_prefix, sizeof(v4_prefix)) )
+        inet_ntop(AF_INET, p + 12, buf, sizeof(buf));
+    else
+        inet_ntop(AF_INET6, p, buf, sizeof(buf));
+
+    printf("%s", buf);
+}
+
+static bool BlockMayMatch(const ColumnarBlockHeader& hdr, const Filter& f)
+{
+    if ( hdr.max_second < f.after || hdr.min_second > f.before )
+        return false;
+
+    if ( !f.by_sid )
+        return true;
+
+    if ( f.sid < hdr.min_sid || f.sid > hdr.max_sid )
+        return false;
+
+    unsigned bit = columnar_bloom_bit(f.sid);
+    return (hdr.sid_bloom[bit >> 5] & (1u << (bit & 31))) != 0;
+}
+
+static void PrintRows(uint8_t* col[], unsigned rows, const Filter& f)
+{
+    for ( unsigned i = 0; i < rows; ++i )
+    {
+        uint32_t sec = Get32(col[COL_SECONDS] + 4*i);
+        uint32_t sid = Get32(col[COL_SID] + 4*i);
+
+        if ( sec < f.after || sec > f.before )
+            continue;
+
+        if ( f.by_sid && sid != f.sid )
+            continue;
+
+        printf("%u.%06u,%u,%u,%u,%u,%u,%u,", sec,
+            Get32(col[COL_MICROSECONDS] + 4*i), Get32(col[COL_EVENT_ID] + 4*i),
+            Get32(col[COL_GID] + 4*i), sid, Get32(col[COL_REV] + 4*i),
+            Get32(col[COL_CLASS] + 4*i), Get32(col[COL_PRIORITY] + 4*i));
+
+        PrintAddr(col[COL_SRC_ADDR] + 16*i);
+        printf(",%u,", Get16(col[COL_SRC_PORT] + 2*i));
+        PrintAddr(col[COL_DST_ADDR] + 16*i);
+
+        printf(",%u,%u,%u,%u\n", Get16(col[COL_DST_PORT] + 2*i),
+            col[COL_PROTO][i], Get32(col[COL_PKT_LEN] + 4*i), col[COL_ACTION][i]);
+    }
+}
+
+static int ReadBlock(FILE* input, const ColumnarBlockHeader& hdr, const Filter& f)
+{
+    ColumnarColumnHeader cols[COL_MAX];
+
+    if ( fread(cols, sizeof(cols), 1, input) != 1 )
+        return -1;
+
+    uint8_t* data[COL_MAX];
+    int ret = 0;
+
+    for ( unsigned i = 0; i < COL_MAX; ++i )
+        data[i] = nullptr;
+
+    for ( unsigned i = 0; i < COL_MAX && !ret; ++i )
+    {
+        uLong raw = ntohl(cols[i].raw_length);
+        uLong len = ntohl(cols[i].length);
+
+        if ( ntohl(cols[i].id) != i || raw != (uLong)hdr.rows * columnar_width[i] )
+        {
+            ret = -1;
+            break;
+        }
+        uint8_t* z = (uint8_t*)malloc(len ? len : 1);
+        data[i] = (uint8_t*)malloc(raw ? raw : 1);
+
+        uLongf out = raw;
+
+        if ( fread(z, len, 1, input) != 1 ||
+            uncompress(data[i], &out, z, len) != Z_OK || out != raw )
+            ret = -1;
+
+        free(z);
+    }
+
+    if ( !ret )
+        PrintRows(data, hdr.rows, f);
+
+    for ( unsigned i = 0; i < COL_MAX; ++i )
+        free(data[i]);
+
+    return ret;
+}
+
+static int ReadFile(const char* name, const Filter& f, bool index)
+{
+    FILE* input = fopen(name, "rb");
+
+    if ( !input )
+    {
+        fprintf(stderr, "Error opening file %s: %s\n", name, strerror(errno));
+        return -1;
+    }
+
+    ColumnarFileHeader fh;
+
+    if ( fread(&fh, sizeof(fh), 1, input) != 1 ||
+        ntohl(fh.magic) != COLUMNAR_MAGIC ||
+        ntohl(fh.version) != COLUMNAR_VERSION ||
+        ntohl(fh.columns) != COL_MAX )
+    {
+        fprintf(stderr, "%s is not a version %u columnar file\n", name, COLUMNAR_VERSION);
+        fclose(input);
+        return -1;
+    }
+
+    ColumnarBlockHeader hdr;
+    unsigned block = 0;
+    int ret = 0;
+
+    while ( fread(&hdr, sizeof(hdr), 1, input) == 1 )
+    {
+        if ( ntohl(hdr.magic) != COLUMNAR_BLOCK_MAGIC )
+        {
+            ret = -1;
+            break;
+        }
+        hdr.rows = ntohl(hdr.rows);
+        hdr.min_second = ntohl(hdr.min_second);
+        hdr.max_second = ntohl(hdr.max_second);
+        hdr.min_sid = ntohl(hdr.min_sid);
+        hdr.max_sid = ntohl(hdr.max_sid);
+        hdr.length = ntohl(hdr.length);
+
+        for ( unsigned i = 0; i < COLUMNAR_BLOOM_WORDS; ++i )
+            hdr.sid_bloom[i] = ntohl(hdr.sid_bloom[i]);
+
+        if ( index )
+            printf("%s,%u,%u,%u,%u,%u,%u,%u\n", name, block, hdr.rows,
+                hdr.min_second, hdr.max_second, hdr.min_sid, hdr.max_sid, hdr.length);
+
+        if ( index || !BlockMayMatch(hdr, f) )
+        {
+            if ( fseek(input, sizeof(ColumnarColumnHeader)*COL_MAX + hdr.length, SEEK_CUR) )
+            {
+                ret = -1;
+                break;
+            }
+        }
+        else if ( ReadBlock(input, hdr, f) )
+        {
+            ret = -1;
+            break;
+        }
+        ++block;
+    }
+
+    if ( ret )
+        fprintf(stderr, "%s: block %u is corrupt\n", name, block);
+
+    fclose(input);
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    Filter f;
+    f.by_sid = false;
+    f.sid = 0;
+    f.after = 0;
+    f.before = UINT32_MAX;
+
+    bool index = false;
+    int c;
+
+    while ( (c = getopt(argc, argv, "is:a:b:")) != -1 )
+    {
+        switch ( c )
+        {
+        case 'i':
+            index = true;
+            break;
+        case 's':
+            f.by_sid = true;
+            f.sid = strtoul(optarg, nullptr, 0);
+            break;
+        case 'a':
+            f.after = strtoul(optarg, nullptr, 0);
+            break;
+        case 'b':
+            f.before = strtoul(optarg, nullptr, 0);
+            break;
+        default:
+            Usage(argv[0]);
+            return -1;
+        }
+    }
+
+    if ( optind >= argc )
+    {
+        Usage(argv[0]);
+        return -1;
+    }
+
+    if ( index )
+        printf("file,block,rows,min_second,max_second,min_sid,max_sid,bytes\n");
+    else
+        printf("time,event_id,gid,sid,rev,class,priority,"
+            "src_addr,src_port,dst_addr,dst_port,proto,pkt_len,action\n");
+
+    int ret = 0;
+
+    for ( int i = optind; i < argc; ++i )
+        if ( ReadFile(argv[i], f, index) )
+            ret = -1;
+
+    return ret;
+}
+
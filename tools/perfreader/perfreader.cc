@@ -0,0 +1,224 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2014-2015 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// perfreader.cc binds the perf_monitor export socket and prints each
+// snapshot received as a csv row.  counters are printed raw; rates are
+// left to whatever consumes the output.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "perf_export_common.h"
+
+static volatile sig_atomic_t stop = 0;
+
+static void Usage(const char* prog)
+{
+    fprintf(stderr, "usage: %s [-n count] [-v] <socket>\n", prog);
+    fprintf(stderr, "    -n count  exit after this many snapshots\n");
+    fprintf(stderr, "    -v        print name: value lines instead of csv\n");
+}
+
+static void Stop(int)
+{
+    stop = 1;
+}
+
+static int OpenSocket(const char* path)
+{
+    struct sockaddr_un addr;
+
+    if ( strlen(path) >= sizeof(addr.sun_path) )
+    {
+        fprintf(stderr, "socket path is too long: %s\n", path);
+        return -1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+
+    if ( fd < 0 )
+    {
+        fprintf(stderr, "Error creating socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    // remove a stale socket left by a prior run
+    unlink(path);
+
+    if ( bind(fd, (struct sockaddr*)&addr, sizeof(addr)) )
+    {
+        fprintf(stderr, "Error binding %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void PrintHeader()
+{
+    printf("thread,seq,epoch,time");
+
+    for ( unsigned i = 0; i < PE_MAX; ++i )
+        printf(",%s", perf_export_names[i]);
+
+    printf("\n");
+}
+
+static void PrintRow(const PerfExportHeader* h, const uint64_t* c, unsigned n)
+{
+    printf("%u,%u,%u,%" PRIu64 ".%06" PRIu64, h->thread, h->seq, h->epoch, h->sec, h->usec);
+
+    for ( unsigned i = 0; i < PE_MAX; ++i )
+    {
+        if ( i < n )
+            printf(",%" PRIu64, c[i]);
+        else
+            printf(",");
+    }
+    printf("\n");
+}
+
+static void PrintLong(const PerfExportHeader* h, const uint64_t* c, unsigned n)
+{
+    printf("thread: %u\nseq: %u\nepoch: %u\ntime: %" PRIu64 ".%06" PRIu64 "\n",
+        h->thread, h->seq, h->epoch, h->sec, h->usec);
+
+    for ( unsigned i = 0; i < n; ++i )
+        printf("%s: %" PRIu64 "\n", perf_export_names[i], c[i]);
+
+    printf("\n");
+}
+
+// newer senders may append counters; only the known ones are printed
+static bool Check(const PerfExportHeader* h, ssize_t len, unsigned& n)
+{
+    if ( len < (ssize_t)sizeof(*h) ||
+        h->magic != PERF_EXPORT_MAGIC || h->version != PERF_EXPORT_VERSION )
+        return false;
+
+    if ( (size_t)len < sizeof(*h) + h->count * sizeof(uint64_t) )
+        return false;
+
+    n = h->count < PE_MAX ? h->count : (unsigned)PE_MAX;
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned long count = 0;
+    bool verbose = false;
+    int c;
+
+    while ( (c = getopt(argc, argv, "n:v")) != -1 )
+    {
+        switch ( c )
+        {
+        case 'n':
+            count = strtoul(optarg, nullptr, 0);
+            break;
+        case 'v':
+            verbose = true;
+            break;
+        default:
+            Usage(argv[0]);
+            return -1;
+        }
+    }
+
+    if ( optind + 1 != argc )
+    {
+        Usage(argv[0]);
+        return -1;
+    }
+
+    const char* path = argv[optind];
+    int fd = OpenSocket(path);
+
+    if ( fd < 0 )
+        return -1;
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = Stop;
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    if ( !verbose )
+        PrintHeader();
+
+    // allow for senders with more counters than we know about
+    uint64_t buf[2 * PERF_EXPORT_MAX_SIZE / sizeof(uint64_t)];
+    unsigned long got = 0;
+    int ret = 0;
+
+    while ( !stop && (!count || got < count) )
+    {
+        ssize_t len = recv(fd, buf, sizeof(buf), 0);
+
+        if ( len < 0 )
+        {
+            if ( errno == EINTR )
+                continue;
+
+            fprintf(stderr, "Error reading %s: %s\n", path, strerror(errno));
+            ret = -1;
+            break;
+        }
+
+        const PerfExportHeader* h = (PerfExportHeader*)buf;
+        const uint64_t* counts = (uint64_t*)(h + 1);
+        unsigned n;
+
+        if ( !Check(h, len, n) )
+        {
+            fprintf(stderr, "Skipping invalid %zd byte snapshot\n", len);
+            continue;
+        }
+
+        if ( verbose )
+            PrintLong(h, counts, n);
+        else
+            PrintRow(h, counts, n);
+
+        fflush(stdout);
+        ++got;
+    }
+
+    close(fd);
+    unlink(path);
+
+    return ret;
+}
+
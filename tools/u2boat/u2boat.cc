@@ -52,20 +52,89 @@
 static int GetRecord(FILE *input, u2record *rec);
 static int PcapInitOutput(FILE *output);
 static int PcapConversion(u2record *rec, FILE *output);
+static int U2Conversion(u2record *rec, FILE *output);
 
-static int ConvertLog(FILE *input, FILE *output, const char *format)
+/* Read the next record from an input and work out where it sorts.  Events
+ * carry their own time; packet and extra data records follow their event
+ * so they take the event's time to keep the group together. */
+static int NextRecord(u2iterator *it)
 {
-    u2record tmp_record;
+    uint32_t *fields;
+
+    it->valid = 0;
+
+    if (GetRecord(it->file, &it->current) == FAILURE)
+        return FAILURE;
+
+    switch (it->current.type)
+    {
+        case UNIFIED2_IDS_EVENT:
+        case UNIFIED2_IDS_EVENT_IPV6:
+        case UNIFIED2_IDS_EVENT_MPLS:
+        case UNIFIED2_IDS_EVENT_IPV6_MPLS:
+        case UNIFIED2_IDS_EVENT_VLAN:
+        case UNIFIED2_IDS_EVENT_IPV6_VLAN:
+            fields = (uint32_t *)it->current.data;
+            if (it->current.length >= 4 * sizeof(uint32_t))
+            {
+                it->timestamp = (uint64_t)ntohl(fields[2]) * 1000000 + ntohl(fields[3]);
+            }
+            break;
+
+        case UNIFIED2_PACKET:
+            fields = (uint32_t *)it->current.data;
+            if ((it->timestamp == 0) && (it->current.length >= 5 * sizeof(uint32_t)))
+            {
+                it->timestamp = (uint64_t)ntohl(fields[3]) * 1000000 + ntohl(fields[4]);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    it->valid = 1;
+    return SUCCESS;
+}
+
+/* Pick the input with the oldest pending record.  Ties go to the input the
+ * last record came from so an event and its packets are never split. */
+static u2iterator *NextInput(u2iterator *inputs, int count, u2iterator *last)
+{
+    u2iterator *next = NULL;
+    int i;
+
+    if ((last != NULL) && last->valid)
+        next = last;
+
+    for (i = 0; i < count; i++)
+    {
+        if (!inputs[i].valid)
+            continue;
+
+        if ((next == NULL) || (inputs[i].timestamp < next->timestamp))
+            next = &inputs[i];
+    }
+    return next;
+}
+
+static int ConvertLog(u2iterator *inputs, int count, FILE *output, const char *format)
+{
+    u2iterator *it = NULL;
+    int i, ret = SUCCESS;
 
     /* Determine conversion function */
     int (* ConvertRecord)(u2record *, FILE *) = NULL;
 
-    /* This will become an if/else series once more formats are supported.
-     * Callbacks are used so that this comparison only needs to happen once. */
+    /* Callbacks are used so that this comparison only needs to happen once. */
     if (strncasecmp(format, "pcap", 4) == 0)
     {
         ConvertRecord = PcapConversion;
     }
+    else if (strncasecmp(format, "u2", 2) == 0)
+    {
+        ConvertRecord = U2Conversion;
+    }
 
     if (ConvertRecord == NULL)
     {
@@ -73,35 +142,49 @@ static int ConvertLog(FILE *input, FILE *output, const char *format)
         return FAILURE;
     }
 
-    /* Initialize the record's data pointer */
-    tmp_record.data = (uint8_t*)malloc(MAX_U2RECORD_DATA_LENGTH * sizeof(uint8_t));
-    if (tmp_record.data == NULL)
+    /* Initialize the records' data pointers and prime each input */
+    for (i = 0; i < count; i++)
     {
-        fprintf(stderr, "Error allocating memory, aborting...\n");
-        return FAILURE;
+        inputs[i].current.data = (uint8_t*)malloc(MAX_U2RECORD_DATA_LENGTH * sizeof(uint8_t));
+        inputs[i].current.size = MAX_U2RECORD_DATA_LENGTH;
+        inputs[i].timestamp = 0;
+        inputs[i].valid = 0;
+
+        if (inputs[i].current.data == NULL)
+        {
+            fprintf(stderr, "Error allocating memory, aborting...\n");
+            ret = FAILURE;
+            break;
+        }
+        NextRecord(&inputs[i]);
     }
 
-    /* Run through input file and convert records */
-    while ( !(feof(input) || ferror(input) || ferror(output)) )
+    /* Run through the input files in time order and convert records */
+    while ( (ret == SUCCESS) && !ferror(output) )
     {
-        if (GetRecord(input, &tmp_record) == FAILURE)
+        if ((it = NextInput(inputs, count, it)) == NULL)
         {
             break;
         }
-        if (ConvertRecord(&tmp_record, output) == FAILURE)
+        if (ConvertRecord(&it->current, output) == FAILURE)
         {
             break;
         }
+        NextRecord(it);
     }
-    if (tmp_record.data != NULL)
-    {
-        free(tmp_record.data);
-        tmp_record.data = NULL;
-    }
-    if (ferror(input))
+
+    for (i = 0; i < count; i++)
     {
-        fprintf(stderr, "Error reading input file, aborting...\n");
-        return FAILURE;
+        if (inputs[i].current.data != NULL)
+        {
+            free(inputs[i].current.data);
+            inputs[i].current.data = NULL;
+        }
+        if (ferror(inputs[i].file))
+        {
+            fprintf(stderr, "Error reading input file %s, aborting...\n", inputs[i].filename);
+            ret = FAILURE;
+        }
     }
     if (ferror(output))
     {
@@ -109,7 +192,7 @@ static int ConvertLog(FILE *input, FILE *output, const char *format)
         return FAILURE;
     }
 
-    return SUCCESS;
+    return ret;
 }
 
 /* Create and write the pcap file's global header */
@@ -185,11 +268,28 @@ static int PcapConversion(u2record *rec, FILE *output)
     return SUCCESS;
 }
 
+/* Write a unified2 record back out unchanged */
+static int U2Conversion(u2record *rec, FILE *output)
+{
+    uint32_t hdr[2];
+
+    /* Type and Length are stored in network order */
+    hdr[0] = htonl(rec->type);
+    hdr[1] = htonl(rec->length);
+
+    if ((fwrite(hdr, sizeof(hdr), 1, output) != 1) ||
+        (fwrite(rec->data, rec->length, 1, output) != 1))
+    {
+        fprintf(stderr, "Error: Unable to write unified2 record\n");
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
 /* Retrieve a single unified2 record from input file */
 static int GetRecord(FILE *input, u2record *rec)
 {
     uint32_t items_read;
-    static uint32_t buffer_size = MAX_U2RECORD_DATA_LENGTH;
     uint8_t *tmp;
 
     if (!input || !rec)
@@ -209,7 +309,7 @@ static int GetRecord(FILE *input, u2record *rec)
     rec->length = ntohl(rec->length);
 
     /* Read in the data portion of the record */
-    if (rec->length > buffer_size)
+    if (rec->length > rec->size)
     {
         tmp = (uint8_t*)malloc(rec->length * sizeof(uint8_t));
         if (tmp == NULL)
@@ -224,7 +324,7 @@ static int GetRecord(FILE *input, u2record *rec)
                 free(rec->data);
             }
             rec->data = tmp;
-            buffer_size = rec->length;
+            rec->size = rec->length;
         }
     }
     items_read = fread(rec->data, sizeof(uint8_t), rec->length, input);
@@ -240,11 +340,12 @@ static int GetRecord(FILE *input, u2record *rec)
 
 int main (int argc, char *argv[])
 {
-    char *input_filename = NULL;
     char *output_filename = NULL;
     const char *output_type = NULL;
 
-    FILE *input_file = NULL;
+    u2iterator *inputs = NULL;
+    int num_inputs, i;
+
     FILE *output_file = NULL;
 
     int c, errnum;
@@ -270,57 +371,64 @@ int main (int argc, char *argv[])
         }
     }
 
-    /* At this point, there should be two filenames remaining. */
-    if (optind != (argc - 2))
+    /* At this point, there should be one or more input filenames followed
+     * by the output filename. */
+    if (optind > (argc - 2))
     {
-        fprintf(stderr, "Usage: u2boat [-t type] <infile> <outfile>\n");
+        fprintf(stderr, "Usage: u2boat [-t type] <infile> [<infile> ...] <outfile>\n");
         return FAILURE;
     }
 
-    input_filename = argv[optind];
-    output_filename = argv[optind+1];
+    num_inputs = argc - optind - 1;
+    output_filename = argv[argc-1];
 
     /* Check inputs */
-    if (input_filename == NULL)
-    {
-        fprintf(stderr, "Error: Input filename must be specified.\n");
-        return FAILURE;
-    }
     if (output_type == NULL)
     {
         fprintf(stdout, "Defaulting to pcap output.\n");
         output_type = "pcap";
     }
-    if (strcasecmp(output_type, "pcap"))
+    if (strcasecmp(output_type, "pcap") && strcasecmp(output_type, "u2"))
     {
-        fprintf(stderr, "Invalid output type. Valid types are: pcap\n");
-        return FAILURE;
-    }
-    if (output_filename == NULL)
-    {
-        fprintf(stderr, "Error: Output filename must be specified.\n");
+        fprintf(stderr, "Invalid output type. Valid types are: pcap, u2\n");
         return FAILURE;
     }
 
     /* Open the files */
-    if ((input_file = fopen(input_filename, "r")) == NULL)
+    inputs = (u2iterator*)calloc(num_inputs, sizeof(u2iterator));
+    if (inputs == NULL)
     {
-        fprintf(stderr, "Unable to open file: %s\n", input_filename);
+        fprintf(stderr, "Error allocating memory, aborting...\n");
         return FAILURE;
     }
+    for (i = 0; i < num_inputs; i++)
+    {
+        inputs[i].filename = argv[optind+i];
+
+        if ((inputs[i].file = fopen(inputs[i].filename, "r")) == NULL)
+        {
+            fprintf(stderr, "Unable to open file: %s\n", inputs[i].filename);
+            return FAILURE;
+        }
+    }
     if ((output_file = fopen(output_filename, "w")) == NULL)
     {
         fprintf(stderr, "Unable to open/create file: %s\n", output_filename);
         return FAILURE;
     }
 
-    ConvertLog(input_file, output_file, output_type);
+    ConvertLog(inputs, num_inputs, output_file, output_type);
 
-    if (fclose(input_file) != 0)
+    for (i = 0; i < num_inputs; i++)
     {
-        errnum = errno;
-        fprintf(stderr, "Error closing input: %s\n", strerror(errnum));
+        if (fclose(inputs[i].file) != 0)
+        {
+            errnum = errno;
+            fprintf(stderr, "Error closing input %s: %s\n", inputs[i].filename, strerror(errnum));
+        }
     }
+    free(inputs);
+
     if (fclose(output_file) != 0)
     {
         errnum = errno;
@@ -26,12 +26,15 @@ typedef struct _record {
     uint32_t type;
     uint32_t length;
     uint8_t *data;
+    uint32_t size;      /* allocated size of data */
 } u2record;
 
 typedef struct _u2iterator {
     FILE *file;
     char *filename;
     u2record current;
+    uint64_t timestamp; /* usecs; packets and extra data inherit their event's */
+    int valid;          /* current holds a record that hasn't been converted */
 } u2iterator;
 
 #endif